@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""
+差分アニメーション変換ツール - Animation Delta Encoder
+同じサイズのフレーム画像列を16色に減色し、先頭フレーム（キーフレーム）と
+前のフレームから変わったバイト範囲だけの差分を RetroDeltaAnimation 用のCヘッダーとして出力するプログラム
+
+使用例:
+python anim_delta_encoder.py stand.png walk1.png stand.png walk2.png --durations 500 300 200 300
+→ stand_anim.h (stand_anim_keyframe, stand_anim_delta_data, stand_anim_frame_offsets, stand_anim_durations)
+
+python anim_delta_encoder.py frame_*.png --durations 100 --var-name hero_run
+python anim_delta_encoder.py f0.png f1.png --no-quantize  (16色以下のパレット画像をそのまま使用)
+"""
+
+import sys
+import argparse
+from pathlib import Path
+import numpy as np
+
+from image_to_palette import M5DataGenerator, sanitize_variable_name
+from tile_slicer import load_indexed_image
+
+
+# PaletteDeltaAnimationData と一致させること
+PATCH_HEADER_BYTES = 3
+MAX_PATCH_BYTES = 255
+MAX_OFFSET = 0xFFFF
+
+
+def parse_arguments():
+    """
+    コマンドライン引数を解析する関数
+    """
+    parser = argparse.ArgumentParser(
+        description='フレーム画像列をキーフレーム＋差分のアニメーションデータに変換します',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+使用例:
+  python %(prog)s stand.png walk1.png stand.png walk2.png --durations 500 300 200 300
+  python %(prog)s frame_*.png --durations 100 --palette gameboy
+  python %(prog)s f0.png f1.png --no-quantize  (16色以下のパレット画像をそのまま使用)
+        """
+    )
+
+    parser.add_argument('frames', nargs='+',
+                       help='フレーム画像ファイルのパス（再生順、全て同じサイズ）')
+    parser.add_argument('--durations', type=int, nargs='+', default=[100],
+                       help='各フレームの表示時間（ミリ秒、1つだけなら全フレーム共通）')
+    parser.add_argument('--palette', choices=["classic", "gameboy", "sepia", "neon"],
+                       default="classic", help='減色に使うカラーパレット')
+    parser.add_argument('--dither', action='store_true',
+                       help='Floyd-Steinbergディザリングを使用')
+    parser.add_argument('--color-space', choices=["rgb", "lab", "hsv"], default="lab",
+                       help='色距離の計算に使う色空間')
+    parser.add_argument('--no-quantize', action='store_true',
+                       help='パレットモード画像のインデックスをそのまま使う（16色以下）')
+    parser.add_argument('--merge-gap', type=int, default=PATCH_HEADER_BYTES,
+                       help='このバイト数以下の変化なし区間は前後のパッチにまとめる（パッチの先頭より小さいと得になる）')
+    parser.add_argument('--output', default='',
+                       help='出力ファイル名（デフォルト: <先頭フレーム名>_anim.h）')
+    parser.add_argument('--var-name', default='',
+                       help='C変数名のプレフィックス（デフォルト: 先頭フレームのファイル名から自動生成）')
+
+    return parser.parse_args()
+
+
+def pack_frame(indices):
+    """
+    インデックス配列を1バイト2ピクセルに詰める（行をまたいで連続、PaletteImageDataと同じ並び）
+
+    Args:
+        indices (ndarray): パレットインデックスの2次元配列
+
+    Returns:
+        bytes: 詰めたデータ
+    """
+    flat = indices.flatten().astype(np.uint8)
+    if flat.size % 2:
+        flat = np.append(flat, np.uint8(0))
+    # 下位4bit: 偶数ピクセル, 上位4bit: 奇数ピクセル
+    return bytes(((flat[1::2] & 0x0F) << 4) | (flat[0::2] & 0x0F))
+
+
+def encode_delta(prev, cur, merge_gap):
+    """
+    前のフレームから変わったバイト範囲をパッチ列にする
+
+    Args:
+        prev (bytes): 前のフレーム
+        cur (bytes): 次のフレーム
+        merge_gap (int): まとめる変化なし区間の最大バイト数
+
+    Returns:
+        list: パッチ列のバイト値
+    """
+    changed = [i for i in range(len(cur)) if prev[i] != cur[i]]
+
+    # 近い変化をまとめて [start, end) の区間にする
+    spans = []
+    for i in changed:
+        if spans and i - spans[-1][1] <= merge_gap:
+            spans[-1][1] = i + 1
+        else:
+            spans.append([i, i + 1])
+
+    out = []
+    for start, end in spans:
+        while start < end:
+            length = min(end - start, MAX_PATCH_BYTES)
+            out.extend([start & 0xFF, start >> 8, length])
+            out.extend(cur[start:start + length])
+            start += length
+    return out
+
+
+def format_bytes(values, indent="    ", per_line=16):
+    """
+    バイト列をC配列の中身として整形する
+    """
+    lines = []
+    for i in range(0, len(values), per_line):
+        line = indent + ", ".join(f"0x{b:02X}" for b in values[i:i + per_line])
+        if i + per_line < len(values):
+            line += ","
+        lines.append(line)
+    return lines
+
+
+def generate_header(width, height, keyframe, delta_data, frame_offsets, durations, palette, var_name, source_names):
+    """
+    差分アニメーションのCヘッダーを生成する
+
+    Returns:
+        str: ヘッダーファイルの内容
+    """
+    keyframe_var = f"{var_name}_keyframe"
+    delta_var = f"{var_name}_delta_data"
+    offsets_var = f"{var_name}_frame_offsets"
+    durations_var = f"{var_name}_durations"
+    upper = var_name.upper()
+    frame_count = len(durations)
+    total_size = len(keyframe) + len(delta_data) + len(frame_offsets) * 2 + len(durations) * 2
+    raw_size = len(keyframe) * frame_count
+
+    lines = ["/*"]
+    lines.append(f" * Auto-generated from {', '.join(source_names)}")
+    lines.append(f" * Frames: {frame_count} ({width}x{height})")
+    lines.append(f" * Size: {len(keyframe)} bytes keyframe + {len(delta_data)} bytes deltas"
+                 f" + {(len(frame_offsets) + len(durations)) * 2} bytes index (full frames: {raw_size} bytes)")
+    lines.append(" * ")
+    lines.append(" * M5StampPico Animation Delta Encoder")
+    lines.append(" */")
+    lines.append("")
+    lines.append("#pragma once")
+    lines.append('#include "RetroDeltaAnimation.hpp"')
+    lines.append("")
+
+    # サイズ定数
+    lines.append(f"// 画像サイズ・フレーム数")
+    lines.append(f"#define {upper}_WIDTH       {width}")
+    lines.append(f"#define {upper}_HEIGHT      {height}")
+    lines.append(f"#define {upper}_FRAME_COUNT {frame_count}")
+    lines.append(f"#define {upper}_SIZE        {total_size}")
+    lines.append("")
+
+    # キーフレーム
+    lines.append(f"// 先頭フレーム（1バイトに2ピクセル格納）")
+    lines.append(f"const uint8_t {keyframe_var}[{len(keyframe)}] = {{")
+    lines.extend(format_bytes(list(keyframe)))
+    lines.append("};")
+    lines.append("")
+
+    # 差分データ
+    lines.append(f"// 差分データ（オフセット2バイト＋バイト数1バイト＋置き換えるバイト列 のパッチ列）")
+    lines.append(f"const uint8_t {delta_var}[{max(len(delta_data), 1)}] = {{")
+    for frame in range(frame_count):
+        start, end = frame_offsets[frame], frame_offsets[frame + 1]
+        source = f"frame {frame_count - 1}" if frame == 0 else f"frame {frame - 1}"
+        lines.append(f"    // frame {frame} (from {source}): {end - start} bytes")
+        chunk = format_bytes(delta_data[start:end])
+        if chunk and end < len(delta_data):
+            chunk[-1] += ","
+        lines.extend(chunk)
+    if not delta_data:
+        lines.append("    0x00")
+    lines.append("};")
+    lines.append("")
+
+    # 差分オフセット
+    lines.append(f"// 各フレームの差分の先頭オフセット（frameCount+1要素、末尾はデータサイズ）")
+    lines.append(f"const uint16_t {offsets_var}[{len(frame_offsets)}] = {{")
+    lines.append("    " + ", ".join(str(v) for v in frame_offsets))
+    lines.append("};")
+    lines.append("")
+
+    # 表示時間
+    lines.append(f"// 各フレームの表示時間（ミリ秒）")
+    lines.append(f"const uint16_t {durations_var}[{len(durations)}] = {{")
+    lines.append("    " + ", ".join(str(v) for v in durations))
+    lines.append("};")
+    lines.append("")
+
+    # パレット
+    lines.append(M5DataGenerator.generate_palette_code(palette, var_name))
+    lines.append("")
+
+    lines.append(f"// 使用例:")
+    lines.append(f"// RetroColorPalette pal;")
+    lines.append(f"// {var_name}_palette_init(pal);")
+    lines.append(f"// PaletteDeltaAnimationData data({keyframe_var}, {delta_var}, {offsets_var}, {durations_var},")
+    lines.append(f"//                                {upper}_WIDTH, {upper}_HEIGHT, {upper}_FRAME_COUNT, &pal);")
+    lines.append(f"// RetroDeltaAnimation anim(data);")
+    lines.append(f"// anim.getAnimation().start();")
+    lines.append(f"// anim.drawChanged(renderer, x, y);  // フレームが変わった部分だけ描き直す")
+    lines.append("")
+
+    return "\n".join(lines)
+
+
+def main():
+    """
+    メイン処理関数
+    """
+    try:
+        args = parse_arguments()
+
+        frame_paths = [Path(p) for p in args.frames]
+        for path in frame_paths:
+            if not path.exists():
+                raise FileNotFoundError(f"画像ファイルが見つかりません: {path}")
+
+        durations = args.durations
+        if len(durations) == 1:
+            durations = durations * len(frame_paths)
+        if len(durations) != len(frame_paths):
+            raise ValueError(f"--durations は1個かフレーム数（{len(frame_paths)}個）を指定してください")
+        if any(d <= 0 or d > 0xFFFF for d in durations):
+            raise ValueError("表示時間は1-65535ミリ秒で指定してください")
+
+        var_name = args.var_name if args.var_name else f"{sanitize_variable_name(args.frames[0])}_anim"
+        output_path = Path(args.output) if args.output else frame_paths[0].parent / f"{frame_paths[0].stem}_anim.h"
+
+        print("=" * 50)
+        print("🎞️  差分アニメーション変換ツール開始！")
+        print("=" * 50)
+
+        # 全フレームを同じパレットで減色して詰める
+        packed = []
+        palette = None
+        size = None
+        for path in frame_paths:
+            indices, frame_palette = load_indexed_image(path, args)
+            if size is None:
+                size = indices.shape
+                palette = frame_palette
+            elif indices.shape != size:
+                raise ValueError(f"フレームのサイズが揃っていません: {path}（{indices.shape[1]}x{indices.shape[0]}）")
+            packed.append(pack_frame(indices))
+
+        height, width = size
+        keyframe = packed[0]
+        if len(keyframe) > MAX_OFFSET:
+            raise ValueError(f"フレームが大きすぎます（{len(keyframe)} バイト、16bitオフセットの範囲外）")
+
+        # フレーム0の差分は最終フレームから先頭に戻る変化（ループ用）
+        delta_data = []
+        frame_offsets = []
+        for frame in range(len(packed)):
+            frame_offsets.append(len(delta_data))
+            prev = packed[frame - 1] if len(packed) > 1 else packed[0]
+            delta_data.extend(encode_delta(prev, packed[frame], args.merge_gap))
+        frame_offsets.append(len(delta_data))
+        if len(delta_data) > MAX_OFFSET:
+            raise ValueError(f"差分データが大きすぎます（{len(delta_data)} バイト、16bitオフセットの範囲外）")
+
+        header = generate_header(width, height, keyframe, delta_data, frame_offsets, durations,
+                                 palette, var_name, [p.name for p in frame_paths])
+        with open(output_path, "w", encoding='utf-8') as f:
+            f.write(header)
+
+        total_size = len(keyframe) + len(delta_data) + (len(frame_offsets) + len(durations)) * 2
+        raw_size = len(keyframe) * len(packed)
+        saving = (raw_size - total_size) / raw_size * 100 if raw_size else 0
+
+        print("\n" + "=" * 50)
+        print("✨ 処理完了！")
+        print(f"🎞️  フレーム: {len(packed)} 枚（{width} x {height}）")
+        print(f"📊 サイズ: {total_size} バイト（全フレーム {raw_size} バイト比 {saving:.1f}% 削減）")
+        print(f"📄 {output_path}")
+        print("=" * 50)
+
+    except FileNotFoundError as e:
+        print(f"❌ ファイルエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except ValueError as e:
+        print(f"❌ 値エラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except KeyboardInterrupt:
+        print("\n⚠️ 処理が中断されました")
+        sys.exit(1)
+    except Exception as e:
+        print(f"❌ 予期しないエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
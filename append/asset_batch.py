@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+アセット一括変換 - Asset Batch Converter
+マニフェスト（assets.json）に並べた変換ジョブのうち、入力画像・引数・変換ツールのどれかが
+前回の変換から変わったもの（または出力が消えた・書き換えられたもの）だけを実行するプログラム
+CONFIG_CSBOARD_ASSET_BATCH を有効にすると main/CMakeLists.txt からビルドのたびに呼ばれる
+
+使用例:
+python asset_batch.py                       (assets.json の古いジョブだけ変換)
+python asset_batch.py --list                (各ジョブが最新かどうかを表示するだけ)
+python asset_batch.py --force               (全ジョブを変換し直す)
+python asset_batch.py --manifest other.json (別のマニフェストを使う)
+
+マニフェスト（パスは全てマニフェストのあるディレクトリからの相対パス）:
+{
+  "jobs": [
+    {
+      "name": "dot_landscape",
+      "tool": "image_to_palette.py",
+      "inputs": ["dot_landscape.png"],
+      "args": ["dot_landscape.png", "--dither", "--output", "../main/dot_landscape", "--header-only"],
+      "outputs": ["../main/dot_landscape.h"]
+    }
+  ]
+}
+tool には image_to_palette.py / tile_slicer.py / anim_delta_encoder.py / asset_packer.py を指定する
+ジョブは同じプロセス内で順に実行するので、同じパレットの減色用変換表は1回だけ作られる
+"""
+
+import os
+import sys
+import json
+import argparse
+import importlib
+from pathlib import Path
+
+from convert_cache import ConversionCache, job_digest
+
+
+TOOLS_DIR = Path(__file__).resolve().parent
+DEFAULT_MANIFEST = TOOLS_DIR / "assets.json"
+CACHE_FILE_NAME = ".asset_cache.json"
+
+
+def parse_arguments():
+    """
+    コマンドライン引数を解析する関数
+    """
+    parser = argparse.ArgumentParser(
+        description='マニフェストの変換ジョブのうち、入力が変わったものだけを実行します',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+使用例:
+  python %(prog)s
+  python %(prog)s --list
+  python %(prog)s --force
+        """
+    )
+
+    parser.add_argument('--manifest', default=str(DEFAULT_MANIFEST),
+                       help='マニフェストファイルのパス（デフォルト: このスクリプトと同じ場所の assets.json）')
+    parser.add_argument('--cache', default='',
+                       help=f'キャッシュファイルのパス（デフォルト: マニフェストと同じ場所の {CACHE_FILE_NAME}）')
+    parser.add_argument('--force', action='store_true',
+                       help='キャッシュを無視して全ジョブを変換する')
+    parser.add_argument('--list', action='store_true',
+                       help='変換せずに各ジョブの状態だけを表示する')
+
+    return parser.parse_args()
+
+
+def load_manifest(manifest_path):
+    """
+    マニフェストを読み込んでジョブを検証する
+
+    Args:
+        manifest_path (Path): マニフェストファイルのパス
+
+    Returns:
+        list: ジョブ（dict）のリスト
+    """
+    with open(manifest_path, "r", encoding="utf-8") as f:
+        manifest = json.load(f)
+
+    jobs = manifest.get("jobs", [])
+    names = set()
+    for job in jobs:
+        for key in ("name", "tool", "inputs", "args", "outputs"):
+            if key not in job:
+                raise ValueError(f"ジョブに '{key}' がありません: {job}")
+        if job["name"] in names:
+            raise ValueError(f"ジョブ名が重複しています: {job['name']}")
+        if not (TOOLS_DIR / job["tool"]).exists():
+            raise ValueError(f"変換ツールが見つかりません: {job['tool']}（ジョブ {job['name']}）")
+        names.add(job["name"])
+    return jobs
+
+
+def run_tool(tool, args):
+    """
+    変換ツールの main() を同じプロセス内で実行する
+
+    Args:
+        tool (str): 変換ツールのスクリプト名
+        args (list): 変換ツールに渡す引数
+
+    Returns:
+        bool: 成功した場合True
+    """
+    module = importlib.import_module(Path(tool).stem)
+    saved_argv = sys.argv
+    sys.argv = [tool] + [str(a) for a in args]
+    try:
+        result = module.main()
+    except SystemExit as e:
+        result = e.code
+    except Exception as e:
+        print(f"❌ {tool}: {e}", file=sys.stderr)
+        result = 1
+    finally:
+        sys.argv = saved_argv
+    return result in (None, 0)
+
+
+def main():
+    """
+    メイン処理関数
+    """
+    try:
+        args = parse_arguments()
+
+        manifest_path = Path(args.manifest).resolve()
+        if not manifest_path.exists():
+            raise FileNotFoundError(f"マニフェストが見つかりません: {args.manifest}")
+        cache_path = Path(args.cache).resolve() if args.cache else manifest_path.parent / CACHE_FILE_NAME
+
+        jobs = load_manifest(manifest_path)
+        cache = ConversionCache(cache_path)
+
+        # ジョブのパスはマニフェストからの相対パス、変換ツールはこのディレクトリから読み込む
+        os.chdir(manifest_path.parent)
+        sys.path.insert(0, str(TOOLS_DIR))
+
+        stale = []
+        for job in jobs:
+            missing = [p for p in job["inputs"] if not Path(p).exists()]
+            if missing:
+                raise FileNotFoundError(f"入力ファイルが見つかりません: {', '.join(missing)}（ジョブ {job['name']}）")
+            digest = job_digest(TOOLS_DIR / job["tool"], job["inputs"], job["args"])
+            fresh = not args.force and cache.is_fresh(job["name"], digest, job["outputs"])
+            if args.list:
+                print(f"{'✅ 最新' if fresh else '🔄 変換が必要'}: {job['name']} → {', '.join(job['outputs'])}")
+            elif not fresh:
+                stale.append((job, digest))
+
+        if args.list:
+            return
+
+        if not stale:
+            print(f"✅ 全 {len(jobs)} ジョブが最新です（{manifest_path.name}）")
+            return
+
+        failed = []
+        for job, digest in stale:
+            print("=" * 50)
+            print(f"🔄 {job['name']}: {job['tool']} {' '.join(job['args'])}")
+            print("=" * 50)
+            if run_tool(job["tool"], job["args"]) and all(Path(p).exists() for p in job["outputs"]):
+                cache.update(job["name"], digest, job["outputs"])
+            else:
+                cache.jobs.pop(job["name"], None)
+                failed.append(job["name"])
+
+        # 失敗したジョブは記録を消すので、次回のビルドでもう一度変換される
+        cache.prune(job["name"] for job in jobs)
+        cache.save()
+
+        print("\n" + "=" * 50)
+        print(f"✨ 変換 {len(stale) - len(failed)} / 最新 {len(jobs) - len(stale)} / 失敗 {len(failed)}")
+        print("=" * 50)
+        if failed:
+            raise RuntimeError(f"変換に失敗したジョブ: {', '.join(failed)}")
+
+    except FileNotFoundError as e:
+        print(f"❌ ファイルエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except ValueError as e:
+        print(f"❌ 値エラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except KeyboardInterrupt:
+        print("\n⚠️ 処理が中断されました")
+        sys.exit(1)
+    except Exception as e:
+        print(f"❌ 予期しないエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+"""
+アセットパッカー - Asset Packer
+画像・フレーム列を16色パレットに変換し、RetroAssetPack用のバイナリ（.rpak）にまとめるプログラム
+生成したパックはデータパーティション「assets」に書き込み、ファームウェアから直接マップして描画する
+
+使用例:
+python asset_packer.py dot_landscape.png nekojara.bmp -o ../assets.rpak
+→ ../assets.rpak（dot_landscape, nekojara の2画像 + 共通パレット）
+
+python asset_packer.py hero=char.png --sequence walk:120:walk1.png,walk2.png,walk3.png
+python asset_packer.py --list ../assets.rpak  (パックの中身を表示)
+
+書き込み:
+idf.py flash  (プロジェクト直下に assets.rpak があれば一緒に書き込まれる)
+parttool.py write_partition --partition-name assets --input assets.rpak  (パックだけ差し替え)
+"""
+
+import sys
+import struct
+import argparse
+from pathlib import Path
+
+from image_to_palette import sanitize_variable_name
+from tile_slicer import load_indexed_image
+
+
+# RetroAssetPackと一致させること
+PACK_MAGIC = b"RPAK"
+PACK_VERSION = 1
+NAME_LENGTH = 24
+NO_PALETTE = 0xFFFF
+TYPE_PALETTE = 1
+TYPE_IMAGE = 2
+TYPE_SEQUENCE = 3
+TYPE_NAMES = {TYPE_PALETTE: "palette", TYPE_IMAGE: "image", TYPE_SEQUENCE: "sequence"}
+
+HEADER_FORMAT = "<4sHHHHI"          # magic, version, entryCount, hashSize, reserved, totalSize
+ENTRY_FORMAT = "<24sIIHHHHHBB"      # name, offset, size, width, height, frameCount, frameMs, palette, type, reserved
+
+# partitions.csv の assets パーティションのサイズ
+DEFAULT_PARTITION_SIZE = 0x1F0000
+
+
+def parse_arguments():
+    """
+    コマンドライン引数を解析する関数
+    """
+    parser = argparse.ArgumentParser(
+        description='画像とフレーム列をRetroAssetPack用のバイナリにまとめます',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+使用例:
+  python %(prog)s dot_landscape.png nekojara.bmp -o ../assets.rpak
+  python %(prog)s hero=char.png --sequence walk:120:walk1.png,walk2.png
+  python %(prog)s indexed.png --no-quantize  (16色以下のパレット画像をそのまま使用)
+  python %(prog)s --list ../assets.rpak
+        """
+    )
+
+    parser.add_argument('images', nargs='*',
+                       help='画像ファイル（名前=ファイル で名前を指定、省略時はファイル名から生成）')
+    parser.add_argument('--sequence', action='append', default=[],
+                       help='フレーム列（名前:1フレームのミリ秒:ファイル1,ファイル2,...）')
+    parser.add_argument('--palette', choices=["classic", "gameboy", "sepia", "neon"],
+                       default="classic", help='減色に使うカラーパレット')
+    parser.add_argument('--dither', action='store_true',
+                       help='Floyd-Steinbergディザリングを使用')
+    parser.add_argument('--color-space', choices=["rgb", "lab", "hsv"], default="lab",
+                       help='色距離の計算に使う色空間')
+    parser.add_argument('--no-quantize', action='store_true',
+                       help='パレットモード画像のインデックスとパレットをそのまま使う（16色以下）')
+    parser.add_argument('-o', '--output', default='assets.rpak',
+                       help='出力ファイル名（デフォルト: assets.rpak）')
+    parser.add_argument('--partition-size', type=lambda v: int(v, 0), default=DEFAULT_PARTITION_SIZE,
+                       help='書き込み先パーティションのサイズ（超える場合はエラー）')
+    parser.add_argument('--list', metavar='PACK', default='',
+                       help='既存のパックの中身を表示して終了')
+
+    return parser.parse_args()
+
+
+def fnv1a(name):
+    """
+    名前のハッシュ値（RetroAssetPack::hashNameと一致させること）
+    """
+    value = 2166136261
+    for b in name.encode('ascii'):
+        value = ((value ^ b) * 16777619) & 0xFFFFFFFF
+    return value
+
+
+def pack_indices(indices):
+    """
+    インデックス配列を1バイト2ピクセルに詰める（下位4bit: 偶数ピクセル）
+    """
+    flat = [int(v) & 0x0F for v in indices.flatten()]
+    if len(flat) % 2:
+        flat.append(0)
+    return bytes((flat[i + 1] << 4) | flat[i] for i in range(0, len(flat), 2))
+
+
+def check_name(name, used):
+    """
+    エントリ名を検証する
+    """
+    if not name or len(name.encode('ascii', 'replace')) >= NAME_LENGTH:
+        raise ValueError(f"名前は1〜{NAME_LENGTH - 1}文字にしてください: '{name}'")
+    if name in used:
+        raise ValueError(f"名前が重複しています: '{name}'")
+    used.add(name)
+
+
+def build_pack(palettes, items):
+    """
+    パックのバイナリを組み立てる
+
+    Args:
+        palettes (list): [(名前, RGB565の16色リスト), ...]
+        items (list): [{"name", "type", "width", "height", "frames", "frame_ms", "palette"}, ...]
+                      frames は1フレームごとのパック済みバイト列、palette は palettes の番号
+
+    Returns:
+        bytes: パックの内容
+    """
+    entries = []
+    datas = []
+    for name, colors in palettes:
+        entries.append({"name": name, "type": TYPE_PALETTE, "width": 0, "height": 0,
+                        "frame_count": 0, "frame_ms": 0, "palette": NO_PALETTE})
+        datas.append(struct.pack("<16H", *colors))
+    for item in items:
+        entries.append({"name": item["name"], "type": item["type"], "width": item["width"],
+                        "height": item["height"], "frame_count": len(item["frames"]),
+                        "frame_ms": item["frame_ms"], "palette": item["palette"]})
+        datas.append(b"".join(item["frames"]))
+
+    if len(entries) > 0xFFFE:
+        raise ValueError("エントリが多すぎます")
+
+    # ハッシュ表（エントリ数の2倍以上の2のべき乗、線形探索）
+    hash_size = 1
+    while hash_size < len(entries) * 2:
+        hash_size *= 2
+    table = [0] * hash_size
+    for i, entry in enumerate(entries):
+        slot = fnv1a(entry["name"]) & (hash_size - 1)
+        while table[slot]:
+            slot = (slot + 1) & (hash_size - 1)
+        table[slot] = i + 1
+
+    def align4(value):
+        return (value + 3) & ~3
+
+    entry_offset = align4(struct.calcsize(HEADER_FORMAT) + hash_size * 2)
+    offset = entry_offset + len(entries) * struct.calcsize(ENTRY_FORMAT)
+    offsets = []
+    for data in datas:
+        offset = align4(offset)
+        offsets.append(offset)
+        offset += len(data)
+    total_size = align4(offset)
+
+    blob = bytearray(total_size)
+    struct.pack_into(HEADER_FORMAT, blob, 0, PACK_MAGIC, PACK_VERSION, len(entries), hash_size, 0, total_size)
+    struct.pack_into(f"<{hash_size}H", blob, struct.calcsize(HEADER_FORMAT), *table)
+    for i, entry in enumerate(entries):
+        struct.pack_into(ENTRY_FORMAT, blob, entry_offset + i * struct.calcsize(ENTRY_FORMAT),
+                         entry["name"].encode('ascii'), offsets[i], len(datas[i]),
+                         entry["width"], entry["height"], entry["frame_count"], entry["frame_ms"],
+                         entry["palette"], entry["type"], 0)
+        blob[offsets[i]:offsets[i] + len(datas[i])] = datas[i]
+
+    return bytes(blob)
+
+
+def list_pack(path):
+    """
+    パックの中身を表示する
+    """
+    blob = Path(path).read_bytes()
+    magic, version, count, hash_size, _, total_size = struct.unpack_from(HEADER_FORMAT, blob, 0)
+    if magic != PACK_MAGIC:
+        raise ValueError(f"RetroAssetPackではありません: {path}")
+
+    print(f"📦 {path}: version {version}, {count} エントリ, {total_size} バイト")
+    entry_offset = (struct.calcsize(HEADER_FORMAT) + hash_size * 2 + 3) & ~3
+    for i in range(count):
+        name, offset, size, width, height, frames, frame_ms, palette, kind, _ = struct.unpack_from(
+            ENTRY_FORMAT, blob, entry_offset + i * struct.calcsize(ENTRY_FORMAT))
+        name = name.split(b"\0", 1)[0].decode('ascii')
+        info = f"   [{i}] {name:<23} {TYPE_NAMES.get(kind, '?'):<8} {size:>7} バイト @0x{offset:06X}"
+        if kind != TYPE_PALETTE:
+            info += f"  {width}x{height}"
+            if kind == TYPE_SEQUENCE:
+                info += f" × {frames} フレーム ({frame_ms}ms)"
+            if palette != NO_PALETTE:
+                info += f"  palette={palette}"
+        print(info)
+
+
+def main():
+    """
+    メイン処理関数
+    """
+    try:
+        args = parse_arguments()
+
+        if args.list:
+            list_pack(args.list)
+            return
+
+        if not args.images and not args.sequence:
+            raise ValueError("画像ファイルか --sequence を1つ以上指定してください")
+
+        print("=" * 50)
+        print("📦 アセットパッカー開始！")
+        print("=" * 50)
+
+        used_names = set()
+        palettes = []
+        palette_lookup = {}
+        items = []
+
+        def add_palette(palette):
+            # 同じ色のパレットは1つにまとめる
+            key = tuple(palette.colors_rgb565)
+            index = palette_lookup.get(key)
+            if index is None:
+                index = len(palettes)
+                name = "palette" if index == 0 else f"palette_{index}"
+                check_name(name, used_names)
+                palettes.append((name, list(key)))
+                palette_lookup[key] = index
+            return index
+
+        def load(path):
+            image_path = Path(path)
+            if not image_path.exists():
+                raise FileNotFoundError(f"画像ファイルが見つかりません: {path}")
+            indices, palette = load_indexed_image(image_path, args)
+            return indices, add_palette(palette)
+
+        for spec in args.images:
+            name, _, path = spec.rpartition("=")
+            name = name if name else sanitize_variable_name(path)
+            check_name(name, used_names)
+            indices, palette_index = load(path)
+            height, width = indices.shape
+            items.append({"name": name, "type": TYPE_IMAGE, "width": width, "height": height,
+                          "frames": [pack_indices(indices)], "frame_ms": 0, "palette": palette_index})
+
+        for spec in args.sequence:
+            parts = spec.split(":", 2)
+            if len(parts) != 3 or not parts[1].isdigit() or not parts[2]:
+                raise ValueError(f"--sequence は 名前:ミリ秒:ファイル1,ファイル2,... の形式です: '{spec}'")
+            name, frame_ms, files = parts[0], int(parts[1]), parts[2].split(",")
+            check_name(name, used_names)
+
+            frames = []
+            size = None
+            palette_index = None
+            for path in files:
+                indices, frame_palette = load(path)
+                if size is None:
+                    size, palette_index = indices.shape, frame_palette
+                elif indices.shape != size or frame_palette != palette_index:
+                    raise ValueError(f"フレーム列 '{name}' のサイズ・パレットが揃っていません: {path}")
+                frames.append(pack_indices(indices))
+            items.append({"name": name, "type": TYPE_SEQUENCE, "width": size[1], "height": size[0],
+                          "frames": frames, "frame_ms": min(frame_ms, 0xFFFF), "palette": palette_index})
+
+        # パレットは先頭に並ぶので、画像側のパレット番号はそのままエントリ番号になる
+        blob = build_pack(palettes, items)
+        if len(blob) > args.partition_size:
+            raise ValueError(f"パーティションに収まりません: {len(blob)} > {args.partition_size} バイト")
+
+        Path(args.output).write_bytes(blob)
+
+        raw_size = sum(len(f) for item in items for f in item["frames"])
+        print("\n" + "=" * 50)
+        print("✨ 処理完了！")
+        print(f"🖼️  画像: {sum(1 for i in items if i['type'] == TYPE_IMAGE)} 個, "
+              f"フレーム列: {sum(1 for i in items if i['type'] == TYPE_SEQUENCE)} 個, パレット: {len(palettes)} 個")
+        print(f"📊 サイズ: {len(blob)} バイト（画素データ {raw_size} バイト、"
+              f"パーティションの {len(blob) / args.partition_size * 100:.1f}%）")
+        print(f"📄 {args.output}")
+        print("=" * 50)
+        list_pack(args.output)
+
+    except FileNotFoundError as e:
+        print(f"❌ ファイルエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except ValueError as e:
+        print(f"❌ 値エラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except KeyboardInterrupt:
+        print("\n⚠️ 処理が中断されました")
+        sys.exit(1)
+    except Exception as e:
+        print(f"❌ 予期しないエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
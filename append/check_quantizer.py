@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+減色チェックツール for image_to_palette.py
+
+numpyによる一括減色（RGB565の変換表）が、1色ずつ厳密に判定する find_closest_color と
+同じ結果になるかを確かめる
+
+チェック内容:
+- 変換表: 全てのパレット・色空間について、RGB565の全色の表の値と find_closest_color を比較
+  （距離が同じ色の選び方の違いは一致とみなす）
+- ディザリング: 以前の変換結果（append/dot_landscape.h、1ピクセルずつ find_closest_color で
+  減色していた頃の出力）と、現在の実装で同じ画像を変換した結果を比較
+  変換表はRGB565単位で判定するので完全には一致しない。ぼかした見た目の色の誤差が
+  以前より悪くなっていないかで判定する
+
+使用例:
+python check_quantizer.py                 # 全てチェック
+python check_quantizer.py --step 7        # 変換表は7色おきに間引いてチェック（速い）
+python check_quantizer.py --skip-cube     # ディザリングの比較だけ
+"""
+
+import argparse
+import os
+import re
+import sys
+
+import numpy as np
+from PIL import Image
+
+from image_to_palette import ColorPalette, ColorQuantizer
+
+
+PALETTES = ["classic", "gameboy", "sepia", "neon"]
+COLOR_SPACES = ["lab", "rgb", "hsv"]
+
+# 距離の差がこれ以下なら同じ距離とみなす（numpyとmathの丸め誤差）
+TIE_EPSILON = 1e-9
+
+# ぼかした色の平均誤差の許容値（以前の誤差 × 比率 + 余裕）
+ERROR_RATIO = 1.05
+ERROR_MARGIN = 0.5
+
+
+def expand_rgb565(index):
+    """変換表のインデックス（RRRRRGGGGGGBBBBB）から代表色のRGB888を求める（_get_cube と同じ）"""
+    r5, g6, b5 = index >> 11, (index >> 5) & 0x3F, index & 0x1F
+    return (r5 << 3) | (r5 >> 2), (g6 << 2) | (g6 >> 4), (b5 << 3) | (b5 >> 2)
+
+
+def color_distance_to(quantizer, rgb, index):
+    """find_closest_color と同じ式で、RGB888の色とパレット色 index の距離を求める"""
+    if quantizer.color_space == "lab":
+        return quantizer._color_distance(quantizer._rgb_to_lab(*rgb), quantizer.palette_lab[index])
+    return quantizer._color_distance(rgb, quantizer.palette.colors_rgb[index])
+
+
+def check_cube(palette_name, color_space, step):
+    """
+    変換表とfind_closest_colorを比較
+
+    Args:
+        palette_name (str): パレット名
+        color_space (str): 色空間
+        step (int): 何色おきにチェックするか（1 = 全色）
+
+    Returns:
+        tuple: (チェックした色数, 距離が同じで選び方だけ違った色数, 不一致の色のリスト)
+    """
+    quantizer = ColorQuantizer(ColorPalette(palette_name), color_space)
+    cube = quantizer._get_cube().ravel().tolist()
+
+    checked = 0
+    ties = 0
+    mismatches = []
+    for index in range(0, len(cube), step):
+        rgb = expand_rgb565(index)
+        expected = quantizer.find_closest_color(*rgb)
+        actual = cube[index]
+        checked += 1
+        if actual == expected:
+            continue
+
+        d_expected = color_distance_to(quantizer, rgb, expected)
+        d_actual = color_distance_to(quantizer, rgb, actual)
+        if abs(d_actual - d_expected) <= TIE_EPSILON * max(1.0, d_expected):
+            ties += 1
+        else:
+            mismatches.append((rgb, expected, actual, d_expected, d_actual))
+
+    return checked, ties, mismatches
+
+
+def load_reference_header(path):
+    """
+    image_to_palette.py が出力したヘッダーから変換条件とインデックス配列を読み込む
+
+    Returns:
+        dict: source, palette, dither, color_space, width, height, indices（行ごとのリスト）
+    """
+    with open(path, "r", encoding="utf-8") as f:
+        text = f.read()
+
+    def comment(key):
+        match = re.search(r"^\s*\*\s*" + key + r":\s*(.+?)\s*$", text, re.MULTILINE)
+        if not match:
+            raise ValueError(f"'{key}' not found in {path}")
+        return match.group(1)
+
+    source = re.search(r"Auto-generated from\s+(\S+)", text)
+    if not source:
+        raise ValueError(f"source image name not found in {path}")
+
+    size = re.search(r"Final size:\s*(\d+)x(\d+)", text)
+    if not size:
+        raise ValueError(f"'Final size' not found in {path}")
+    width, height = int(size.group(1)), int(size.group(2))
+
+    data = re.search(r"const uint8_t \w+_data\[\d+\]\s*=\s*\{(.*?)\};", text, re.DOTALL)
+    if not data:
+        raise ValueError(f"data array not found in {path}")
+    data_bytes = [int(v, 16) for v in re.findall(r"0x([0-9A-Fa-f]{2})", data.group(1))]
+
+    # 1バイト2ピクセル（下位4bit: 偶数ピクセル, 上位4bit: 奇数ピクセル）
+    bytes_per_row = (width + 1) // 2
+    if len(data_bytes) != bytes_per_row * height:
+        raise ValueError(f"data size mismatch in {path}: {len(data_bytes)} bytes")
+    indices = []
+    for y in range(height):
+        row = []
+        for byte_value in data_bytes[y * bytes_per_row:(y + 1) * bytes_per_row]:
+            row.extend([byte_value & 0x0F, byte_value >> 4])
+        indices.append(row[:width])
+
+    return {
+        "source": source.group(1),
+        "palette": comment("Palette"),
+        "dither": comment("Dithering") == "ON",
+        "color_space": comment("Color space"),
+        "width": width,
+        "height": height,
+        "indices": indices,
+    }
+
+
+def blurred_error(original, indices, palette):
+    """
+    インデックス画像をパレット色に戻して3×3でぼかし、ぼかした元画像との平均の色の差を求める
+    （ディザリングは近くのピクセルの平均で色を表すので、ぼかした色で比べる）
+    """
+    colors = np.array(palette.colors_rgb, dtype=np.float64)
+    rendered = colors[np.array(indices, dtype=np.int64)]
+    source = original.astype(np.float64)
+
+    def box3(image):
+        height, width = image.shape[0], image.shape[1]
+        total = image[0:height - 2, 0:width - 2]
+        for dy in range(3):
+            for dx in range(3):
+                if dy or dx:
+                    total = total + image[dy:height - 2 + dy, dx:width - 2 + dx]
+        return total / 9.0
+
+    diff = box3(rendered) - box3(source)
+    return float(np.sqrt((diff * diff).sum(axis=2)).mean())
+
+
+def check_reference(header_path):
+    """
+    以前の変換結果と現在の実装の変換結果を比較
+
+    Returns:
+        bool: ぼかした色の誤差が許容範囲内ならTrue
+    """
+    reference = load_reference_header(header_path)
+    image_path = os.path.join(os.path.dirname(os.path.abspath(header_path)), reference["source"])
+
+    image = Image.open(image_path)
+    if image.size != (reference["width"], reference["height"]):
+        raise ValueError(f"{image_path} is {image.size}, reference is {reference['width']}x{reference['height']}")
+
+    palette = ColorPalette(reference["palette"])
+    quantizer = ColorQuantizer(palette, reference["color_space"])
+    current = np.array(quantizer.quantize_image(image, reference["dither"])).tolist()
+
+    total = reference["width"] * reference["height"]
+    changed = sum(1 for old_row, new_row in zip(reference["indices"], current)
+                  for old, new in zip(old_row, new_row) if old != new)
+
+    original = np.array(image.convert("RGB"))
+    old_error = blurred_error(original, reference["indices"], palette)
+    new_error = blurred_error(original, current, palette)
+    limit = old_error * ERROR_RATIO + ERROR_MARGIN
+
+    print(f"🖼️  {os.path.basename(header_path)} ({reference['source']}, {reference['palette']}, "
+          f"{reference['color_space']}, dither {'ON' if reference['dither'] else 'OFF'})")
+    print(f"   changed pixels: {changed}/{total} ({changed * 100.0 / total:.1f}%)")
+    print(f"   blurred color error: previous {old_error:.2f}, current {new_error:.2f} (limit {limit:.2f})")
+
+    return new_error <= limit
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check image_to_palette.py table quantization against find_closest_color")
+    parser.add_argument("--step", type=int, default=1,
+                        help="Check every N-th RGB565 color of each table (default: all 65536)")
+    parser.add_argument("--reference", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "dot_landscape.h"),
+                        help="Header converted by the previous per-pixel implementation")
+    parser.add_argument("--skip-cube", action="store_true", help="Skip the table check")
+    parser.add_argument("--skip-reference", action="store_true", help="Skip the dithered image comparison")
+
+    args = parser.parse_args()
+    if args.step < 1:
+        print("❌ Error: --step must be 1 or more")
+        return 1
+
+    failed = False
+
+    if not args.skip_cube:
+        for palette_name in PALETTES:
+            for color_space in COLOR_SPACES:
+                checked, ties, mismatches = check_cube(palette_name, color_space, args.step)
+                status = "✅" if not mismatches else "❌"
+                print(f"{status} table {palette_name}/{color_space}: {checked} colors, "
+                      f"{ties} ties, {len(mismatches)} mismatches")
+                for rgb, expected, actual, d_expected, d_actual in mismatches[:5]:
+                    print(f"   RGB{rgb}: find_closest_color {expected} ({d_expected:.6f}), "
+                          f"table {actual} ({d_actual:.6f})")
+                failed |= bool(mismatches)
+
+    if not args.skip_reference:
+        try:
+            if check_reference(args.reference):
+                print("✅ dithered output is as close to the source as the previous output")
+            else:
+                print("❌ dithered output is further from the source than the previous output")
+                failed = True
+        except Exception as e:
+            print(f"❌ Error comparing with reference: {e}")
+            failed = True
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
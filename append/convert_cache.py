@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""
+変換キャッシュ - Conversion Cache
+画像変換の入力（画像ファイル・オプション・変換ツールのスクリプト）と出力の内容ハッシュを記録し、
+前回の変換から何も変わっていないジョブを飛ばすためのキャッシュ
+asset_batch.py から使う
+
+キャッシュファイル（JSON）:
+{
+  "version": 1,
+  "jobs": {
+    "<ジョブ名>": {"digest": "<入力のSHA-256>", "outputs": {"<出力パス>": "<出力のSHA-256>"}}
+  }
+}
+"""
+
+import os
+import re
+import json
+import hashlib
+from pathlib import Path
+
+
+CACHE_VERSION = 1
+
+# 同じディレクトリの変換ツールを読み込む import 文（from image_to_palette import ... など）
+LOCAL_IMPORT = re.compile(r'^\s*(?:from\s+(\w+)\s+import|import\s+(\w+))', re.MULTILINE)
+
+
+def file_digest(path):
+    """
+    ファイル内容のSHA-256を計算する
+
+    Args:
+        path (Path): ファイルのパス
+
+    Returns:
+        str: 16進のハッシュ値
+    """
+    hasher = hashlib.sha256()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 16), b""):
+            hasher.update(chunk)
+    return hasher.hexdigest()
+
+
+def tool_sources(tool_path):
+    """
+    変換ツールのスクリプトと、それが読み込む同じディレクトリのスクリプトを列挙する
+    （image_to_palette.py の減色処理を変えたら tile_slicer.py のジョブも古くなるように）
+
+    Args:
+        tool_path (Path): 変換ツールのスクリプト
+
+    Returns:
+        list: スクリプトのパス（重複なし、名前順）
+    """
+    tool_path = Path(tool_path)
+    found = {}
+    pending = [tool_path]
+    while pending:
+        path = pending.pop()
+        if path.name in found or not path.exists():
+            continue
+        found[path.name] = path
+        for match in LOCAL_IMPORT.finditer(path.read_text(encoding="utf-8")):
+            module = match.group(1) or match.group(2)
+            pending.append(tool_path.parent / f"{module}.py")
+    return [found[name] for name in sorted(found)]
+
+
+def job_digest(tool_path, inputs, args):
+    """
+    ジョブの入力全体のハッシュを計算する
+
+    Args:
+        tool_path (Path): 変換ツールのスクリプト
+        inputs (list): 入力ファイルのパス
+        args (list): 変換ツールに渡す引数
+
+    Returns:
+        str: 16進のハッシュ値
+    """
+    hasher = hashlib.sha256()
+    hasher.update(json.dumps([str(a) for a in args]).encode("utf-8"))
+    for path in tool_sources(tool_path) + [Path(p) for p in inputs]:
+        hasher.update(path.name.encode("utf-8"))
+        hasher.update(file_digest(path).encode("ascii"))
+    return hasher.hexdigest()
+
+
+class ConversionCache:
+    """変換ジョブごとの入力・出力ハッシュの記録"""
+
+    def __init__(self, path):
+        """
+        キャッシュファイルを読み込む（無い・壊れている・形式が違う場合は空から始める）
+
+        Args:
+            path (Path): キャッシュファイルのパス
+        """
+        self.path = Path(path)
+        self.jobs = {}
+        try:
+            with open(self.path, "r", encoding="utf-8") as f:
+                data = json.load(f)
+            if data.get("version") == CACHE_VERSION:
+                self.jobs = data.get("jobs", {})
+        except (OSError, ValueError, AttributeError):
+            pass
+
+    def is_fresh(self, name, digest, outputs):
+        """
+        ジョブが最新かどうか（入力が前回と同じで、出力が全て前回書いたままか）
+
+        Args:
+            name (str): ジョブ名
+            digest (str): 今回の入力のハッシュ
+            outputs (list): 出力ファイルのパス
+
+        Returns:
+            bool: 変換を飛ばしてよければTrue
+        """
+        entry = self.jobs.get(name)
+        if not entry or entry.get("digest") != digest:
+            return False
+        recorded = entry.get("outputs", {})
+        for path in outputs:
+            path = Path(path)
+            if not path.exists() or recorded.get(str(path)) != file_digest(path):
+                return False
+        return True
+
+    def update(self, name, digest, outputs):
+        """
+        変換後のジョブを記録する
+
+        Args:
+            name (str): ジョブ名
+            digest (str): 入力のハッシュ
+            outputs (list): 出力ファイルのパス
+        """
+        self.jobs[name] = {
+            "digest": digest,
+            "outputs": {str(Path(p)): file_digest(p) for p in outputs},
+        }
+
+    def prune(self, names):
+        """
+        指定以外のジョブの記録を削除する（マニフェストから消えたジョブ）
+
+        Args:
+            names (iterable): 残すジョブ名
+        """
+        keep = set(names)
+        self.jobs = {name: entry for name, entry in self.jobs.items() if name in keep}
+
+    def save(self):
+        """キャッシュファイルを書き出す（途中で止まっても壊れないよう一時ファイルから置き換える）"""
+        temp_path = self.path.with_name(self.path.name + ".tmp")
+        with open(temp_path, "w", encoding="utf-8") as f:
+            json.dump({"version": CACHE_VERSION, "jobs": self.jobs}, f, indent=2, sort_keys=True)
+            f.write("\n")
+        os.replace(temp_path, self.path)
@@ -236,6 +236,8 @@ def generate_c_header_content(image_data_list, invert=False):
     header_content.append(f"// 1ビット1ピクセル形式のモノクロ画像データ")
     header_content.append(f"// ビット値: {bit_meaning}")
     header_content.append(f"// バイト内のビット順序: MSB（左のピクセル）→ LSB（右のピクセル）")
+    header_content.append(f"// 各行は (幅+7)/8 バイトに切り上げ")
+    header_content.append(f"// 描画: MonoImageData img(配列, 幅, 高さ, ビット1の色, ビット0の色); renderer.drawToCanvas(img, x, y);")
     header_content.append("")
     
     # 各画像のデータを生成
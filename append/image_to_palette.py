@@ -10,6 +10,7 @@
 - ディザリング対応
 - M5StampPico用データ配列生成
 - 複数のカラーパレット対応
+- numpyによる一括減色（RGB565の全色→パレット色の変換表を使う）
 
 使用例:
 python improved_palette_tool.py cat.jpg --palette classic --dither --output result
@@ -182,46 +183,149 @@ class ColorPalette:
 
 
 class ColorQuantizer:
-    """色量子化・減色クラス"""
-    
+    """
+    色量子化・減色クラス
+
+    画像全体をnumpyでまとめて変換する:
+    - 全てのRGB565色（32x64x32）について最も近いパレット色を先に求めた変換表（キューブ）を作り、
+      各ピクセルは表を引くだけで減色する（パネルの表示解像度と同じRGB565単位で判定）
+    - キューブはパレットと色空間の組ごとに1回だけ作り、同じプロセス内の変換で使い回す
+    - ディザリングは横方向の誤差（7/16）だけを1行ずつ順に伝え、下の行への誤差は行単位で一括加算する
+    """
+
+    # RGB565の各成分の段階数（R, G, B）
+    CUBE_SHAPE = (32, 64, 32)
+
+    # (色空間, パレット色) → キューブ
+    _cube_cache: Dict[Tuple, np.ndarray] = {}
+
     def __init__(self, palette: ColorPalette, color_space: str = "lab"):
         self.palette = palette
         self.color_space = color_space.lower()
-        
+
         # パレット色をLAB色空間に変換（より正確な色距離計算のため）
         if self.color_space == "lab":
             self.palette_lab = [self._rgb_to_lab(r, g, b) for r, g, b in palette.colors_rgb]
-    
+
     def _rgb_to_lab(self, r: int, g: int, b: int) -> Tuple[float, float, float]:
         """RGB to LAB conversion"""
         # RGB to XYZ
         r, g, b = r / 255.0, g / 255.0, b / 255.0
-        
+
         def gamma_correct(c):
             return ((c + 0.055) / 1.055) ** 2.4 if c > 0.04045 else c / 12.92
-        
+
         r, g, b = gamma_correct(r), gamma_correct(g), gamma_correct(b)
-        
+
         # XYZ using sRGB matrix
         x = r * 0.4124564 + g * 0.3575761 + b * 0.1804375
         y = r * 0.2126729 + g * 0.7151522 + b * 0.0721750
         z = r * 0.0193339 + g * 0.1191920 + b * 0.9503041
-        
+
         # XYZ to LAB
         def f(t):
             return t ** (1/3) if t > 0.008856 else (7.787 * t + 16/116)
-        
+
         # D65 白色点で正規化
         x, y, z = x / 0.95047, y / 1.00000, z / 1.08883
-        
+
         fx, fy, fz = f(x), f(y), f(z)
-        
+
         L = 116 * fy - 16
         a = 500 * (fx - fy)
         b = 200 * (fy - fz)
-        
+
         return (L, a, b)
-    
+
+    @staticmethod
+    def _rgb_to_lab_array(rgb: np.ndarray) -> np.ndarray:
+        """RGB to LAB conversion（N×3配列をまとめて変換、_rgb_to_lab と同じ式）"""
+        c = rgb.astype(np.float64) / 255.0
+        c = np.where(c > 0.04045, ((c + 0.055) / 1.055) ** 2.4, c / 12.92)
+
+        # XYZ using sRGB matrix、D65 白色点で正規化
+        matrix = np.array([[0.4124564, 0.3575761, 0.1804375],
+                           [0.2126729, 0.7151522, 0.0721750],
+                           [0.0193339, 0.1191920, 0.9503041]])
+        xyz = (c @ matrix.T) / np.array([0.95047, 1.00000, 1.08883])
+
+        f = np.where(xyz > 0.008856, np.cbrt(xyz), 7.787 * xyz + 16/116)
+        L = 116 * f[:, 1] - 16
+        a = 500 * (f[:, 0] - f[:, 1])
+        b = 200 * (f[:, 1] - f[:, 2])
+        return np.stack([L, a, b], axis=1)
+
+    @staticmethod
+    def _rgb_to_hsv_array(rgb: np.ndarray) -> np.ndarray:
+        """RGB to HSV conversion（N×3配列をまとめて変換、colorsys.rgb_to_hsv と同じ値）"""
+        c = rgb.astype(np.float64) / 255.0
+        r, g, b = c[:, 0], c[:, 1], c[:, 2]
+        maxc = c.max(axis=1)
+        minc = c.min(axis=1)
+        rangec = maxc - minc
+
+        # 無彩色（rangec == 0）は h = s = 0
+        safe_max = np.where(maxc > 0, maxc, 1.0)
+        safe_range = np.where(rangec > 0, rangec, 1.0)
+        s = np.where(rangec > 0, rangec / safe_max, 0.0)
+        rc = (maxc - r) / safe_range
+        gc = (maxc - g) / safe_range
+        bc = (maxc - b) / safe_range
+        h = np.where(r == maxc, bc - gc, np.where(g == maxc, 2.0 + rc - bc, 4.0 + gc - rc))
+        h = np.where(rangec > 0, (h / 6.0) % 1.0, 0.0)
+        return np.stack([h, s, maxc], axis=1)
+
+    def _nearest_indices(self, rgb: np.ndarray) -> np.ndarray:
+        """
+        N×3のRGB配列それぞれに最も近いパレット色のインデックスを求める
+        距離は _color_distance と同じ（平方根は大小関係が変わらないので省略）
+        """
+        palette_rgb = np.array(self.palette.colors_rgb, dtype=np.float64)
+        if self.color_space == "lab":
+            target = self._rgb_to_lab_array(rgb)
+            reference = self._rgb_to_lab_array(palette_rgb)
+        elif self.color_space == "rgb":
+            target = rgb.astype(np.float64)
+            reference = palette_rgb
+        else:
+            target = self._rgb_to_hsv_array(rgb)
+            reference = self._rgb_to_hsv_array(palette_rgb)
+
+        diff = target[:, None, :] - reference[None, :, :]
+        if self.color_space == "hsv":
+            # 色相は円形
+            dh = np.abs(diff[:, :, 0])
+            diff[:, :, 0] = np.minimum(dh, 1 - dh)
+
+        # 同じ距離なら若いインデックス（find_closest_color と同じ）
+        return np.argmin((diff * diff).sum(axis=2), axis=1).astype(np.uint8)
+
+    def _get_cube(self) -> np.ndarray:
+        """RGB565の全色 → パレットインデックスの変換表を取得（初回だけ計算）"""
+        key = (self.color_space, tuple(tuple(c) for c in self.palette.colors_rgb))
+        cube = ColorQuantizer._cube_cache.get(key)
+        if cube is None:
+            # 各段階の代表色はRGB565を表示する時と同じく上位ビットを下位に複製したRGB888
+            r5, g6, b5 = np.meshgrid(np.arange(32), np.arange(64), np.arange(32), indexing='ij')
+            rgb = np.stack([(r5 << 3) | (r5 >> 2), (g6 << 2) | (g6 >> 4), (b5 << 3) | (b5 >> 2)], axis=-1)
+            cube = self._nearest_indices(rgb.reshape(-1, 3)).reshape(self.CUBE_SHAPE)
+            ColorQuantizer._cube_cache[key] = cube
+        return cube
+
+    def _lookup(self, image_array: np.ndarray) -> np.ndarray:
+        """H×W×3（uint8）の画像を変換表で一括減色"""
+        cube = self._get_cube()
+        return cube[image_array[:, :, 0] >> 3, image_array[:, :, 1] >> 2, image_array[:, :, 2] >> 3]
+
+    def _make_palette_image(self, result_array: np.ndarray) -> Image.Image:
+        """インデックス配列からパレット画像を作成"""
+        result = Image.fromarray(result_array, mode='P')
+        palette_data = []
+        for r, g, b in self.palette.colors_rgb:
+            palette_data.extend([r, g, b])
+        result.putpalette(palette_data)
+        return result
+
     def _color_distance(self, color1: Tuple, color2: Tuple) -> float:
         """色距離を計算"""
         if self.color_space == "lab":
@@ -236,22 +340,22 @@ class ColorQuantizer:
             # HSV距離
             h1, s1, v1 = colorsys.rgb_to_hsv(color1[0]/255, color1[1]/255, color1[2]/255)
             h2, s2, v2 = colorsys.rgb_to_hsv(color2[0]/255, color2[1]/255, color2[2]/255)
-            
+
             dh = min(abs(h1 - h2), 1 - abs(h1 - h2))  # 色相は円形
             ds, dv = s1 - s2, v1 - v2
             return math.sqrt(dh*dh + ds*ds + dv*dv)
-    
+
     def find_closest_color(self, r: int, g: int, b: int) -> int:
-        """最も近いパレット色のインデックスを取得"""
+        """最も近いパレット色のインデックスを取得（1色だけ、変換表を使わない厳密な判定）"""
         if self.color_space == "lab":
             target_lab = self._rgb_to_lab(r, g, b)
             distances = [self._color_distance(target_lab, pal_lab) for pal_lab in self.palette_lab]
         else:
             target = (r, g, b)
             distances = [self._color_distance(target, pal_rgb) for pal_rgb in self.palette.colors_rgb]
-        
+
         return distances.index(min(distances))
-    
+
     def quantize_image(self, image: Image.Image, dither: bool = False) -> Image.Image:
         """画像を16色に減色"""
         # RGBA対応
@@ -259,10 +363,10 @@ class ColorQuantizer:
             # 透明部分を透明色（インデックス0）に変換
             image_array = np.array(image)
             alpha_channel = image_array[:, :, 3]
-            
+
             # RGB部分を変換
             rgb_image = Image.fromarray(image_array[:, :, :3])
-            
+
             if dither:
                 # Floyd-Steinbergディザリング（透明度考慮版）
                 result = self._floyd_steinberg_dither_with_alpha(rgb_image, alpha_channel)
@@ -275,143 +379,90 @@ class ColorQuantizer:
                 result = self._floyd_steinberg_dither(image)
             else:
                 result = self._simple_quantize(image)
-        
+
         return result
-    
+
     def _quantize_with_alpha(self, image: Image.Image, alpha_channel: np.ndarray) -> Image.Image:
         """透明度を考慮したシンプルな量子化"""
-        width, height = image.size
-        image_array = np.array(image)
-        result_array = np.zeros((height, width), dtype=np.uint8)
-        
-        for y in range(height):
-            for x in range(width):
-                if alpha_channel[y, x] < 128:  # 透明
-                    result_array[y, x] = self.palette.transparent_index
-                else:
-                    r, g, b = image_array[y, x]
-                    closest_idx = self.find_closest_color(r, g, b)
-                    result_array[y, x] = closest_idx
-        
-        # パレット画像として結果を作成
-        result = Image.fromarray(result_array, mode='P')
-        palette_data = []
-        for r, g, b in self.palette.colors_rgb:
-            palette_data.extend([r, g, b])
-        result.putpalette(palette_data)
-        
-        return result
-    
+        result_array = self._lookup(np.array(image.convert('RGB')))
+        result_array[alpha_channel < 128] = self.palette.transparent_index  # 透明
+        return self._make_palette_image(result_array)
+
     def _simple_quantize(self, image: Image.Image) -> Image.Image:
         """シンプルな最近傍量子化"""
-        width, height = image.size
-        image_array = np.array(image.convert('RGB'))
-        result_array = np.zeros((height, width), dtype=np.uint8)
-        
-        # パレット画像用データを作成
-        palette_data = []
-        for r, g, b in self.palette.colors_rgb:
-            palette_data.extend([r, g, b])
-        
-        for y in range(height):
-            for x in range(width):
-                r, g, b = image_array[y, x]
-                closest_idx = self.find_closest_color(r, g, b)
-                result_array[y, x] = closest_idx
-        
-        result = Image.fromarray(result_array, mode='P')
-        result.putpalette(palette_data)
-        
-        return result
-    
+        return self._make_palette_image(self._lookup(np.array(image.convert('RGB'))))
+
     def _floyd_steinberg_dither(self, image: Image.Image) -> Image.Image:
         """Floyd-Steinbergディザリング"""
-        width, height = image.size
         image_array = np.array(image.convert('RGB'), dtype=np.float32)
-        result_array = np.zeros((height, width), dtype=np.uint8)
-        
-        # パレット画像用データを作成
-        palette_data = []
-        for r, g, b in self.palette.colors_rgb:
-            palette_data.extend([r, g, b])
-        
-        for y in range(height):
-            for x in range(width):
-                old_pixel = image_array[y, x]
-                r, g, b = old_pixel.astype(int)
-                
-                # クランプ処理
-                r = max(0, min(255, r))
-                g = max(0, min(255, g))
-                b = max(0, min(255, b))
-                
-                closest_idx = self.find_closest_color(r, g, b)
-                result_array[y, x] = closest_idx
-                
-                new_pixel = np.array(self.palette.colors_rgb[closest_idx], dtype=np.float32)
-                quant_error = old_pixel - new_pixel
-                
-                # エラー拡散
-                if x < width - 1:
-                    image_array[y, x + 1] += quant_error * 7/16
-                if y < height - 1:
-                    if x > 0:
-                        image_array[y + 1, x - 1] += quant_error * 3/16
-                    image_array[y + 1, x] += quant_error * 5/16
-                    if x < width - 1:
-                        image_array[y + 1, x + 1] += quant_error * 1/16
-        
-        result = Image.fromarray(result_array, mode='P')
-        result.putpalette(palette_data)
-        
-        return result
-    
+        return self._make_palette_image(self._error_diffuse(image_array))
+
     def _floyd_steinberg_dither_with_alpha(self, image: Image.Image, alpha_channel: np.ndarray) -> Image.Image:
         """透明度対応Floyd-Steinbergディザリング"""
-        width, height = image.size
-        image_array = np.array(image, dtype=np.float32)
-        result_array = np.zeros((height, width), dtype=np.uint8)
-        
-        # パレット画像用データを作成
-        palette_data = []
-        for r, g, b in self.palette.colors_rgb:
-            palette_data.extend([r, g, b])
-        
+        image_array = np.array(image.convert('RGB'), dtype=np.float32)
+        return self._make_palette_image(self._error_diffuse(image_array, alpha_channel >= 128))
+
+    def _error_diffuse(self, image_array: np.ndarray, opaque: Optional[np.ndarray] = None) -> np.ndarray:
+        """
+        Floyd-Steinbergの誤差拡散で減色
+
+        Args:
+            image_array (ndarray): H×W×3の画像（float32、誤差を加算していくので書き換わる）
+            opaque (ndarray): 不透明ピクセルのマスク（None = 全て不透明）
+                              透明ピクセルは透明色にし、誤差を受け取らない・出さない
+
+        Returns:
+            ndarray: インデックス配列
+        """
+        height, width, _ = image_array.shape
+        result_array = np.full((height, width), self.palette.transparent_index, dtype=np.uint8)
+
+        # 行内のループは変換表・パレットをPythonのリストで引く（numpyの要素アクセスより速い）
+        cube = self._get_cube().ravel().tolist()
+        colors = [tuple(float(c) for c in rgb) for rgb in self.palette.colors_rgb]
+
         for y in range(height):
+            row = image_array[y].tolist()
+            mask = opaque[y].tolist() if opaque is not None else None
+            indices = result_array[y].tolist()
+            errors = [(0.0, 0.0, 0.0)] * width
+
+            # 右隣への誤差（7/16）は前のピクセルの結果で決まるので1ピクセルずつ順に処理
+            carry_r = carry_g = carry_b = 0.0
             for x in range(width):
-                if alpha_channel[y, x] < 128:  # 透明
-                    result_array[y, x] = self.palette.transparent_index
+                if mask is not None and not mask[x]:
+                    carry_r = carry_g = carry_b = 0.0
                     continue
-                
-                old_pixel = image_array[y, x]
-                r, g, b = old_pixel.astype(int)
-                
-                # クランプ処理
-                r = max(0, min(255, r))
-                g = max(0, min(255, g))
-                b = max(0, min(255, b))
-                
-                closest_idx = self.find_closest_color(r, g, b)
-                result_array[y, x] = closest_idx
-                
-                new_pixel = np.array(self.palette.colors_rgb[closest_idx], dtype=np.float32)
-                quant_error = old_pixel - new_pixel
-                
-                # エラー拡散（透明ピクセルには拡散しない）
-                if x < width - 1 and alpha_channel[y, x + 1] >= 128:
-                    image_array[y, x + 1] += quant_error * 7/16
-                if y < height - 1:
-                    if x > 0 and alpha_channel[y + 1, x - 1] >= 128:
-                        image_array[y + 1, x - 1] += quant_error * 3/16
-                    if alpha_channel[y + 1, x] >= 128:
-                        image_array[y + 1, x] += quant_error * 5/16
-                    if x < width - 1 and alpha_channel[y + 1, x + 1] >= 128:
-                        image_array[y + 1, x + 1] += quant_error * 1/16
-        
-        result = Image.fromarray(result_array, mode='P')
-        result.putpalette(palette_data)
-        
-        return result
+
+                r = row[x][0] + carry_r
+                g = row[x][1] + carry_g
+                b = row[x][2] + carry_b
+
+                # クランプ処理（小数部は切り捨て）
+                ri = min(255, max(0, int(r)))
+                gi = min(255, max(0, int(g)))
+                bi = min(255, max(0, int(b)))
+
+                index = cube[((ri >> 3) << 11) | ((gi >> 2) << 5) | (bi >> 3)]
+                indices[x] = index
+
+                pr, pg, pb = colors[index]
+                er, eg, eb = r - pr, g - pg, b - pb
+                errors[x] = (er, eg, eb)
+                carry_r, carry_g, carry_b = er * 7/16, eg * 7/16, eb * 7/16
+
+            result_array[y] = indices
+
+            # 下の行への誤差（左下3/16・真下5/16・右下1/16）は行単位でまとめて加算
+            # （透明ピクセルに加算した値は読まれないのでマスク不要）
+            if y < height - 1:
+                error_array = np.array(errors, dtype=np.float32)
+                below = error_array * (5/16)
+                below[:-1] += error_array[1:] * (3/16)
+                below[1:] += error_array[:-1] * (1/16)
+                image_array[y + 1] += below
+
+        return result_array
 
 
 class M5DataGenerator:
@@ -482,6 +533,147 @@ class M5DataGenerator:
         
         return "\n".join(lines)
     
+    # 事前変換バリエーション（回転は時計回り、PaletteImageRenderer::BLIT_* と同じ向き）
+    VARIANT_TRANSPOSE = {
+        "fliph": Image.Transpose.FLIP_LEFT_RIGHT,
+        "flipv": Image.Transpose.FLIP_TOP_BOTTOM,
+        "rot90": Image.Transpose.ROTATE_270,
+        "rot180": Image.Transpose.ROTATE_180,
+        "rot270": Image.Transpose.ROTATE_90,
+    }
+
+    @staticmethod
+    def make_variant(quantized_image: Image.Image, variant: str) -> Image.Image:
+        """減色済み画像を反転・回転したバリエーションを生成（インデックスはそのまま）"""
+        return quantized_image.transpose(M5DataGenerator.VARIANT_TRANSPOSE[variant])
+
+    # ランレングス圧縮の定数（PaletteRleImageDataと一致させること）
+    RLE_RUN_FLAG = 0x80
+    RLE_MAX_TOKEN_PIXELS = 128
+    RLE_MIN_RUN = 6  # これ未満の繰り返しはリテラルに含める（2バイトのトークンより得にならない）
+
+    @staticmethod
+    def encode_rle_row(row: List[int]) -> List[int]:
+        """1行分のパレットインデックスをランレングス圧縮
+
+        ランは2ピクセル周期の模様（単色を含む）の繰り返しとして探す
+        """
+        max_pixels = M5DataGenerator.RLE_MAX_TOKEN_PIXELS
+        out = []
+        literal = []
+
+        def flush_literal():
+            for start in range(0, len(literal), max_pixels):
+                chunk = literal[start:start + max_pixels]
+                out.append(len(chunk) - 1)
+                for i in range(0, len(chunk), 2):
+                    low = chunk[i] & 0x0F
+                    high = chunk[i + 1] & 0x0F if i + 1 < len(chunk) else 0
+                    out.append((high << 4) | low)
+            literal.clear()
+
+        x = 0
+        width = len(row)
+        while x < width:
+            first = row[x]
+            second = row[x + 1] if x + 1 < width else first
+            run = 1
+            while x + run < width and row[x + run] == (second if run & 1 else first):
+                run += 1
+
+            # 透明ランは描画時にスキップできるので短くてもランにする
+            min_run = 2 if first == 0 and second == 0 else M5DataGenerator.RLE_MIN_RUN
+            if run >= min_run:
+                flush_literal()
+                pattern = ((second & 0x0F) << 4) | (first & 0x0F)
+                while run > 0:
+                    length = min(run, max_pixels)
+                    out.append(M5DataGenerator.RLE_RUN_FLAG | (length - 1))
+                    out.append(pattern)
+                    run -= length
+                    x += length
+                    # 奇数長で区切った場合は次のトークンの位相が入れ替わる
+                    if length & 1:
+                        pattern = ((pattern << 4) | (pattern >> 4)) & 0xFF
+            else:
+                literal.append(first)
+                x += 1
+
+        flush_literal()
+        return out
+
+    @staticmethod
+    def generate_rle_data_array(quantized_image: Image.Image, base_var_name: str) -> Tuple[str, int]:
+        """行オフセット付きランレングス圧縮形式のC配列を生成"""
+        width, height = quantized_image.size
+        image_array = np.array(quantized_image)
+
+        data_bytes = []
+        row_offsets = []
+        for y in range(height):
+            row_offsets.append(len(data_bytes))
+            data_bytes.extend(M5DataGenerator.encode_rle_row([int(v) for v in image_array[y]]))
+        row_offsets.append(len(data_bytes))
+
+        # 行オフセットはuint16_t
+        if len(data_bytes) > 0xFFFF:
+            raise ValueError(f"RLE data too large for 16-bit row offsets: {len(data_bytes)} bytes")
+
+        raw_size = (width * height + 1) // 2
+
+        data_var = f"{base_var_name}_rle_data"
+        offsets_var = f"{base_var_name}_row_offsets"
+        width_var = f"{base_var_name}_width"
+        height_var = f"{base_var_name}_height"
+
+        lines = [f"// Image: {width}x{height} pixels, 16-color palette, run-length compressed"]
+        lines.append(f"// Generated data size: {len(data_bytes)} bytes + {len(row_offsets) * 2} bytes row index (raw 4bpp: {raw_size} bytes)")
+        lines.append("")
+
+        # 画像サイズ定数
+        lines.append(f"// 画像サイズ情報")
+        lines.append(f"const uint16_t {width_var} = {width};")
+        lines.append(f"const uint16_t {height_var} = {height};")
+        lines.append("")
+
+        # 圧縮データ配列
+        lines.append(f"// 圧縮画像データ配列（行ごとのラン/リテラルトークン列）")
+        lines.append(f"const uint8_t {data_var}[{len(data_bytes)}] = {{")
+        for i in range(0, len(data_bytes), 16):
+            chunk = data_bytes[i:i+16]
+            hex_values = [f"0x{b:02X}" for b in chunk]
+            line = "    " + ", ".join(hex_values)
+            if i + 16 < len(data_bytes):
+                line += ","
+            lines.append(line)
+        lines.append("};")
+        lines.append("")
+
+        # 行オフセット配列
+        lines.append(f"// 行オフセット配列（height+1要素、末尾はデータサイズ）")
+        lines.append(f"const uint16_t {offsets_var}[{len(row_offsets)}] = {{")
+        for i in range(0, len(row_offsets), 8):
+            chunk = row_offsets[i:i+8]
+            line = "    " + ", ".join(str(v) for v in chunk)
+            if i + 8 < len(row_offsets):
+                line += ","
+            lines.append(line)
+        lines.append("};")
+        lines.append("")
+
+        # 使用例とマクロ定義
+        lines.append(f"// 便利なマクロ定義")
+        lines.append(f"#define {base_var_name.upper()}_WIDTH  {width}")
+        lines.append(f"#define {base_var_name.upper()}_HEIGHT {height}")
+        lines.append(f"#define {base_var_name.upper()}_SIZE   {len(data_bytes)}")
+        lines.append("")
+
+        lines.append(f"// 使用例:")
+        lines.append(f"// PaletteRleImageData myImage({data_var}, {offsets_var}, {width_var}, {height_var});")
+        lines.append(f"// renderer.drawToCanvas(myImage, x, y, true);")
+
+        return "\n".join(lines), len(data_bytes) + len(row_offsets) * 2
+
     @staticmethod
     def generate_palette_code(palette: ColorPalette, base_var_name: str) -> str:
         """パレット定義のC++コードを生成（改良版）"""
@@ -543,6 +735,12 @@ def main():
     parser.add_argument("--max-size", type=int, default=None, 
                        help="Maximum width/height (will resize). If not specified, use original size")
     parser.add_argument("--preview", action="store_true", help="Generate palette preview")
+    parser.add_argument("--rle", action="store_true",
+                       help="Emit run-length compressed data for PaletteRleImageData")
+    parser.add_argument("--variants", nargs="+", default=[], choices=list(M5DataGenerator.VARIANT_TRANSPOSE.keys()),
+                       help="Also emit pre-flipped/rotated copies (<var>_<variant>_data); rotations are clockwise")
+    parser.add_argument("--header-only", action="store_true",
+                       help="Write only the C header (skip the BMP and preview PNG, used by asset_batch.py)")
     
     args = parser.parse_args()
     
@@ -559,6 +757,8 @@ def main():
     print(f"🎨 Using palette: {args.palette}")
     print(f"🎨 Color space: {args.color_space}")
     print(f"🎨 Dithering: {'ON' if args.dither else 'OFF'}")
+    print(f"🗜️  RLE: {'ON' if args.rle else 'OFF'}")
+    print(f"🔁 Variants: {', '.join(args.variants) if args.variants else 'none'}")
     print(f"🏷️  Variable name: {var_name}")
     
     # 画像読み込み
@@ -605,20 +805,36 @@ def main():
     
     # BMP保存
     bmp_path = f"{output_prefix}.bmp"
-    quantized.save(bmp_path)
-    print(f"💾 Saved BMP: {bmp_path}")
-    
-    # RGB表示用画像も保存
-    rgb_image = quantized.convert('RGB')
     rgb_path = f"{output_prefix}_preview.png"
-    rgb_image.save(rgb_path)
-    print(f"💾 Saved preview: {rgb_path}")
+    if not args.header_only:
+        quantized.save(bmp_path)
+        print(f"💾 Saved BMP: {bmp_path}")
+        
+        # RGB表示用画像も保存
+        rgb_image = quantized.convert('RGB')
+        rgb_image.save(rgb_path)
+        print(f"💾 Saved preview: {rgb_path}")
     
     # M5StampPico用データ生成（改良版）
     print("🔢 Generating M5StampPico data...")
     try:
-        data_code = M5DataGenerator.generate_data_array(quantized, var_name)
+        if args.rle:
+            data_code, rle_size = M5DataGenerator.generate_rle_data_array(quantized, var_name)
+        else:
+            data_code = M5DataGenerator.generate_data_array(quantized, var_name)
         palette_code = M5DataGenerator.generate_palette_code(palette, var_name)
+
+        # 事前変換バリエーション（パレットは元画像と共通）
+        variant_codes = []
+        for variant in args.variants:
+            variant_image = M5DataGenerator.make_variant(quantized, variant)
+            variant_var = f"{var_name}_{variant}"
+            if args.rle:
+                variant_code, variant_size = M5DataGenerator.generate_rle_data_array(variant_image, variant_var)
+                rle_size += variant_size
+            else:
+                variant_code = M5DataGenerator.generate_data_array(variant_image, variant_var)
+            variant_codes.append(f"// Variant: {variant}\n" + variant_code)
     except Exception as e:
         print(f"❌ Error generating code: {e}")
         return 1
@@ -633,6 +849,8 @@ def main():
             f.write(f" * Palette: {args.palette}\n")
             f.write(f" * Dithering: {'ON' if args.dither else 'OFF'}\n")
             f.write(f" * Color space: {args.color_space}\n")
+            f.write(f" * RLE: {'ON' if args.rle else 'OFF'}\n")
+            f.write(f" * Variants: {', '.join(args.variants) if args.variants else 'none'}\n")
             f.write(f" * Variable name: {var_name}\n")
             f.write(" * \n")
             f.write(" * M5StampPico 16-Color Palette Image Tool (Improved Version)\n")
@@ -641,6 +859,9 @@ def main():
             f.write('#include "RetroGamePaletteImage.hpp"\n\n')
             f.write(data_code)
             f.write("\n\n")
+            for variant_code in variant_codes:
+                f.write(variant_code)
+                f.write("\n\n")
             f.write(palette_code)
         
         print(f"💾 Saved C header: {header_path}")
@@ -650,30 +871,40 @@ def main():
     
     # 統計情報
     final_size = quantized.size
-    data_size = (final_size[0] * final_size[1] + 1) // 2
-    original_16bit_size = final_size[0] * final_size[1] * 2
+    data_size = rle_size if args.rle else (final_size[0] * final_size[1] + 1) // 2 * (1 + len(args.variants))
+    original_16bit_size = final_size[0] * final_size[1] * 2 * (1 + len(args.variants))
     saving = ((original_16bit_size - data_size) / original_16bit_size) * 100
     
     print("\n📊 Conversion Summary:")
     print(f"   Input file: {args.input}")
     print(f"   Original size: {image.size}")
     print(f"   Final size: {final_size}")
-    print(f"   Variable names: {var_name}_data, {var_name}_width, {var_name}_height")
+    if args.rle:
+        print(f"   Variable names: {var_name}_rle_data, {var_name}_row_offsets, {var_name}_width, {var_name}_height")
+    else:
+        print(f"   Variable names: {var_name}_data, {var_name}_width, {var_name}_height")
+    for variant in args.variants:
+        variant_w, variant_h = final_size[::-1] if variant in ("rot90", "rot270") else final_size
+        print(f"   Variant {variant}: {var_name}_{variant}_data ({variant_w}x{variant_h})")
     print(f"   Palette: {args.palette} ({len(palette.colors_rgb)} colors)")
     print(f"   Data size: {data_size} bytes")
     print(f"   Memory saving: {saving:.1f}% vs 16-bit RGB565")
     print(f"   Files generated:")
-    print(f"     - {bmp_path} (BMP image)")
-    print(f"     - {rgb_path} (Preview)")
+    if not args.header_only:
+        print(f"     - {bmp_path} (BMP image)")
+        print(f"     - {rgb_path} (Preview)")
     print(f"     - {header_path} (C header with size info)")
     if args.preview:
         print(f"     - {output_prefix}_palette.png (Palette preview)")
     
     print("\n🎮 Ready for M5StampPico!")
     print(f"   #include \"{header_path}\"")
-    print(f"   PaletteImageData img({var_name}_data, {var_name}_width, {var_name}_height);")
-    print(f"   // または")
-    print(f"   PaletteImageData img({var_name}_data, {var_name.upper()}_WIDTH, {var_name.upper()}_HEIGHT);")
+    if args.rle:
+        print(f"   PaletteRleImageData img({var_name}_rle_data, {var_name}_row_offsets, {var_name}_width, {var_name}_height);")
+    else:
+        print(f"   PaletteImageData img({var_name}_data, {var_name}_width, {var_name}_height);")
+        print(f"   // または")
+        print(f"   PaletteImageData img({var_name}_data, {var_name.upper()}_WIDTH, {var_name.upper()}_HEIGHT);")
     
     return 0
 
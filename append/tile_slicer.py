@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+"""
+タイルスライスツール - Tile Slicer
+画像を8x8または16x16のタイルに分割し、重複を除去したタイルセットと
+タイルインデックスマップをRetroTilemap用のCヘッダーとして出力するプログラム
+
+使用例:
+python tile_slicer.py bglong1.png --tile-size 8
+→ bglong1_tiles.h (bglong1_tiles, bglong1_map, タイル数・マップサイズ定数)
+
+python tile_slicer.py nekonoba2025_cut_0_0_560.bmp --tile-size 16 --palette classic --dither
+python tile_slicer.py foreground.png --empty-transparent  (全透明タイルは描画しない)
+"""
+
+import sys
+import argparse
+from pathlib import Path
+from PIL import Image
+import numpy as np
+
+from image_to_palette import ColorPalette, ColorQuantizer, M5DataGenerator, sanitize_variable_name
+
+
+# RetroTilemap::EMPTY_TILEと一致させること
+EMPTY_TILE = 0xFFFF
+
+
+def parse_arguments():
+    """
+    コマンドライン引数を解析する関数
+    """
+    parser = argparse.ArgumentParser(
+        description='画像を重複除去済みタイルセットとタイルマップに変換します',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog="""
+使用例:
+  python %(prog)s bglong1.png --tile-size 8
+  python %(prog)s bg.bmp --tile-size 16 --palette gameboy --dither
+  python %(prog)s indexed.png --no-quantize  (16色以下のパレット画像をそのまま使用)
+        """
+    )
+
+    parser.add_argument('image',
+                       help='処理する画像ファイルのパス')
+    parser.add_argument('--tile-size', type=int, choices=[8, 16], default=8,
+                       help='タイルの一辺（ピクセル）')
+    parser.add_argument('--palette', choices=["classic", "gameboy", "sepia", "neon"],
+                       default="classic", help='減色に使うカラーパレット')
+    parser.add_argument('--dither', action='store_true',
+                       help='Floyd-Steinbergディザリングを使用')
+    parser.add_argument('--color-space', choices=["rgb", "lab", "hsv"], default="lab",
+                       help='色距離の計算に使う色空間')
+    parser.add_argument('--no-quantize', action='store_true',
+                       help='パレットモード画像のインデックスをそのまま使う（16色以下）')
+    parser.add_argument('--empty-transparent', action='store_true',
+                       help='全ピクセル透明のタイルをEMPTY_TILEとして出力（描画しない）')
+    parser.add_argument('--output', default='',
+                       help='出力ファイル名（デフォルト: <入力名>_tiles.h）')
+    parser.add_argument('--var-name', default='',
+                       help='C変数名のプレフィックス（デフォルト: 入力ファイル名から自動生成）')
+
+    return parser.parse_args()
+
+
+def load_indexed_image(image_path, args):
+    """
+    画像を読み込み、16色パレットインデックスの2次元配列に変換する
+
+    Args:
+        image_path (Path): 画像ファイルのパス
+        args: コマンドライン引数
+
+    Returns:
+        tuple: (インデックス配列, ColorPalette)
+    """
+    image = Image.open(image_path)
+    print(f"画像を読み込みました: {image_path}")
+    print(f"画像サイズ: {image.size[0]} x {image.size[1]} ピクセル")
+
+    palette = ColorPalette(args.palette)
+
+    if args.no_quantize:
+        if image.mode != 'P':
+            raise ValueError("--no-quantize はパレットモード（P）の画像にのみ使えます")
+        indices = np.array(image, dtype=np.uint8)
+        if indices.max() >= 16:
+            raise ValueError(f"パレットインデックスが16色を超えています（最大 {indices.max()}）")
+
+        # 画像側のパレットをそのまま使う
+        raw = image.getpalette()[:48]
+        raw += [0] * (48 - len(raw))
+        palette.colors_rgb = [tuple(raw[i:i + 3]) for i in range(0, 48, 3)]
+        palette.colors_rgb565 = [((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+                                 for r, g, b in palette.colors_rgb]
+        return indices, palette
+
+    quantizer = ColorQuantizer(palette, args.color_space)
+    quantized = quantizer.quantize_image(image, args.dither)
+    return np.array(quantized, dtype=np.uint8), palette
+
+
+def slice_tiles(indices, tile_size, empty_transparent=False):
+    """
+    インデックス配列をタイルに分割して重複を除去する
+    端の半端な部分は透明色（インデックス0）で埋める
+
+    Args:
+        indices (ndarray): パレットインデックスの2次元配列
+        tile_size (int): タイルの一辺
+        empty_transparent (bool): 全透明タイルをEMPTY_TILEにするか
+
+    Returns:
+        tuple: (タイルのバイト列リスト, タイルマップ, マップ幅, マップ高さ)
+    """
+    height, width = indices.shape
+    map_width = (width + tile_size - 1) // tile_size
+    map_height = (height + tile_size - 1) // tile_size
+
+    padded = np.zeros((map_height * tile_size, map_width * tile_size), dtype=np.uint8)
+    padded[:height, :width] = indices
+
+    tiles = []
+    tile_lookup = {}
+    tile_map = []
+    empty_count = 0
+
+    for ty in range(map_height):
+        for tx in range(map_width):
+            block = padded[ty * tile_size:(ty + 1) * tile_size, tx * tile_size:(tx + 1) * tile_size]
+
+            if empty_transparent and not block.any():
+                tile_map.append(EMPTY_TILE)
+                empty_count += 1
+                continue
+
+            # 下位4bit: 偶数ピクセル, 上位4bit: 奇数ピクセル（PaletteImageDataと同じ並び）
+            flat = block.flatten()
+            packed = bytes(((flat[1::2] & 0x0F) << 4) | (flat[0::2] & 0x0F))
+
+            index = tile_lookup.get(packed)
+            if index is None:
+                index = len(tiles)
+                if index >= EMPTY_TILE:
+                    raise ValueError("ユニークタイルが多すぎます（65535個まで）")
+                tile_lookup[packed] = index
+                tiles.append(packed)
+            tile_map.append(index)
+
+    if empty_transparent:
+        print(f"全透明タイル: {empty_count} 個（EMPTY_TILE）")
+
+    return tiles, tile_map, map_width, map_height
+
+
+def generate_header(tiles, tile_map, map_width, map_height, tile_size, palette, var_name, source_name):
+    """
+    タイルセットとタイルマップのCヘッダーを生成する
+
+    Returns:
+        str: ヘッダーファイルの内容
+    """
+    tiles_var = f"{var_name}_tiles"
+    map_var = f"{var_name}_map"
+    upper = var_name.upper()
+    tile_bytes = tile_size * tile_size // 2
+    tiles_size = len(tiles) * tile_bytes
+    raw_size = map_width * tile_size * map_height * tile_size // 2
+
+    lines = ["/*"]
+    lines.append(f" * Auto-generated from {source_name}")
+    lines.append(f" * Tiles: {len(tiles)} unique of {map_width * map_height} ({tile_size}x{tile_size})")
+    lines.append(f" * Map: {map_width}x{map_height} tiles ({map_width * tile_size}x{map_height * tile_size} pixels)")
+    lines.append(f" * Size: {tiles_size} bytes tiles + {len(tile_map) * 2} bytes map (raw 4bpp: {raw_size} bytes)")
+    lines.append(" * ")
+    lines.append(" * M5StampPico Tile Slicer")
+    lines.append(" */")
+    lines.append("")
+    lines.append("#pragma once")
+    lines.append('#include "RetroTilemap.hpp"')
+    lines.append("")
+
+    # サイズ定数
+    lines.append(f"// タイル・マップサイズ情報")
+    lines.append(f"#define {upper}_TILE_SIZE  {tile_size}")
+    lines.append(f"#define {upper}_TILE_COUNT {len(tiles)}")
+    lines.append(f"#define {upper}_MAP_WIDTH  {map_width}")
+    lines.append(f"#define {upper}_MAP_HEIGHT {map_height}")
+    lines.append("")
+
+    # タイルセット配列
+    lines.append(f"// タイルセット（1タイル{tile_bytes}バイト、1バイトに2ピクセル格納）")
+    lines.append(f"const uint8_t {tiles_var}[{max(tiles_size, 1)}] = {{")
+    for i, tile in enumerate(tiles):
+        lines.append(f"    // tile {i}")
+        for row in range(0, tile_bytes, 16):
+            hex_values = [f"0x{b:02X}" for b in tile[row:row + 16]]
+            line = "    " + ", ".join(hex_values)
+            if i + 1 < len(tiles) or row + 16 < tile_bytes:
+                line += ","
+            lines.append(line)
+    if not tiles:
+        lines.append("    0x00")
+    lines.append("};")
+    lines.append("")
+
+    # タイルマップ配列
+    lines.append(f"// タイルマップ（0x{EMPTY_TILE:04X} = EMPTY_TILE）")
+    lines.append(f"const uint16_t {map_var}[{len(tile_map)}] = {{")
+    for ty in range(map_height):
+        row = tile_map[ty * map_width:(ty + 1) * map_width]
+        line = "    " + ", ".join(f"0x{v:04X}" if v == EMPTY_TILE else str(v) for v in row)
+        if ty + 1 < map_height:
+            line += ","
+        lines.append(line)
+    lines.append("};")
+    lines.append("")
+
+    # パレット
+    lines.append(M5DataGenerator.generate_palette_code(palette, var_name))
+    lines.append("")
+
+    lines.append(f"// 使用例:")
+    lines.append(f"// RetroColorPalette pal;")
+    lines.append(f"// {var_name}_palette_init(pal);")
+    lines.append(f"// RetroTileset tileset({tiles_var}, {upper}_TILE_SIZE, {upper}_TILE_COUNT, &pal);")
+    lines.append(f"// RetroTilemap tilemap(&tileset, {map_var}, {upper}_MAP_WIDTH, {upper}_MAP_HEIGHT);")
+    lines.append(f"// tilemap.setScroll(scrollX, scrollY);")
+    lines.append(f"// tilemap.render(renderer);")
+    lines.append("")
+
+    return "\n".join(lines)
+
+
+def main():
+    """
+    メイン処理関数
+    """
+    try:
+        args = parse_arguments()
+
+        image_path = Path(args.image)
+        if not image_path.exists():
+            raise FileNotFoundError(f"画像ファイルが見つかりません: {args.image}")
+
+        var_name = args.var_name if args.var_name else sanitize_variable_name(args.image)
+        output_path = Path(args.output) if args.output else image_path.parent / f"{image_path.stem}_tiles.h"
+
+        print("=" * 50)
+        print("🧩 タイルスライスツール開始！")
+        print("=" * 50)
+
+        indices, palette = load_indexed_image(image_path, args)
+        tiles, tile_map, map_width, map_height = slice_tiles(indices, args.tile_size, args.empty_transparent)
+
+        header = generate_header(tiles, tile_map, map_width, map_height, args.tile_size,
+                                 palette, var_name, image_path.name)
+        with open(output_path, "w", encoding='utf-8') as f:
+            f.write(header)
+
+        tiles_size = len(tiles) * args.tile_size * args.tile_size // 2
+        raw_size = map_width * args.tile_size * map_height * args.tile_size // 2
+        total_size = tiles_size + len(tile_map) * 2
+        saving = (raw_size - total_size) / raw_size * 100 if raw_size else 0
+
+        print("\n" + "=" * 50)
+        print("✨ 処理完了！")
+        print(f"🧩 タイル: {len(tiles)} 個（全 {map_width * map_height} 個中、{args.tile_size}x{args.tile_size}）")
+        print(f"🗺️  マップ: {map_width} x {map_height} タイル")
+        print(f"📊 サイズ: {total_size} バイト（4bit一枚絵 {raw_size} バイト比 {saving:.1f}% 削減）")
+        print(f"📄 {output_path}")
+        print("=" * 50)
+
+    except FileNotFoundError as e:
+        print(f"❌ ファイルエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except ValueError as e:
+        print(f"❌ 値エラー: {e}", file=sys.stderr)
+        sys.exit(1)
+    except KeyboardInterrupt:
+        print("\n⚠️ 処理が中断されました")
+        sys.exit(1)
+    except Exception as e:
+        print(f"❌ 予期しないエラー: {e}", file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
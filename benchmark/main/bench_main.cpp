@@ -0,0 +1,244 @@
+/*
+ * 描画プリミティブ ベンチマーク for M5StampPico
+ * 固定のアセット・座標・倍率で各描画関数を繰り返し実行し、
+ * 1フレームあたりの時間とピクセル処理速度をシリアルに表形式で出力する
+ *
+ * 出力形式（1行1ケース、カンマ区切り）:
+ *   BENCH_HEADER,case,canvas,iterations,us_per_frame,min_us,pixels_per_frame,pixels_per_us
+ *   BENCH,draw_landscape,rgb565,200,812.35,801,21584,26.570
+ *   BENCH_DONE,cases=38
+ * "BENCH"で始まる行だけを拾えばコミット間で比較できる
+ */
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <M5Unified.h>
+
+#include "LGFX_ST7789P3_76x284.hpp"
+#include "RetroGamePaletteImage.hpp"
+#include "RetroBitmapFont.hpp"
+#include "RetroHotAssetCache.hpp"
+#include "dot_landscape.h"
+#include "display_images.h"
+
+static const char *TAG = "Benchmark";
+
+// ディスプレイインスタンス
+static LGFX_ST7789P3_76x284 tft;
+
+// 計測前の空回し回数
+static const int WARMUP_ITERATIONS = 3;
+
+/**
+ * ベンチマークで使うアセット
+ */
+struct BenchAssets {
+    PaletteImageData landscape;   // 284x76 一枚絵
+    PaletteImageData heart;       // 8x8 スプライト
+    PaletteImageData face;        // 16x16 スプライト
+    PaletteImageData character;   // 12x16 スプライト
+    MonoImageData mono;           // 394x560 1bitモノクロ画像
+    mutable RetroTextRun title;   // 28文字のHUD文字列（描画すると変更フラグが落ちる）
+    mutable RetroHotAssetCache hotCache;  // 一枚絵を内部RAMへ先読みしたキャッシュ
+
+    BenchAssets()
+        : landscape(dot_landscape_data, dot_landscape_width, dot_landscape_height),
+          heart(SAMPLE_HEART_8x8, 8, 8),
+          face(SAMPLE_FACE_16x16, 16, 16),
+          character(SAMPLE_CHAR_STAND_12x16, 12, 16),
+          mono(nekonoba2025_cut_0_0_560, NEKONOBA2025_CUT_0_0_560_WIDTH, NEKONOBA2025_CUT_0_0_560_HEIGHT),
+          title(&RetroBitmapFont::getDefault(), 28),
+          hotCache(landscape.dataSize) {
+        title.setText("M5StampPico - Landscape Mode");
+        hotCache.prefetch(landscape);
+    }
+};
+
+/**
+ * ベンチマークケース
+ * run は1フレーム分の処理、pixels はそのフレームで処理するピクセル数
+ */
+struct BenchCase {
+    const char* name;
+    int iterations;
+    uint32_t pixels;
+    void (*run)(PaletteImageRenderer& renderer, const BenchAssets& assets);
+};
+
+static const BenchCase BENCH_CASES[] = {
+    {"clear", 200, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets&) {
+        r.clearCanvas(0x0000);
+    }},
+    {"draw_landscape", 200, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        r.drawToCanvas(a.landscape, 0, 0, true);
+    }},
+    {"draw_landscape_cached", 200, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        // フラッシュ上の一枚絵を内部RAMのコピーから描画（draw_landscape と比べる）
+        r.setAssetCache(&a.hotCache);
+        r.drawToCanvas(a.landscape, 0, 0, true);
+        r.setAssetCache(nullptr);
+    }},
+    {"draw_landscape_opaque", 200, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        r.drawToCanvasOpaque(a.landscape, 0, 0);
+    }},
+    {"draw_sprite_8x8_x64", 200, 64 * 8 * 8, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        // 32列×2行、偶数・奇数X座標を混在させる
+        for (int i = 0; i < 64; i++) {
+            r.drawToCanvas(a.heart, (i % 32) * 8 + (i / 32), 20 + (i / 32) * 30, true);
+        }
+    }},
+    {"draw_sprite_16x16_x32", 200, 32 * 16 * 16, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        for (int i = 0; i < 32; i++) {
+            r.drawToCanvas(a.face, (i % 16) * 17, 10 + (i / 16) * 40, true);
+        }
+    }},
+    {"draw_sprite_12x16_x32", 200, 32 * 12 * 16, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        for (int i = 0; i < 32; i++) {
+            r.drawToCanvas(a.character, (i % 16) * 17 + 1, 10 + (i / 16) * 40, true);
+        }
+    }},
+    {"draw_sprite_12x16_x32_fliph", 200, 32 * 12 * 16, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        for (int i = 0; i < 32; i++) {
+            r.drawToCanvasTransformed(a.character, (i % 16) * 17 + 1, 10 + (i / 16) * 40,
+                                      PaletteImageRenderer::BLIT_FLIP_H, true);
+        }
+    }},
+    {"draw_sprite_12x16_x32_rot90", 200, 32 * 12 * 16, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        for (int i = 0; i < 32; i++) {
+            r.drawToCanvasTransformed(a.character, (i % 16) * 17, 10 + (i / 16) * 40,
+                                      PaletteImageRenderer::BLIT_ROTATE_90, true);
+        }
+    }},
+    {"draw_sprite_16x16_x32_opaque", 200, 32 * 16 * 16, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        for (int i = 0; i < 32; i++) {
+            r.drawToCanvasOpaque(a.face, (i % 16) * 17, 10 + (i / 16) * 40);
+        }
+    }},
+    {"draw_mono_284x76", 200, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        // 画像の中ほどを切り出す（左端は奇数ビット位置から始まる）
+        r.drawToCanvas(a.mono, -55, -240, true);
+    }},
+    {"draw_mono_284x76_opaque", 200, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        r.drawToCanvas(a.mono, -55, -240, false);
+    }},
+    {"draw_text_28ch_glyphs", 200, 28 * 6 * 8, [](PaletteImageRenderer& r, const BenchAssets&) {
+        RetroBitmapFont::getDefault().drawText(r, 5, 4, "M5StampPico - Landscape Mode", 0xFFFF);
+    }},
+    {"draw_text_28ch_run", 200, 28 * 6 * 8, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        a.title.draw(r, 5, 4);
+    }},
+    {"scaled_landscape_0.5x", 200, 142 * 38, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        r.drawToCanvasScaled(a.landscape, 71, 19, 0.5f, 0.5f, false);
+    }},
+    {"scaled_sprite_16x16_2x_x8", 200, 8 * 32 * 32, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        for (int i = 0; i < 8; i++) {
+            r.drawToCanvasScaled(a.face, i * 34, 20, 2.0f, 2.0f, true);
+        }
+    }},
+    {"scaled_sprite_16x16_1.5x_x8", 200, 8 * 24 * 24, [](PaletteImageRenderer& r, const BenchAssets& a) {
+        for (int i = 0; i < 8; i++) {
+            r.drawToCanvasScaled(a.face, i * 34, 26, 1.5f, 1.5f, true);
+        }
+    }},
+    {"push", 50, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets&) {
+        r.pushCanvasToDisplay(0, 0, 0x0000);
+    }},
+    {"push_opaque", 50, 284 * 76, [](PaletteImageRenderer& r, const BenchAssets&) {
+        r.pushCanvasToDisplayOpaque(0, 0);
+    }},
+};
+
+static const int BENCH_CASE_COUNT = sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]);
+
+/**
+ * 1ケースを計測して結果行を出力
+ * @param bench ベンチマークケース
+ * @param renderer 描画先レンダラー
+ * @param canvasName キャンバス種別の表示名
+ * @param assets アセット
+ */
+static void runBenchCase(const BenchCase& bench, PaletteImageRenderer& renderer,
+                         const char* canvasName, const BenchAssets& assets) {
+    // 背景を揃えてからキャッシュ・バッファ確保を済ませる
+    renderer.clearCanvas(0x0000);
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) {
+        bench.run(renderer, assets);
+    }
+
+    int64_t totalUs = 0;
+    int64_t minUs = INT64_MAX;
+    for (int i = 0; i < bench.iterations; i++) {
+        int64_t start = esp_timer_get_time();
+        bench.run(renderer, assets);
+        int64_t elapsed = esp_timer_get_time() - start;
+        totalUs += elapsed;
+        minUs = min(minUs, elapsed);
+    }
+
+    // 描画しただけのダーティ矩形が次のケースに残らないようにする
+    renderer.clearDirty();
+
+    double usPerFrame = (double)totalUs / bench.iterations;
+    double pixelsPerUs = usPerFrame > 0.0 ? bench.pixels / usPerFrame : 0.0;
+    printf("BENCH,%s,%s,%d,%.2f,%lld,%lu,%.3f\n", bench.name, canvasName, bench.iterations,
+           usPerFrame, (long long)minUs, (unsigned long)bench.pixels, pixelsPerUs);
+
+    // ウォッチドッグ対策で他タスクに譲る
+    vTaskDelay(1);
+}
+
+/**
+ * 全ケースを指定キャンバスで計測
+ * @param renderer 描画先レンダラー
+ * @param canvasName キャンバス種別の表示名
+ * @param assets アセット
+ */
+static void runBenchSuite(PaletteImageRenderer& renderer, const char* canvasName, const BenchAssets& assets) {
+    // プロファイラ自体のコストを含めず、描画関数だけを測る
+    renderer.setProfilingEnabled(false);
+
+    for (int i = 0; i < BENCH_CASE_COUNT; i++) {
+        runBenchCase(BENCH_CASES[i], renderer, canvasName, assets);
+    }
+}
+
+// メイン関数
+extern "C" void app_main(void) {
+    ESP_LOGI(TAG, "=== Rendering Benchmark ===");
+
+    auto cfg = M5.config();
+    M5.begin(cfg);
+
+    // 本体デモと同じ横向き（284×76）
+    tft.initWithRotation(1);
+    
+    // 転送系のケースはSPIクロックに比例するので、比較時に確認できるよう出力しておく
+    ESP_LOGI(TAG, "SPI write clock: %luHz", (unsigned long)tft.getWriteFrequency());
+
+    BenchAssets assets;
+    RetroColorPalette palette;
+
+    {
+        PaletteImageRenderer rgb565(&tft, tft.width(), tft.height());
+        PaletteImageRenderer indexed(&tft, tft.width(), tft.height(), palette);
+
+        // 表の途中にライブラリのログが混ざらないようにする
+        esp_log_level_set("*", ESP_LOG_WARN);
+
+        printf("BENCH_HEADER,case,canvas,iterations,us_per_frame,min_us,pixels_per_frame,pixels_per_us\n");
+        runBenchSuite(rgb565, "rgb565", assets);
+        runBenchSuite(indexed, "pal4", assets);
+        printf("BENCH_DONE,cases=%d\n", BENCH_CASE_COUNT * 2);
+
+        esp_log_level_set("*", ESP_LOG_INFO);
+    }
+
+    ESP_LOGI(TAG, "Benchmark complete");
+
+    while (true) {
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+    }
+}
@@ -4,8 +4,9 @@
  * ランダムドット問題解決 + 回転対応 for M5StampPico
  */
 
-// #include "LGFX_ST7789P3_76x284.hpp"
-// #include "esp_log.h"
+#include "LGFX_ST7789P3_76x284.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
 
 // ログタグ定義
 static const char *TAG = "LGFX_ST7789P3";
@@ -28,7 +29,7 @@ const LGFX_ST7789P3_76x284::RotationConfig LGFX_ST7789P3_76x284::rotation_config
 /**
  * コンストラクタ：SPI設定とパネル設定
  */
-LGFX_ST7789P3_76x284::LGFX_ST7789P3_76x284(void)
+LGFX_ST7789P3_76x284::LGFX_ST7789P3_76x284(uint32_t writeFreq)
 {
     ESP_LOGI(TAG, "Initializing LGFX_ST7789P3_76x284 class (rotation-aware)...");
     
@@ -37,7 +38,7 @@ LGFX_ST7789P3_76x284::LGFX_ST7789P3_76x284(void)
         auto cfg = _bus_instance.config();
         cfg.spi_host = HSPI_HOST;
         cfg.spi_mode = 0;                // SPI Mode 0
-        cfg.freq_write = 20000000;       // 20MHz
+        cfg.freq_write = writeFreq;      // デフォルト20MHz（menuconfigで変更可能）
         cfg.freq_read = 10000000;        // 10MHz
         cfg.spi_3wire = false;           // 4線式SPI
         cfg.use_lock = true;
@@ -49,7 +50,8 @@ LGFX_ST7789P3_76x284::LGFX_ST7789P3_76x284(void)
         _bus_instance.config(cfg);
         _panel_instance.setBus(&_bus_instance);
         
-        ESP_LOGI(TAG, "SPI bus configured: SCLK=%d, MOSI=%d, DC=%d", PIN_SCL, PIN_SDA, PIN_DC);
+        ESP_LOGI(TAG, "SPI bus configured: SCLK=%d, MOSI=%d, DC=%d, write=%luHz",
+                 PIN_SCL, PIN_SDA, PIN_DC, (unsigned long)writeFreq);
     }
 
     // ST7789P3 (76×284) 専用パネル設定
@@ -90,6 +92,11 @@ LGFX_ST7789P3_76x284::LGFX_ST7789P3_76x284(void)
     }
 
     setPanel(&_panel_instance);
+    
+    _transfer_lock = xSemaphoreCreateMutex();
+    if (!_transfer_lock) {
+        ESP_LOGE(TAG, "Failed to create transfer lock, panel idle mode is not fenced against background pushes");
+    }
     ESP_LOGI(TAG, "LGFX_ST7789P3_76x284 class initialization complete");
 }
 
@@ -149,11 +156,14 @@ void LGFX_ST7789P3_76x284::performRotationAwareInitialization(int rotation)
     
     startWrite();
     
-    // Memory Data Access Control (MADCTL) - 回転に応じて設定
-    ESP_LOGI(TAG, "Setting MADCTL for rotation %d...", rotation);
-    writeCommand(0x36);  // MADCTL
-    writeData(config.madctl);
+    // MADCTL・CASET・RASET - 回転に応じて設定
+    ESP_LOGI(TAG, "Setting MADCTL and address window for rotation %d...", rotation);
+    writeRotationRegisters(config);
     ESP_LOGI(TAG, "✓ MADCTL set to 0x%02X", config.madctl);
+    ESP_LOGI(TAG, "✓ CASET set to %d-%d (width=%d)",
+             config.offset_x, config.offset_x + config.width - 1, config.width);
+    ESP_LOGI(TAG, "✓ RASET set to %d-%d (height=%d)",
+             config.offset_y, config.offset_y + config.height - 1, config.height);
     
     // Color Mode - 16bit RGB565
     ESP_LOGI(TAG, "Setting Color Mode...");
@@ -161,38 +171,73 @@ void LGFX_ST7789P3_76x284::performRotationAwareInitialization(int rotation)
     writeData(0x05);     // 16-bit/pixel
     ESP_LOGI(TAG, "✓ COLMOD set to RGB565");
     
-    // Column Address Set - 回転対応
-    ESP_LOGI(TAG, "Setting Column Address (CASET) for rotation %d...", rotation);
+    // その他のST7789P3設定
+    setupST7789P3Registers();
+    
+    endWrite();
+    
+    ESP_LOGI(TAG, "=== Rotation-Aware Custom Initialization Complete ===");
+}
+
+/**
+ * 回転角度別のMADCTL・CASET・RASETを書き込み
+ */
+void LGFX_ST7789P3_76x284::writeRotationRegisters(const RotationConfig& config)
+{
+    // Memory Data Access Control (MADCTL)
+    writeCommand(0x36);  // MADCTL
+    writeData(config.madctl);
+    
+    // Column Address Set
     uint16_t x_start = config.offset_x;
     uint16_t x_end = x_start + config.width - 1;
-    
     writeCommand(0x2A);  // CASET
     writeData(x_start >> 8);
     writeData(x_start & 0xFF);
     writeData(x_end >> 8);
     writeData(x_end & 0xFF);
-    ESP_LOGI(TAG, "✓ CASET set to 0x%04X-0x%04X (%d-%d, width=%d)", 
-             x_start, x_end, x_start, x_end, config.width);
     
-    // Row Address Set - 回転対応
-    ESP_LOGI(TAG, "Setting Row Address (RASET) for rotation %d...", rotation);
+    // Row Address Set
     uint16_t y_start = config.offset_y;
     uint16_t y_end = y_start + config.height - 1;
-    
     writeCommand(0x2B);  // RASET
     writeData(y_start >> 8);
     writeData(y_start & 0xFF);
     writeData(y_end >> 8);
     writeData(y_end & 0xFF);
-    ESP_LOGI(TAG, "✓ RASET set to 0x%04X-0x%04X (%d-%d, height=%d)", 
-             y_start, y_end, y_start, y_end, config.height);
+}
+
+/**
+ * 回転角度の高速切り替え
+ */
+void LGFX_ST7789P3_76x284::setRotationFast(int rotation)
+{
+    if (rotation < 0 || rotation > 3) {
+        ESP_LOGE(TAG, "Invalid rotation: %d", rotation);
+        return;
+    }
     
-    // その他のST7789P3設定
-    setupST7789P3Registers();
+    const int64_t start = esp_timer_get_time();
+    const auto& config = rotation_configs[rotation];
+    
+    // 転送中のDMAがあれば、書き込み方向を変える前に終わらせる
+    waitDMA();
+    
+    // LGFX側の幅・高さ・アドレスウィンドウの計算を切り替えてから、パネル専用の値で上書き
+    setRotation(rotation);
+    _current_rotation = rotation;
     
+    startWrite();
+    writeRotationRegisters(config);
     endWrite();
     
-    ESP_LOGI(TAG, "=== Rotation-Aware Custom Initialization Complete ===");
+    // 回転2/3ではスクロールの向きが逆になるので、同じ見た目のスクロール量を設定し直す
+    if (_hw_scroll_enabled) {
+        setHardwareScroll(_hw_scroll_offset);
+    }
+    
+    ESP_LOGI(TAG, "Rotation switched to %d - %s (%ldx%ld) in %lldus",
+             rotation, config.name, width(), height(), (long long)(esp_timer_get_time() - start));
 }
 
 /**
@@ -295,6 +340,146 @@ void LGFX_ST7789P3_76x284::setupST7789P3Registers()
     ESP_LOGI(TAG, "✓ ST7789P3 display turned on");
 }
 
+/**
+ * SPI書き込みクロックを変更
+ */
+void LGFX_ST7789P3_76x284::setWriteFrequency(uint32_t freq)
+{
+    waitDMA();
+    
+    // 分周比はバス初期化時に計算されるので、設定を差し替えて再初期化する
+    auto cfg = _bus_instance.config();
+    cfg.freq_write = freq;
+    _bus_instance.release();
+    _bus_instance.config(cfg);
+    _bus_instance.init();
+    
+    ESP_LOGI(TAG, "SPI write clock set to %luHz", (unsigned long)freq);
+}
+
+/**
+ * 現在のSPI書き込みクロックを取得
+ */
+uint32_t LGFX_ST7789P3_76x284::getWriteFrequency() const
+{
+    return _bus_instance.config().freq_write;
+}
+
+/**
+ * テストパターンを全画面に書き込み
+ */
+bool LGFX_ST7789P3_76x284::runProbePatterns(uint16_t* line, bool verify, int64_t& elapsedUs)
+{
+    const int w = width();
+    const int h = height();
+    uint16_t* readback = line + w;
+    bool ok = true;
+    
+    elapsedUs = 0;
+    for (int pattern = 0; pattern < PROBE_PATTERNS && ok; pattern++) {
+        uint32_t seed = 0x12345678u + pattern;
+        
+        startWrite();
+        for (int y = 0; y < h; y++) {
+            // 0: 全ビットが隣接ピクセルで反転する市松, 1: グラデーション, 2: 疑似乱数
+            for (int x = 0; x < w; x++) {
+                uint16_t v;
+                if (pattern == 0) {
+                    v = ((x ^ y) & 1) ? 0xAAAA : 0x5555;
+                } else if (pattern == 1) {
+                    v = (uint16_t)(((x * 31 / w) << 11) | ((y * 63 / h) << 5) | ((x + y) & 0x1F));
+                } else {
+                    seed ^= seed << 13;
+                    seed ^= seed >> 17;
+                    seed ^= seed << 5;
+                    v = (uint16_t)seed;
+                }
+                line[x] = v;
+            }
+            
+            int64_t start = esp_timer_get_time();
+            pushImage(0, y, w, 1, (const lgfx::swap565_t*)line);
+            elapsedUs += esp_timer_get_time() - start;
+            
+            if (verify) {
+                readRect(0, y, w, 1, (lgfx::swap565_t*)readback);
+                if (memcmp(line, readback, w * sizeof(uint16_t)) != 0) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+        endWrite();
+    }
+    return ok;
+}
+
+/**
+ * より速いSPIクロックを探して設定（書き込み専用の配線ではスループットだけで選ぶ）
+ */
+uint32_t LGFX_ST7789P3_76x284::probeWriteFrequency(uint32_t maxFreq)
+{
+    ESP_LOGI(TAG, "=== SPI Write Clock Probe ===");
+    
+    // 読み出しにはMISOの配線とパネルの読み出し設定が必要
+    const bool verify = _panel_instance.config().readable && _bus_instance.config().pin_miso >= 0;
+    
+    // HSPIのIO_MUXピン（SCLK=14, MOSI=13）以外はGPIOマトリクス経由になる
+    const bool iomux = (PIN_SCL == 14 && PIN_SDA == 13);
+    if (!verify && !iomux && maxFreq > SPI_GPIO_MATRIX_MAX_FREQ) {
+        ESP_LOGI(TAG, "Readback unavailable, capping probe at %luHz (GPIO matrix)",
+                 (unsigned long)SPI_GPIO_MATRIX_MAX_FREQ);
+        maxFreq = SPI_GPIO_MATRIX_MAX_FREQ;
+    }
+    
+    uint16_t* line = (uint16_t*)malloc(width() * 2 * sizeof(uint16_t));
+    if (!line) {
+        ESP_LOGE(TAG, "Failed to allocate probe buffer");
+        return getWriteFrequency();
+    }
+    
+    uint32_t best = getWriteFrequency();
+    int64_t bestUs;
+    if (!runProbePatterns(line, verify, bestUs)) {
+        ESP_LOGE(TAG, "Pattern mismatch at the current clock (%luHz)", (unsigned long)best);
+    } else {
+        ESP_LOGI(TAG, "  %luHz: %lldus", (unsigned long)best, (long long)bestUs);
+        
+        // 現在より速い分周比を1段ずつ試す
+        for (uint32_t divider = (SPI_APB_FREQ + best - 1) / best - 1; divider >= 1; divider--) {
+            const uint32_t freq = SPI_APB_FREQ / divider;
+            if (freq > maxFreq) break;
+            
+            setWriteFrequency(freq);
+            int64_t us;
+            if (!runProbePatterns(line, verify, us)) {
+                ESP_LOGW(TAG, "  %luHz: pattern mismatch", (unsigned long)freq);
+                break;
+            }
+            ESP_LOGI(TAG, "  %luHz: %lldus", (unsigned long)freq, (long long)us);
+            
+            // 照合できない場合、転送時間が1割以上短くならないなら上げる意味がない
+            if (!verify && us * 10 > bestUs * 9) {
+                ESP_LOGI(TAG, "  No throughput gain, stopping");
+                break;
+            }
+            best = freq;
+            bestUs = us;
+        }
+        
+        if (getWriteFrequency() != best) {
+            setWriteFrequency(best);
+        }
+    }
+    
+    fillScreen(0x0000);
+    free(line);
+    
+    ESP_LOGI(TAG, "SPI write clock: %luHz (%s)", (unsigned long)best,
+             verify ? "verified by readback" : "write-only, not verified");
+    return best;
+}
+
 /**
  * 現在の回転角度名を取得
  */
@@ -306,6 +491,133 @@ const char* LGFX_ST7789P3_76x284::getCurrentRotationName() const
     return "Unknown";
 }
 
+/**
+ * ハードウェアスクロール開始
+ */
+void LGFX_ST7789P3_76x284::enableHardwareScroll()
+{
+    // 全回転で長辺はフレームメモリの行方向（オフセットは上下とも18ライン）
+    const uint16_t top_fixed = OFFSET_Y;
+    const uint16_t bottom_fixed = PANEL_MEMORY_LINES - OFFSET_Y - SCROLL_AREA_LINES;
+    
+    startWrite();
+    writeCommand(0x33);  // VSCRDEF
+    writeData(top_fixed >> 8);
+    writeData(top_fixed & 0xFF);
+    writeData(SCROLL_AREA_LINES >> 8);
+    writeData(SCROLL_AREA_LINES & 0xFF);
+    writeData(bottom_fixed >> 8);
+    writeData(bottom_fixed & 0xFF);
+    endWrite();
+    
+    _hw_scroll_enabled = true;
+    setHardwareScroll(0);
+    
+    ESP_LOGI(TAG, "Hardware scroll enabled: TFA=%d, VSA=%d, BFA=%d (%s)",
+             top_fixed, SCROLL_AREA_LINES, bottom_fixed,
+             isScrollAxisHorizontal() ? "horizontal" : "vertical");
+}
+
+/**
+ * ハードウェアスクロール終了
+ */
+void LGFX_ST7789P3_76x284::disableHardwareScroll()
+{
+    if (!_hw_scroll_enabled) return;
+    
+    setHardwareScroll(0);
+    
+    startWrite();
+    writeCommand(0x33);  // VSCRDEF（フレームメモリ全体）
+    writeData(0x00);
+    writeData(0x00);
+    writeData(PANEL_MEMORY_LINES >> 8);
+    writeData(PANEL_MEMORY_LINES & 0xFF);
+    writeData(0x00);
+    writeData(0x00);
+    endWrite();
+    
+    _hw_scroll_enabled = false;
+    ESP_LOGI(TAG, "Hardware scroll disabled");
+}
+
+/**
+ * ハードウェアスクロール量を設定
+ */
+void LGFX_ST7789P3_76x284::setHardwareScroll(int offset)
+{
+    if (!_hw_scroll_enabled) return;
+    
+    offset %= SCROLL_AREA_LINES;
+    if (offset < 0) offset += SCROLL_AREA_LINES;
+    _hw_scroll_offset = offset;
+    
+    // 回転2/3は長辺方向が物理的な行と逆向きなので、逆方向にスクロールさせる
+    int line = (_current_rotation >= 2 && offset) ? SCROLL_AREA_LINES - offset : offset;
+    uint16_t start_address = OFFSET_Y + line;
+    
+    notifyTransferBegin();
+    startWrite();
+    writeCommand(0x37);  // VSCSAD
+    writeData(start_address >> 8);
+    writeData(start_address & 0xFF);
+    endWrite();
+    notifyFrameSent(2);
+}
+
+/**
+ * 画面上の位置をフレームメモリ位置に変換
+ */
+int LGFX_ST7789P3_76x284::scrollScreenToMemory(int screenPos) const
+{
+    int pos = (screenPos + _hw_scroll_offset) % SCROLL_AREA_LINES;
+    return (pos < 0) ? pos + SCROLL_AREA_LINES : pos;
+}
+
+/**
+ * スクロール方向に細長いスプライトを転送
+ */
+void LGFX_ST7789P3_76x284::pushScrollStrip(lgfx::LGFX_Sprite* strip, int screenPos)
+{
+    if (!strip) return;
+    
+    const bool horizontal = isScrollAxisHorizontal();
+    const int length = horizontal ? strip->width() : strip->height();
+    const int pos = scrollScreenToMemory(screenPos);
+    
+    notifyTransferBegin();
+    // 画面外にはみ出した分はクリップされるので、端をまたぐ場合は先頭側にも書き込む
+    if (horizontal) {
+        strip->pushSprite(this, pos, 0);
+        if (pos + length > SCROLL_AREA_LINES) {
+            strip->pushSprite(this, pos - SCROLL_AREA_LINES, 0);
+        }
+    } else {
+        strip->pushSprite(this, 0, pos);
+        if (pos + length > SCROLL_AREA_LINES) {
+            strip->pushSprite(this, 0, pos - SCROLL_AREA_LINES);
+        }
+    }
+}
+
+/**
+ * パネルのアイドルモード切り替え（IDMON/IDMOFF）
+ */
+void LGFX_ST7789P3_76x284::setPanelIdleMode(bool enable)
+{
+    if (enable == _panel_idle) return;
+    
+    // 別タスクのDMA転送の途中にコマンドを挟まないよう、転送の完了を待つ
+    beginBackgroundTransfer();
+    startWrite();
+    writeCommand(enable ? 0x39 : 0x38);  // IDMON / IDMOFF
+    endWrite();
+    endBackgroundTransfer();
+    
+    _panel_idle = enable;
+    ESP_LOGI(TAG, "Panel idle mode %s", enable ? "on (8 colors)" : "off");
+}
+
 /*
 使用方法：
 
@@ -334,6 +646,19 @@ PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
 - 2: 76×284 (縦向き反転)
 - 3: 284×76 (横向き、左回り)
 
+4. ハードウェアスクロール（長辺方向）：
+
+tft.enableHardwareScroll();
+scroll += 4;
+tft.setHardwareScroll(scroll);             // 画面全体が4ライン流れる
+tft.pushScrollStrip(&strip, tft.width() - 4);  // 新しく見える帯だけ転送
+tft.disableHardwareScroll();
+
+5. 回転角度の高速切り替え（再初期化なし）：
+
+tft.setRotationFast(3);                    // 横向きのまま上下反転（MADCTLと列・行アドレスだけ）
+renderer.pushCanvasToDisplayOpaque(0, 0);  // 同じキャンバスを転送し直す
+
 互換性：
 - 既存のperformCustomInitialization()はrotation=0で動作
 - initWithRotation()を使えば任意の回転角度で初期化可能
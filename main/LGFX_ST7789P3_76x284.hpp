@@ -8,6 +8,9 @@
 
 #include <M5Unified.h>
 #include <lgfx/v1/panel/Panel_ST7789.hpp>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
 
 // 76×284専用オフセット調整値（ランダムドット対策）
 constexpr int OFFSET_X = 82;  // X方向オフセット（左右調整）
@@ -21,6 +24,19 @@ constexpr int PIN_DC = 21;   // Data/Command
 constexpr int PIN_CS = 19;   // Chip Select
 constexpr int PIN_BLK = -1;  // Backlight - ハードウェア制御
 
+// SPI書き込みクロック（menuconfig「csboard-pico Display」で変更可能）
+#ifdef CONFIG_CSBOARD_LCD_SPI_FREQ_HZ
+constexpr uint32_t SPI_WRITE_FREQ_DEFAULT = CONFIG_CSBOARD_LCD_SPI_FREQ_HZ;
+#else
+constexpr uint32_t SPI_WRITE_FREQ_DEFAULT = 20000000;  // 20MHz
+#endif
+constexpr uint32_t SPI_APB_FREQ = 80000000;              // SPIクロックの分周元（APBクロック）
+constexpr uint32_t SPI_GPIO_MATRIX_MAX_FREQ = 40000000;  // GPIOマトリクス経由のピンでの書き込み上限
+
+// ハードウェアスクロール（パネル長辺方向）
+constexpr int PANEL_MEMORY_LINES = 320;  // ST7789のフレームメモリ行数
+constexpr int SCROLL_AREA_LINES = 284;   // スクロール領域の行数（パネル長辺）
+
 /**
  * ST7789P3 (76×284) 専用LGFXクラス（回転対応統合版）
  * 
@@ -33,10 +49,25 @@ constexpr int PIN_BLK = -1;  // Backlight - ハードウェア制御
  */
 class LGFX_ST7789P3_76x284 : public lgfx::LGFX_Device
 {
+public:
+    /**
+     * 転送フック（省電力管理など、画面の更新を知りたいモジュールが登録する）
+     * 描画タスクから呼ばれる
+     */
+    struct TransferHooks {
+        void (*beforeTransfer)();              // 転送・スクロールの直前（nullptr可）
+        void (*afterFrame)(size_t spiBytes);   // 1フレーム分の更新後（nullptr可、0=変化なし）
+    };
+
 private:
     lgfx::Panel_ST7789 _panel_instance;
     lgfx::Bus_SPI _bus_instance;
     int _current_rotation = 0;
+    bool _hw_scroll_enabled = false;  // ハードウェアスクロール有効フラグ
+    int _hw_scroll_offset = 0;        // 現在のスクロール量（0〜SCROLL_AREA_LINES-1）
+    bool _panel_idle = false;         // パネルのアイドルモード（8色表示）中フラグ
+    TransferHooks _transfer_hooks = {};  // 転送フック（未登録はnullptr）
+    SemaphoreHandle_t _transfer_lock = nullptr;  // 別タスクの転送中はパネルへのコマンドを待たせる
 
     // 回転角度別オフセット設定
     struct RotationConfig {
@@ -51,12 +82,56 @@ private:
     // 各回転角度の設定値
     static const RotationConfig rotation_configs[4];
 
+    static constexpr int PROBE_PATTERNS = 3;  // クロック探索のテストパターン数
+
+    /**
+     * テストパターンを順に全画面へ書き込み、読み出し可能なら照合する
+     * @param line 作業バッファ（幅×2要素）
+     * @param verify 読み出して照合するか
+     * @param elapsedUs 書き込みにかかった時間の合計（出力）
+     * @return 照合で不一致が無かった場合true
+     */
+    bool runProbePatterns(uint16_t* line, bool verify, int64_t& elapsedUs);
+
+    /**
+     * 回転角度に応じたMADCTL・CASET・RASETを書き込む（startWrite()中に呼ぶ）
+     * @param config 回転角度別の設定値
+     */
+    void writeRotationRegisters(const RotationConfig& config);
+
 public:
     /**
      * コンストラクタ
      * SPI設定とパネル設定を行う
+     * @param writeFreq SPI書き込みクロック（Hz）
+     */
+    LGFX_ST7789P3_76x284(uint32_t writeFreq = SPI_WRITE_FREQ_DEFAULT);
+
+    /**
+     * SPI書き込みクロックを変更
+     * バスを再初期化するので、startWrite()中やDMA転送中には呼ばないこと
+     * 実際のクロックはAPBクロック（80MHz）の分周で決まる
+     * @param freq SPI書き込みクロック（Hz）
+     */
+    void setWriteFrequency(uint32_t freq);
+
+    /**
+     * 現在のSPI書き込みクロックを取得
+     * @return SPI書き込みクロック（Hz）
      */
-    LGFX_ST7789P3_76x284(void);
+    uint32_t getWriteFrequency() const;
+
+    /**
+     * より速いSPIクロックを探して設定（起動時の自己診断）
+     * 現在のクロックから80MHzの整数分周を1段ずつ上げ、テストパターンを全画面に書き込む
+     * - パネルが読み出し可能（MISO接続）なら、読み出して一致しなければその前の段で止める
+     * - 読み出せない場合はGPIOマトリクスの上限で打ち切り、転送時間が10%以上短くならなければ止める
+     *   （スループットだけで選び、表示が崩れないかは確認しない）
+     * 終了後は画面を黒で塗りつぶす
+     * @param maxFreq 試す上限クロック（Hz）
+     * @return 設定したSPI書き込みクロック（Hz）
+     */
+    uint32_t probeWriteFrequency(uint32_t maxFreq = SPI_APB_FREQ);
 
     /**
      * ST7789P3 (76×284) 専用カスタム初期化
@@ -70,6 +145,23 @@ public:
      */
     void initWithRotation(int rotation);
 
+    /**
+     * 初期化済みのパネルの回転角度を高速に切り替え
+     * MADCTLと列・行アドレスだけを書き換え、電源・ガンマ設定と120msの安定化待ちは行わない
+     * フレームメモリの内容はそのまま残るので、切り替え後にキャンバスを転送し直すこと
+     * （同じ向き同士の0↔2・1↔3なら同じキャンバスを再描画せずに転送できる）
+     * DMA転送の完了を待ってから切り替える
+     * @param rotation 回転角度 (0=縦, 1=横右, 2=縦反転, 3=横左)
+     */
+    void setRotationFast(int rotation);
+
+    /**
+     * 指定の回転角度に切り替えても画面の幅・高さが変わらないか
+     * @param rotation 回転角度
+     * @return true=同じ大きさ（今のキャンバスをそのまま転送できる）
+     */
+    bool keepsFramebufferSize(int rotation) const { return ((rotation ^ _current_rotation) & 1) == 0; }
+
     /**
      * 回転対応カスタム初期化（内部使用）
      * @param rotation 回転角度
@@ -102,4 +194,105 @@ public:
      * 現在の回転角度名を取得
      */
     const char* getCurrentRotationName() const;
+
+    /**
+     * ハードウェアスクロール開始（VSCRDEF）
+     * パネル長辺の284ラインをスクロール領域に設定し、上下のオフセット分は固定領域にする
+     * 回転1/3では画面の横方向、回転0/2では縦方向にスクロールする
+     */
+    void enableHardwareScroll();
+
+    /**
+     * ハードウェアスクロール終了
+     * スクロール位置を戻し、スクロール領域をフレームメモリ全体に戻す
+     */
+    void disableHardwareScroll();
+
+    /**
+     * ハードウェアスクロール量を設定（VSCSAD）
+     * 画面上の位置pには、フレームメモリの (p + offset) % 284 の内容が表示される
+     * 回転2/3での向きの反転はここで吸収する
+     * スクロール量の変更は1フレーム分の画面更新として転送フックに通知する
+     * @param offset スクロール量（負の値・284以上も可）
+     */
+    void setHardwareScroll(int offset);
+
+    /**
+     * 現在のハードウェアスクロール量を取得
+     * @return スクロール量（0〜SCROLL_AREA_LINES-1）
+     */
+    int getHardwareScroll() const { return _hw_scroll_offset; }
+
+    /**
+     * ハードウェアスクロール中かどうか
+     * @return true=有効
+     */
+    bool isHardwareScrollEnabled() const { return _hw_scroll_enabled; }
+
+    /**
+     * スクロール方向が画面の横方向かどうか
+     * @return true=横（回転1/3）, false=縦（回転0/2）
+     */
+    bool isScrollAxisHorizontal() const { return (_current_rotation & 1) != 0; }
+
+    /**
+     * 画面上の位置を書き込み先のフレームメモリ位置に変換
+     * @param screenPos スクロール方向の画面上の位置
+     * @return 書き込み先の座標（スクロール方向）
+     */
+    int scrollScreenToMemory(int screenPos) const;
+
+    /**
+     * スクロール方向に細長いスプライトを画面上の位置に合わせて転送
+     * フレームメモリの端をまたぐ場合は2回に分けて書き込む
+     * スクロールで新しく見える帯だけを描き足す用途
+     * （1フレームとしての記録は対になる setHardwareScroll() で行う）
+     * @param strip 転送するスプライト（スクロールと直交する方向は画面全体の長さ）
+     * @param screenPos スクロール方向の画面上の位置
+     */
+    void pushScrollStrip(lgfx::LGFX_Sprite* strip, int screenPos);
+
+    /**
+     * 転送フックを登録（登録済みのものは置き換える）
+     * @param hooks フック
+     */
+    void setTransferHooks(const TransferHooks& hooks) { _transfer_hooks = hooks; }
+
+    /**
+     * 転送の直前に呼ぶ（フレームを送る全ての経路から呼ぶこと）
+     */
+    void notifyTransferBegin() { if (_transfer_hooks.beforeTransfer) _transfer_hooks.beforeTransfer(); }
+
+    /**
+     * 1フレーム分の転送が終わったら呼ぶ（フレームを送る全ての経路から呼ぶこと）
+     * @param spiBytes 転送したバイト数（0=画面に変化なし）
+     */
+    void notifyFrameSent(size_t spiBytes) { if (_transfer_hooks.afterFrame) _transfer_hooks.afterFrame(spiBytes); }
+
+    /**
+     * 別タスクでの転送を開始（転送タスクが転送の直前に呼ぶ）
+     * endBackgroundTransfer() までの間、setPanelIdleMode() は転送の完了を待つ
+     * notifyFrameSent() は転送の受け渡し時に呼ばれるため、完了の目印には使えない
+     */
+    void beginBackgroundTransfer() { if (_transfer_lock) xSemaphoreTake(_transfer_lock, portMAX_DELAY); }
+
+    /**
+     * 別タスクでの転送を終了（DMA転送の完了後に呼ぶ）
+     */
+    void endBackgroundTransfer() { if (_transfer_lock) xSemaphoreGive(_transfer_lock); }
+
+    /**
+     * パネルのアイドルモードを切り替え（IDMON/IDMOFF）
+     * アイドルモードでは各色1bitの8色表示になり、パネルの消費電流が減る
+     * フレームメモリの内容は変わらないので、解除すれば元の色で表示される
+     * 別タスクで転送中（beginBackgroundTransfer()〜endBackgroundTransfer()）なら完了を待ってから送る
+     * @param enable true=アイドルモード
+     */
+    void setPanelIdleMode(bool enable);
+
+    /**
+     * パネルがアイドルモード中かどうか
+     * @return true=アイドルモード（8色表示）
+     */
+    bool isPanelIdleMode() const { return _panel_idle; }
 };
@@ -0,0 +1,241 @@
+/*
+ * RetroAssetPack.cpp
+ * フラッシュパーティション上のアセットパック実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroAssetPack.hpp"
+#include "esp_log.h"
+
+// ログタグ定義
+static const char *TAG = "RetroAssetPack";
+
+static_assert(sizeof(RetroAssetPack::Header) == 16, "Header layout must match asset_packer.py");
+static_assert(sizeof(RetroAssetPack::Entry) == 44, "Entry layout must match asset_packer.py");
+
+RetroAssetPack::RetroAssetPack()
+    : base(nullptr), mappedSize(0), mmapHandle(0), mapped(false),
+      header(nullptr), hashTable(nullptr), entries(nullptr) {
+}
+
+RetroAssetPack::~RetroAssetPack() {
+    close();
+}
+
+uint32_t RetroAssetPack::hashName(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const char* p = name; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash;
+}
+
+bool RetroAssetPack::open(const char* partitionLabel) {
+    close();
+
+    const esp_partition_t* partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partitionLabel);
+    if (!partition) {
+        ESP_LOGE(TAG, "Partition not found: %s", partitionLabel);
+        return false;
+    }
+
+    // 先にヘッダーだけをマップしてパックの大きさを読む（MMUのページをパーティション全体分使わないため）
+    const void* ptr = nullptr;
+    esp_err_t err = esp_partition_mmap(partition, 0, sizeof(Header), ESP_PARTITION_MMAP_DATA, &ptr, &mmapHandle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map partition %s: %s", partitionLabel, esp_err_to_name(err));
+        return false;
+    }
+    const uint32_t magic = ((const Header*)ptr)->magic;
+    const size_t packSize = ((const Header*)ptr)->totalSize;
+    esp_partition_munmap(mmapHandle);
+
+    if (magic != MAGIC) {
+        ESP_LOGE(TAG, "Invalid asset pack magic: 0x%08lx", (unsigned long)magic);
+        return false;
+    }
+    if (packSize < sizeof(Header) || packSize > partition->size) {
+        ESP_LOGE(TAG, "Asset pack size out of range: %zu bytes (partition %lu bytes)",
+                 packSize, (unsigned long)partition->size);
+        return false;
+    }
+
+    // パックの範囲だけをマップし直す
+    err = esp_partition_mmap(partition, 0, packSize, ESP_PARTITION_MMAP_DATA, &ptr, &mmapHandle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map asset pack (%zu bytes): %s", packSize, esp_err_to_name(err));
+        return false;
+    }
+
+    base = (const uint8_t*)ptr;
+    mappedSize = packSize;
+    mapped = true;
+
+    if (!validate()) {
+        close();
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Asset pack opened: %s, %d entries, %lu bytes (partition %lu bytes)",
+             partitionLabel, header->entryCount, (unsigned long)header->totalSize, (unsigned long)partition->size);
+    return true;
+}
+
+bool RetroAssetPack::openMemory(const uint8_t* data, size_t size) {
+    close();
+    if (!data || ((uintptr_t)data & 3)) {
+        ESP_LOGE(TAG, "Asset pack data must be 4-byte aligned");
+        return false;
+    }
+
+    base = data;
+    mappedSize = size;
+    if (!validate()) {
+        close();
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Asset pack opened from memory: %d entries, %lu bytes",
+             header->entryCount, (unsigned long)header->totalSize);
+    return true;
+}
+
+void RetroAssetPack::close() {
+    if (mapped) {
+        esp_partition_munmap(mmapHandle);
+        mapped = false;
+    }
+    base = nullptr;
+    mappedSize = 0;
+    header = nullptr;
+    hashTable = nullptr;
+    entries = nullptr;
+}
+
+bool RetroAssetPack::validate() {
+    if (mappedSize < sizeof(Header)) return false;
+
+    const Header* h = (const Header*)base;
+    if (h->magic != MAGIC) {
+        ESP_LOGE(TAG, "Invalid asset pack magic: 0x%08lx", (unsigned long)h->magic);
+        return false;
+    }
+    if (h->version != VERSION) {
+        ESP_LOGE(TAG, "Unsupported asset pack version: %d", h->version);
+        return false;
+    }
+    if (h->totalSize > mappedSize) {
+        ESP_LOGE(TAG, "Asset pack truncated: %lu > %zu bytes", (unsigned long)h->totalSize, mappedSize);
+        return false;
+    }
+    if (h->hashSize == 0 || (h->hashSize & (h->hashSize - 1)) || h->hashSize < h->entryCount) {
+        ESP_LOGE(TAG, "Invalid hash table size: %d", h->hashSize);
+        return false;
+    }
+
+    const size_t hashOffset = sizeof(Header);
+    const size_t entryOffset = (hashOffset + h->hashSize * sizeof(uint16_t) + 3) & ~(size_t)3;
+    if (entryOffset + (size_t)h->entryCount * sizeof(Entry) > h->totalSize) {
+        ESP_LOGE(TAG, "Asset pack index out of range");
+        return false;
+    }
+
+    const Entry* e = (const Entry*)(base + entryOffset);
+    for (int i = 0; i < h->entryCount; i++) {
+        const Entry& entry = e[i];
+
+        // 取り出し時に検査しなくて済むよう、開く時点で全エントリの範囲を確認しておく
+        bool ok = entry.name[NAME_LENGTH - 1] == '\0' &&
+                  (entry.offset & 3) == 0 &&
+                  entry.offset <= h->totalSize && entry.size <= h->totalSize - entry.offset;
+        if (ok && entry.type == TYPE_PALETTE) {
+            ok = entry.size >= RetroColorPalette::MAX_COLORS * sizeof(uint16_t);
+        } else if (ok && (entry.type == TYPE_IMAGE || entry.type == TYPE_SEQUENCE)) {
+            const size_t frameBytes = ((size_t)entry.width * entry.height + 1) / 2;
+            ok = entry.frameCount > 0 && entry.size >= frameBytes * entry.frameCount &&
+                 (entry.palette == NO_PALETTE ||
+                  (entry.palette < h->entryCount && e[entry.palette].type == TYPE_PALETTE));
+        }
+        if (!ok) {
+            ESP_LOGE(TAG, "Invalid asset entry %d (%.*s)", i, NAME_LENGTH, entry.name);
+            return false;
+        }
+    }
+
+    header = h;
+    hashTable = (const uint16_t*)(base + hashOffset);
+    entries = e;
+    return true;
+}
+
+bool RetroAssetPack::isOpen() const {
+    return header != nullptr;
+}
+
+int RetroAssetPack::getEntryCount() const {
+    return header ? header->entryCount : 0;
+}
+
+const RetroAssetPack::Entry* RetroAssetPack::getEntry(int index) const {
+    if (!header || index < 0 || index >= header->entryCount) return nullptr;
+    return &entries[index];
+}
+
+int RetroAssetPack::find(const char* name) const {
+    if (!header || !name) return -1;
+
+    const uint32_t mask = header->hashSize - 1;
+    uint32_t slot = hashName(name) & mask;
+    for (uint32_t probe = 0; probe <= mask; probe++) {
+        const uint16_t value = hashTable[slot];
+        if (value == 0) return -1;  // 空きスロットに当たれば登録されていない
+
+        const int index = value - 1;
+        if (index < header->entryCount && strncmp(entries[index].name, name, NAME_LENGTH) == 0) {
+            return index;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+bool RetroAssetPack::getPalette(int index, RetroColorPalette& out) const {
+    const Entry* e = getEntry(index);
+    if (!e || e->type != TYPE_PALETTE) return false;
+
+    memcpy(out.colors, base + e->offset, sizeof(out.colors));
+    out.invalidateLut();
+    return true;
+}
+
+bool RetroAssetPack::getImage(int index, PaletteImageData& out, int frame) const {
+    const Entry* e = getEntry(index);
+    if (!e || (e->type != TYPE_IMAGE && e->type != TYPE_SEQUENCE)) return false;
+    if (frame < 0 || frame >= e->frameCount) return false;
+
+    const size_t frameBytes = ((size_t)e->width * e->height + 1) / 2;
+    out.data = base + e->offset + frameBytes * frame;
+    out.width = e->width;
+    out.height = e->height;
+    out.dataSize = frameBytes;
+
+    // パレットが同じなら変換テーブルを作り直さない
+    RetroColorPalette palette;
+    if (e->palette != NO_PALETTE) {
+        memcpy(palette.colors, base + entries[e->palette].offset, sizeof(palette.colors));
+    }
+    if (memcmp(out.palette.colors, palette.colors, sizeof(palette.colors)) != 0) {
+        memcpy(out.palette.colors, palette.colors, sizeof(palette.colors));
+        out.palette.invalidateLut();
+    }
+    return true;
+}
+
+bool RetroAssetPack::getImage(const char* name, PaletteImageData& out, int frame) const {
+    return getImage(find(name), out, frame);
+}
+
+size_t RetroAssetPack::getSize() const {
+    return header ? header->totalSize : 0;
+}
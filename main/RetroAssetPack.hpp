@@ -0,0 +1,179 @@
+/*
+ * RetroAssetPack.hpp
+ * フラッシュパーティション上のアセットパック for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 画像・パレット・フレーム列を1つのバイナリ（append/asset_packer.py で生成）にまとめる
+ * - データパーティションを esp_partition_mmap でマップし、画素データはコピーせずに直接描画
+ * - 名前のハッシュ表で O(1) 検索
+ * - アセットを差し替えてもファームウェアの再ビルドは不要（パーティションだけ書き込む）
+ *
+ * バイナリ形式（リトルエンディアン、各データは4バイト境界）:
+ *   Header     16バイト
+ *   uint16_t   hashTable[hashSize]   エントリ番号+1（0=空き）、線形探索
+ *   Entry      entries[entryCount]   （4バイト境界から）
+ *   データ本体
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+#include "esp_partition.h"
+
+/**
+ * アセットパック
+ * open() したパックから取り出した PaletteImageData はマップ済み領域を直接指すので、
+ * close() した後は使わないこと
+ */
+class RetroAssetPack {
+public:
+    static constexpr uint32_t MAGIC = 0x4B415052;     // "RPAK"
+    static constexpr uint16_t VERSION = 1;            // 形式バージョン
+    static constexpr int NAME_LENGTH = 24;            // 名前の最大長（終端NUL込み）
+    static constexpr uint16_t NO_PALETTE = 0xFFFF;    // パレットなし（デフォルトパレット）
+
+    // エントリの種類
+    static constexpr uint8_t TYPE_PALETTE = 1;   // パレット（RGB565×16）
+    static constexpr uint8_t TYPE_IMAGE = 2;     // 4bit画像（1フレーム）
+    static constexpr uint8_t TYPE_SEQUENCE = 3;  // 同じサイズの4bit画像のフレーム列
+
+    /**
+     * パックヘッダ
+     */
+    struct Header {
+        uint32_t magic;                // MAGIC
+        uint16_t version;              // VERSION
+        uint16_t entryCount;           // エントリ数
+        uint16_t hashSize;             // ハッシュ表の要素数（2のべき乗）
+        uint16_t reserved;
+        uint32_t totalSize;            // パック全体のバイト数
+    };
+
+    /**
+     * エントリ（索引）
+     */
+    struct Entry {
+        char name[NAME_LENGTH];        // 名前（NUL終端）
+        uint32_t offset;               // データのパック先頭からの位置
+        uint32_t size;                 // データのバイト数
+        uint16_t width, height;        // 画像サイズ（画像・フレーム列）
+        uint16_t frameCount;           // フレーム数（画像は1）
+        uint16_t frameMs;              // 1フレームの表示時間（フレーム列）
+        uint16_t palette;              // 使用するパレットのエントリ番号（NO_PALETTE=デフォルト）
+        uint8_t type;                  // エントリの種類
+        uint8_t reserved;
+    };
+
+private:
+    const uint8_t* base;               // パック先頭（マップ済み領域）
+    size_t mappedSize;                 // マップしたバイト数
+    esp_partition_mmap_handle_t mmapHandle;  // パーティションのマップハンドル
+    bool mapped;                       // esp_partition_mmap でマップしたか
+    const Header* header;              // ヘッダ
+    const uint16_t* hashTable;         // ハッシュ表
+    const Entry* entries;              // エントリ一覧
+
+    /**
+     * 名前のハッシュ値（FNV-1a、asset_packer.py と一致させること）
+     * @param name 名前
+     * @return ハッシュ値
+     */
+    static uint32_t hashName(const char* name);
+
+    /**
+     * ヘッダと全エントリの範囲を検証してポインタを設定
+     * @return 正しいパックの場合true
+     */
+    bool validate();
+
+public:
+    /**
+     * コンストラクタ
+     */
+    RetroAssetPack();
+
+    /**
+     * デストラクタ（マップを解除）
+     */
+    ~RetroAssetPack();
+
+    /**
+     * データパーティションをマップしてパックを開く（マップするのはヘッダーの totalSize 分だけ）
+     * @param partitionLabel パーティション名（partitions.csv）
+     * @return 開けた場合true
+     */
+    bool open(const char* partitionLabel = "assets");
+
+    /**
+     * メモリ上のパックを開く（アプリに埋め込んだパック用、コピーしない）
+     * @param data パックの先頭（4バイト境界）
+     * @param size パックのバイト数
+     * @return 開けた場合true
+     */
+    bool openMemory(const uint8_t* data, size_t size);
+
+    /**
+     * パックを閉じる（パーティションのマップを解除）
+     */
+    void close();
+
+    /**
+     * パックを開いているかどうか
+     * @return true=開いている
+     */
+    bool isOpen() const;
+
+    /**
+     * エントリ数を取得
+     * @return エントリ数
+     */
+    int getEntryCount() const;
+
+    /**
+     * エントリを取得
+     * @param index エントリ番号
+     * @return エントリ（範囲外はnullptr）
+     */
+    const Entry* getEntry(int index) const;
+
+    /**
+     * 名前でエントリを検索
+     * @param name 名前
+     * @return エントリ番号（見つからない場合-1）
+     */
+    int find(const char* name) const;
+
+    /**
+     * パレットを取得
+     * @param index パレットのエントリ番号
+     * @param out 出力先
+     * @return 取得できた場合true
+     */
+    bool getPalette(int index, RetroColorPalette& out) const;
+
+    /**
+     * 画像（フレーム列の1フレーム）を取得
+     * 画素データはパックを直接指し、パレットは色が変わった場合だけ差し替える
+     * （同じ出力先でフレームを切り替えても変換テーブルは再構築されない）
+     * @param index 画像・フレーム列のエントリ番号
+     * @param out 出力先（例: PaletteImageData img(nullptr, 0, 0);）
+     * @param frame フレーム番号（画像は0）
+     * @return 取得できた場合true
+     */
+    bool getImage(int index, PaletteImageData& out, int frame = 0) const;
+
+    /**
+     * 名前で画像を取得
+     * @param name 名前
+     * @param out 出力先
+     * @param frame フレーム番号
+     * @return 取得できた場合true
+     */
+    bool getImage(const char* name, PaletteImageData& out, int frame = 0) const;
+
+    /**
+     * パック全体のバイト数を取得
+     * @return バイト数（開いていない場合0）
+     */
+    size_t getSize() const;
+};
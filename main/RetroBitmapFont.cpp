@@ -0,0 +1,263 @@
+/*
+ * RetroBitmapFont.cpp
+ * レトロゲーム風ビットマップフォント実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroBitmapFont.hpp"
+#include "RetroRenderPool.hpp"
+#include "esp_log.h"
+#include <stdarg.h>
+
+// ログタグ定義
+static const char *TAG = "RetroBitmapFont";
+
+// 組み込みフォントのセルサイズと文字範囲
+static constexpr int DEFAULT_CELL_WIDTH = 6;    // 5ドット + 字間1ドット
+static constexpr int DEFAULT_CELL_HEIGHT = 8;   // 7ドット + 下がり1ドット
+static constexpr char DEFAULT_FIRST_CHAR = 0x20;
+static constexpr int DEFAULT_GLYPH_COUNT = 0x7F - 0x20;
+
+/**
+ * 組み込み5x7フォント（ASCII 0x20-0x7E）
+ * 1文字5バイト、1バイトが1列（bit0が最上段）
+ */
+static const uint8_t DEFAULT_FONT_5X7[DEFAULT_GLYPH_COUNT][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},  //   ! "
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},  // # $ %
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x08, 0x07, 0x03, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},  // & ' (
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x2A, 0x1C, 0x7F, 0x1C, 0x2A}, {0x08, 0x08, 0x3E, 0x08, 0x08},  // ) * +
+    {0x00, 0x80, 0x70, 0x30, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x00, 0x60, 0x60, 0x00},  // , - .
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},  // / 0 1
+    {0x72, 0x49, 0x49, 0x49, 0x46}, {0x21, 0x41, 0x49, 0x4D, 0x33}, {0x18, 0x14, 0x12, 0x7F, 0x10},  // 2 3 4
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x31}, {0x41, 0x21, 0x11, 0x09, 0x07},  // 5 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x46, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x00, 0x14, 0x00, 0x00},  // 8 9 :
+    {0x00, 0x40, 0x34, 0x00, 0x00}, {0x00, 0x08, 0x14, 0x22, 0x41}, {0x14, 0x14, 0x14, 0x14, 0x14},  // ; < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x59, 0x09, 0x06}, {0x3E, 0x41, 0x5D, 0x59, 0x4E},  // > ? @
+    {0x7C, 0x12, 0x11, 0x12, 0x7C}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},  // A B C
+    {0x7F, 0x41, 0x41, 0x41, 0x3E}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},  // D E F
+    {0x3E, 0x41, 0x41, 0x51, 0x73}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},  // G H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},  // J K L
+    {0x7F, 0x02, 0x1C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},  // M N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},  // P Q R
+    {0x26, 0x49, 0x49, 0x49, 0x32}, {0x03, 0x01, 0x7F, 0x01, 0x03}, {0x3F, 0x40, 0x40, 0x40, 0x3F},  // S T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},  // V W X
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x59, 0x49, 0x4D, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x41},  // Y Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x41, 0x7F}, {0x04, 0x02, 0x01, 0x02, 0x04},  // \ ] ^
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x03, 0x07, 0x08, 0x00}, {0x20, 0x54, 0x54, 0x78, 0x40},  // _ ` a
+    {0x7F, 0x28, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x28}, {0x38, 0x44, 0x44, 0x28, 0x7F},  // b c d
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x00, 0x08, 0x7E, 0x09, 0x02}, {0x18, 0xA4, 0xA4, 0x9C, 0x78},  // e f g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x40, 0x3D, 0x00},  // h i j
+    {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x78, 0x04, 0x78},  // k l m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0xFC, 0x18, 0x24, 0x24, 0x18},  // n o p
+    {0x18, 0x24, 0x24, 0x18, 0xFC}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x24},  // q r s
+    {0x04, 0x04, 0x3F, 0x44, 0x24}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},  // t u v
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x4C, 0x90, 0x90, 0x90, 0x7C},  // w x y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x77, 0x00, 0x00},  // z { |
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x02, 0x01, 0x02, 0x04, 0x02},                                  // } ~
+};
+
+// ===== RetroBitmapFont 実装 =====
+
+RetroBitmapFont::RetroBitmapFont(const uint8_t* atlasData, int width, int height, char first, int count,
+                                 const RetroColorPalette* customPalette)
+    : atlas(atlasData, width, height * count, customPalette),
+      cellWidth(width), cellHeight(height), firstChar(first), glyphCount(count) {
+    if (width & 1) {
+        ESP_LOGE(TAG, "Cell width must be even: %d", width);
+    }
+    ESP_LOGI(TAG, "RetroBitmapFont created: %d glyphs, %dx%d cell", glyphCount, cellWidth, cellHeight);
+}
+
+RetroBitmapFont& RetroBitmapFont::getDefault() {
+    static uint8_t* atlasData = nullptr;
+    static RetroBitmapFont* font = nullptr;
+    if (font) return *font;
+
+    // 1bitの列データを4bitの行データ（偶数ピクセルが下位4bit）に展開
+    const int rowBytes = DEFAULT_CELL_WIDTH / 2;
+    const size_t glyphBytes = rowBytes * DEFAULT_CELL_HEIGHT;
+    atlasData = (uint8_t*)calloc(DEFAULT_GLYPH_COUNT, glyphBytes);
+    if (atlasData) {
+        for (int g = 0; g < DEFAULT_GLYPH_COUNT; g++) {
+            uint8_t* glyph = atlasData + g * glyphBytes;
+            for (int col = 0; col < 5; col++) {
+                const uint8_t bits = DEFAULT_FONT_5X7[g][col];
+                for (int row = 0; row < DEFAULT_CELL_HEIGHT; row++) {
+                    if (bits & (1 << row)) {
+                        glyph[row * rowBytes + col / 2] |= INK_INDEX << ((col & 1) * 4);
+                    }
+                }
+            }
+        }
+    } else {
+        ESP_LOGE(TAG, "Failed to allocate default font atlas");
+    }
+
+    RetroColorPalette palette;
+    palette.setColor(RetroColorPalette::TRANSPARENT_INDEX, 0x0000);
+    palette.setColor(INK_INDEX, 0xFFFF);
+    font = new RetroBitmapFont(atlasData, DEFAULT_CELL_WIDTH, atlasData ? DEFAULT_CELL_HEIGHT : 0,
+                               DEFAULT_FIRST_CHAR, atlasData ? DEFAULT_GLYPH_COUNT : 0, &palette);
+    return *font;
+}
+
+int RetroBitmapFont::getGlyphIndex(char ch) const {
+    int glyph = (uint8_t)ch - (uint8_t)firstChar;
+    if (glyph >= 0 && glyph < glyphCount) return glyph;
+
+    glyph = '?' - (uint8_t)firstChar;
+    return (glyph >= 0 && glyph < glyphCount) ? glyph : -1;
+}
+
+const uint8_t* RetroBitmapFont::getGlyphRow(int glyph, int row) const {
+    return atlas.data + ((glyph * cellHeight + row) * cellWidth) / 2;
+}
+
+int RetroBitmapFont::getTextWidth(const char* text) const {
+    int widest = 0, chars = 0;
+    for (const char* p = text; *p; p++) {
+        if (*p == '\n') {
+            widest = max(widest, chars);
+            chars = 0;
+        } else {
+            chars++;
+        }
+    }
+    return max(widest, chars) * cellWidth;
+}
+
+int RetroBitmapFont::drawText(PaletteImageRenderer& renderer, int x, int y, const char* text, uint16_t color) {
+    if (!text || !atlas.data) return 0;
+
+    // 変化が無ければ変換テーブルは作り直されない
+    atlas.palette.setColor(INK_INDEX, color);
+
+    int penX = x, penY = y, widest = 0;
+    for (const char* p = text; *p; p++) {
+        if (*p == '\n') {
+            widest = max(widest, penX - x);
+            penX = x;
+            penY += cellHeight;
+            continue;
+        }
+        const int glyph = getGlyphIndex(*p);
+        if (glyph >= 0 && *p != ' ') {
+            renderer.drawRegionToCanvas(atlas, 0, glyph * cellHeight, cellWidth, cellHeight, penX, penY, true);
+        }
+        penX += cellWidth;
+    }
+    return max(widest, penX - x);
+}
+
+// ===== RetroTextRun 実装 =====
+
+RetroTextRun::RetroTextRun(RetroBitmapFont* textFont, int maxLength)
+    : font(textFont), maxChars(max(1, maxLength)), text(nullptr), formatBuffer(nullptr), pixels(nullptr),
+      image(nullptr, 0, 0), opaque(false), changed(true), rasterizeCount(0) {
+    text = new char[maxChars + 1];
+    text[0] = '\0';
+    formatBuffer = new char[maxChars + 1];
+    pixels = (uint8_t*)RetroRenderPool::acquireBuffer(maxChars * font->cellWidth * font->cellHeight / 2);
+    if (!pixels) {
+        ESP_LOGE(TAG, "Failed to allocate text run: %d chars", maxChars);
+    }
+    image.data = pixels;
+    image.height = font->cellHeight;
+    setColors(0xFFFF);
+}
+
+RetroTextRun::~RetroTextRun() {
+    RetroRenderPool::releaseBuffer(pixels);
+    delete[] formatBuffer;
+    delete[] text;
+}
+
+void RetroTextRun::setColors(uint16_t fgColor) {
+    if (opaque || image.palette.colors[RetroBitmapFont::INK_INDEX] != fgColor) changed = true;
+    opaque = false;
+    image.palette.setColor(RetroBitmapFont::INK_INDEX, fgColor);
+}
+
+void RetroTextRun::setColors(uint16_t fgColor, uint16_t bgColor) {
+    if (!opaque || image.palette.colors[RetroBitmapFont::INK_INDEX] != fgColor ||
+        image.palette.colors[RetroColorPalette::TRANSPARENT_INDEX] != bgColor) {
+        changed = true;
+    }
+    opaque = true;
+    image.palette.setColor(RetroBitmapFont::INK_INDEX, fgColor);
+    image.palette.setColor(RetroColorPalette::TRANSPARENT_INDEX, bgColor);
+}
+
+void RetroTextRun::rasterize() {
+    const int length = strlen(text);
+    const int glyphRowBytes = font->cellWidth / 2;
+    const int rowBytes = length * glyphRowBytes;
+
+    // 文字ごとのグリフ行を横に並べる（セル幅が偶数なのでバイト単位のコピーで済む）
+    for (int row = 0; row < font->cellHeight; row++) {
+        uint8_t* dst = pixels + row * rowBytes;
+        for (int i = 0; i < length; i++) {
+            const int glyph = font->getGlyphIndex(text[i]);
+            if (glyph >= 0) {
+                memcpy(dst + i * glyphRowBytes, font->getGlyphRow(glyph, row), glyphRowBytes);
+            } else {
+                memset(dst + i * glyphRowBytes, 0, glyphRowBytes);
+            }
+        }
+    }
+
+    image.width = length * font->cellWidth;
+    image.dataSize = rowBytes * font->cellHeight;
+    rasterizeCount++;
+}
+
+bool RetroTextRun::setText(const char* newText) {
+    if (!pixels || !newText) return false;
+    if (strncmp(text, newText, maxChars) == 0) return false;  // 切り捨て後が同じなら変化なし
+
+    strncpy(text, newText, maxChars);
+    text[maxChars] = '\0';
+    rasterize();
+    changed = true;
+    return true;
+}
+
+bool RetroTextRun::setTextf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(formatBuffer, maxChars + 1, format, args);
+    va_end(args);
+    return setText(formatBuffer);
+}
+
+void RetroTextRun::draw(PaletteImageRenderer& renderer, int x, int y) {
+    if (image.width > 0) {
+        renderer.drawToCanvas(image, x, y, !opaque);
+    }
+    changed = false;
+}
+
+bool RetroTextRun::isChanged() const {
+    return changed;
+}
+
+const char* RetroTextRun::getText() const {
+    return text;
+}
+
+int RetroTextRun::getWidth() const {
+    return image.width;
+}
+
+int RetroTextRun::getHeight() const {
+    return image.height;
+}
+
+const PaletteImageData& RetroTextRun::getImage() const {
+    return image;
+}
+
+uint32_t RetroTextRun::getRasterizeCount() const {
+    return rasterizeCount;
+}
@@ -0,0 +1,193 @@
+/*
+ * RetroBitmapFont.hpp
+ * レトロゲーム風ビットマップフォント for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - グリフを PaletteImageData と同じ4bitニブル配置で事前展開したアトラス（インデックス1=文字色、0=透明）
+ * - グリフはタイルセットと同じく縦に並べて保持（グリフiは data + i * cellWidth * cellHeight / 2 から）
+ * - 文字描画は drawRegionToCanvas を使い、スパン変換・透明処理のカーネルをそのまま再利用
+ * - RetroTextRun は文字列が変わった時だけ再ラスタライズし、普段は1枚の画像として描画
+ * - 組み込みの5x7フォント（6x8セル、ASCII 0x20-0x7E）
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * ビットマップフォント
+ * 等幅セル（幅は偶数、1行がバイト境界に揃う）のグリフアトラス
+ */
+struct RetroBitmapFont {
+    static constexpr uint8_t INK_INDEX = 1;  // グリフの文字色インデックス
+
+    PaletteImageData atlas;        // グリフを縦に並べた画像（幅cellWidth、高さcellHeight*glyphCount）
+    int cellWidth, cellHeight;     // セルサイズ（文字送り・行送り）
+    char firstChar;                // アトラス先頭の文字
+    int glyphCount;                // グリフ数
+
+    /**
+     * コンストラクタ
+     * @param atlasData グリフアトラスのデータ配列（4bit/pixel、グリフを縦に並べたもの）
+     * @param width セル幅（偶数）
+     * @param height セル高さ
+     * @param first アトラス先頭の文字
+     * @param count グリフ数
+     * @param customPalette カスタムパレット（nullptr = デフォルト）
+     */
+    RetroBitmapFont(const uint8_t* atlasData, int width, int height, char first, int count,
+                    const RetroColorPalette* customPalette = nullptr);
+
+    /**
+     * 組み込みの5x7フォントを取得
+     * 初回呼び出し時に1bitデータから4bitアトラスへ展開する（以降は展開済みを返す）
+     * @return フォント
+     */
+    static RetroBitmapFont& getDefault();
+
+    /**
+     * 文字のグリフ番号を取得
+     * @param ch 文字
+     * @return グリフ番号（アトラスに無い文字は'?'、それも無ければ-1）
+     */
+    int getGlyphIndex(char ch) const;
+
+    /**
+     * グリフ1行分のデータを取得
+     * @param glyph グリフ番号
+     * @param row 行（0〜cellHeight-1）
+     * @return cellWidth/2 バイトの行データ
+     */
+    const uint8_t* getGlyphRow(int glyph, int row) const;
+
+    /**
+     * 文字列の描画幅を計算（改行を含む場合は最も長い行）
+     * @param text 文字列
+     * @return 幅（ピクセル）
+     */
+    int getTextWidth(const char* text) const;
+
+    /**
+     * 文字列をキャンバスに描画（透明背景）
+     * 1文字ずつ drawRegionToCanvas で描画する（毎回描き直す動的テキスト用）
+     * @param renderer 描画先レンダラー
+     * @param x 左上X座標
+     * @param y 左上Y座標
+     * @param text 文字列（'\n'で改行）
+     * @param color 文字色（RGB565）
+     * @return 描画した最も長い行の幅（ピクセル）
+     */
+    int drawText(PaletteImageRenderer& renderer, int x, int y, const char* text, uint16_t color);
+};
+
+/**
+ * キャッシュ付きテキスト
+ * 文字列を1枚のパレット画像にラスタライズして保持し、文字列が変わった時だけ作り直す
+ * スコアやステータス表示など、毎フレーム描くが中身はたまにしか変わらないHUD用
+ */
+class RetroTextRun {
+private:
+    RetroBitmapFont* font;             // フォント
+    int maxChars;                      // 最大文字数
+    char* text;                        // 現在の文字列（maxChars+1バイト）
+    char* formatBuffer;                // setTextf の書式展開先（maxChars+1バイト）
+    uint8_t* pixels;                   // ラスタライズ済み画像（プールから借りる）
+    PaletteImageData image;            // pixels を指す画像（幅は現在の文字数分）
+    bool opaque;                       // 背景色で塗るか（false=透明背景）
+    bool changed;                      // 前回の描画以降に内容が変わったか
+    uint32_t rasterizeCount;           // 再ラスタライズした回数
+
+    /**
+     * 現在の文字列を画像に展開
+     */
+    void rasterize();
+
+public:
+    /**
+     * コンストラクタ（白文字・透明背景）
+     * @param textFont フォント
+     * @param maxLength 最大文字数（これを超える文字は切り捨て）
+     */
+    RetroTextRun(RetroBitmapFont* textFont, int maxLength);
+
+    /**
+     * デストラクタ
+     */
+    ~RetroTextRun();
+
+    // バッファを所有するためコピー禁止
+    RetroTextRun(const RetroTextRun&) = delete;
+    RetroTextRun& operator=(const RetroTextRun&) = delete;
+
+    /**
+     * 文字色を設定（透明背景）
+     * @param fgColor 文字色（RGB565）
+     */
+    void setColors(uint16_t fgColor);
+
+    /**
+     * 文字色と背景色を設定（背景を塗る）
+     * @param fgColor 文字色（RGB565）
+     * @param bgColor 背景色（RGB565）
+     */
+    void setColors(uint16_t fgColor, uint16_t bgColor);
+
+    /**
+     * 文字列を設定（前回と同じなら何もしない）
+     * @param newText 文字列（改行は非対応）
+     * @return 内容が変わった場合true
+     */
+    bool setText(const char* newText);
+
+    /**
+     * 書式付きで文字列を設定（前回と同じなら何もしない、最大文字数で切り捨て）
+     * @param format printf形式の書式
+     * @return 内容が変わった場合true
+     */
+    bool setTextf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * キャンバスに描画
+     * @param renderer 描画先レンダラー
+     * @param x 左上X座標
+     * @param y 左上Y座標
+     */
+    void draw(PaletteImageRenderer& renderer, int x, int y);
+
+    /**
+     * 前回の描画以降に内容（文字列・色）が変わったか
+     * @return true=描き直しが必要
+     */
+    bool isChanged() const;
+
+    /**
+     * 現在の文字列を取得
+     * @return 文字列
+     */
+    const char* getText() const;
+
+    /**
+     * 描画幅を取得
+     * @return 幅（ピクセル、現在の文字数 x セル幅）
+     */
+    int getWidth() const;
+
+    /**
+     * 描画高さを取得
+     * @return 高さ（ピクセル）
+     */
+    int getHeight() const;
+
+    /**
+     * ラスタライズ済み画像を取得（レイヤー合成などで直接描く場合）
+     * 文字列を変えると幅が変わるため、参照は保持したまま毎回サイズを読むこと
+     * @return 画像（背景を塗らない設定ではインデックス0が透明）
+     */
+    const PaletteImageData& getImage() const;
+
+    /**
+     * 再ラスタライズした回数を取得
+     * @return 回数
+     */
+    uint32_t getRasterizeCount() const;
+};
@@ -0,0 +1,152 @@
+/*
+ * RetroCollisionMask.cpp
+ * ピクセル単位の当たり判定マスク実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroCollisionMask.hpp"
+#include "esp_log.h"
+
+// ログタグ定義
+static const char *TAG = "RetroCollision";
+
+/**
+ * 下位nビットが1のマスク
+ * @param n ビット数（1〜32）
+ * @return マスク
+ */
+static inline uint32_t lowBits(int n) {
+    return n >= 32 ? 0xFFFFFFFFu : ((1u << n) - 1);
+}
+
+RetroCollisionMask::RetroCollisionMask(const PaletteImageData& img, bool flipH)
+    : bits(nullptr), rowLeft(nullptr), rowRight(nullptr),
+      width(img.width), height(img.height), wordsPerRow((img.width + 31) / 32),
+      left(img.width), top(img.height), right(-1), bottom(-1) {
+    if (width <= 0 || height <= 0) {
+        width = height = wordsPerRow = 0;
+        return;
+    }
+
+    // マスク本体と行範囲は1回の確保にまとめる
+    const size_t maskBytes = (size_t)height * wordsPerRow * sizeof(uint32_t);
+    uint8_t* memory = (uint8_t*)calloc(1, maskBytes + (size_t)height * 2 * sizeof(int16_t));
+    if (!memory) {
+        ESP_LOGE(TAG, "Failed to allocate collision mask: %dx%d", width, height);
+        width = height = wordsPerRow = 0;
+        return;
+    }
+    bits = (uint32_t*)memory;
+    rowLeft = (int16_t*)(memory + maskBytes);
+    rowRight = rowLeft + height;
+
+    for (int y = 0; y < height; y++) {
+        uint32_t* row = bits + y * wordsPerRow;
+        int rowMin = width, rowMax = -1;
+        for (int x = 0; x < width; x++) {
+            // 画像データは行をまたいで連続（偶数ピクセルが下位4bit）
+            const int pixel = y * width + x;
+            const uint8_t index = img.data ? (img.data[pixel >> 1] >> ((pixel & 1) * 4)) & 0x0F : 0;
+            if (index == RetroColorPalette::TRANSPARENT_INDEX) continue;
+
+            const int mx = flipH ? width - 1 - x : x;
+            row[mx >> 5] |= 1u << (mx & 31);
+            rowMin = min(rowMin, mx);
+            rowMax = max(rowMax, mx);
+        }
+        rowLeft[y] = rowMin;
+        rowRight[y] = rowMax;
+        if (rowMax >= 0) {
+            left = min(left, rowMin);
+            right = max(right, rowMax);
+            top = min(top, y);
+            bottom = y;
+        }
+    }
+
+    ESP_LOGI(TAG, "RetroCollisionMask created: %dx%d, bounds (%d,%d)-(%d,%d), %zu bytes",
+             width, height, left, top, right, bottom, getMemoryUsage());
+}
+
+RetroCollisionMask::~RetroCollisionMask() {
+    free(bits);  // rowLeft/rowRight も同じ確保領域
+}
+
+uint32_t RetroCollisionMask::extractBits(int y, int bitPos) const {
+    const uint32_t* row = bits + y * wordsPerRow;
+    const int word = bitPos >> 5;
+    const int shift = bitPos & 31;
+    if (word >= wordsPerRow) return 0;
+
+    uint32_t value = row[word] >> shift;
+    if (shift && word + 1 < wordsPerRow) {
+        value |= row[word + 1] << (32 - shift);
+    }
+    return value;
+}
+
+bool RetroCollisionMask::hitTest(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) return false;
+    return (bits[y * wordsPerRow + (x >> 5)] >> (x & 31)) & 1;
+}
+
+bool RetroCollisionMask::overlapsRect(int maskX, int maskY, int rectX, int rectY, int rectWidth, int rectHeight) const {
+    if (isEmpty() || rectWidth <= 0 || rectHeight <= 0) return false;
+
+    // 外接矩形同士で交差範囲を絞る（座標はマスク側）
+    const int y0 = max(top, rectY - maskY);
+    const int y1 = min(bottom, rectY - maskY + rectHeight - 1);
+    const int x0 = max(left, rectX - maskX);
+    const int x1 = min(right, rectX - maskX + rectWidth - 1);
+    if (y0 > y1 || x0 > x1) return false;
+
+    for (int y = y0; y <= y1; y++) {
+        const int sx0 = max(x0, (int)rowLeft[y]);
+        const int sx1 = min(x1, (int)rowRight[y]);
+        if (sx0 > sx1) continue;
+
+        for (int x = sx0; x <= sx1; x += 32) {
+            if (extractBits(y, x) & lowBits(sx1 - x + 1)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool RetroCollisionMask::overlap(const RetroCollisionMask& a, int ax, int ay,
+                                 const RetroCollisionMask& b, int bx, int by) {
+    if (a.isEmpty() || b.isEmpty()) return false;
+
+    // 外接矩形の交差（画面座標）
+    const int x0 = max(ax + a.left, bx + b.left);
+    const int x1 = min(ax + a.right, bx + b.right);
+    const int y0 = max(ay + a.top, by + b.top);
+    const int y1 = min(ay + a.bottom, by + b.bottom);
+    if (x0 > x1 || y0 > y1) return false;
+
+    for (int y = y0; y <= y1; y++) {
+        const int ya = y - ay, yb = y - by;
+
+        // 行ごとの不透明範囲が重ならない行は読まない
+        const int sx0 = max(x0, max(ax + a.rowLeft[ya], bx + b.rowLeft[yb]));
+        const int sx1 = min(x1, min(ax + a.rowRight[ya], bx + b.rowRight[yb]));
+        if (sx0 > sx1) continue;
+
+        for (int x = sx0; x <= sx1; x += 32) {
+            const uint32_t mask = lowBits(sx1 - x + 1);
+            if (a.extractBits(ya, x - ax) & b.extractBits(yb, x - bx) & mask) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool RetroCollisionMask::isEmpty() const {
+    return right < 0;
+}
+
+size_t RetroCollisionMask::getMemoryUsage() const {
+    return (size_t)height * wordsPerRow * sizeof(uint32_t) + (size_t)height * 2 * sizeof(int16_t);
+}
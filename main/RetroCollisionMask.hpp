@@ -0,0 +1,97 @@
+/*
+ * RetroCollisionMask.hpp
+ * ピクセル単位の当たり判定マスク for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - パレット画像の不透明ピクセルを1bit/pixelに詰めたマスクを事前に作成
+ * - 行ごとの不透明範囲（左端・右端）と全体の外接矩形を保持し、重ならない行は読まない
+ * - 2つのマスクの重なりは、交差する行だけを32bitワード単位のANDで検査
+ * - 左右反転したスプライト用に反転済みマスクも作成できる
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * 当たり判定マスク
+ * 行ごとに wordsPerRow 個の32bitワード、ピクセルxはワード x/32 のビット x%32（不透明=1）
+ */
+struct RetroCollisionMask {
+    uint32_t* bits;                // マスク本体（height * wordsPerRow ワード）
+    int16_t* rowLeft;              // 行ごとの不透明範囲の左端（空行はwidth）
+    int16_t* rowRight;             // 行ごとの不透明範囲の右端（空行は-1）
+    int width, height;             // マスクサイズ（画像と同じ）
+    int wordsPerRow;               // 1行のワード数
+    int left, top, right, bottom;  // 不透明ピクセルの外接矩形（両端を含む、空ならleft>right）
+
+    /**
+     * パレット画像からマスクを作成（透明色インデックス以外を不透明とする）
+     * @param img パレット画像データ
+     * @param flipH 左右反転したマスクを作るか（FLIP_H で描くスプライト用）
+     */
+    explicit RetroCollisionMask(const PaletteImageData& img, bool flipH = false);
+
+    /**
+     * デストラクタ
+     */
+    ~RetroCollisionMask();
+
+    // バッファを所有するためコピー禁止
+    RetroCollisionMask(const RetroCollisionMask&) = delete;
+    RetroCollisionMask& operator=(const RetroCollisionMask&) = delete;
+
+    /**
+     * 指定座標が不透明かどうか
+     * @param x マスク上のX座標
+     * @param y マスク上のY座標
+     * @return true=不透明（範囲外はfalse）
+     */
+    bool hitTest(int x, int y) const;
+
+    /**
+     * 矩形と重なる不透明ピクセルがあるか（弾・地形タイルなどとの判定）
+     * @param maskX マスク左上のX座標
+     * @param maskY マスク左上のY座標
+     * @param rectX 矩形のX座標
+     * @param rectY 矩形のY座標
+     * @param rectWidth 矩形の幅
+     * @param rectHeight 矩形の高さ
+     * @return 重なっている場合true
+     */
+    bool overlapsRect(int maskX, int maskY, int rectX, int rectY, int rectWidth, int rectHeight) const;
+
+    /**
+     * 2つのマスクの不透明ピクセルが重なるか
+     * @param a マスクA
+     * @param ax マスクA左上のX座標
+     * @param ay マスクA左上のY座標
+     * @param b マスクB
+     * @param bx マスクB左上のX座標
+     * @param by マスクB左上のY座標
+     * @return 重なっている場合true
+     */
+    static bool overlap(const RetroCollisionMask& a, int ax, int ay,
+                        const RetroCollisionMask& b, int bx, int by);
+
+    /**
+     * 不透明ピクセルが無いか
+     * @return true=全て透明
+     */
+    bool isEmpty() const;
+
+    /**
+     * メモリ使用量を計算
+     * @return 使用メモリ量（バイト）
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    /**
+     * 行の指定ビット位置から32ピクセル分のマスクを取り出す
+     * @param y 行
+     * @param bitPos 先頭のピクセル位置（0以上）
+     * @return 32ピクセル分のマスク（範囲外は0）
+     */
+    uint32_t extractBits(int y, int bitPos) const;
+};
@@ -0,0 +1,222 @@
+/*
+ * RetroDeltaAnimation.cpp
+ * 差分圧縮アニメーション実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroDeltaAnimation.hpp"
+#include "RetroRenderPool.hpp"
+#include "esp_log.h"
+
+// ログタグ定義
+static const char *TAG = "RetroDeltaAnim";
+
+// 表示時間の配列が無い場合の1フレームの表示時間（ミリ秒）
+static constexpr uint16_t DEFAULT_FRAME_DURATION = 100;
+
+// ===== PaletteDeltaAnimationData実装 =====
+
+PaletteDeltaAnimationData::PaletteDeltaAnimationData(const uint8_t* keyframeData, const uint8_t* delta,
+                                                     const uint16_t* offsets, const uint16_t* frameDurations,
+                                                     int w, int h, int count, const RetroColorPalette* customPalette)
+    : keyframe(keyframeData), deltaData(delta), frameOffsets(offsets), durations(frameDurations),
+      width(w), height(h), frameCount(count) {
+    keyframeSize = (width * height + 1) / 2;
+
+    if (customPalette) {
+        palette = *customPalette;
+    }
+}
+
+size_t PaletteDeltaAnimationData::getDataSize() const {
+    if (frameCount <= 0) return keyframeSize;
+    return keyframeSize + frameOffsets[frameCount] + (frameCount + 1) * sizeof(uint16_t) +
+           (durations ? frameCount * sizeof(uint16_t) : 0);
+}
+
+// ===== RetroDeltaAnimation実装 =====
+
+RetroAnimation::AnimationFrame* RetroDeltaAnimation::createFrames(const PaletteDeltaAnimationData& anim,
+                                                                  const PaletteImageData* target) {
+    if (anim.frameCount <= 0) return nullptr;
+
+    RetroAnimation::AnimationFrame* list = (RetroAnimation::AnimationFrame*)RetroRenderPool::acquireBuffer(
+        anim.frameCount * sizeof(RetroAnimation::AnimationFrame));
+    if (!list) return nullptr;
+
+    for (int i = 0; i < anim.frameCount; i++) {
+        list[i].image = target;
+        list[i].duration = anim.durations ? anim.durations[i] : DEFAULT_FRAME_DURATION;
+        list[i].offsetX = 0;
+        list[i].offsetY = 0;
+    }
+    return list;
+}
+
+RetroDeltaAnimation::RetroDeltaAnimation(const PaletteDeltaAnimationData& anim, bool loopAnimation)
+    : source(&anim), pixels(nullptr), image(nullptr, anim.width, anim.height, &anim.palette),
+      frames(createFrames(anim, &image)), timeline(frames, frames ? anim.frameCount : 0, loopAnimation),
+      decodedFrame(0), appliedBytes(0) {
+    // 展開済みフレームはキーフレームのコピーから始める
+    pixels = (uint8_t*)RetroRenderPool::acquireBuffer(anim.keyframeSize);
+    if (!pixels || !frames) {
+        ESP_LOGE(TAG, "Failed to allocate delta animation buffers (%zu bytes frame, %d frames)",
+                 anim.keyframeSize, anim.frameCount);
+        RetroRenderPool::releaseBuffer(pixels);
+        pixels = nullptr;
+        clearChanged();
+        return;
+    }
+    memcpy(pixels, anim.keyframe, anim.keyframeSize);
+    image.data = pixels;
+
+    // 最初の描画ではフレーム全体を描く
+    changedX0 = changedY0 = 0;
+    changedX1 = anim.width;
+    changedY1 = anim.height;
+
+    ESP_LOGI(TAG, "RetroDeltaAnimation created: %d frames %dx%d, %zu bytes in flash (full frames: %zu bytes)",
+             anim.frameCount, anim.width, anim.height, anim.getDataSize(), anim.keyframeSize * anim.frameCount);
+}
+
+RetroDeltaAnimation::~RetroDeltaAnimation() {
+    RetroRenderPool::releaseBuffer(pixels);
+    RetroRenderPool::releaseBuffer(frames);
+}
+
+void RetroDeltaAnimation::clearChanged() {
+    changedX0 = changedY0 = 0;
+    changedX1 = changedY1 = 0;
+}
+
+void RetroDeltaAnimation::addChanged(int x0, int y0, int x1, int y1) {
+    if (changedX0 >= changedX1) {
+        changedX0 = x0;
+        changedY0 = y0;
+        changedX1 = x1;
+        changedY1 = y1;
+        return;
+    }
+    changedX0 = min(changedX0, x0);
+    changedY0 = min(changedY0, y0);
+    changedX1 = max(changedX1, x1);
+    changedY1 = max(changedY1, y1);
+}
+
+void RetroDeltaAnimation::applyDelta(int frame) {
+    const uint8_t* p = source->deltaData + source->frameOffsets[frame];
+    const uint8_t* end = source->deltaData + source->frameOffsets[frame + 1];
+    const int width = source->width;
+    const int totalPixels = width * source->height;
+
+    while (end - p >= PaletteDeltaAnimationData::PATCH_HEADER_BYTES) {
+        const size_t offset = p[0] | (p[1] << 8);
+        const size_t length = p[2];
+        p += PaletteDeltaAnimationData::PATCH_HEADER_BYTES;
+        if (offset + length > source->keyframeSize || length > (size_t)(end - p)) {
+            ESP_LOGE(TAG, "Corrupt delta patch in frame %d (offset %zu, %zu bytes)", frame, offset, length);
+            return;
+        }
+
+        memcpy(pixels + offset, p, length);
+        p += length;
+        appliedBytes += length;
+
+        // 置き換えたバイトの画素範囲（1行に収まればその列だけ、行をまたぐなら行全体）
+        const int first = (int)offset * 2;
+        const int last = min(totalPixels, (int)(offset + length) * 2) - 1;
+        if (last < first) continue;
+        const int y0 = first / width;
+        const int y1 = last / width;
+        if (y0 == y1) {
+            addChanged(first % width, y0, last % width + 1, y0 + 1);
+        } else {
+            addChanged(0, y0, width, y1 + 1);
+        }
+    }
+}
+
+void RetroDeltaAnimation::sync() {
+    if (!pixels) return;
+
+    // 非ループ再生の終了時はフレーム番号がフレーム数に達するので最終フレームに留める
+    const int target = min(timeline.getCurrentFrameIndex(), source->frameCount - 1);
+
+    // 前のフレームからの差分を順に適用（先頭に戻る時はフレーム0の差分を使う）
+    while (decodedFrame != target) {
+        decodedFrame = (decodedFrame + 1) % source->frameCount;
+        applyDelta(decodedFrame);
+    }
+}
+
+RetroAnimation& RetroDeltaAnimation::getAnimation() {
+    return timeline;
+}
+
+const PaletteImageData* RetroDeltaAnimation::getCurrentFrame() {
+    if (!pixels || !timeline.getCurrentFrame()) return nullptr;
+    sync();
+    return &image;
+}
+
+bool RetroDeltaAnimation::getChangedRect(int& x, int& y, int& w, int& h) {
+    sync();
+    x = changedX0;
+    y = changedY0;
+    w = changedX1 - changedX0;
+    h = changedY1 - changedY0;
+    return w > 0 && h > 0;
+}
+
+void RetroDeltaAnimation::draw(PaletteImageRenderer& renderer, int x, int y, bool useTransparency) {
+    const PaletteImageData* frame = getCurrentFrame();
+    if (!frame) return;
+
+    renderer.drawToCanvas(*frame, x, y, useTransparency);
+    clearChanged();
+}
+
+bool RetroDeltaAnimation::drawChanged(PaletteImageRenderer& renderer, int x, int y, bool useTransparency) {
+    const PaletteImageData* frame = getCurrentFrame();
+    int changedX, changedY, changedW, changedH;
+    if (!frame || !getChangedRect(changedX, changedY, changedW, changedH)) return false;
+
+    // 変わった矩形だけを描くので、レンダラーの変更領域もその範囲になる
+    renderer.drawRegionToCanvas(*frame, changedX, changedY, changedW, changedH,
+                                x + changedX, y + changedY, useTransparency);
+    clearChanged();
+    return true;
+}
+
+uint32_t RetroDeltaAnimation::getAppliedBytes() const {
+    return appliedBytes;
+}
+
+// ===== サンプルデータ =====
+// anim_delta_encoder.py stand.png walk1.png stand.png walk2.png --durations 500 300 200 300
+
+// 差分データ（オフセット2バイト＋バイト数1バイト＋置き換えるバイト列 のパッチ列、108バイト）
+const uint8_t SAMPLE_CHAR_WALK_DELTA_DATA[] = {
+    // frame 0 (from frame 3): 26 bytes
+    0x46, 0x00, 0x01, 0x00, 0x4C, 0x00, 0x13, 0x00, 0x00, 0x00, 0x00, 0x77, 0x77, 0x00, 0x00, 0x00,
+    0x00, 0x77, 0x77, 0x00, 0x00, 0x00, 0x07, 0x77, 0x77, 0x70,
+    // frame 1 (from frame 0): 28 bytes
+    0x43, 0x00, 0x01, 0x07, 0x49, 0x00, 0x01, 0x07, 0x4F, 0x00, 0x11, 0x07, 0x77, 0x00, 0x77, 0x00,
+    0x00, 0x07, 0x77, 0x00, 0x77, 0x00, 0x00, 0x77, 0x77, 0x07, 0x77, 0x70,
+    // frame 2 (from frame 1): 28 bytes
+    0x43, 0x00, 0x01, 0x00, 0x49, 0x00, 0x01, 0x00, 0x4F, 0x00, 0x11, 0x00, 0x77, 0x77, 0x00, 0x00,
+    0x00, 0x00, 0x77, 0x77, 0x00, 0x00, 0x00, 0x07, 0x77, 0x77, 0x70, 0x00,
+    // frame 3 (from frame 2): 26 bytes
+    0x46, 0x00, 0x01, 0x70, 0x4C, 0x00, 0x13, 0x70, 0x00, 0x00, 0x77, 0x00, 0x77, 0x70, 0x00, 0x00,
+    0x77, 0x00, 0x77, 0x70, 0x00, 0x07, 0x77, 0x70, 0x77, 0x77
+};
+
+// 各フレームの差分の先頭オフセット（frameCount+1要素、末尾はデータサイズ）
+const uint16_t SAMPLE_CHAR_WALK_DELTA_OFFSETS[] = {
+    0, 26, 54, 82, 108
+};
+
+// 各フレームの表示時間（ミリ秒）
+const uint16_t SAMPLE_CHAR_WALK_DELTA_DURATIONS[] = {
+    500, 300, 200, 300
+};
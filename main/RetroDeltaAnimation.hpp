@@ -0,0 +1,190 @@
+/*
+ * RetroDeltaAnimation.hpp
+ * 差分圧縮アニメーション for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 先頭フレーム（キーフレーム）1枚と、前のフレームから変わったバイト範囲の差分だけをフラッシュに置く
+ *   （歩行パターンのように足だけが動くフレーム列を1枚分＋α の容量で持てる）
+ * - 再生時は内部RAMの展開済みフレーム1枚に差分を適用するだけで次のフレームになる
+ * - 差分で変わった矩形を記録し、その部分だけ描き直す（pushDirtyRegions で変わった行だけ転送）
+ * - 再生タイミングは RetroAnimation に任せるので RetroFrameScheduler にそのまま登録できる
+ *
+ * データは anim_delta_encoder.py で生成する
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * 差分圧縮アニメーションデータ
+ * 差分データはフレームごとのパッチ列:
+ * - パッチ: 展開済みデータ上のバイトオフセット（2バイト、リトルエンディアン）+ バイト数（1バイト、1-255）
+ *           + 置き換えるバイト列（1バイト2ピクセル、偶数ピクセルが下位4bit）
+ * - フレームi（i>=1）の差分はフレームi-1からの変化、フレーム0の差分は最終フレームから先頭へ戻る変化
+ */
+struct PaletteDeltaAnimationData {
+    static constexpr int PATCH_HEADER_BYTES = 3;   // パッチの先頭（オフセット＋バイト数）
+    static constexpr int MAX_PATCH_BYTES = 255;    // 1パッチの最大バイト数
+
+    const uint8_t* keyframe;        // 先頭フレームの画像データ（1バイトに2ピクセル格納）
+    const uint8_t* deltaData;       // 差分データ（パッチ列）
+    const uint16_t* frameOffsets;   // 各フレームの差分の先頭オフセット（frameCount+1要素、末尾は全体サイズ）
+    const uint16_t* durations;      // 各フレームの表示時間（ミリ秒、nullptr = 全フレーム100ms）
+    RetroColorPalette palette;      // カラーパレット
+    int width, height;              // 画像サイズ
+    int frameCount;                 // フレーム数
+    size_t keyframeSize;            // 先頭フレームのバイト数
+
+    /**
+     * コンストラクタ
+     * @param keyframeData 先頭フレームの画像データ配列のポインタ
+     * @param delta 差分データ配列のポインタ
+     * @param offsets 差分オフセット配列のポインタ（frameCount+1要素）
+     * @param frameDurations 表示時間配列のポインタ（frameCount要素、nullptr可）
+     * @param w 画像幅
+     * @param h 画像高さ
+     * @param count フレーム数
+     * @param customPalette カスタムパレット（nullptr = デフォルト）
+     */
+    PaletteDeltaAnimationData(const uint8_t* keyframeData, const uint8_t* delta, const uint16_t* offsets,
+                              const uint16_t* frameDurations, int w, int h, int count,
+                              const RetroColorPalette* customPalette = nullptr);
+
+    /**
+     * フラッシュ上のデータサイズを取得
+     * @return キーフレーム・差分・オフセット・表示時間の合計バイト数
+     */
+    size_t getDataSize() const;
+};
+
+/**
+ * 差分圧縮アニメーションの再生
+ * getAnimation() で再生制御（start/stop/update、RetroFrameScheduler への登録）を行い、
+ * フレームが変わったら drawChanged() で変わった部分だけ描き直す
+ * 展開済みフレームと差分の適用は、フレーム画像・変更矩形を参照した時にまとめて行う
+ */
+class RetroDeltaAnimation {
+private:
+    const PaletteDeltaAnimationData* source;   // 差分圧縮データ
+    uint8_t* pixels;                           // 展開済みフレーム（プールから借りる）
+    PaletteImageData image;                    // pixels を指す画像
+    RetroAnimation::AnimationFrame* frames;    // 全フレームが image を指すフレーム配列（プールから借りる）
+    RetroAnimation timeline;                   // 再生タイミング
+    int decodedFrame;                          // pixels に展開済みのフレーム番号
+    int changedX0, changedY0;                  // 前回の描画以降に変わった矩形の左上
+    int changedX1, changedY1;                  // 同右下（含まない、変化なしなら changedX0 >= changedX1）
+    uint32_t appliedBytes;                     // 適用した差分のバイト数（累計）
+
+    /**
+     * フレーム配列を作成（timeline の初期化用）
+     * @param anim 差分圧縮データ
+     * @param target 全フレームが指す画像
+     * @return フレーム配列（確保失敗時nullptr）
+     */
+    static RetroAnimation::AnimationFrame* createFrames(const PaletteDeltaAnimationData& anim,
+                                                        const PaletteImageData* target);
+
+    /**
+     * 1フレーム分の差分を展開済みフレームに適用
+     * @param frame 適用するフレーム番号
+     */
+    void applyDelta(int frame);
+
+    /**
+     * 展開済みフレームを timeline の現在フレームに合わせる
+     */
+    void sync();
+
+    /**
+     * 変更矩形を空にする
+     */
+    void clearChanged();
+
+    /**
+     * 変更矩形に範囲を追加
+     * @param x0 左端
+     * @param y0 上端
+     * @param x1 右端（含まない）
+     * @param y1 下端（含まない）
+     */
+    void addChanged(int x0, int y0, int x1, int y1);
+
+public:
+    /**
+     * コンストラクタ
+     * @param anim 差分圧縮データ（再生中は保持しておくこと）
+     * @param loopAnimation ループ再生するか
+     */
+    RetroDeltaAnimation(const PaletteDeltaAnimationData& anim, bool loopAnimation = true);
+
+    /**
+     * デストラクタ
+     */
+    ~RetroDeltaAnimation();
+
+    // バッファを所有するためコピー禁止
+    RetroDeltaAnimation(const RetroDeltaAnimation&) = delete;
+    RetroDeltaAnimation& operator=(const RetroDeltaAnimation&) = delete;
+
+    /**
+     * 再生タイミングを取得（start/stop/update や RetroFrameScheduler::add に使う）
+     * @return アニメーション
+     */
+    RetroAnimation& getAnimation();
+
+    /**
+     * 現在のフレーム画像を取得（差分を適用してから返す）
+     * @return 展開済みフレーム（停止中・確保失敗時nullptr）
+     */
+    const PaletteImageData* getCurrentFrame();
+
+    /**
+     * 前回の描画以降に変わった矩形を取得（差分を適用してから返す）
+     * @param x 左上X座標の格納先（画像内座標）
+     * @param y 左上Y座標の格納先
+     * @param w 幅の格納先
+     * @param h 高さの格納先
+     * @return 変わった部分がある場合true
+     */
+    bool getChangedRect(int& x, int& y, int& w, int& h);
+
+    /**
+     * 現在のフレーム全体を描画
+     * @param renderer 描画先レンダラー
+     * @param x 描画先X座標
+     * @param y 描画先Y座標
+     * @param useTransparency 透明色を使用するか
+     */
+    void draw(PaletteImageRenderer& renderer, int x, int y, bool useTransparency = true);
+
+    /**
+     * 前回の描画以降に変わった矩形だけを描画
+     * 透明にしたピクセルは前の色が残るため、透明色を使う場合は先に矩形の背景を描き直すこと
+     * @param renderer 描画先レンダラー
+     * @param x フレーム左上の描画先X座標
+     * @param y フレーム左上の描画先Y座標
+     * @param useTransparency 透明色を使用するか
+     * @return 描画した場合true（変化なし・停止中はfalse）
+     */
+    bool drawChanged(PaletteImageRenderer& renderer, int x, int y, bool useTransparency = true);
+
+    /**
+     * 適用した差分のバイト数を取得
+     * @return バイト数（生成時から累計）
+     */
+    uint32_t getAppliedBytes() const;
+};
+
+// ===== サンプルデータ =====
+
+/**
+ * 12x16キャラクターの歩行サイクル（立ち→歩き1→立ち→歩き2、4フレーム）
+ * SAMPLE_CHAR_STAND/WALK1/WALK2_12x16 を anim_delta_encoder.py で差分圧縮したもの
+ * キーフレームは SAMPLE_CHAR_STAND_12x16 をそのまま使う
+ * PaletteDeltaAnimationData walk(SAMPLE_CHAR_STAND_12x16, SAMPLE_CHAR_WALK_DELTA_DATA,
+ *                                SAMPLE_CHAR_WALK_DELTA_OFFSETS, SAMPLE_CHAR_WALK_DELTA_DURATIONS, 12, 16, 4);
+ */
+extern const uint8_t SAMPLE_CHAR_WALK_DELTA_DATA[];
+extern const uint16_t SAMPLE_CHAR_WALK_DELTA_OFFSETS[];
+extern const uint16_t SAMPLE_CHAR_WALK_DELTA_DURATIONS[];
@@ -0,0 +1,220 @@
+/*
+ * RetroFrameScheduler.cpp
+ * フレームスケジューラ実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroFrameScheduler.hpp"
+#include "RetroPowerManager.hpp"
+#include "esp_log.h"
+
+// ログタグ定義
+static const char *TAG = "RetroFrameSched";
+
+// 時刻なし（再生中のアニメーションが無い・タイムアウトなし）
+static constexpr int64_t NO_TIME = INT64_MAX;
+
+RetroFrameScheduler::RetroFrameScheduler()
+    : mode(MODE_ON_CHANGE), periodUs(0), nextTickUs(0), vsyncRenderer(nullptr),
+      timer(nullptr), waiter(nullptr), wakeCount(0), lateCount(0) {
+    for (int i = 0; i < MAX_ANIMATIONS; i++) {
+        animations[i] = nullptr;
+    }
+}
+
+RetroFrameScheduler::~RetroFrameScheduler() {
+    if (timer) {
+        esp_timer_stop(timer);
+        esp_timer_delete(timer);
+        timer = nullptr;
+    }
+}
+
+void RetroFrameScheduler::timerCallback(void* arg) {
+    RetroFrameScheduler* self = (RetroFrameScheduler*)arg;
+    if (self->waiter) {
+        xTaskNotifyGive(self->waiter);
+    }
+}
+
+int RetroFrameScheduler::add(RetroAnimation* anim) {
+    if (!anim) return -1;
+
+    for (int i = 0; i < MAX_ANIMATIONS; i++) {
+        if (animations[i] == anim) return i;
+    }
+    for (int i = 0; i < MAX_ANIMATIONS; i++) {
+        if (!animations[i]) {
+            animations[i] = anim;
+            return i;
+        }
+    }
+
+    ESP_LOGE(TAG, "No free animation slot (max %d)", MAX_ANIMATIONS);
+    return -1;
+}
+
+void RetroFrameScheduler::remove(RetroAnimation* anim) {
+    for (int i = 0; i < MAX_ANIMATIONS; i++) {
+        if (animations[i] == anim) {
+            animations[i] = nullptr;
+        }
+    }
+}
+
+void RetroFrameScheduler::setOnChange() {
+    mode = MODE_ON_CHANGE;
+    vsyncRenderer = nullptr;
+}
+
+void RetroFrameScheduler::setFixedFps(int fps) {
+    mode = MODE_FIXED_FPS;
+    periodUs = 1000000 / max(1, fps);
+    nextTickUs = esp_timer_get_time();
+    vsyncRenderer = nullptr;
+    ESP_LOGI(TAG, "Fixed FPS mode: %d fps (%lu us)", fps, (unsigned long)periodUs);
+}
+
+void RetroFrameScheduler::setVsync(PaletteImageRenderer* renderer) {
+    mode = MODE_VSYNC;
+    vsyncRenderer = renderer;
+}
+
+bool RetroFrameScheduler::getNextDeadline(uint32_t& timeMs) const {
+    bool found = false;
+    uint32_t nowMs = (uint32_t)(esp_timer_get_time() / 1000);
+    int32_t nearest = 0;
+    for (int i = 0; i < MAX_ANIMATIONS; i++) {
+        const RetroAnimation* anim = animations[i];
+        if (!anim || !anim->isPlaying()) continue;
+
+        // ミリ秒カウンタの一周を考慮して現在時刻からの差で比べる
+        const int32_t delta = (int32_t)(anim->getNextFrameTime() - nowMs);
+        if (!found || delta < nearest) {
+            nearest = delta;
+            found = true;
+        }
+    }
+    if (found) {
+        timeMs = nowMs + nearest;
+    }
+    return found;
+}
+
+uint32_t RetroFrameScheduler::updateAnimations(uint32_t timeMs) {
+    uint32_t changed = 0;
+    for (int i = 0; i < MAX_ANIMATIONS; i++) {
+        if (animations[i] && animations[i]->update(timeMs)) {
+            changed |= 1u << i;
+        }
+    }
+    return changed;
+}
+
+bool RetroFrameScheduler::sleepUntil(int64_t deadlineUs, int64_t timeoutUs) {
+    const bool timedOut = deadlineUs > timeoutUs;
+    const int64_t targetUs = timedOut ? timeoutUs : deadlineUs;
+    if (targetUs == NO_TIME) return false;  // 起こす予定が無い
+
+    const int64_t delayUs = targetUs - esp_timer_get_time();
+    if (delayUs <= 0) return !timedOut;
+
+    if (!timer) {
+        esp_timer_create_args_t args = {};
+        args.callback = timerCallback;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "frame_sched";
+        if (esp_timer_create(&args, &timer) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create frame timer, falling back to vTaskDelay");
+            timer = nullptr;
+        }
+    }
+
+    const TickType_t delayTicks = pdMS_TO_TICKS((delayUs + 999) / 1000) + 1;
+    bool waited = false;
+    if (timer) {
+        waiter = xTaskGetCurrentTaskHandle();
+        if (esp_timer_start_once(timer, (uint64_t)delayUs) == ESP_OK) {
+            // 通知が届かなくても止まったままにならないよう、タイマーより1ティック長く待って打ち切る
+            if (ulTaskNotifyTake(pdTRUE, delayTicks + 1) == 0) {
+                esp_timer_stop(timer);
+            }
+            waited = true;
+        } else {
+            ESP_LOGW(TAG, "Failed to start frame timer, falling back to vTaskDelay");
+        }
+        waiter = nullptr;
+    }
+    if (!waited) {
+        vTaskDelay(delayTicks);
+    }
+    return !timedOut;
+}
+
+uint32_t RetroFrameScheduler::wait(uint32_t timeoutMs) {
+    const int64_t timeoutUs = (timeoutMs == WAIT_FOREVER) ? NO_TIME
+                                                          : esp_timer_get_time() + (int64_t)timeoutMs * 1000;
+
+    while (true) {
+        int64_t deadlineUs = NO_TIME;
+
+        if (mode != MODE_ON_CHANGE && RetroPowerManager::isIdle()) {
+            // 画面が止まっている間は低いフレームレートで起こす（アニメーションの切り替え時刻が先ならその時刻）
+            const int64_t nowUs = esp_timer_get_time();
+            deadlineUs = min(nowUs + (int64_t)RetroPowerManager::getIdleFrameIntervalMs() * 1000,
+                             getNextDeadlineUs(nowUs));
+            nextTickUs = deadlineUs;  // 復帰後は起きた時刻から周期の格子を作り直す
+        } else if (mode == MODE_VSYNC) {
+            // 前回の転送が終わるまでは次のフレームを描けない
+            if (vsyncRenderer) {
+                vsyncRenderer->waitForPushComplete();
+            }
+            deadlineUs = esp_timer_get_time();
+        } else if (mode == MODE_FIXED_FPS) {
+            // 周期の格子に揃える（描画が周期を超えたら次の格子点まで飛ばす）
+            const int64_t nowUs = esp_timer_get_time();
+            nextTickUs += periodUs;
+            if (nextTickUs <= nowUs) {
+                lateCount++;
+                nextTickUs += ((nowUs - nextTickUs) / periodUs + 1) * periodUs;
+            }
+            deadlineUs = nextTickUs;
+        } else {
+            deadlineUs = getNextDeadlineUs(esp_timer_get_time());
+        }
+
+        if (!sleepUntil(deadlineUs, timeoutUs)) {
+            return finishWait(updateAnimations((uint32_t)(esp_timer_get_time() / 1000)));
+        }
+        wakeCount++;
+
+        const uint32_t changed = updateAnimations((uint32_t)(esp_timer_get_time() / 1000));
+        if (changed || mode != MODE_ON_CHANGE) return finishWait(changed);
+    }
+}
+
+int64_t RetroFrameScheduler::getNextDeadlineUs(int64_t nowUs) const {
+    uint32_t nextMs;
+    if (!getNextDeadline(nextMs)) return NO_TIME;
+
+    // ミリ秒の切り替え時刻をマイクロ秒の絶対時刻に戻す
+    const uint32_t nowMs = (uint32_t)(nowUs / 1000);
+    return (nowUs / 1000 + (int32_t)(nextMs - nowMs)) * 1000;
+}
+
+uint32_t RetroFrameScheduler::finishWait(uint32_t changed) {
+    // アニメーションが動いたら、描画を始める前に最大クロックへ戻す
+    if (changed) {
+        RetroPowerManager::wake();
+    }
+    return changed;
+}
+
+uint32_t RetroFrameScheduler::getWakeCount() const {
+    return wakeCount;
+}
+
+uint32_t RetroFrameScheduler::getLateCount() const {
+    return lateCount;
+}
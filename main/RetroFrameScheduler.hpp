@@ -0,0 +1,149 @@
+/*
+ * RetroFrameScheduler.hpp
+ * フレームスケジューラ for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 複数の RetroAnimation を登録し、全アニメーションの次の切り替え時刻を計算
+ * - esp_timer のワンショットタイマーで描画タスクを起こす（FreeRTOSのティック丸めを受けない）
+ * - フレームが変わるまで描画タスクは眠ったまま（何も変わらないフレームを描かない）
+ * - 一定FPSモード（周期の格子に揃えて起こす）と、転送完了を待つvsync風モード
+ * - 省電力アイドル中（RetroPowerManager）は一定FPS・vsync風モードも低いフレームレートで起こす
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+#include "esp_timer.h"
+
+/**
+ * フレームスケジューラ
+ * wait() を呼んだタスクを次に描画すべき時刻まで眠らせる
+ */
+class RetroFrameScheduler {
+public:
+    static constexpr int MAX_ANIMATIONS = 16;          // 登録できるアニメーション数
+    static constexpr uint32_t WAIT_FOREVER = 0xFFFFFFFF;  // wait() のタイムアウトなし
+
+    // 起こし方
+    static constexpr uint8_t MODE_ON_CHANGE = 0;   // いずれかのアニメーションのフレームが変わった時だけ
+    static constexpr uint8_t MODE_FIXED_FPS = 1;   // 一定周期ごと（フレームが変わらなくても起こす）
+    static constexpr uint8_t MODE_VSYNC = 2;       // 前回の転送が完了したらすぐ（パネルの転送速度で回す）
+
+private:
+    RetroAnimation* animations[MAX_ANIMATIONS];  // 登録済みアニメーション（空き=nullptr）
+    uint8_t mode;                      // 起こし方
+    uint32_t periodUs;                 // 一定FPSモードの周期
+    int64_t nextTickUs;                // 一定FPSモードの次の時刻
+    PaletteImageRenderer* vsyncRenderer;  // vsync風モードで転送完了を待つレンダラー
+    esp_timer_handle_t timer;          // ワンショットタイマー
+    TaskHandle_t waiter;               // wait() 中のタスク
+    uint32_t wakeCount;                // 起こした回数
+    uint32_t lateCount;                // 予定時刻に間に合わなかった回数
+
+    /**
+     * タイマーコールバック（esp_timerタスクから呼ばれる）
+     * @param arg スケジューラ
+     */
+    static void timerCallback(void* arg);
+
+    /**
+     * 指定時刻まで眠る
+     * @param deadlineUs 起きる時刻（esp_timer_get_time() 基準）
+     * @param timeoutUs タイムアウト時刻（esp_timer_get_time() 基準）
+     * @return deadlineUs まで眠った場合true、タイムアウトした場合false
+     */
+    bool sleepUntil(int64_t deadlineUs, int64_t timeoutUs);
+
+    /**
+     * 全アニメーションを更新
+     * @param timeMs 現在時刻（ミリ秒）
+     * @return フレームが変わったアニメーションのビットマスク（登録番号順）
+     */
+    uint32_t updateAnimations(uint32_t timeMs);
+
+    /**
+     * 次にフレームが変わる時刻をマイクロ秒で取得
+     * @param nowUs 現在時刻（esp_timer_get_time() 基準）
+     * @return 次の切り替え時刻（再生中のアニメーションが無ければ INT64_MAX）
+     */
+    int64_t getNextDeadlineUs(int64_t nowUs) const;
+
+    /**
+     * wait() の戻り値を返す前の処理（フレームが変わったら省電力アイドルから復帰）
+     * @param changed フレームが変わったアニメーションのビットマスク
+     * @return changed をそのまま返す
+     */
+    uint32_t finishWait(uint32_t changed);
+
+public:
+    /**
+     * コンストラクタ（MODE_ON_CHANGE）
+     */
+    RetroFrameScheduler();
+
+    /**
+     * デストラクタ
+     */
+    ~RetroFrameScheduler();
+
+    /**
+     * アニメーションを登録
+     * @param anim アニメーション（スケジューラより長く生存すること）
+     * @return 登録番号（wait() の戻り値のビット位置、登録できない場合-1）
+     */
+    int add(RetroAnimation* anim);
+
+    /**
+     * アニメーションの登録を解除
+     * @param anim アニメーション
+     */
+    void remove(RetroAnimation* anim);
+
+    /**
+     * フレームが変わった時だけ起こすモードにする
+     */
+    void setOnChange();
+
+    /**
+     * 一定FPSで起こすモードにする
+     * @param fps フレームレート（1以上）
+     */
+    void setFixedFps(int fps);
+
+    /**
+     * 前回の転送完了を待ってすぐ起こすモードにする
+     * ダブルバッファ（enableDoubleBuffer）のレンダラーでは転送完了フェンスを待つ
+     * @param renderer 転送完了を待つレンダラー
+     */
+    void setVsync(PaletteImageRenderer* renderer);
+
+    /**
+     * 次に描画すべき時刻まで呼び出し元のタスクを眠らせ、アニメーションを更新
+     * MODE_ON_CHANGE ではフレームが変わるかタイムアウトするまで戻らない
+     * 省電力アイドル中は MODE_FIXED_FPS・MODE_VSYNC でもアイドル用の間隔で起こし、
+     * フレームが変わったら最大クロックに戻してから返す
+     * （再生中のアニメーションが無く、タイムアウトも無い場合はすぐに戻る）
+     * @param timeoutMs タイムアウト（ミリ秒、WAIT_FOREVER=なし）
+     * @return フレームが変わったアニメーションのビットマスク（変化が無ければ0）
+     */
+    uint32_t wait(uint32_t timeoutMs = WAIT_FOREVER);
+
+    /**
+     * 次にフレームが変わる時刻を取得
+     * @param timeMs 時刻の格納先（ミリ秒）
+     * @return 再生中のアニメーションがある場合true
+     */
+    bool getNextDeadline(uint32_t& timeMs) const;
+
+    /**
+     * 起こした回数を取得
+     * @return 起こした回数
+     */
+    uint32_t getWakeCount() const;
+
+    /**
+     * 予定時刻に間に合わなかった回数を取得（一定FPSモードで描画が周期を超えた回数）
+     * @return 回数
+     */
+    uint32_t getLateCount() const;
+};
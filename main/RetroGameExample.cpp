@@ -0,0 +1,174 @@
+/*
+ * RetroGameExample.cpp
+ * レトロゲーム風16色パレット画像システムのサンプル実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroGameExample.hpp"
+#include "RetroFrameScheduler.hpp"
+#include "RetroPaletteAnimator.hpp"
+#include "RetroHotAssetCache.hpp"
+#include "esp_log.h"
+#include <cmath>
+
+// ログタグ定義
+static const char *TAG = "RetroGameExample";
+
+// ===== サンプル実装 =====
+
+void RetroGameExample::basicUsageExample(LGFX_ST7789P3_76x284* display) {
+    ESP_LOGI(TAG, "=== Basic Usage Example ===");
+    
+    // 1. パレット画像データ作成
+    PaletteImageData heartImage(SAMPLE_HEART_8x8, 8, 8);
+    
+    // 2. レンダラー初期化（32x32のキャンバス）
+    PaletteImageRenderer renderer(display, 32, 32);
+    
+    // 3. キャンバスをクリア
+    renderer.clearCanvas(0x001F);  // 青背景
+    
+    // 4. ハート画像を描画（透明色対応）
+    renderer.drawToCanvas(heartImage, 12, 12, true);
+    
+    // 5. ディスプレイに表示（透明色は黒）
+    renderer.pushCanvasToDisplay(22, 138, 0x0000);  // 中央付近に表示
+    
+    ESP_LOGI(TAG, "Heart displayed with transparency");
+}
+
+void RetroGameExample::animationExample(LGFX_ST7789P3_76x284* display) {
+    ESP_LOGI(TAG, "=== Animation Example ===");
+    
+    PaletteImageData heartImage(SAMPLE_HEART_8x8, 8, 8);
+    PaletteImageData coinImage(SAMPLE_COIN_8x8, 8, 8);
+    PaletteImageRenderer renderer(display, 76, 284);  // フルスクリーン
+    
+    // 10fps固定（描画時間に関係なく100ms間隔の格子で起こす）
+    RetroFrameScheduler scheduler;
+    scheduler.setFixedFps(10);
+    
+    for (int frame = 0; frame < 60; frame++) {
+        renderer.clearCanvas(0x0010);  // ダークブルー背景
+        
+        // フレームごとに点滅するハート
+        if ((frame / 10) % 2 == 0) {
+            renderer.drawToCanvas(heartImage, 34, 100, true);
+        }
+        
+        // 回転するコイン（スケール変更でアニメーション）
+        float scale = 0.5f + 0.5f * sin(frame * 0.2f);
+        renderer.drawToCanvasScaled(coinImage, 30, 150, scale, 1.0f, true);
+        
+        renderer.pushCanvasToDisplayOpaque(0, 0);
+        scheduler.wait();
+    }
+    
+    ESP_LOGI(TAG, "Animation complete");
+}
+
+void RetroGameExample::characterWalkExample(LGFX_ST7789P3_76x284* display) {
+    ESP_LOGI(TAG, "=== Character Walk Example ===");
+    
+    // アニメーションフレーム設定
+    PaletteImageData standImage(SAMPLE_CHAR_STAND_12x16, 12, 16);
+    PaletteImageData walk1Image(SAMPLE_CHAR_WALK1_12x16, 12, 16);
+    PaletteImageData walk2Image(SAMPLE_CHAR_WALK2_12x16, 12, 16);
+    
+    RetroAnimation::AnimationFrame walkFrames[] = {
+        {&standImage, 500, 0, 0},  // 立ち：500ms
+        {&walk1Image, 300, 0, 0},  // 歩き1：300ms
+        {&standImage, 200, 0, 0},  // 立ち：200ms
+        {&walk2Image, 300, 0, 0}   // 歩き2：300ms
+    };
+    
+    RetroAnimation walkAnimation(walkFrames, 4, true);
+    PaletteImageRenderer renderer(display, 76, 284);
+    
+    // アニメーションで使うフレームを内部RAMへ先読み（同じ画像は1回だけコピー）
+    RetroHotAssetCache hotAssets;
+    hotAssets.prefetch(walkAnimation);
+    renderer.setAssetCache(&hotAssets);
+    
+    // フレームが切り替わる時だけ描画タスクを起こす
+    RetroFrameScheduler scheduler;
+    scheduler.add(&walkAnimation);
+    walkAnimation.start();
+    
+    // 背景は最初に一度だけ全面送信
+    renderer.clearCanvas(0x0400);  // ダークグリーン背景
+    renderer.pushCanvasToDisplayOpaque(0, 0);
+    
+    bool needsRedraw = true;
+    uint8_t facing = PaletteImageRenderer::BLIT_NONE;
+    int prevX = 0, prevY = 0, prevW = 0, prevH = 0;
+    size_t totalBytes = 0;
+    const uint32_t startMs = esp_timer_get_time() / 1000;
+    const uint32_t turnMs = 10000;   // 後半に切り替える時刻
+    const uint32_t totalMs = 20000;  // 20秒間のアニメーション
+    
+    while (true) {
+        const uint32_t elapsed = (uint32_t)(esp_timer_get_time() / 1000) - startMs;
+        if (elapsed >= totalMs) break;
+        
+        // 後半は左向き（左右反転して描画、反転用の画像データは不要）
+        const uint8_t nextFacing = (elapsed < turnMs) ? PaletteImageRenderer::BLIT_NONE : PaletteImageRenderer::BLIT_FLIP_H;
+        if (nextFacing != facing) {
+            facing = nextFacing;
+            needsRedraw = true;
+        }
+        
+        // フレームが変わった時だけキャラクター周辺を描き直す
+        const PaletteImageData* currentFrame = walkAnimation.getCurrentFrame();
+        if (needsRedraw && currentFrame) {
+            renderer.fillCanvasRect(prevX, prevY, prevW, prevH, 0x0400);
+            
+            int offsetX, offsetY;
+            walkAnimation.getCurrentOffset(offsetX, offsetY);
+            prevX = 32 + offsetX;
+            prevY = 134 + offsetY;
+            prevW = currentFrame->width;
+            prevH = currentFrame->height;
+            renderer.drawToCanvasTransformed(*currentFrame, prevX, prevY, facing, true);
+            needsRedraw = false;
+        }
+        
+        totalBytes += renderer.pushDirtyRegions(0, 0);
+        
+        // 次のフレーム切り替えか、向きを変える時刻まで眠る
+        const uint32_t next = (elapsed < turnMs) ? turnMs : totalMs;
+        if (scheduler.wait(next - elapsed)) {
+            needsRedraw = true;
+        }
+    }
+    
+    ESP_LOGI(TAG, "Character walk animation complete (%zu bytes pushed, %lu wakeups, asset cache %lu%% hit)",
+             totalBytes, (unsigned long)scheduler.getWakeCount(), (unsigned long)hotAssets.getHitRate());
+}
+
+void RetroGameExample::paletteEffectExample(LGFX_ST7789P3_76x284* display) {
+    ESP_LOGI(TAG, "=== Palette Effect Example ===");
+    
+    PaletteImageData faceImage(SAMPLE_FACE_16x16, 16, 16);
+    
+    // 4bitキャンバスに一度だけ描画し、以降はパレットだけを変える
+    PaletteImageRenderer renderer(display, 76, 284, faceImage.palette);
+    renderer.clearCanvasIndex(RetroColorPalette::TRANSPARENT_INDEX);
+    renderer.drawToCanvas(faceImage, 30, 134, true);
+    
+    RetroPaletteAnimator animator(faceImage.palette);
+    animator.addHueCycle(1, 15, 12000, 80, 90, 24);
+    
+    RetroFrameScheduler scheduler;
+    scheduler.setFixedFps(10);
+    
+    for (int frame = 0; frame < 120; frame++) {
+        if (animator.apply(renderer)) {
+            renderer.pushCanvasToDisplayOpaque(0, 0);
+        }
+        
+        scheduler.wait();
+    }
+    
+    ESP_LOGI(TAG, "Palette effect complete");
+}
\ No newline at end of file
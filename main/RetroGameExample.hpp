@@ -0,0 +1,42 @@
+/*
+ * RetroGameExample.hpp
+ * レトロゲーム風16色パレット画像システムのサンプル for M5StampPico + ST7789P3
+ *
+ * フレームスケジューラ・パレットアニメーションと組み合わせた使い方の例
+ * 描画システム本体（RetroGamePaletteImage）とは別の翻訳単位にして、
+ * サンプルが使うモジュールを本体に引き込まないようにしている
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * 基本的な使用方法のサンプルクラス
+ */
+class RetroGameExample {
+public:
+    /**
+     * 基本描画のサンプル
+     * @param display ディスプレイインスタンス
+     */
+    static void basicUsageExample(LGFX_ST7789P3_76x284* display);
+    
+    /**
+     * アニメーションのサンプル
+     * @param display ディスプレイインスタンス
+     */
+    static void animationExample(LGFX_ST7789P3_76x284* display);
+    
+    /**
+     * キャラクター歩行アニメーションのサンプル
+     * @param display ディスプレイインスタンス
+     */
+    static void characterWalkExample(LGFX_ST7789P3_76x284* display);
+    
+    /**
+     * パレット変更エフェクトのサンプル
+     * @param display ディスプレイインスタンス
+     */
+    static void paletteEffectExample(LGFX_ST7789P3_76x284* display);
+};
\ No newline at end of file
@@ -5,18 +5,56 @@
  */
 
 #include "RetroGamePaletteImage.hpp"
+#include "RetroRenderPool.hpp"
+#include "RetroHotAssetCache.hpp"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "sdkconfig.h"
 #include <cmath>
+#include <algorithm>
+#include <inttypes.h>
 
 // ログタグ定義
 static const char *TAG = "RetroGamePalette";
 
+// スパン展開・変換テーブル参照の内側ループは内部RAM（IRAM）に置く
+// DMA転送中などにフラッシュキャッシュミスで描画が止まらないようにするため
+#if CONFIG_CSBOARD_BLIT_IN_IRAM
+#define RETRO_BLIT_IRAM IRAM_ATTR
+#else
+#define RETRO_BLIT_IRAM
+#endif
+
 // ===== RetroColorPalette 実装 =====
 
-RetroColorPalette::RetroColorPalette() {
+RetroColorPalette::RetroColorPalette() : lut(nullptr), lutDirty(true) {
     initClassicRetroColors();
 }
 
+RetroColorPalette::RetroColorPalette(const RetroColorPalette& other) : lut(nullptr), lutDirty(true) {
+    memcpy(colors, other.colors, sizeof(colors));
+}
+
+RetroColorPalette& RetroColorPalette::operator=(const RetroColorPalette& other) {
+    if (this == &other) return *this;
+    
+    memcpy(colors, other.colors, sizeof(colors));
+    
+    // 確保済みのテーブルは再利用（相手が構築済みならそのままコピー）
+    if (lut && other.lut && !other.lutDirty) {
+        memcpy(lut, other.lut, sizeof(PixelPairLut));
+        lutDirty = false;
+    } else {
+        lutDirty = true;
+    }
+    return *this;
+}
+
+RetroColorPalette::~RetroColorPalette() {
+    RetroRenderPool::releaseBuffer(lut);
+}
+
 void RetroColorPalette::initClassicRetroColors() {
     // ファミコン風16色パレット
     colors[0]  = 0x0000;  // 透明色（黒）
@@ -36,243 +74,2223 @@ void RetroColorPalette::initClassicRetroColors() {
     colors[14] = 0x4208;  // ダークグレー
     colors[15] = 0x2104;  // ベリーダーク
     
+    lutDirty = true;
     ESP_LOGI(TAG, "Classic retro colors initialized");
 }
 
-void RetroColorPalette::initGrayscalePalette() {
-    colors[0] = 0x0000;  // 透明色（黒）
+void RetroColorPalette::initGrayscalePalette() {
+    colors[0] = 0x0000;  // 透明色（黒）
+    
+    // グレースケール15段階
+    for (int i = 1; i < MAX_COLORS; i++) {
+        uint8_t level = (i * 255) / (MAX_COLORS - 1);
+        colors[i] = rgb888ToRgb565(level, level, level);
+    }
+    
+    lutDirty = true;
+    ESP_LOGI(TAG, "Grayscale palette initialized");
+}
+
+void RetroColorPalette::initSepiaPalette() {
+    colors[0] = 0x0000;  // 透明色（黒）
+    
+    // セピア調15段階
+    for (int i = 1; i < MAX_COLORS; i++) {
+        float ratio = (float)i / (MAX_COLORS - 1);
+        uint8_t r = (uint8_t)(ratio * 255 * 0.8f);  // 赤みを強く
+        uint8_t g = (uint8_t)(ratio * 255 * 0.6f);  // 緑は中程度
+        uint8_t b = (uint8_t)(ratio * 255 * 0.4f);  // 青は弱く
+        colors[i] = rgb888ToRgb565(r, g, b);
+    }
+    
+    lutDirty = true;
+    ESP_LOGI(TAG, "Sepia palette initialized");
+}
+
+void RetroColorPalette::setColor(uint8_t index, uint16_t color) {
+    if (index < MAX_COLORS && colors[index] != color) {
+        colors[index] = color;
+        lutDirty = true;
+    }
+}
+
+const RetroColorPalette::PixelPairLut* RetroColorPalette::getPairLut() const {
+    if (!lut) {
+        lut = (PixelPairLut*)RetroRenderPool::acquireBuffer(sizeof(PixelPairLut));
+        if (!lut) {
+            ESP_LOGE(TAG, "Failed to allocate pixel pair LUT");
+            return nullptr;
+        }
+        lutDirty = true;
+    }
+    
+    if (lutDirty) {
+        // バス順（バイトスワップ済み）の色を先に作る
+        uint16_t swapped[MAX_COLORS];
+        for (int i = 0; i < MAX_COLORS; i++) {
+            swapped[i] = (uint16_t)((colors[i] >> 8) | (colors[i] << 8));
+        }
+        
+        for (int b = 0; b < 256; b++) {
+            uint8_t even = b & 0x0F;  // 偶数ピクセル: 下位4bit
+            uint8_t odd = b >> 4;     // 奇数ピクセル: 上位4bit
+            lut->pairs[b] = (uint32_t)swapped[even] | ((uint32_t)swapped[odd] << 16);
+            lut->opaqueMask[b] = (even != TRANSPARENT_INDEX ? 0x01 : 0) |
+                                 (odd != TRANSPARENT_INDEX ? 0x02 : 0);
+        }
+        lutDirty = false;
+    }
+    
+    return lut;
+}
+
+void RetroColorPalette::invalidateLut() {
+    lutDirty = true;
+}
+
+uint8_t RetroColorPalette::findClosestIndex(uint16_t color) const {
+    for (int i = 0; i < MAX_COLORS; i++) {
+        if (colors[i] == color) return i;
+    }
+    
+    int r = (color >> 11) & 0x1F, g = (color >> 5) & 0x3F, b = color & 0x1F;
+    uint8_t best = 0;
+    int bestDistance = INT32_MAX;
+    for (int i = 0; i < MAX_COLORS; i++) {
+        int dr = r - ((colors[i] >> 11) & 0x1F);
+        int dg = g - ((colors[i] >> 5) & 0x3F);
+        int db = b - (colors[i] & 0x1F);
+        int distance = 4 * dr * dr + dg * dg + 4 * db * db;  // 5bit成分を6bit相当に揃える
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint16_t RetroColorPalette::rgb888ToRgb565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+uint16_t RetroColorPalette::hsvToRgb565(uint16_t h, uint8_t s, uint8_t v) {
+    // HSV to RGB conversion（整数演算のみ、各成分は0-255）
+    h %= 360;
+    if (s > 100) s = 100;
+    if (v > 100) v = 100;
+    
+    int V = v * 255 / 100;
+    int C = V * s / 100;
+    int d = h % 120 - 60;
+    int X = C * (60 - (d < 0 ? -d : d)) / 60;
+    int m = V - C;
+    
+    int r, g, b;
+    if (h < 60) {
+        r = C; g = X; b = 0;
+    } else if (h < 120) {
+        r = X; g = C; b = 0;
+    } else if (h < 180) {
+        r = 0; g = C; b = X;
+    } else if (h < 240) {
+        r = 0; g = X; b = C;
+    } else if (h < 300) {
+        r = X; g = 0; b = C;
+    } else {
+        r = C; g = 0; b = X;
+    }
+    
+    return rgb888ToRgb565((uint8_t)(r + m), (uint8_t)(g + m), (uint8_t)(b + m));
+}
+
+// ===== PaletteImageData 実装 =====
+
+PaletteImageData::PaletteImageData(const uint8_t* imageData, int w, int h, const RetroColorPalette* customPalette) 
+    : data(imageData), width(w), height(h), collisionMask(nullptr) {
+    dataSize = (width * height + 1) / 2;  // 1バイトに2ピクセル
+    
+    if (customPalette) {
+        palette = *customPalette;
+    }
+    // デフォルトパレットは既にコンストラクタで初期化済み
+    
+    ESP_LOGI(TAG, "PaletteImageData created: %dx%d, %zu bytes", width, height, dataSize);
+}
+
+uint8_t PaletteImageData::getPixelIndex(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return RetroColorPalette::TRANSPARENT_INDEX;  // 範囲外は透明
+    }
+    
+    int pixelIndex = y * width + x;
+    int byteIndex = pixelIndex / 2;
+    
+    if (byteIndex >= dataSize) {
+        return RetroColorPalette::TRANSPARENT_INDEX;  // 範囲外は透明
+    }
+    
+    // 偶数ピクセル: 下位4bit、奇数ピクセル: 上位4bit
+    return (pixelIndex % 2 == 0) ? 
+           (data[byteIndex] & 0x0F) : 
+           ((data[byteIndex] & 0xF0) >> 4);
+}
+
+uint16_t PaletteImageData::getPixelColor(int x, int y) const {
+    uint8_t index = getPixelIndex(x, y);
+    return palette.colors[index];
+}
+
+bool PaletteImageData::isTransparent(int x, int y) const {
+    return getPixelIndex(x, y) == RetroColorPalette::TRANSPARENT_INDEX;
+}
+
+size_t PaletteImageData::getMemoryUsage() const {
+    return dataSize + sizeof(RetroColorPalette);
+}
+
+void PaletteImageData::setPalette(const RetroColorPalette& newPalette) {
+    palette = newPalette;
+}
+
+// ===== PaletteRleImageData 実装 =====
+
+PaletteRleImageData::PaletteRleImageData(const uint8_t* rleData, const uint16_t* offsets, int w, int h,
+                                         const RetroColorPalette* customPalette)
+    : data(rleData), rowOffsets(offsets), width(w), height(h) {
+    dataSize = (offsets && h > 0) ? offsets[h] : 0;
+
+    if (customPalette) {
+        palette = *customPalette;
+    }
+
+    ESP_LOGI(TAG, "PaletteRleImageData created: %dx%d, %zu bytes (raw %d bytes)",
+             width, height, dataSize, (width * height + 1) / 2);
+}
+
+uint8_t PaletteRleImageData::getPixelIndex(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return RetroColorPalette::TRANSPARENT_INDEX;  // 範囲外は透明
+    }
+
+    const uint8_t* p = data + rowOffsets[y];
+    int pos = 0;
+    while (pos < width) {
+        uint8_t token = *p++;
+        int len = (token & 0x7F) + 1;
+        if (x < pos + len) {
+            int i = x - pos;
+            if (token & RUN_FLAG) {
+                return (i & 1) ? (*p >> 4) : (*p & 0x0F);
+            }
+            return (i & 1) ? (p[i >> 1] >> 4) : (p[i >> 1] & 0x0F);
+        }
+        p += (token & RUN_FLAG) ? 1 : (len + 1) >> 1;
+        pos += len;
+    }
+    return RetroColorPalette::TRANSPARENT_INDEX;
+}
+
+uint16_t PaletteRleImageData::getPixelColor(int x, int y) const {
+    uint8_t index = getPixelIndex(x, y);
+    return palette.colors[index];
+}
+
+bool PaletteRleImageData::isTransparent(int x, int y) const {
+    return getPixelIndex(x, y) == RetroColorPalette::TRANSPARENT_INDEX;
+}
+
+size_t PaletteRleImageData::getMemoryUsage() const {
+    return dataSize + (height + 1) * sizeof(uint16_t) + sizeof(RetroColorPalette);
+}
+
+void PaletteRleImageData::setPalette(const RetroColorPalette& newPalette) {
+    palette = newPalette;
+}
+
+// ===== MonoImageData 実装 =====
+
+MonoImageData::MonoImageData(const uint8_t* bitmap, int w, int h, uint16_t color1, uint16_t color0)
+    : data(bitmap), width(w), height(h) {
+    colors[0] = color0;
+    colors[1] = color1;
+    rowBytes = (w + 7) / 8;
+    dataSize = (size_t)rowBytes * h;
+
+    ESP_LOGI(TAG, "MonoImageData created: %dx%d, %zu bytes", width, height, dataSize);
+}
+
+uint8_t MonoImageData::getPixelBit(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return 0;  // 範囲外はビット0
+    }
+    return (data[y * rowBytes + (x >> 3)] >> (7 - (x & 7))) & 1;
+}
+
+uint16_t MonoImageData::getPixelColor(int x, int y) const {
+    return colors[getPixelBit(x, y)];
+}
+
+size_t MonoImageData::getMemoryUsage() const {
+    return dataSize + sizeof(colors);
+}
+
+void MonoImageData::setColors(uint16_t color1, uint16_t color0) {
+    colors[0] = color0;
+    colors[1] = color1;
+}
+
+// ===== PaletteImageRenderer 実装 =====
+
+PaletteImageRenderer::PaletteImageRenderer(LGFX_ST7789P3_76x284* gfx, M5Canvas* cnv) 
+    : display(gfx), canvas(cnv), canvasOwned(false), lineBuffer(nullptr), bufferSize(0),
+      scaleXMap(nullptr), scaleRowIndex(nullptr), scaleBufferSize(0), assetCache(nullptr), dirtyCount(0),
+      frontCanvas(nullptr), secondaryCanvas(nullptr), pushTask(nullptr), pushDone(nullptr),
+      pushTaskStop(false), pushX(0), pushY(0) {
+    ESP_LOGI(TAG, "PaletteImageRenderer created with external canvas");
+}
+
+PaletteImageRenderer::PaletteImageRenderer(LGFX_ST7789P3_76x284* gfx, int canvasWidth, int canvasHeight) 
+    : display(gfx), canvasOwned(true), lineBuffer(nullptr), bufferSize(0),
+      scaleXMap(nullptr), scaleRowIndex(nullptr), scaleBufferSize(0), assetCache(nullptr), dirtyCount(0),
+      frontCanvas(nullptr), secondaryCanvas(nullptr), pushTask(nullptr), pushDone(nullptr),
+      pushTaskStop(false), pushX(0), pushY(0) {
+    canvas = RetroRenderPool::acquireCanvas(gfx, canvasWidth, canvasHeight, 16);
+    ESP_LOGI(TAG, "PaletteImageRenderer created with %dx%d canvas", canvasWidth, canvasHeight);
+}
+
+PaletteImageRenderer::PaletteImageRenderer(LGFX_ST7789P3_76x284* gfx, int canvasWidth, int canvasHeight,
+                                           const RetroColorPalette& palette) 
+    : display(gfx), canvasOwned(true), lineBuffer(nullptr), bufferSize(0),
+      scaleXMap(nullptr), scaleRowIndex(nullptr), scaleBufferSize(0), assetCache(nullptr), dirtyCount(0),
+      frontCanvas(nullptr), secondaryCanvas(nullptr), pushTask(nullptr), pushDone(nullptr),
+      pushTaskStop(false), pushX(0), pushY(0) {
+    canvas = RetroRenderPool::acquireCanvas(gfx, canvasWidth, canvasHeight, 4);
+    setCanvasPalette(palette);
+    ESP_LOGI(TAG, "PaletteImageRenderer created with %dx%d 4bit canvas", canvasWidth, canvasHeight);
+}
+
+PaletteImageRenderer::~PaletteImageRenderer() {
+    disableDoubleBuffer();
+    RetroRenderPool::releaseBuffer(lineBuffer);
+    RetroRenderPool::releaseBuffer(scaleXMap);
+    RetroRenderPool::releaseBuffer(scaleRowIndex);
+    RetroRenderPool::releaseBuffer(profile.samples);
+    if (canvasOwned) {
+        RetroRenderPool::releaseCanvas(canvas);
+    }
+    ESP_LOGI(TAG, "PaletteImageRenderer destroyed");
+}
+
+void PaletteImageRenderer::initLineBuffer(int maxWidth) {
+    RetroRenderPool::releaseBuffer(lineBuffer);
+    bufferSize = maxWidth;
+    lineBuffer = (uint16_t*)RetroRenderPool::acquireBuffer(bufferSize * sizeof(uint16_t));
+    ESP_LOGI(TAG, "Line buffer initialized: %zu bytes", bufferSize * sizeof(uint16_t));
+}
+
+/**
+ * 変換テーブルで1行分を展開（バイトスワップ済みRGB565）
+ * 出力が4バイト境界に揃っていれば1ソースバイトにつき32bitストア1回
+ * @param dst 出力先
+ * @param src ソースの先頭バイト
+ * @param nibble 先頭ピクセルの位置（0=下位4bit, 1=上位4bit）
+ * @param count ピクセル数
+ * @param pairs 変換テーブル
+ */
+static inline RETRO_BLIT_IRAM void expandSpan565(uint16_t* dst, const uint8_t* src, int nibble, int count, const uint32_t* pairs) {
+    if (count <= 0) return;
+    
+    // 先頭を4バイト境界に揃える
+    if ((uintptr_t)dst & 2) {
+        uint32_t v = pairs[*src];
+        *dst++ = nibble ? (uint16_t)(v >> 16) : (uint16_t)v;
+        src += nibble;
+        nibble ^= 1;
+        count--;
+    }
+    
+    uint32_t* dst32 = (uint32_t*)dst;
+    if (nibble == 0) {
+        for (; count >= 2; count -= 2) {
+            *dst32++ = pairs[*src++];
+        }
+    } else {
+        // ソースが半バイトずれている場合は隣接バイトの上位/下位を組み合わせる
+        for (; count >= 2; count -= 2) {
+            *dst32++ = (pairs[src[0]] >> 16) | (pairs[src[1]] << 16);
+            src++;
+        }
+    }
+    
+    if (count) {
+        uint32_t v = pairs[*src];
+        *(uint16_t*)dst32 = nibble ? (uint16_t)(v >> 16) : (uint16_t)v;
+    }
+}
+
+bool PaletteImageRenderer::clipToCanvas(int imgWidth, int imgHeight, int offsetX, int offsetY,
+                                        int& srcX, int& srcY, int& width, int& height) const {
+    if (!canvas) return false;
+
+    int x0 = max(0, offsetX);
+    int y0 = max(0, offsetY);
+    int x1 = min((int)canvas->width(), offsetX + imgWidth);
+    int y1 = min((int)canvas->height(), offsetY + imgHeight);
+
+    if (x0 >= x1 || y0 >= y1) return false;
+
+    srcX = x0 - offsetX;
+    srcY = y0 - offsetY;
+    width = x1 - x0;
+    height = y1 - y0;
+    return true;
+}
+
+bool PaletteImageRenderer::clipRegionToCanvas(const PaletteImageData& img, int regionX, int regionY,
+                                              int regionWidth, int regionHeight, int offsetX, int offsetY,
+                                              int& srcX, int& srcY, int& dstX, int& dstY,
+                                              int& width, int& height) const {
+    // 領域を画像範囲でクリップ（はみ出した分だけ描画位置もずらす）
+    if (regionX < 0) {
+        offsetX -= regionX;
+        regionWidth += regionX;
+        regionX = 0;
+    }
+    if (regionY < 0) {
+        offsetY -= regionY;
+        regionHeight += regionY;
+        regionY = 0;
+    }
+    regionWidth = min(regionWidth, img.width - regionX);
+    regionHeight = min(regionHeight, img.height - regionY);
+    if (regionWidth <= 0 || regionHeight <= 0) return false;
+
+    int clipX, clipY;
+    if (!clipToCanvas(regionWidth, regionHeight, offsetX, offsetY, clipX, clipY, width, height)) return false;
+
+    srcX = regionX + clipX;
+    srcY = regionY + clipY;
+    dstX = offsetX + clipX;
+    dstY = offsetY + clipY;
+    return true;
+}
+
+uint16_t* PaletteImageRenderer::getCanvasBuffer16() const {
+    if (!canvas || canvas->getColorDepth() != lgfx::rgb565_2Byte) return nullptr;
+    return (uint16_t*)canvas->getBuffer();
+}
+
+uint8_t* PaletteImageRenderer::getCanvasBuffer4() const {
+    if (!canvas || canvas->getColorDepth() != lgfx::palette_4bit) return nullptr;
+    return (uint8_t*)canvas->getBuffer();
+}
+
+/**
+ * 4bitキャンバスへ1行分のインデックスをコピー
+ * ソースは偶数ピクセルが下位4bit、キャンバスは偶数ピクセルが上位4bit
+ * @param dstRow キャンバス行の先頭
+ * @param dstX 行内の書き込み開始X
+ * @param src ソースの先頭バイト
+ * @param nibble 先頭ピクセルの位置（0=下位4bit, 1=上位4bit）
+ * @param count ピクセル数
+ * @param transparent 透明インデックスを書き込まないか
+ */
+static inline RETRO_BLIT_IRAM void copySpan4(uint8_t* dstRow, int dstX, const uint8_t* src, int nibble, int count, bool transparent) {
+    uint8_t* dst = dstRow + (dstX >> 1);
+    
+    // 先頭がバイトの後半（下位4bit）なら1ピクセル単独で書き込む
+    if ((dstX & 1) && count > 0) {
+        uint8_t v = nibble ? (*src >> 4) : (*src & 0x0F);
+        src += nibble;
+        nibble ^= 1;
+        if (!transparent || v != RetroColorPalette::TRANSPARENT_INDEX) {
+            *dst = (*dst & 0xF0) | v;
+        }
+        dst++;
+        count--;
+    }
+    
+    for (; count >= 2; count -= 2) {
+        uint8_t packed;
+        if (nibble == 0) {
+            uint8_t b = *src++;
+            packed = (uint8_t)((b << 4) | (b >> 4));  // 並び替えのみ
+        } else {
+            packed = (src[0] & 0xF0) | (src[1] & 0x0F);
+            src++;
+        }
+        
+        if (transparent) {
+            uint8_t keep = ((packed & 0xF0) ? 0x00 : 0xF0) | ((packed & 0x0F) ? 0x00 : 0x0F);
+            if (keep == 0xFF) {
+                dst++;
+                continue;
+            }
+            packed |= *dst & keep;
+        }
+        *dst++ = packed;
+    }
+    
+    if (count) {
+        uint8_t v = nibble ? (*src >> 4) : (*src & 0x0F);
+        if (!transparent || v != RetroColorPalette::TRANSPARENT_INDEX) {
+            *dst = (*dst & 0x0F) | (v << 4);
+        }
+    }
+}
+
+void PaletteImageRenderer::drawToIndexedCanvas(const PaletteImageData& img, const uint8_t* data,
+                                               int regionX, int regionY, int regionWidth, int regionHeight,
+                                               int offsetX, int offsetY, bool useTransparency) {
+    uint8_t* frameBuffer = getCanvasBuffer4();
+    if (!frameBuffer) return;
+    
+    int srcX, srcY, dstX, dstTop, width, height;
+    if (!clipRegionToCanvas(img, regionX, regionY, regionWidth, regionHeight, offsetX, offsetY,
+                            srcX, srcY, dstX, dstTop, width, height)) return;
+    
+    markDirty(dstX, dstTop, width, height);
+    addProfilePixels(width, height);
+    
+    const int rowBytes = (canvas->width() + 1) / 2;
+    for (int row = 0; row < height; row++) {
+        const int dstY = dstTop + row;
+        int pixelIndex = (srcY + row) * img.width + srcX;
+        copySpan4(frameBuffer + dstY * rowBytes, dstX, data + (pixelIndex >> 1),
+                  pixelIndex & 1, width, useTransparency);
+    }
+}
+
+void PaletteImageRenderer::drawToCanvas(const PaletteImageData& img, int offsetX, int offsetY, bool useTransparency) {
+    ProfileScope scope(this, STAGE_BLIT);
+    drawRegionToCanvas(img, 0, 0, img.width, img.height, offsetX, offsetY, useTransparency);
+}
+
+void PaletteImageRenderer::drawRegionToCanvas(const PaletteImageData& img, int regionX, int regionY,
+                                              int regionWidth, int regionHeight,
+                                              int offsetX, int offsetY, bool useTransparency) {
+    if (!canvas) return;
+    ProfileScope scope(this, STAGE_BLIT);
+    drawRegionWithData(img, resolveImageData(img), regionX, regionY, regionWidth, regionHeight,
+                       offsetX, offsetY, useTransparency);
+}
+
+void PaletteImageRenderer::drawRegionWithData(const PaletteImageData& img, const uint8_t* data,
+                                              int regionX, int regionY, int regionWidth, int regionHeight,
+                                              int offsetX, int offsetY, bool useTransparency) {
+    int srcX, srcY, dstX, dstTop, width, height;
+    if (!clipRegionToCanvas(img, regionX, regionY, regionWidth, regionHeight, offsetX, offsetY,
+                            srcX, srcY, dstX, dstTop, width, height)) return;
+    if (blitSpecialized(img, data, srcY * img.width + srcX, img.width, dstX, dstTop, width, height,
+                        BLIT_MODE_NORMAL, 0, 0, useTransparency)) return;
+    
+    // 4bitキャンバスはインデックスをそのままコピー
+    if (getCanvasBuffer4()) {
+        drawToIndexedCanvas(img, data, regionX, regionY, regionWidth, regionHeight, offsetX, offsetY, useTransparency);
+        return;
+    }
+    
+    // 透明色を使用しない場合は高速描画
+    if (!useTransparency) {
+        drawRegionOpaque(img, data, regionX, regionY, regionWidth, regionHeight, offsetX, offsetY);
+        return;
+    }
+
+    const RetroColorPalette::PixelPairLut* lut = img.palette.getPairLut();
+    if (!lut) return;
+    
+    markDirty(dstX, dstTop, width, height);
+    addProfilePixels(width, height);
+
+    // 16bitキャンバスなら直接書き込み、それ以外はラインバッファ経由でpushImage
+    uint16_t* frameBuffer = getCanvasBuffer16();
+    const int stride = canvas->width();
+    if (!frameBuffer && (!lineBuffer || bufferSize < (size_t)width)) {
+        initLineBuffer(width);
+    }
+
+    for (int row = 0; row < height; row++) {
+        const int dstY = dstTop + row;
+
+        // 行頭のピクセル位置（偶数: 下位4bit、奇数: 上位4bit）
+        int pixelIndex = (srcY + row) * img.width + srcX;
+        const uint8_t* src = data + (pixelIndex >> 1);
+        int nibble = pixelIndex & 1;
+
+        uint16_t* out = frameBuffer ? frameBuffer + dstY * stride + dstX : lineBuffer;
+
+        int x = 0;
+        while (x < width) {
+            // 透明ランをスキップ（バイト境界では2ピクセルまとめて判定）
+            while (x < width) {
+                uint8_t mask = lut->opaqueMask[*src];
+                if (nibble == 0 && mask == 0 && x + 1 < width) {
+                    src++;
+                    x += 2;
+                    continue;
+                }
+                if (mask & (1 << nibble)) break;
+                src += nibble;
+                nibble ^= 1;
+                x++;
+            }
+
+            // 不透明ランを展開
+            const int runStart = x;
+            while (x < width) {
+                uint8_t mask = lut->opaqueMask[*src];
+                uint32_t pair = lut->pairs[*src];
+                if (nibble == 0 && mask == 0x03 && x + 1 < width) {
+                    out[x] = (uint16_t)pair;
+                    out[x + 1] = (uint16_t)(pair >> 16);
+                    src++;
+                    x += 2;
+                    continue;
+                }
+                if (!(mask & (1 << nibble))) break;
+                out[x] = nibble ? (uint16_t)(pair >> 16) : (uint16_t)pair;
+                src += nibble;
+                nibble ^= 1;
+                x++;
+            }
+
+            if (!frameBuffer && x > runStart) {
+                canvas->pushImage(dstX + runStart, dstY, x - runStart, 1,
+                                  (const lgfx::swap565_t*)(lineBuffer + runStart));
+            }
+        }
+    }
+}
+
+void PaletteImageRenderer::drawToCanvasOpaque(const PaletteImageData& img, int offsetX, int offsetY) {
+    if (!canvas) return;
+    ProfileScope scope(this, STAGE_BLIT);
+    drawRegionOpaque(img, resolveImageData(img), 0, 0, img.width, img.height, offsetX, offsetY);
+}
+
+void PaletteImageRenderer::drawRegionOpaque(const PaletteImageData& img, const uint8_t* data,
+                                            int regionX, int regionY, int regionWidth, int regionHeight,
+                                            int offsetX, int offsetY) {
+    if (!canvas) return;
+    
+    int srcX, srcY, dstX, dstTop, width, height;
+    if (!clipRegionToCanvas(img, regionX, regionY, regionWidth, regionHeight, offsetX, offsetY,
+                            srcX, srcY, dstX, dstTop, width, height)) return;
+    if (blitSpecialized(img, data, srcY * img.width + srcX, img.width, dstX, dstTop, width, height,
+                        BLIT_MODE_NORMAL, 0, 0, false)) return;
+    
+    if (getCanvasBuffer4()) {
+        drawToIndexedCanvas(img, data, regionX, regionY, regionWidth, regionHeight, offsetX, offsetY, false);
+        return;
+    }
+    
+    const RetroColorPalette::PixelPairLut* lut = img.palette.getPairLut();
+    if (!lut) return;
+    
+    markDirty(dstX, dstTop, width, height);
+    addProfilePixels(width, height);
+    
+    // 16bitキャンバスなら直接書き込み、それ以外はラインバッファ経由でpushImage
+    uint16_t* frameBuffer = getCanvasBuffer16();
+    const int stride = canvas->width();
+    if (!frameBuffer && (!lineBuffer || bufferSize < (size_t)width)) {
+        initLineBuffer(width);
+    }
+    
+    for (int row = 0; row < height; row++) {
+        const int dstY = dstTop + row;
+        int pixelIndex = (srcY + row) * img.width + srcX;
+        
+        uint16_t* out = frameBuffer ? frameBuffer + dstY * stride + dstX : lineBuffer;
+        expandSpan565(out, data + (pixelIndex >> 1), pixelIndex & 1, width, lut->pairs);
+        
+        if (!frameBuffer) {
+            canvas->pushImage(dstX, dstY, width, 1, (const lgfx::swap565_t*)lineBuffer);
+        }
+    }
+}
+
+/**
+ * 16bitバッファを2ピクセル周期の模様で塗りつぶし
+ * 出力を4バイト境界に揃えて2ピクセルずつ書き込む
+ * @param dst 出力先
+ * @param pair 下位16bit: 先頭ピクセル, 上位16bit: 次のピクセル（バイトスワップ済み）
+ * @param count ピクセル数
+ */
+static inline RETRO_BLIT_IRAM void fillSpan565(uint16_t* dst, uint32_t pair, int count) {
+    if (count <= 0) return;
+
+    if ((uintptr_t)dst & 2) {
+        *dst++ = (uint16_t)pair;
+        pair = (pair >> 16) | (pair << 16);
+        count--;
+    }
+
+    uint32_t* dst32 = (uint32_t*)dst;
+    for (; count >= 2; count -= 2) {
+        *dst32++ = pair;
+    }
+
+    if (count) {
+        *(uint16_t*)dst32 = (uint16_t)pair;
+    }
+}
+
+/**
+ * 4bitキャンバスの1行を2ピクセル周期の模様で塗りつぶし
+ * @param dstRow キャンバス行の先頭
+ * @param dstX 行内の書き込み開始X
+ * @param pattern 下位4bit: 先頭ピクセル, 上位4bit: 次のピクセル（ソースの配置）
+ * @param count ピクセル数
+ */
+static inline RETRO_BLIT_IRAM void fillSpan4(uint8_t* dstRow, int dstX, uint8_t pattern, int count) {
+    uint8_t* dst = dstRow + (dstX >> 1);
+
+    if ((dstX & 1) && count > 0) {
+        *dst = (*dst & 0xF0) | (pattern & 0x0F);
+        pattern = (uint8_t)((pattern << 4) | (pattern >> 4));
+        dst++;
+        count--;
+    }
+
+    // キャンバスは偶数ピクセルが上位4bitなので並び替えて書き込む
+    if (count >= 2) {
+        memset(dst, (uint8_t)((pattern << 4) | (pattern >> 4)), count >> 1);
+        dst += count >> 1;
+    }
+
+    if (count & 1) {
+        *dst = (*dst & 0x0F) | (pattern << 4);
+    }
+}
+
+/**
+ * リテラルの指定ピクセルのインデックスを取得
+ * @param src リテラルデータの先頭（偶数ピクセルが下位4bit）
+ * @param i ピクセル位置
+ * @return パレットインデックス
+ */
+static inline RETRO_BLIT_IRAM uint8_t literalIndexAt(const uint8_t* src, int i) {
+    return (i & 1) ? (src[i >> 1] >> 4) : (src[i >> 1] & 0x0F);
+}
+
+/**
+ * 進み幅つきで1行分を展開（バイトスワップ済みRGB565）
+ * 左右反転（step=-1）は1ソースバイトから上位→下位の順に2ピクセルを取り出し、
+ * 回転（step=±画像幅）は1ピクセルごとに変換テーブルを引く
+ * @param dst 出力先
+ * @param data 画像データの先頭
+ * @param p 先頭ピクセルのソース位置
+ * @param step 1ピクセル進むごとのソース位置の増分
+ * @param count ピクセル数
+ * @param lut 変換テーブル
+ * @param transparent 透明インデックスを書き込まないか
+ */
+static inline RETRO_BLIT_IRAM void expandSpanStep565(uint16_t* dst, const uint8_t* data, int p, int step, int count,
+                                     const RetroColorPalette::PixelPairLut* lut, bool transparent) {
+    int x = 0;
+    
+    if (step == -1) {
+        // 下位4bitから始まる場合は1ピクセル単独で処理して上位4bitに揃える
+        if (!(p & 1) && count > 0) {
+            uint8_t b = data[p >> 1];
+            if (!transparent || (lut->opaqueMask[b] & 0x01)) {
+                dst[0] = (uint16_t)lut->pairs[b];
+            }
+            p--;
+            x++;
+        }
+        
+        for (; x + 1 < count; x += 2, p -= 2) {
+            uint8_t b = data[p >> 1];
+            uint32_t pair = lut->pairs[b];
+            if (!transparent) {
+                dst[x] = (uint16_t)(pair >> 16);
+                dst[x + 1] = (uint16_t)pair;
+                continue;
+            }
+            uint8_t mask = lut->opaqueMask[b];
+            if (mask & 0x02) dst[x] = (uint16_t)(pair >> 16);
+            if (mask & 0x01) dst[x + 1] = (uint16_t)pair;
+        }
+    }
+    
+    for (; x < count; x++, p += step) {
+        uint8_t b = data[p >> 1];
+        uint8_t index = (p & 1) ? (b >> 4) : (b & 0x0F);
+        if (!transparent || index != RetroColorPalette::TRANSPARENT_INDEX) {
+            dst[x] = (uint16_t)lut->pairs[index];
+        }
+    }
+}
+
+/**
+ * 4bitキャンバスのバイトに2ピクセル分を書き込む
+ * @param dst 書き込み先（書き込み後に1進む）
+ * @param packed 上位4bit: 左ピクセル, 下位4bit: 右ピクセル
+ * @param transparent 透明インデックスを書き込まないか
+ */
+static inline RETRO_BLIT_IRAM void storePacked4(uint8_t*& dst, uint8_t packed, bool transparent) {
+    if (transparent) {
+        uint8_t keep = ((packed & 0xF0) ? 0x00 : 0xF0) | ((packed & 0x0F) ? 0x00 : 0x0F);
+        if (keep == 0xFF) {
+            dst++;
+            return;
+        }
+        packed |= *dst & keep;
+    }
+    *dst++ = packed;
+}
+
+/**
+ * 進み幅つきで4bitキャンバスへ1行分のインデックスをコピー
+ * 左右反転でソースが上位4bitから始まる場合は、ソースの並び（上位→下位）が
+ * キャンバスの並びと一致するので1バイトずつそのままコピーする
+ * @param dstRow キャンバス行の先頭
+ * @param dstX 行内の書き込み開始X
+ * @param data 画像データの先頭
+ * @param p 先頭ピクセルのソース位置
+ * @param step 1ピクセル進むごとのソース位置の増分
+ * @param count ピクセル数
+ * @param transparent 透明インデックスを書き込まないか
+ */
+static inline RETRO_BLIT_IRAM void copySpanStep4(uint8_t* dstRow, int dstX, const uint8_t* data, int p, int step, int count,
+                                 bool transparent) {
+    uint8_t* dst = dstRow + (dstX >> 1);
+    int x = 0;
+    
+    // 先頭がバイトの後半（下位4bit）なら1ピクセル単独で書き込む
+    if ((dstX & 1) && count > 0) {
+        uint8_t v = literalIndexAt(data, p);
+        if (!transparent || v != RetroColorPalette::TRANSPARENT_INDEX) {
+            *dst = (*dst & 0xF0) | v;
+        }
+        dst++;
+        p += step;
+        x++;
+    }
+    
+    if (step == -1 && (p & 1)) {
+        for (; x + 1 < count; x += 2, p -= 2) {
+            storePacked4(dst, data[p >> 1], transparent);
+        }
+    } else if (step == -1) {
+        // ソースが半バイトずれている場合は隣接バイトの下位/上位を組み合わせる
+        for (; x + 1 < count; x += 2, p -= 2) {
+            const uint8_t* src = data + (p >> 1);
+            storePacked4(dst, (uint8_t)((src[0] << 4) | (src[-1] >> 4)), transparent);
+        }
+    } else {
+        for (; x + 1 < count; x += 2, p += 2 * step) {
+            storePacked4(dst, (uint8_t)((literalIndexAt(data, p) << 4) | literalIndexAt(data, p + step)), transparent);
+        }
+    }
+    
+    if (x < count) {
+        uint8_t v = literalIndexAt(data, p);
+        if (!transparent || v != RetroColorPalette::TRANSPARENT_INDEX) {
+            *dst = (*dst & 0x0F) | (v << 4);
+        }
+    }
+}
+
+// ===== コンパイル時特殊化ブリッター =====
+// 透明色の有無・左右反転・整数倍率・出力深度をテンプレート引数にして、
+// 行ループ内の分岐をコンパイル時に消した描画関数を作る
+// どの組み合わせを作るかは Kconfig（CSBOARD_BLIT_TEMPLATES*）で選び、作らなかった組み合わせは汎用版で描く
+
+/**
+ * 特殊化ブリッター1回分の描画内容
+ * 出力行rのソース行は、等倍ならr、拡大なら (phaseY + r) / 倍率
+ */
+struct BlitJob {
+    uint8_t* dst;                                // 出力先の先頭行
+    int dstStride;                               // 出力の1行のバイト数
+    int dstX;                                    // 行内の書き込み開始X
+    const uint8_t* data;                         // 画像データ
+    int srcPixel;                                // 先頭行の先頭ピクセルのソース位置
+    int srcRowStep;                              // ソース行の増分（上下反転時は負）
+    int width, height;                           // 出力のピクセル数・行数
+    int phaseX, phaseY;                          // 拡大時の先頭ピクセル・先頭行の拡大内の位置
+    const RetroColorPalette::PixelPairLut* lut;  // 変換テーブル（16bit出力のみ）
+};
+
+typedef void (*BlitFn)(const BlitJob& job);
+
+/**
+ * 16bit出力に同じインデックスの色をn個書き込む
+ * @param dst 出力先
+ * @param index パレットインデックス
+ * @param n ピクセル数
+ * @param lut 変換テーブル
+ */
+template <bool Transparent>
+FORCE_INLINE_ATTR void fillIndex565(uint16_t* dst, uint8_t index, int n, const RetroColorPalette::PixelPairLut* lut) {
+    if (Transparent && index == RetroColorPalette::TRANSPARENT_INDEX) return;
+    const uint16_t color = (uint16_t)lut->pairs[index];  // 上位4bitが0のバイト＝インデックス単色
+    for (int k = 0; k < n; k++) {
+        dst[k] = color;
+    }
+}
+
+/**
+ * 等倍で16bit出力へ1行分を展開
+ * 1ソースバイトの2ピクセルを順方向なら下位→上位、左右反転なら上位→下位の順に書き込む
+ * @param dst 出力先
+ * @param data 画像データの先頭
+ * @param p 先頭ピクセルのソース位置
+ * @param count ピクセル数
+ * @param lut 変換テーブル
+ */
+template <bool Transparent, bool FlipX>
+FORCE_INLINE_ATTR void blitSpan565(uint16_t* dst, const uint8_t* data, int p, int count,
+                               const RetroColorPalette::PixelPairLut* lut) {
+    if constexpr (!Transparent && !FlipX) {
+        // 不透明の順方向は32bitストアの展開がそのまま使える
+        expandSpan565(dst, data + (p >> 1), p & 1, count, lut->pairs);
+        return;
+    }
+    
+    constexpr int step = FlipX ? -1 : 1;
+    constexpr int leadNibble = FlipX ? 1 : 0;   // ペアの1つ目になる位置
+    constexpr uint8_t firstMask = FlipX ? 0x02 : 0x01;
+    constexpr uint8_t secondMask = FlipX ? 0x01 : 0x02;
+    int x = 0;
+    
+    if (count > 0 && (p & 1) != leadNibble) {
+        fillIndex565<Transparent>(dst, literalIndexAt(data, p), 1, lut);
+        p += step;
+        x++;
+    }
+    
+    for (; x + 1 < count; x += 2, p += 2 * step) {
+        const uint8_t b = data[p >> 1];
+        const uint32_t pair = lut->pairs[b];
+        const uint16_t first = FlipX ? (uint16_t)(pair >> 16) : (uint16_t)pair;
+        const uint16_t second = FlipX ? (uint16_t)pair : (uint16_t)(pair >> 16);
+        if constexpr (Transparent) {
+            const uint8_t mask = lut->opaqueMask[b];
+            if (mask & firstMask) dst[x] = first;
+            if (mask & secondMask) dst[x + 1] = second;
+        } else {
+            dst[x] = first;
+            dst[x + 1] = second;
+        }
+    }
+    
+    if (x < count) {
+        fillIndex565<Transparent>(dst + x, literalIndexAt(data, p), 1, lut);
+    }
+}
+
+/**
+ * 整数倍で16bit出力へ1行分を展開（ソース1ピクセルをScale個並べる）
+ * @param dst 出力先
+ * @param data 画像データの先頭
+ * @param p 先頭ピクセルのソース位置
+ * @param phase 先頭ピクセルの拡大内の位置（0〜Scale-1）
+ * @param count ピクセル数
+ * @param lut 変換テーブル
+ */
+template <bool Transparent, int Scale>
+FORCE_INLINE_ATTR void blitScaledSpan565(uint16_t* dst, const uint8_t* data, int p, int phase, int count,
+                                     const RetroColorPalette::PixelPairLut* lut) {
+    int x = 0;
+    
+    // 先頭ピクセルは拡大の途中から
+    if (phase && count > 0) {
+        x = min(Scale - phase, count);
+        fillIndex565<Transparent>(dst, literalIndexAt(data, p++), x, lut);
+    }
+    
+    for (; x + Scale <= count; x += Scale, p++) {
+        fillIndex565<Transparent>(dst + x, literalIndexAt(data, p), Scale, lut);
+    }
+    
+    if (x < count) {
+        fillIndex565<Transparent>(dst + x, literalIndexAt(data, p), count - x, lut);
+    }
+}
+
+/**
+ * 整数倍で4bitキャンバスへ1行分のインデックスを書き込む
+ * @param dstRow キャンバス行の先頭
+ * @param dstX 行内の書き込み開始X
+ * @param data 画像データの先頭
+ * @param p 先頭ピクセルのソース位置
+ * @param phase 先頭ピクセルの拡大内の位置（0〜Scale-1）
+ * @param count ピクセル数
+ */
+template <bool Transparent, int Scale>
+FORCE_INLINE_ATTR void blitScaledSpan4(uint8_t* dstRow, int dstX, const uint8_t* data, int p, int phase, int count) {
+    int x = 0;
+    while (x < count) {
+        const uint8_t index = literalIndexAt(data, p++);
+        const int n = min(Scale - phase, count - x);
+        phase = 0;
+        if (!Transparent || index != RetroColorPalette::TRANSPARENT_INDEX) {
+            fillSpan4(dstRow, dstX + x, (uint8_t)(index * 0x11), n);
+        }
+        x += n;
+    }
+}
+
+/**
+ * 特殊化した行ループ本体
+ * 不透明の拡大では、同じソース行が続く出力行を直前の行のコピーで済ませる
+ * 関数テンプレートにはsection属性（IRAM_ATTR）が効かないため、テンプレートは全て
+ * 組み合わせごとの通常の関数（DEFINE_BLIT_KERNEL）に必ずインライン展開する
+ * @param job 描画内容
+ */
+template <int Depth, bool Transparent, bool FlipX, int Scale>
+FORCE_INLINE_ATTR void blitRows(const BlitJob& job) {
+    int prevSrcRow = -1;
+    for (int row = 0; row < job.height; row++) {
+        const int srcRow = (Scale == 1) ? row : (job.phaseY + row) / Scale;
+        const int p = job.srcPixel + srcRow * job.srcRowStep;
+        uint8_t* dstRow = job.dst + row * job.dstStride;
+        const bool repeatedRow = (Scale > 1 && !Transparent && srcRow == prevSrcRow);
+        prevSrcRow = srcRow;
+        
+        if constexpr (Depth == 16) {
+            uint16_t* out = (uint16_t*)dstRow + job.dstX;
+            if (repeatedRow) {
+                memcpy(out, (uint16_t*)(dstRow - job.dstStride) + job.dstX, job.width * sizeof(uint16_t));
+            } else if constexpr (Scale > 1) {
+                blitScaledSpan565<Transparent, Scale>(out, job.data, p, job.phaseX, job.width, job.lut);
+            } else {
+                blitSpan565<Transparent, FlipX>(out, job.data, p, job.width, job.lut);
+            }
+        } else {
+            if (repeatedRow && !(job.dstX & 1) && !(job.width & 1)) {
+                memcpy(dstRow + (job.dstX >> 1), dstRow - job.dstStride + (job.dstX >> 1), job.width >> 1);
+            } else if constexpr (Scale > 1) {
+                blitScaledSpan4<Transparent, Scale>(dstRow, job.dstX, job.data, p, job.phaseX, job.width);
+            } else if constexpr (FlipX) {
+                copySpanStep4(dstRow, job.dstX, job.data, p, -1, job.width, Transparent);
+            } else {
+                copySpan4(dstRow, job.dstX, job.data + (p >> 1), p & 1, job.width, Transparent);
+            }
+        }
+    }
+}
+
+// 組み合わせごとの描画関数（名前は blit<深度>_<透明色>_<左右反転>_<倍率>）
+#define BLIT_KERNEL_NAME(depth, transparent, flipX, scale) blit##depth##_##transparent##_##flipX##_##scale
+#define DEFINE_BLIT_KERNEL(depth, transparent, flipX, scale)                            \
+    static RETRO_BLIT_IRAM void BLIT_KERNEL_NAME(depth, transparent, flipX, scale)(const BlitJob& job) { \
+        blitRows<depth, transparent, flipX, scale>(job);                                \
+    }
+
+// Kconfigで外した組み合わせは作らずnullptr（汎用版で描く）
+#if CONFIG_CSBOARD_BLIT_TEMPLATES
+#define BLIT_KERNEL(depth, transparent, flipX, scale) BLIT_KERNEL_NAME(depth, transparent, flipX, scale)
+#define DEFINE_BLIT_NORMAL_KERNELS(depth) \
+    DEFINE_BLIT_KERNEL(depth, false, false, 1) DEFINE_BLIT_KERNEL(depth, true, false, 1)
+#else
+#define BLIT_KERNEL(depth, transparent, flipX, scale) nullptr
+#define DEFINE_BLIT_NORMAL_KERNELS(depth)
+#endif
+
+#if CONFIG_CSBOARD_BLIT_TEMPLATES_FLIP
+#define BLIT_FLIP_KERNEL(depth, transparent) BLIT_KERNEL(depth, transparent, true, 1)
+#define DEFINE_BLIT_FLIP_KERNELS(depth) \
+    DEFINE_BLIT_KERNEL(depth, false, true, 1) DEFINE_BLIT_KERNEL(depth, true, true, 1)
+#else
+#define BLIT_FLIP_KERNEL(depth, transparent) nullptr
+#define DEFINE_BLIT_FLIP_KERNELS(depth)
+#endif
+
+#if CONFIG_CSBOARD_BLIT_TEMPLATES_INT_SCALE
+#define BLIT_SCALE_KERNEL(depth, transparent, scale) BLIT_KERNEL(depth, transparent, false, scale)
+#define DEFINE_BLIT_SCALE_KERNELS(depth)                                                \
+    DEFINE_BLIT_KERNEL(depth, false, false, 2) DEFINE_BLIT_KERNEL(depth, true, false, 2) \
+    DEFINE_BLIT_KERNEL(depth, false, false, 3) DEFINE_BLIT_KERNEL(depth, true, false, 3) \
+    DEFINE_BLIT_KERNEL(depth, false, false, 4) DEFINE_BLIT_KERNEL(depth, true, false, 4)
+#else
+#define BLIT_SCALE_KERNEL(depth, transparent, scale) nullptr
+#define DEFINE_BLIT_SCALE_KERNELS(depth)
+#endif
+
+#define DEFINE_BLIT_KERNELS(depth) \
+    DEFINE_BLIT_NORMAL_KERNELS(depth) DEFINE_BLIT_FLIP_KERNELS(depth) DEFINE_BLIT_SCALE_KERNELS(depth)
+
+DEFINE_BLIT_KERNELS(16)
+#if CONFIG_CSBOARD_BLIT_TEMPLATES_4BPP
+DEFINE_BLIT_KERNELS(4)
+#endif
+
+// BLIT_MODE_* の順
+#define BLIT_KERNEL_ROW(depth, transparent) {                                         \
+        BLIT_KERNEL(depth, transparent, false, 1), BLIT_FLIP_KERNEL(depth, transparent), \
+        BLIT_SCALE_KERNEL(depth, transparent, 2), BLIT_SCALE_KERNEL(depth, transparent, 3), \
+        BLIT_SCALE_KERNEL(depth, transparent, 4) }
+
+bool PaletteImageRenderer::blitSpecialized(const PaletteImageData& img, const uint8_t* data,
+                                           int srcPixel, int srcRowStep, int dstX, int dstY, int width, int height,
+                                           uint8_t mode, int phaseX, int phaseY, bool useTransparency) {
+    // [出力深度: 0=16bit, 1=4bit][透明色][行ループの種類]
+    static const BlitFn kernels[2][2][BLIT_MODE_COUNT] = {
+        { BLIT_KERNEL_ROW(16, false), BLIT_KERNEL_ROW(16, true) },
+#if CONFIG_CSBOARD_BLIT_TEMPLATES_4BPP
+        { BLIT_KERNEL_ROW(4, false), BLIT_KERNEL_ROW(4, true) },
+#else
+        {},
+#endif
+    };
+    static_assert(BLIT_MODE_SCALE2 + BLIT_MAX_INT_SCALE - 2 == BLIT_MODE_COUNT - 1,
+                  "BLIT_KERNEL_ROW must cover every integer scale");
+    
+    if (!canvas || !data || mode >= BLIT_MODE_COUNT) return false;
+    
+    uint8_t* buffer4 = getCanvasBuffer4();
+    uint16_t* buffer16 = buffer4 ? nullptr : getCanvasBuffer16();
+    if (!buffer4 && !buffer16) return false;  // LGFX経由の描画は汎用版
+    
+    const BlitFn kernel = kernels[buffer4 ? 1 : 0][useTransparency ? 1 : 0][mode];
+    if (!kernel) return false;
+    
+    BlitJob job;
+    job.lut = nullptr;
+    if (buffer4) {
+        job.dstStride = (canvas->width() + 1) / 2;
+        job.dst = buffer4 + dstY * job.dstStride;
+    } else {
+        job.lut = img.palette.getPairLut();
+        if (!job.lut) return false;
+        job.dstStride = canvas->width() * sizeof(uint16_t);
+        job.dst = (uint8_t*)(buffer16 + dstY * canvas->width());
+    }
+    job.dstX = dstX;
+    job.data = data;
+    job.srcPixel = srcPixel;
+    job.srcRowStep = srcRowStep;
+    job.width = width;
+    job.height = height;
+    job.phaseX = phaseX;
+    job.phaseY = phaseY;
+    
+    markDirty(dstX, dstY, width, height);
+    addProfilePixels(width, height);
+    kernel(job);
+    return true;
+}
+
+#undef BLIT_KERNEL_ROW
+#undef DEFINE_BLIT_KERNELS
+#undef DEFINE_BLIT_SCALE_KERNELS
+#undef BLIT_SCALE_KERNEL
+#undef DEFINE_BLIT_FLIP_KERNELS
+#undef BLIT_FLIP_KERNEL
+#undef DEFINE_BLIT_NORMAL_KERNELS
+#undef BLIT_KERNEL
+#undef DEFINE_BLIT_KERNEL
+#undef BLIT_KERNEL_NAME
+
+void PaletteImageRenderer::drawToCanvasTransformed(const PaletteImageData& img, int offsetX, int offsetY,
+                                                   uint8_t transform, bool useTransparency) {
+    if (!canvas || !img.data) return;
+    ProfileScope scope(this, STAGE_BLIT);
+    const uint8_t* data = resolveImageData(img);
+    
+    // 回転しない場合は、上下反転をソース行の増分の符号、左右反転を特殊化した行ループで扱う
+    if (!(transform & BLIT_ROTATE_90)) {
+        int clipX, clipY, width, height;
+        if (!clipToCanvas(img.width, img.height, offsetX, offsetY, clipX, clipY, width, height)) return;
+        const int srcX = (transform & BLIT_FLIP_H) ? img.width - 1 - clipX : clipX;
+        const int srcY = (transform & BLIT_FLIP_V) ? img.height - 1 - clipY : clipY;
+        if (blitSpecialized(img, data, srcY * img.width + srcX, (transform & BLIT_FLIP_V) ? -img.width : img.width,
+                            offsetX + clipX, offsetY + clipY, width, height,
+                            (transform & BLIT_FLIP_H) ? BLIT_MODE_FLIP_X : BLIT_MODE_NORMAL, 0, 0,
+                            useTransparency)) return;
+    }
+    
+    // 上下反転だけなら行の順番を入れ替えるだけで通常の行コピーがそのまま使える
+    if (!(transform & (BLIT_FLIP_H | BLIT_ROTATE_90))) {
+        if (!(transform & BLIT_FLIP_V)) {
+            drawRegionWithData(img, data, 0, 0, img.width, img.height, offsetX, offsetY, useTransparency);
+            return;
+        }
+        const int rowStart = max(0, -offsetY);
+        const int rowEnd = min((int)img.height, (int)canvas->height() - offsetY);
+        for (int row = rowStart; row < rowEnd; row++) {
+            drawRegionWithData(img, data, 0, img.height - 1 - row, img.width, 1, offsetX, offsetY + row, useTransparency);
+        }
+        return;
+    }
+    
+    const bool rotate = (transform & BLIT_ROTATE_90) != 0;
+    const int outWidth = rotate ? img.height : img.width;
+    const int outHeight = rotate ? img.width : img.height;
+    
+    int clipX, clipY, width, height;
+    if (!clipToCanvas(outWidth, outHeight, offsetX, offsetY, clipX, clipY, width, height)) return;
+    const int dstX = offsetX + clipX;
+    const int dstTop = offsetY + clipY;
+    
+    // 出力で1ピクセル右に進んだときのソース位置の増分
+    // 回転時は出力の行がソースの列になる（上下反転なら下向き、それ以外は上向きにたどる）
+    int step;
+    if (rotate) {
+        step = (transform & BLIT_FLIP_V) ? img.width : -img.width;
+    } else {
+        step = (transform & BLIT_FLIP_H) ? -1 : 1;
+    }
+    
+    uint8_t* indexedBuffer = getCanvasBuffer4();
+    const RetroColorPalette::PixelPairLut* lut = nullptr;
+    if (!indexedBuffer) {
+        lut = img.palette.getPairLut();
+        if (!lut) return;
+    }
+    
+    markDirty(dstX, dstTop, width, height);
+    addProfilePixels(width, height);
+    
+    // 16bitキャンバスなら直接書き込み、それ以外はラインバッファ経由でpushImage
+    uint16_t* frameBuffer = getCanvasBuffer16();
+    const int stride = canvas->width();
+    const int rowBytes = (stride + 1) / 2;
+    if (!indexedBuffer && !frameBuffer && (!lineBuffer || bufferSize < (size_t)width)) {
+        initLineBuffer(width);
+    }
+    
+    for (int row = 0; row < height; row++) {
+        const int dstY = dstTop + row;
+        
+        // 出力行の先頭ピクセル（clipX, clipY + row）に対応するソース座標
+        // 反転を先に、回転を後に適用する
+        int srcX = rotate ? clipY + row : clipX;
+        int srcY = rotate ? img.height - 1 - clipX : clipY + row;
+        if (transform & BLIT_FLIP_H) srcX = img.width - 1 - srcX;
+        if (transform & BLIT_FLIP_V) srcY = img.height - 1 - srcY;
+        const int pixelIndex = srcY * img.width + srcX;
+        
+        if (indexedBuffer) {
+            copySpanStep4(indexedBuffer + dstY * rowBytes, dstX, data, pixelIndex, step, width, useTransparency);
+            continue;
+        }
+        if (frameBuffer) {
+            expandSpanStep565(frameBuffer + dstY * stride + dstX, data, pixelIndex, step, width,
+                              lut, useTransparency);
+            continue;
+        }
+        
+        // ラインバッファには全ピクセルを展開し、不透明ランだけをpushImage
+        expandSpanStep565(lineBuffer, data, pixelIndex, step, width, lut, false);
+        int x = 0;
+        while (x < width) {
+            while (useTransparency && x < width &&
+                   literalIndexAt(data, pixelIndex + x * step) == RetroColorPalette::TRANSPARENT_INDEX) {
+                x++;
+            }
+            const int runStart = x;
+            while (x < width && (!useTransparency ||
+                   literalIndexAt(data, pixelIndex + x * step) != RetroColorPalette::TRANSPARENT_INDEX)) {
+                x++;
+            }
+            if (x > runStart) {
+                canvas->pushImage(dstX + runStart, dstY, x - runStart, 1,
+                                  (const lgfx::swap565_t*)(lineBuffer + runStart));
+            }
+        }
+    }
+}
+
+void PaletteImageRenderer::drawToCanvas(const PaletteRleImageData& img, int offsetX, int offsetY, bool useTransparency) {
+    if (!canvas || !img.data || !img.rowOffsets) return;
+    ProfileScope scope(this, STAGE_BLIT);
+
+    int srcX, srcY, width, height;
+    if (!clipToCanvas(img.width, img.height, offsetX, offsetY, srcX, srcY, width, height)) return;
+
+    // 4bitキャンバスはインデックスのまま書き込むので変換テーブル不要
+    uint16_t* frameBuffer16 = getCanvasBuffer16();
+    uint8_t* frameBuffer4 = getCanvasBuffer4();
+    const RetroColorPalette::PixelPairLut* lut = nullptr;
+    if (!frameBuffer4) {
+        lut = img.palette.getPairLut();
+        if (!lut) return;
+    }
+
+    markDirty(offsetX + srcX, offsetY + srcY, width, height);
+    addProfilePixels(width, height);
+
+    if (!frameBuffer16 && !frameBuffer4 && (!lineBuffer || bufferSize < (size_t)width)) {
+        initLineBuffer(width);
+    }
+
+    const int stride = canvas->width();
+    const int rowBytes = (canvas->width() + 1) / 2;
+    const int dstX = offsetX + srcX;
+    const int srcEnd = srcX + width;
+    uint8_t runPattern[PaletteRleImageData::MAX_TOKEN_PIXELS / 2 + 1];  // 模様ランのリテラル展開用
+    for (int row = 0; row < height; row++) {
+        const int dstY = offsetY + srcY + row;
+        const uint8_t* p = img.data + img.rowOffsets[srcY + row];
+
+        int pos = 0;
+        while (pos < srcEnd) {
+            // トークンを解読
+            uint8_t token = *p++;
+            const int len = (token & 0x7F) + 1;
+            const bool isRun = (token & PaletteRleImageData::RUN_FLAG) != 0;
+            const uint8_t* literal = p;
+            p += isRun ? 1 : (len + 1) >> 1;
+
+            // クリップ範囲との重なり
+            const int start = max(pos, srcX);
+            const int end = min(pos + len, srcEnd);
+            int skip = start - pos;
+            const int count = end - start;
+            const int x = dstX + (start - srcX);
+            pos += len;
+            if (count <= 0) continue;
+
+            if (isRun) {
+                // クリップで奇数ピクセル目から始まる場合は模様の位相を入れ替える
+                uint8_t pattern = *literal;
+                if (skip & 1) {
+                    pattern = (uint8_t)((pattern << 4) | (pattern >> 4));
+                }
+                const uint8_t first = pattern & 0x0F;
+                const uint8_t second = pattern >> 4;
+
+                // 透明ランは丸ごとスキップ
+                if (useTransparency && pattern == 0) continue;
+
+                // 片方だけ透明な模様はリテラルと同じ扱い（模様を並べたバッファを作る）
+                if (!(useTransparency && (first == 0 || second == 0))) {
+                    if (frameBuffer16) {
+                        fillSpan565(frameBuffer16 + dstY * stride + x, lut->pairs[pattern], count);
+                        continue;
+                    }
+                    if (frameBuffer4) {
+                        fillSpan4(frameBuffer4 + dstY * rowBytes, x, pattern, count);
+                        continue;
+                    }
+                    if (first == second) {
+                        canvas->fillRect(x, dstY, count, 1, img.palette.colors[first]);
+                        continue;
+                    }
+                }
+
+                memset(runPattern, pattern, (count + 1) >> 1);
+                literal = runPattern;
+                skip = 0;
+            }
+
+            if (frameBuffer4) {
+                copySpan4(frameBuffer4 + dstY * rowBytes, x, literal + (skip >> 1), skip & 1,
+                          count, useTransparency);
+                continue;
+            }
+
+            uint16_t* out = frameBuffer16 ? frameBuffer16 + dstY * stride + x : lineBuffer;
+            if (!useTransparency) {
+                expandSpan565(out, literal + (skip >> 1), skip & 1, count, lut->pairs);
+                if (!frameBuffer16) {
+                    canvas->pushImage(x, dstY, count, 1, (const lgfx::swap565_t*)lineBuffer);
+                }
+                continue;
+            }
+
+            // リテラル内の透明ピクセルを飛ばしながら不透明ランを書き込む
+            int i = 0;
+            while (i < count) {
+                while (i < count && literalIndexAt(literal, skip + i) == RetroColorPalette::TRANSPARENT_INDEX) {
+                    i++;
+                }
+                const int runStart = i;
+                while (i < count) {
+                    uint8_t v = literalIndexAt(literal, skip + i);
+                    if (v == RetroColorPalette::TRANSPARENT_INDEX) break;
+                    out[i] = (uint16_t)lut->pairs[v];
+                    i++;
+                }
+                if (!frameBuffer16 && i > runStart) {
+                    canvas->pushImage(x + runStart, dstY, i - runStart, 1,
+                                      (const lgfx::swap565_t*)(lineBuffer + runStart));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * 1bit画像の1行分をバイトスワップ済みRGB565に展開
+ * ソースのバイト境界ごとに区切り、8ピクセル揃ったバイトは4ピクセル単位の変換テーブル2回で書き込む
+ * @param dst 出力先
+ * @param row ソース行の先頭
+ * @param bitPos 先頭ピクセルのビット位置
+ * @param count ピクセル数
+ * @param lut 4ビット→4ピクセルの変換テーブル
+ * @param transparent ビット0を書き込まないか（全ビット0のバイトはスキップ）
+ */
+static inline void expandMono565(uint16_t* dst, const uint8_t* row, int bitPos, int count,
+                                 const uint16_t (*lut)[4], bool transparent) {
+    const uint16_t color0 = lut[0][0];
+    const uint16_t color1 = lut[15][0];
+    int x = 0;
+    while (x < count) {
+        const int shift = bitPos & 7;
+        const int n = min(8 - shift, count - x);
+        const uint8_t present = (uint8_t)(0xFF00 >> n);
+        const uint8_t v = (uint8_t)(row[bitPos >> 3] << shift) & present;
+        uint16_t* o = dst + x;
+        x += n;
+        bitPos += n;
+
+        if (transparent && v == 0) continue;
+        if (n == 8 && (!transparent || v == 0xFF)) {
+            memcpy(o, lut[v >> 4], 4 * sizeof(uint16_t));
+            memcpy(o + 4, lut[v & 0x0F], 4 * sizeof(uint16_t));
+            continue;
+        }
+        for (int k = 0; k < n; k++) {
+            if (v & (0x80 >> k)) {
+                o[k] = color1;
+            } else if (!transparent) {
+                o[k] = color0;
+            }
+        }
+    }
+}
+
+/**
+ * 1bit画像の1行分を4bitキャンバスに書き込む
+ * 1バイト8ピクセルを32bitのインデックス列とマスクに変換し、
+ * 書き込み位置のニブル境界に合わせてずらしてから最大5バイトにまとめて書き込む
+ * @param dstRow 出力行の先頭
+ * @param dstX 出力先X座標
+ * @param row ソース行の先頭
+ * @param bitPos 先頭ピクセルのビット位置
+ * @param count ピクセル数
+ * @param indexLut 4ビット→4ピクセル分のインデックス（左端が上位）
+ * @param maskLut 4ビット→4ピクセル分のマスク（ビット1のピクセルが0xF）
+ * @param transparent ビット0を書き込まないか（全ビット0のバイトはスキップ）
+ */
+static inline void copyMono4(uint8_t* dstRow, int dstX, const uint8_t* row, int bitPos, int count,
+                             const uint16_t* indexLut, const uint16_t* maskLut, bool transparent) {
+    int x = 0;
+    while (x < count) {
+        const int shift = bitPos & 7;
+        const int n = min(8 - shift, count - x);
+        const uint8_t present = (uint8_t)(0xFF00 >> n);
+        const uint8_t v = (uint8_t)(row[bitPos >> 3] << shift) & present;
+        const int d = dstX + x;
+        x += n;
+        bitPos += n;
+
+        if (transparent && v == 0) continue;
+        const uint8_t m = transparent ? v : present;
+        const uint32_t pixels = ((uint32_t)indexLut[v >> 4] << 16) | indexLut[v & 0x0F];
+        const uint32_t mask = ((uint32_t)maskLut[m >> 4] << 16) | maskLut[m & 0x0F];
+
+        // 奇数X座標から始まる場合は1ニブル分ずらす（40bit = 5バイト分）
+        const int align = (d & 1) ? 4 : 8;
+        const uint64_t pixels40 = (uint64_t)pixels << align;
+        const uint64_t mask40 = (uint64_t)mask << align;
+        uint8_t* o = dstRow + (d >> 1);
+        for (int j = 0; j < 5; j++) {
+            const uint8_t bm = (uint8_t)(mask40 >> (32 - 8 * j));
+            if (!bm) continue;
+            o[j] = (uint8_t)((o[j] & ~bm) | ((uint8_t)(pixels40 >> (32 - 8 * j)) & bm));
+        }
+    }
+}
+
+void PaletteImageRenderer::drawToCanvas(const MonoImageData& img, int offsetX, int offsetY, bool useTransparency) {
+    if (!canvas || !img.data) return;
+    ProfileScope scope(this, STAGE_BLIT);
+
+    int srcX, srcY, width, height;
+    if (!clipToCanvas(img.width, img.height, offsetX, offsetY, srcX, srcY, width, height)) return;
+
+    markDirty(offsetX + srcX, offsetY + srcY, width, height);
+    addProfilePixels(width, height);
+
+    uint16_t* frameBuffer16 = getCanvasBuffer16();
+    uint8_t* frameBuffer4 = getCanvasBuffer4();
+    const int dstX = offsetX + srcX;
+
+    if (frameBuffer4) {
+        // 2色をキャンバスパレットのインデックスに置き換えて4ピクセル分のテーブルを作る
+        const uint8_t index0 = canvasPalette.findClosestIndex(img.colors[0]);
+        const uint8_t index1 = canvasPalette.findClosestIndex(img.colors[1]);
+        uint16_t indexLut[16], maskLut[16];
+        for (int n = 0; n < 16; n++) {
+            indexLut[n] = 0;
+            maskLut[n] = 0;
+            for (int k = 0; k < 4; k++) {
+                const bool bit = (n & (8 >> k)) != 0;
+                indexLut[n] |= (uint16_t)((bit ? index1 : index0) << (12 - 4 * k));
+                maskLut[n] |= (uint16_t)((bit ? 0xF : 0) << (12 - 4 * k));
+            }
+        }
+
+        const int rowBytes = (canvas->width() + 1) / 2;
+        for (int row = 0; row < height; row++) {
+            copyMono4(frameBuffer4 + (offsetY + srcY + row) * rowBytes, dstX,
+                      img.data + (srcY + row) * img.rowBytes, srcX, width, indexLut, maskLut, useTransparency);
+        }
+        return;
+    }
+
+    // 4ビット→4ピクセルの変換テーブル（バイトスワップ済みRGB565）
+    uint16_t lut[16][4];
+    const uint16_t swapped0 = (uint16_t)((img.colors[0] >> 8) | (img.colors[0] << 8));
+    const uint16_t swapped1 = (uint16_t)((img.colors[1] >> 8) | (img.colors[1] << 8));
+    for (int n = 0; n < 16; n++) {
+        for (int k = 0; k < 4; k++) {
+            lut[n][k] = (n & (8 >> k)) ? swapped1 : swapped0;
+        }
+    }
+
+    if (frameBuffer16) {
+        const int stride = canvas->width();
+        for (int row = 0; row < height; row++) {
+            expandMono565(frameBuffer16 + (offsetY + srcY + row) * stride + dstX,
+                          img.data + (srcY + row) * img.rowBytes, srcX, width, lut, useTransparency);
+        }
+        return;
+    }
+
+    // フォールバック: 不透明は行単位でプッシュ、透明はビット1のランを塗りつぶす
+    if (!useTransparency && (!lineBuffer || bufferSize < (size_t)width)) {
+        initLineBuffer(width);
+        if (!lineBuffer || bufferSize < (size_t)width) return;
+    }
+    for (int row = 0; row < height; row++) {
+        const int dstY = offsetY + srcY + row;
+        const uint8_t* src = img.data + (srcY + row) * img.rowBytes;
+        if (!useTransparency) {
+            expandMono565(lineBuffer, src, srcX, width, lut, false);
+            canvas->pushImage(dstX, dstY, width, 1, (const lgfx::swap565_t*)lineBuffer);
+            continue;
+        }
+
+        int i = 0;
+        while (i < width) {
+            while (i < width && !((src[(srcX + i) >> 3] >> (7 - ((srcX + i) & 7))) & 1)) {
+                i++;
+            }
+            const int runStart = i;
+            while (i < width && ((src[(srcX + i) >> 3] >> (7 - ((srcX + i) & 7))) & 1)) {
+                i++;
+            }
+            if (i > runStart) {
+                canvas->fillRect(dstX + runStart, dstY, i - runStart, 1, img.colors[1]);
+            }
+        }
+    }
+}
+
+bool PaletteImageRenderer::initScaleBuffer(int maxWidth) {
+    if (scaleXMap && scaleRowIndex && scaleBufferSize >= (size_t)maxWidth) return true;
+    
+    RetroRenderPool::releaseBuffer(scaleXMap);
+    RetroRenderPool::releaseBuffer(scaleRowIndex);
+    scaleBufferSize = maxWidth;
+    scaleXMap = (uint16_t*)RetroRenderPool::acquireBuffer(scaleBufferSize * sizeof(uint16_t));
+    scaleRowIndex = (uint8_t*)RetroRenderPool::acquireBuffer(scaleBufferSize);
+    if (!scaleXMap || !scaleRowIndex) {
+        ESP_LOGE(TAG, "Failed to allocate scale buffer: %zu pixels", scaleBufferSize);
+        scaleBufferSize = 0;
+        return false;
+    }
+    ESP_LOGI(TAG, "Scale buffer initialized: %zu pixels", scaleBufferSize);
+    return true;
+}
+
+void PaletteImageRenderer::drawToCanvasScaled(const PaletteImageData& img, int offsetX, int offsetY, 
+                                             float scaleX, float scaleY, bool useTransparency) {
+    if (!canvas || !img.data || scaleX <= 0.0f || scaleY <= 0.0f) return;
+    ProfileScope scope(this, STAGE_BLIT);
+    const uint8_t* data = resolveImageData(img);
+    
+    int scaledWidth = (int)(img.width * scaleX);
+    int scaledHeight = (int)(img.height * scaleY);
+    
+    // 出力側でクリップ（dstX/dstYはスケール後画像内の開始位置）
+    int dstX, dstY, width, height;
+    if (!clipToCanvas(scaledWidth, scaledHeight, offsetX, offsetY, dstX, dstY, width, height)) return;
+    
+    // 縦横同じ整数倍率は倍率ごとに特殊化した行ループで描く（スケールバッファ不要）
+    const int intScale = (int)scaleX;
+    if (scaleX == scaleY && scaleX == (float)intScale && intScale >= 2 && intScale <= BLIT_MAX_INT_SCALE) {
+        const int srcPixel = (dstY / intScale) * img.width + dstX / intScale;
+        if (blitSpecialized(img, data, srcPixel, img.width, offsetX + dstX, offsetY + dstY, width, height,
+                            BLIT_MODE_SCALE2 + intScale - 2, dstX % intScale, dstY % intScale,
+                            useTransparency)) return;
+    }
+    
+    if (!initScaleBuffer(width)) return;
+    
+    const RetroColorPalette::PixelPairLut* lut = img.palette.getPairLut();
+    if (!lut) return;
+    
+    markDirty(offsetX + dstX, offsetY + dstY, width, height);
+    addProfilePixels(width, height);
+    
+    // 出力座標→ソース座標の16.16固定小数点ステップ
+    // 切り上げておくと整数倍率で境界のピクセルが1つ手前にずれない
+    const uint32_t stepX = (uint32_t)ceilf(65536.0f / scaleX);
+    const uint32_t stepY = (uint32_t)ceilf(65536.0f / scaleY);
+    const bool exact2x = (scaleX == 2.0f && scaleY == 2.0f);
+    const bool exactHalf = (scaleX == 0.5f && scaleY == 0.5f);
+    
+    // ソースX座標テーブル（行幅ごとに1回だけ計算）
+    for (int i = 0; i < width; i++) {
+        uint32_t sx = (uint32_t)(((uint64_t)(dstX + i) * stepX) >> 16);
+        scaleXMap[i] = (uint16_t)min((int)sx, img.width - 1);
+    }
+    
+    uint16_t* frameBuffer16 = getCanvasBuffer16();
+    uint8_t* frameBuffer4 = getCanvasBuffer4();
+    const int stride16 = canvas->width();
+    const int rowBytes4 = (canvas->width() + 1) / 2;
+    const int canvasX = offsetX + dstX;
+    
+    int prevSrcY = -1;
+    for (int row = 0; row < height; row++) {
+        const int canvasY = offsetY + dstY + row;
+        int srcY = min((int)(((uint64_t)(dstY + row) * stepY) >> 16), img.height - 1);
+        const bool repeatedRow = (srcY == prevSrcY);
+        
+        // 新しいソース行だけデコードし、スケール済みインデックス行を作る
+        if (!repeatedRow) {
+            const int rowBase = srcY * img.width;
+            if (exactHalf && ((rowBase + scaleXMap[0]) & 1) == 0) {
+                // 0.5倍：ソースの偶数ピクセル（各バイトの下位4bit）を順に拾う
+                const uint8_t* src = data + ((rowBase + scaleXMap[0]) >> 1);
+                for (int i = 0; i < width; i++) {
+                    scaleRowIndex[i] = src[i] & 0x0F;
+                }
+            } else if (exact2x) {
+                // 2倍：ソース1ピクセルを2回ずつ並べる
+                int i = 0;
+                int p = rowBase + scaleXMap[0];
+                if ((dstX & 1) && i < width) {
+                    scaleRowIndex[i++] = (data[p >> 1] >> ((p & 1) << 2)) & 0x0F;
+                    p++;
+                }
+                for (; i + 1 < width; i += 2, p++) {
+                    uint8_t index = (data[p >> 1] >> ((p & 1) << 2)) & 0x0F;
+                    scaleRowIndex[i] = index;
+                    scaleRowIndex[i + 1] = index;
+                }
+                if (i < width) {
+                    scaleRowIndex[i] = (data[p >> 1] >> ((p & 1) << 2)) & 0x0F;
+                }
+            } else {
+                for (int i = 0; i < width; i++) {
+                    int p = rowBase + scaleXMap[i];
+                    scaleRowIndex[i] = (data[p >> 1] >> ((p & 1) << 2)) & 0x0F;
+                }
+            }
+            prevSrcY = srcY;
+        }
+        
+        if (frameBuffer16) {
+            uint16_t* out = frameBuffer16 + canvasY * stride16 + canvasX;
+            if (repeatedRow && !useTransparency) {
+                // 直前の出力行をそのまま複製
+                memcpy(out, out - stride16, width * sizeof(uint16_t));
+            } else if (exact2x && !useTransparency && (dstX & 1) == 0 && ((uintptr_t)out & 2) == 0 && (width & 1) == 0) {
+                // 2倍：同じ色の2ピクセルを32bitストア1回で書き込む
+                uint32_t* out32 = (uint32_t*)out;
+                for (int i = 0; i < width; i += 2) {
+                    uint32_t c = lut->pairs[scaleRowIndex[i]] & 0xFFFF;
+                    *out32++ = c | (c << 16);
+                }
+            } else {
+                for (int i = 0; i < width; i++) {
+                    uint8_t index = scaleRowIndex[i];
+                    if (!useTransparency || index != RetroColorPalette::TRANSPARENT_INDEX) {
+                        out[i] = (uint16_t)lut->pairs[index];  // 上位4bitが0のバイト＝インデックス単色
+                    }
+                }
+            }
+        } else if (frameBuffer4) {
+            // 4bitキャンバスはインデックスをそのまま書き込む
+            uint8_t* rowPtr = frameBuffer4 + canvasY * rowBytes4;
+            if (repeatedRow && !useTransparency && (canvasX & 1) == 0 && (width & 1) == 0) {
+                memcpy(rowPtr + (canvasX >> 1), rowPtr - rowBytes4 + (canvasX >> 1), width >> 1);
+            } else {
+                for (int i = 0; i < width; i++) {
+                    uint8_t index = scaleRowIndex[i];
+                    if (useTransparency && index == RetroColorPalette::TRANSPARENT_INDEX) continue;
+                    int x = canvasX + i;
+                    uint8_t& b = rowPtr[x >> 1];
+                    b = (x & 1) ? ((b & 0xF0) | index) : ((b & 0x0F) | (index << 4));
+                }
+            }
+        } else {
+            for (int i = 0; i < width; i++) {
+                uint8_t index = scaleRowIndex[i];
+                if (!useTransparency || index != RetroColorPalette::TRANSPARENT_INDEX) {
+                    canvas->drawPixel(canvasX + i, canvasY, img.palette.colors[index]);
+                }
+            }
+        }
+    }
+}
+
+void PaletteImageRenderer::pushCanvasToDisplay(int x, int y, uint16_t transparentColor) {
+    if (!canvas || !display) return;
+    
+    display->notifyTransferBegin();
+    {
+        ProfileScope scope(this, STAGE_PUSH);
+        if (isIndexedCanvas()) {
+            // パレットキャンバスの透明色はインデックスで指定する
+            uint16_t transparentIndex = canvasPalette.findClosestIndex(transparentColor);
+            canvas->pushSprite(display, x, y, transparentIndex);
+        } else {
+            canvas->pushSprite(display, x, y, transparentColor);
+        }
+    }
+    dirtyCount = 0;
+    endProfileFrame((size_t)canvas->width() * canvas->height() * sizeof(uint16_t));
+}
+
+void PaletteImageRenderer::pushCanvasToDisplayOpaque(int x, int y) {
+    if (!canvas || !display) return;
     
-    // グレースケール15段階
-    for (int i = 1; i < MAX_COLORS; i++) {
-        uint8_t level = (i * 255) / (MAX_COLORS - 1);
-        colors[i] = rgb888ToRgb565(level, level, level);
+    display->notifyTransferBegin();
+    {
+        ProfileScope scope(this, STAGE_PUSH);
+        canvas->pushSprite(display, x, y);
     }
-    
-    ESP_LOGI(TAG, "Grayscale palette initialized");
+    dirtyCount = 0;
+    endProfileFrame((size_t)canvas->width() * canvas->height() * sizeof(uint16_t));
 }
 
-void RetroColorPalette::initSepiaPalette() {
-    colors[0] = 0x0000;  // 透明色（黒）
+size_t PaletteImageRenderer::pushDirtyRegions(int x, int y) {
+    if (!canvas || !display) return 0;
+    if (dirtyCount == 0) {
+        endProfileFrame(0);
+        return 0;
+    }
     
-    // セピア調15段階
-    for (int i = 1; i < MAX_COLORS; i++) {
-        float ratio = (float)i / (MAX_COLORS - 1);
-        uint8_t r = (uint8_t)(ratio * 255 * 0.8f);  // 赤みを強く
-        uint8_t g = (uint8_t)(ratio * 255 * 0.6f);  // 緑は中程度
-        uint8_t b = (uint8_t)(ratio * 255 * 0.4f);  // 青は弱く
-        colors[i] = rgb888ToRgb565(r, g, b);
+    // 変化があった時だけ転送フックに通知する（静止画面は省電力アイドルのまま）
+    display->notifyTransferBegin();
+    size_t bytesSent = 0;
+    {
+        ProfileScope scope(this, STAGE_PUSH);
+        const int displayWidth = display->width();
+        const int displayHeight = display->height();
+        
+        // クリップ矩形で転送範囲を絞り、矩形ごとにウィンドウを設定して送る
+        display->startWrite();
+        for (int i = 0; i < dirtyCount; i++) {
+            const DirtyRect& r = dirtyRects[i];
+            int x0 = max(0, x + r.x);
+            int y0 = max(0, y + r.y);
+            int x1 = min(displayWidth, x + r.x + r.w);
+            int y1 = min(displayHeight, y + r.y + r.h);
+            if (x0 >= x1 || y0 >= y1) continue;
+            
+            display->setClipRect(x0, y0, x1 - x0, y1 - y0);
+            canvas->pushSprite(display, x, y);
+            bytesSent += (size_t)(x1 - x0) * (y1 - y0) * sizeof(uint16_t);
+        }
+        display->clearClipRect();
+        display->endWrite();
     }
     
-    ESP_LOGI(TAG, "Sepia palette initialized");
+    dirtyCount = 0;
+    endProfileFrame(bytesSent);
+    return bytesSent;
 }
 
-void RetroColorPalette::setColor(uint8_t index, uint16_t color) {
-    if (index < MAX_COLORS) {
-        colors[index] = color;
+void PaletteImageRenderer::pushCanvasDMA(M5Canvas* target, int x, int y) {
+    if (uint16_t* buffer = (target->getColorDepth() == lgfx::rgb565_2Byte) ? (uint16_t*)target->getBuffer() : nullptr) {
+        // 16bitキャンバスはバッファをそのままDMA転送
+        display->startWrite();
+        display->pushImageDMA(x, y, target->width(), target->height(), (const lgfx::swap565_t*)buffer);
+        display->waitDMA();
+        display->endWrite();
+    } else {
+        // パレットキャンバスは展開が必要なので通常のプッシュ
+        target->pushSprite(display, x, y);
     }
 }
 
-uint16_t RetroColorPalette::rgb888ToRgb565(uint8_t r, uint8_t g, uint8_t b) {
-    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+void PaletteImageRenderer::pushTaskEntry(void* arg) {
+    PaletteImageRenderer* self = (PaletteImageRenderer*)arg;
+    
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (self->pushTaskStop) break;
+        
+        // 転送中はパネルのアイドルモード切り替え（省電力管理）を待たせる
+        self->display->beginBackgroundTransfer();
+        self->pushCanvasDMA(self->frontCanvas, self->pushX, self->pushY);
+        self->display->endBackgroundTransfer();
+        xSemaphoreGive(self->pushDone);
+    }
+    
+    // 停止完了を通知
+    xSemaphoreGive(self->pushDone);
+    vTaskDelete(nullptr);
 }
 
-uint16_t RetroColorPalette::hsvToRgb565(uint16_t h, uint8_t s, uint8_t v) {
-    // HSV to RGB conversion
-    h %= 360;
-    float S = s / 100.0f;
-    float V = v / 100.0f;
+bool PaletteImageRenderer::enableDoubleBuffer(int coreId) {
+    if (!canvas || !display) return false;
+    if (pushTask) return true;
     
-    float C = V * S;
-    float X = C * (1 - abs(fmod(h / 60.0f, 2) - 1));
-    float m = V - C;
+    // 同じサイズ・色深度の2枚目を確保
+    secondaryCanvas = RetroRenderPool::acquireCanvas(display, canvas->width(), canvas->height(),
+                                                     canvas->getColorDepth() & lgfx::bit_mask);
+    if (!secondaryCanvas) {
+        ESP_LOGE(TAG, "Failed to allocate back buffer for double buffering");
+        return false;
+    }
     
-    float r, g, b;
-    if (h < 60) {
-        r = C; g = X; b = 0;
-    } else if (h < 120) {
-        r = X; g = C; b = 0;
-    } else if (h < 180) {
-        r = 0; g = C; b = X;
-    } else if (h < 240) {
-        r = 0; g = X; b = C;
-    } else if (h < 300) {
-        r = X; g = 0; b = C;
-    } else {
-        r = C; g = 0; b = X;
+    pushDone = xSemaphoreCreateBinary();
+    xSemaphoreGive(pushDone);  // 未転送状態は「完了」扱い
+    
+    frontCanvas = secondaryCanvas;
+    pushTaskStop = false;
+    setCanvasPalette(canvasPalette);  // 両方のキャンバスにパレットを反映
+    
+    if (xTaskCreatePinnedToCore(pushTaskEntry, "canvas_push", 4096, this, 5, &pushTask, coreId) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create canvas push task");
+        pushTask = nullptr;
+        vSemaphoreDelete(pushDone);
+        pushDone = nullptr;
+        frontCanvas = nullptr;
+        RetroRenderPool::releaseCanvas(secondaryCanvas);
+        secondaryCanvas = nullptr;
+        return false;
+    }
+    
+    ESP_LOGI(TAG, "Double buffering enabled (push task on core %d)", coreId);
+    return true;
+}
+
+void PaletteImageRenderer::disableDoubleBuffer() {
+    if (!pushTask) return;
+    
+    // 転送完了を待ってからタスクを停止
+    xSemaphoreTake(pushDone, portMAX_DELAY);
+    pushTaskStop = true;
+    xTaskNotifyGive(pushTask);
+    xSemaphoreTake(pushDone, portMAX_DELAY);
+    pushTask = nullptr;
+    vSemaphoreDelete(pushDone);
+    pushDone = nullptr;
+    
+    // 元のキャンバスへ戻し、描画中だった裏側の内容を引き継ぐ
+    if (canvas == secondaryCanvas) {
+        const int rowBytes = (canvas->width() * (canvas->getColorDepth() & lgfx::bit_mask) + 7) / 8;
+        memcpy(frontCanvas->getBuffer(), canvas->getBuffer(), rowBytes * canvas->height());
+        canvas = frontCanvas;
     }
     
-    uint8_t R = (uint8_t)((r + m) * 255);
-    uint8_t G = (uint8_t)((g + m) * 255);
-    uint8_t B = (uint8_t)((b + m) * 255);
+    RetroRenderPool::releaseCanvas(secondaryCanvas);
+    secondaryCanvas = nullptr;
+    frontCanvas = nullptr;
     
-    return rgb888ToRgb565(R, G, B);
+    ESP_LOGI(TAG, "Double buffering disabled");
 }
 
-// ===== PaletteImageData 実装 =====
+bool PaletteImageRenderer::isDoubleBuffered() const {
+    return pushTask != nullptr;
+}
 
-PaletteImageData::PaletteImageData(const uint8_t* imageData, int w, int h, const RetroColorPalette* customPalette) 
-    : data(imageData), width(w), height(h) {
-    dataSize = (width * height + 1) / 2;  // 1バイトに2ピクセル
+void PaletteImageRenderer::swapBuffers(int x, int y) {
+    if (!pushTask) {
+        pushCanvasToDisplayOpaque(x, y);
+        return;
+    }
     
-    if (customPalette) {
-        palette = *customPalette;
+    {
+        // 転送はタスク側で行うため、計測されるのは前フレームの転送待ち時間
+        ProfileScope scope(this, STAGE_PUSH);
+        
+        // 前フレームの転送完了を待つ
+        xSemaphoreTake(pushDone, portMAX_DELAY);
+        
+        // フックはパネルへコマンドを送ることがあるため、転送タスクが止まってから通知する
+        display->notifyTransferBegin();
+        
+        M5Canvas* drawn = canvas;
+        canvas = frontCanvas;
+        frontCanvas = drawn;
+        pushX = x;
+        pushY = y;
+        dirtyCount = 0;
+        
+        xTaskNotifyGive(pushTask);
     }
-    // デフォルトパレットは既にコンストラクタで初期化済み
+    endProfileFrame((size_t)canvas->width() * canvas->height() * sizeof(uint16_t));
+}
+
+void PaletteImageRenderer::waitForPushComplete() {
+    if (!pushTask) return;
     
-    ESP_LOGI(TAG, "PaletteImageData created: %dx%d, %zu bytes", width, height, dataSize);
+    xSemaphoreTake(pushDone, portMAX_DELAY);
+    xSemaphoreGive(pushDone);
 }
 
-uint8_t PaletteImageData::getPixelIndex(int x, int y) const {
-    if (x < 0 || x >= width || y < 0 || y >= height) {
-        return RetroColorPalette::TRANSPARENT_INDEX;  // 範囲外は透明
+bool PaletteImageRenderer::rotateDisplay(int rotation) {
+    if (!canvas || !display) return false;
+    if (!display->keepsFramebufferSize(rotation)) {
+        ESP_LOGE(TAG, "Rotation %d swaps width and height, canvas must be recreated", rotation);
+        return false;
     }
     
-    int pixelIndex = y * width + x;
-    int byteIndex = pixelIndex / 2;
+    // 書き込み方向は転送の途中で変えられないので、転送中のフレームを待つ
+    waitForPushComplete();
+    display->setRotationFast(rotation);
     
-    if (byteIndex >= dataSize) {
-        return RetroColorPalette::TRANSPARENT_INDEX;  // 範囲外は透明
+    if (pushTask) {
+        // 表示中のフレームを新しい向きで送り直す
+        display->notifyTransferBegin();
+        xSemaphoreTake(pushDone, portMAX_DELAY);
+        xTaskNotifyGive(pushTask);
+    } else {
+        markAllDirty();
     }
-    
-    // 偶数ピクセル: 下位4bit、奇数ピクセル: 上位4bit
-    return (pixelIndex % 2 == 0) ? 
-           (data[byteIndex] & 0x0F) : 
-           ((data[byteIndex] & 0xF0) >> 4);
+    return true;
 }
 
-uint16_t PaletteImageData::getPixelColor(int x, int y) const {
-    uint8_t index = getPixelIndex(x, y);
-    return palette.colors[index];
+void PaletteImageRenderer::markDirty(int x, int y, int w, int h) {
+    if (!canvas) return;
+    
+    int x0 = max(0, x);
+    int y0 = max(0, y);
+    int x1 = min((int)canvas->width(), x + w);
+    int y1 = min((int)canvas->height(), y + h);
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    // 重なる・接する矩形を結合（結合後に新たに重なる矩形も繰り返し吸収）
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < dirtyCount; i++) {
+            const DirtyRect& r = dirtyRects[i];
+            if (x0 <= r.x + r.w && r.x <= x1 && y0 <= r.y + r.h && r.y <= y1) {
+                x0 = min(x0, r.x);
+                y0 = min(y0, r.y);
+                x1 = max(x1, r.x + r.w);
+                y1 = max(y1, r.y + r.h);
+                dirtyRects[i] = dirtyRects[--dirtyCount];
+                merged = true;
+                break;
+            }
+        }
+    }
+    
+    // 上限に達したら全矩形を外接矩形1つにまとめる
+    if (dirtyCount >= MAX_DIRTY_RECTS) {
+        for (int i = 0; i < dirtyCount; i++) {
+            const DirtyRect& r = dirtyRects[i];
+            x0 = min(x0, r.x);
+            y0 = min(y0, r.y);
+            x1 = max(x1, r.x + r.w);
+            y1 = max(y1, r.y + r.h);
+        }
+        dirtyCount = 0;
+    }
+    
+    dirtyRects[dirtyCount++] = {x0, y0, x1 - x0, y1 - y0};
 }
 
-bool PaletteImageData::isTransparent(int x, int y) const {
-    return getPixelIndex(x, y) == RetroColorPalette::TRANSPARENT_INDEX;
+void PaletteImageRenderer::markAllDirty() {
+    if (!canvas) return;
+    
+    dirtyRects[0] = {0, 0, (int)canvas->width(), (int)canvas->height()};
+    dirtyCount = 1;
 }
 
-size_t PaletteImageData::getMemoryUsage() const {
-    return dataSize + sizeof(RetroColorPalette);
+void PaletteImageRenderer::clearDirty() {
+    dirtyCount = 0;
 }
 
-void PaletteImageData::setPalette(const RetroColorPalette& newPalette) {
-    palette = newPalette;
+int PaletteImageRenderer::getDirtyRectCount() const {
+    return dirtyCount;
 }
 
-// ===== PaletteImageRenderer 実装 =====
-
-PaletteImageRenderer::PaletteImageRenderer(LGFX_ST7789P3_76x284* gfx, M5Canvas* cnv) 
-    : display(gfx), canvas(cnv), canvasOwned(false), lineBuffer(nullptr), bufferSize(0) {
-    ESP_LOGI(TAG, "PaletteImageRenderer created with external canvas");
+const PaletteImageRenderer::DirtyRect* PaletteImageRenderer::getDirtyRects() const {
+    return dirtyRects;
 }
 
-PaletteImageRenderer::PaletteImageRenderer(LGFX_ST7789P3_76x284* gfx, int canvasWidth, int canvasHeight) 
-    : display(gfx), canvasOwned(true), lineBuffer(nullptr), bufferSize(0) {
-    canvas = new M5Canvas(gfx);
-    canvas->createSprite(canvasWidth, canvasHeight);
-    ESP_LOGI(TAG, "PaletteImageRenderer created with %dx%d canvas", canvasWidth, canvasHeight);
+void PaletteImageRenderer::fillCanvasRect(int x, int y, int w, int h, uint16_t color) {
+    if (!canvas) return;
+    ProfileScope scope(this, STAGE_CLEAR);
+    
+    uint16_t value = isIndexedCanvas() ? canvasPalette.findClosestIndex(color) : color;
+    canvas->fillRect(x, y, w, h, value);
+    markDirty(x, y, w, h);
+    
+    int x0 = max(0, x);
+    int y0 = max(0, y);
+    int x1 = min((int)canvas->width(), x + w);
+    int y1 = min((int)canvas->height(), y + h);
+    if (x0 < x1 && y0 < y1) addProfilePixels(x1 - x0, y1 - y0);
 }
 
-PaletteImageRenderer::~PaletteImageRenderer() {
-    if (lineBuffer) {
-        free(lineBuffer);
-    }
-    if (canvasOwned && canvas) {
-        canvas->deleteSprite();
-        delete canvas;
+void PaletteImageRenderer::clearCanvas(uint16_t color) {
+    if (!canvas) return;
+    ProfileScope scope(this, STAGE_CLEAR);
+    
+    if (isIndexedCanvas()) {
+        clearCanvasIndex(canvasPalette.findClosestIndex(color));
+        return;
     }
-    ESP_LOGI(TAG, "PaletteImageRenderer destroyed");
+    canvas->fillSprite(color);
+    markAllDirty();
+    addProfilePixels(canvas->width(), canvas->height());
 }
 
-void PaletteImageRenderer::initLineBuffer(int maxWidth) {
-    if (lineBuffer) {
-        free(lineBuffer);
+void PaletteImageRenderer::clearCanvasIndex(uint8_t index) {
+    if (!canvas) return;
+    ProfileScope scope(this, STAGE_CLEAR);
+    
+    index &= 0x0F;
+    if (uint8_t* frameBuffer = getCanvasBuffer4()) {
+        const int rowBytes = (canvas->width() + 1) / 2;
+        memset(frameBuffer, index * 0x11, rowBytes * canvas->height());
+    } else {
+        canvas->fillSprite(canvasPalette.colors[index]);
     }
-    bufferSize = maxWidth;
-    lineBuffer = (uint16_t*)malloc(bufferSize * sizeof(uint16_t));
-    ESP_LOGI(TAG, "Line buffer initialized: %zu bytes", bufferSize * sizeof(uint16_t));
+    markAllDirty();
+    addProfilePixels(canvas->width(), canvas->height());
 }
 
-void PaletteImageRenderer::drawToCanvas(const PaletteImageData& img, int offsetX, int offsetY, bool useTransparency) {
-    if (!canvas) return;
+void PaletteImageRenderer::setCanvasPalette(const RetroColorPalette& palette) {
+    canvasPalette = palette;
     
-    // 透明色を使用しない場合は高速描画
-    if (!useTransparency) {
-        drawToCanvasOpaque(img, offsetX, offsetY);
-        return;
-    }
+    if (!isIndexedCanvas()) return;
     
-    // 透明色対応の描画（ピクセル単位）
-    for (int y = 0; y < img.height; y++) {
-        for (int x = 0; x < img.width; x++) {
-            uint8_t index = img.getPixelIndex(x, y);
-            
-            // 透明色をスキップ
-            if (index != RetroColorPalette::TRANSPARENT_INDEX) {
-                uint16_t color = img.palette.colors[index];
-                canvas->drawPixel(x + offsetX, y + offsetY, color);
-            }
+    // 表示色が全体的に変わるので次回は全面プッシュ
+    markAllDirty();
+    
+    for (int i = 0; i < RetroColorPalette::MAX_COLORS; i++) {
+        uint16_t c = palette.colors[i];
+        // RGB565 → RGB888（下位ビットは上位ビットで補完）
+        uint8_t r = ((c >> 11) & 0x1F) << 3;
+        uint8_t g = ((c >> 5) & 0x3F) << 2;
+        uint8_t b = (c & 0x1F) << 3;
+        r |= r >> 5;
+        g |= g >> 6;
+        b |= b >> 5;
+        canvas->setPaletteColor(i, r, g, b);
+        if (secondaryCanvas) {
+            // ダブルバッファ時はもう一方にも反映
+            M5Canvas* other = (canvas == secondaryCanvas) ? frontCanvas : secondaryCanvas;
+            other->setPaletteColor(i, r, g, b);
         }
     }
 }
 
-void PaletteImageRenderer::drawToCanvasOpaque(const PaletteImageData& img, int offsetX, int offsetY) {
-    if (!canvas) return;
+const RetroColorPalette& PaletteImageRenderer::getCanvasPalette() const {
+    return canvasPalette;
+}
+
+bool PaletteImageRenderer::isIndexedCanvas() const {
+    return getCanvasBuffer4() != nullptr;
+}
+
+void PaletteImageRenderer::setAssetCache(RetroHotAssetCache* cache) {
+    assetCache = cache;
+}
+
+RetroHotAssetCache* PaletteImageRenderer::getAssetCache() const {
+    return assetCache;
+}
+
+const uint8_t* PaletteImageRenderer::resolveImageData(const PaletteImageData& img) {
+    return assetCache ? assetCache->lookup(img.data) : img.data;
+}
+
+// ===== プロファイラ =====
+
+PaletteImageRenderer::ProfileScope::ProfileScope(PaletteImageRenderer* renderer, int profileStage)
+    : owner(renderer), stage(profileStage), start(0), active(renderer->profile.enabled) {
+    // 入れ子の描画（drawToCanvas→drawRegionToCanvas等）は外側だけ計上する
+    if (active && owner->profile.depth++ == 0) {
+        start = esp_timer_get_time();
+    }
+}
+
+PaletteImageRenderer::ProfileScope::~ProfileScope() {
+    // 区間の途中でsetProfilingEnabledされた場合は何もしない（depthは初期化済み）
+    if (!active || !owner->profile.enabled || owner->profile.depth == 0) return;
     
-    // ライン描画用バッファが未初期化なら初期化
-    if (!lineBuffer || bufferSize < img.width) {
-        initLineBuffer(img.width);
+    owner->profile.depth--;
+    if (start) {
+        owner->profile.stageUs[stage] += (uint32_t)(esp_timer_get_time() - start);
+    }
+}
+
+void PaletteImageRenderer::addProfilePixels(int width, int height) {
+    if (profile.enabled) {
+        profile.pixels += (uint32_t)width * height;
+    }
+}
+
+void PaletteImageRenderer::endProfileFrame(size_t spiBytes) {
+    // 転送の有無を転送フックへ通知（プロファイル無効時も通知）
+    if (display) {
+        display->notifyFrameSent(spiBytes);
     }
+    if (!profile.enabled) return;
     
-    // ライン単位で高速描画
-    for (int y = 0; y < img.height; y++) {
-        // 1ライン分をバッファに変換
-        for (int x = 0; x < img.width; x++) {
-            uint8_t index = img.getPixelIndex(x, y);
-            lineBuffer[x] = img.palette.colors[index];
+    int64_t now = esp_timer_get_time();
+    
+    if (!profile.samples) {
+        profile.samples = (uint32_t*)RetroRenderPool::acquireBuffer(PROFILE_SERIES * PROFILE_WINDOW * sizeof(uint32_t));
+        if (!profile.samples) {
+            ESP_LOGE(TAG, "Failed to allocate profiler samples, profiling disabled");
+            profile.enabled = false;
+            return;
         }
-        
-        // M5GFXの高速ライン描画
-        canvas->pushImage(offsetX, y + offsetY, img.width, 1, lineBuffer);
+    }
+    
+    // 系列ごとにPROFILE_WINDOW個のリングバッファ（ステージ, 合計, フレーム間隔の順）
+    uint32_t renderUs = 0;
+    for (int i = 0; i < PROFILE_STAGES; i++) {
+        profile.samples[i * PROFILE_WINDOW + profile.head] = profile.stageUs[i];
+        renderUs += profile.stageUs[i];
+    }
+    uint32_t intervalUs = profile.lastFrameEnd ? (uint32_t)(now - profile.lastFrameEnd) : renderUs;
+    profile.samples[PROFILE_STAGES * PROFILE_WINDOW + profile.head] = renderUs;
+    profile.samples[(PROFILE_STAGES + 1) * PROFILE_WINDOW + profile.head] = intervalUs;
+    
+    profile.head = (profile.head + 1) % PROFILE_WINDOW;
+    if (profile.count < PROFILE_WINDOW) profile.count++;
+    
+    profile.frames++;
+    profile.lastPixels = profile.pixels;
+    profile.lastSpiBytes = (uint32_t)spiBytes;
+    profile.totalPixels += profile.pixels;
+    profile.totalSpiBytes += spiBytes;
+    profile.lastFrameEnd = now;
+    
+    for (int i = 0; i < PROFILE_STAGES; i++) {
+        profile.stageUs[i] = 0;
+    }
+    profile.pixels = 0;
+    
+    if (profile.logInterval && profile.frames % profile.logInterval == 0) {
+        logStats();
     }
 }
 
-void PaletteImageRenderer::drawToCanvasScaled(const PaletteImageData& img, int offsetX, int offsetY, 
-                                             float scaleX, float scaleY, bool useTransparency) {
-    if (!canvas) return;
+PaletteImageRenderer::RenderStats PaletteImageRenderer::getStats() const {
+    RenderStats stats = {};
+    stats.samples = profile.count;
+    stats.frames = profile.frames;
+    stats.lastPixels = profile.lastPixels;
+    stats.lastSpiBytes = profile.lastSpiBytes;
+    stats.totalPixels = profile.totalPixels;
+    stats.totalSpiBytes = profile.totalSpiBytes;
+    if (assetCache) {
+        stats.assetHits = assetCache->getHitCount();
+        stats.assetMisses = assetCache->getMissCount();
+    }
+    if (!profile.samples || profile.count == 0) return stats;
     
-    int scaledWidth = (int)(img.width * scaleX);
-    int scaledHeight = (int)(img.height * scaleY);
+    const int n = profile.count;
+    const int last = (profile.head + PROFILE_WINDOW - 1) % PROFILE_WINDOW;
+    const int p99 = (n * 99 + 99) / 100 - 1;  // ceil(0.99n)番目
     
-    for (int sy = 0; sy < scaledHeight; sy++) {
-        for (int sx = 0; sx < scaledWidth; sx++) {
-            // スケールされた座標を元の画像座標にマッピング
-            int origX = (int)(sx / scaleX);
-            int origY = (int)(sy / scaleY);
-            
-            uint8_t index = img.getPixelIndex(origX, origY);
-            
-            if (!useTransparency || index != RetroColorPalette::TRANSPARENT_INDEX) {
-                uint16_t color = img.palette.colors[index];
-                canvas->drawPixel(sx + offsetX, sy + offsetY, color);
-            }
+    for (int series = 0; series < PROFILE_SERIES; series++) {
+        const uint32_t* values = profile.samples + series * PROFILE_WINDOW;
+        
+        // n < PROFILE_WINDOW の間はリングバッファの先頭n個が有効
+        uint32_t sorted[PROFILE_WINDOW];
+        uint64_t sum = 0;
+        uint32_t minValue = UINT32_MAX;
+        for (int i = 0; i < n; i++) {
+            sorted[i] = values[i];
+            sum += values[i];
+            minValue = min(minValue, values[i]);
+        }
+        std::nth_element(sorted, sorted + p99, sorted + n);
+        
+        TimingStats t;
+        t.minUs = minValue;
+        t.avgUs = (uint32_t)(sum / n);
+        t.p99Us = sorted[p99];
+        t.lastUs = values[last];
+        
+        if (series < PROFILE_STAGES) {
+            stats.stage[series] = t;
+        } else if (series == PROFILE_STAGES) {
+            stats.render = t;
+        } else {
+            stats.interval = t;
         }
     }
+    return stats;
 }
 
-void PaletteImageRenderer::pushCanvasToDisplay(int x, int y, uint16_t transparentColor) {
-    if (!canvas || !display) return;
-    
-    canvas->pushSprite(display, x, y, transparentColor);
+void PaletteImageRenderer::resetStats() {
+    for (int i = 0; i < PROFILE_STAGES; i++) {
+        profile.stageUs[i] = 0;
+    }
+    profile.pixels = 0;
+    profile.head = 0;
+    profile.count = 0;
+    profile.lastFrameEnd = 0;
+    profile.frames = 0;
+    profile.lastPixels = 0;
+    profile.lastSpiBytes = 0;
+    profile.totalPixels = 0;
+    profile.totalSpiBytes = 0;
+    if (assetCache) {
+        assetCache->resetStats();
+    }
 }
 
-void PaletteImageRenderer::pushCanvasToDisplayOpaque(int x, int y) {
-    if (!canvas || !display) return;
+void PaletteImageRenderer::setProfilingEnabled(bool enable) {
+    if (enable == profile.enabled) return;
     
-    canvas->pushSprite(display, x, y);
+    // 計測区間の途中で切り替えても入れ子カウントが狂わないよう、統計ごと初期化する
+    profile.enabled = enable;
+    profile.depth = 0;
+    resetStats();
+    if (!enable && profile.samples) {
+        RetroRenderPool::releaseBuffer(profile.samples);
+        profile.samples = nullptr;
+    }
 }
 
-void PaletteImageRenderer::clearCanvas(uint16_t color) {
-    if (canvas) {
-        canvas->fillSprite(color);
+bool PaletteImageRenderer::isProfilingEnabled() const {
+    return profile.enabled;
+}
+
+void PaletteImageRenderer::setStatsLogInterval(uint32_t frames) {
+    profile.logInterval = frames;
+}
+
+void PaletteImageRenderer::logStats() const {
+    RenderStats stats = getStats();
+    if (stats.samples == 0) {
+        ESP_LOGI(TAG, "Render stats: no frames");
+        return;
+    }
+    
+    uint32_t fps = stats.interval.avgUs ? 1000000 / stats.interval.avgUs : 0;
+    ESP_LOGI(TAG, "Render stats (%" PRIu32 " frames): clear %" PRIu32 "/%" PRIu32 "/%" PRIu32
+             " blit %" PRIu32 "/%" PRIu32 "/%" PRIu32 " push %" PRIu32 "/%" PRIu32 "/%" PRIu32
+             " total %" PRIu32 "/%" PRIu32 "/%" PRIu32 " us (min/avg/p99), %" PRIu32 " fps, %" PRIu32 " px, %" PRIu32 " B",
+             stats.samples,
+             stats.stage[STAGE_CLEAR].minUs, stats.stage[STAGE_CLEAR].avgUs, stats.stage[STAGE_CLEAR].p99Us,
+             stats.stage[STAGE_BLIT].minUs, stats.stage[STAGE_BLIT].avgUs, stats.stage[STAGE_BLIT].p99Us,
+             stats.stage[STAGE_PUSH].minUs, stats.stage[STAGE_PUSH].avgUs, stats.stage[STAGE_PUSH].p99Us,
+             stats.render.minUs, stats.render.avgUs, stats.render.p99Us,
+             fps, stats.lastPixels, stats.lastSpiBytes);
+    if (assetCache) {
+        ESP_LOGI(TAG, "Asset cache: %" PRIu32 "%% hit (%" PRIu32 " hits, %" PRIu32 " flash reads), %zu/%zu bytes",
+                 assetCache->getHitRate(), stats.assetHits, stats.assetMisses,
+                 assetCache->getUsedBytes(), assetCache->getCapacity());
     }
 }
 
@@ -298,11 +2316,15 @@ RetroAnimation::RetroAnimation(AnimationFrame* animFrames, int count, bool loopA
 }
 
 bool RetroAnimation::update() {
-    if (!playing || frameCount <= 0) return false;
-    
-    uint32_t currentTime = esp_timer_get_time() / 1000;  // ミリ秒に変換
+    return update(esp_timer_get_time() / 1000);  // ミリ秒に変換
+}
+
+bool RetroAnimation::update(uint32_t timeMs) {
+    // 再生し終わった非ループアニメーションは currentFrame == frameCount のまま（reset() で戻す）
+    if (!playing || frameCount <= 0 || currentFrame >= frameCount) return false;
     
-    if (currentTime - lastFrameTime >= frames[currentFrame].duration) {
+    if (timeMs - lastFrameTime >= frames[currentFrame].duration) {
+        const uint32_t due = lastFrameTime + frames[currentFrame].duration;
         currentFrame++;
         
         if (currentFrame >= frameCount) {
@@ -314,18 +2336,42 @@ bool RetroAnimation::update() {
             }
         }
         
-        lastFrameTime = currentTime;
+        // 予定時刻から積み上げる（1フレーム以上遅れた場合は現在時刻に合わせ直す）
+        lastFrameTime = (timeMs - due >= frames[currentFrame].duration) ? timeMs : due;
         return true;  // フレームが変更された
     }
     
     return false;
 }
 
+uint32_t RetroAnimation::getNextFrameTime() const {
+    if (frameCount <= 0 || currentFrame >= frameCount) return lastFrameTime;
+    return lastFrameTime + frames[currentFrame].duration;
+}
+
 const PaletteImageData* RetroAnimation::getCurrentFrame() {
     if (!playing || currentFrame >= frameCount) return nullptr;
     return frames[currentFrame].image;
 }
 
+const RetroCollisionMask* RetroAnimation::getCurrentMask() const {
+    if (!playing || currentFrame >= frameCount || !frames[currentFrame].image) return nullptr;
+    return frames[currentFrame].image->collisionMask;
+}
+
+int RetroAnimation::getFrameCount() const {
+    return frameCount;
+}
+
+int RetroAnimation::getCurrentFrameIndex() const {
+    return currentFrame;
+}
+
+const PaletteImageData* RetroAnimation::getFrameImage(int index) const {
+    if (index < 0 || index >= frameCount) return nullptr;
+    return frames[index].image;
+}
+
 void RetroAnimation::getCurrentOffset(int& offsetX, int& offsetY) {
     if (playing && currentFrame < frameCount) {
         offsetX = frames[currentFrame].offsetX;
@@ -473,122 +2519,3 @@ const uint8_t SAMPLE_CHAR_WALK2_12x16[] = {
     0x00, 0x77, 0x00, 0x77, 0x70, 0x00,
     0x07, 0x77, 0x70, 0x77, 0x77, 0x00
 };
-
-// ===== サンプル実装 =====
-
-void RetroGameExample::basicUsageExample(LGFX_ST7789P3_76x284* display) {
-    ESP_LOGI(TAG, "=== Basic Usage Example ===");
-    
-    // 1. パレット画像データ作成
-    PaletteImageData heartImage(SAMPLE_HEART_8x8, 8, 8);
-    
-    // 2. レンダラー初期化（32x32のキャンバス）
-    PaletteImageRenderer renderer(display, 32, 32);
-    
-    // 3. キャンバスをクリア
-    renderer.clearCanvas(0x001F);  // 青背景
-    
-    // 4. ハート画像を描画（透明色対応）
-    renderer.drawToCanvas(heartImage, 12, 12, true);
-    
-    // 5. ディスプレイに表示（透明色は黒）
-    renderer.pushCanvasToDisplay(22, 138, 0x0000);  // 中央付近に表示
-    
-    ESP_LOGI(TAG, "Heart displayed with transparency");
-}
-
-void RetroGameExample::animationExample(LGFX_ST7789P3_76x284* display) {
-    ESP_LOGI(TAG, "=== Animation Example ===");
-    
-    PaletteImageData heartImage(SAMPLE_HEART_8x8, 8, 8);
-    PaletteImageData coinImage(SAMPLE_COIN_8x8, 8, 8);
-    PaletteImageRenderer renderer(display, 76, 284);  // フルスクリーン
-    
-    for (int frame = 0; frame < 60; frame++) {
-        renderer.clearCanvas(0x0010);  // ダークブルー背景
-        
-        // フレームごとに点滅するハート
-        if ((frame / 10) % 2 == 0) {
-            renderer.drawToCanvas(heartImage, 34, 100, true);
-        }
-        
-        // 回転するコイン（スケール変更でアニメーション）
-        float scale = 0.5f + 0.5f * sin(frame * 0.2f);
-        renderer.drawToCanvasScaled(coinImage, 30, 150, scale, 1.0f, true);
-        
-        renderer.pushCanvasToDisplayOpaque(0, 0);
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-    }
-    
-    ESP_LOGI(TAG, "Animation complete");
-}
-
-void RetroGameExample::characterWalkExample(LGFX_ST7789P3_76x284* display) {
-    ESP_LOGI(TAG, "=== Character Walk Example ===");
-    
-    // アニメーションフレーム設定
-    PaletteImageData standImage(SAMPLE_CHAR_STAND_12x16, 12, 16);
-    PaletteImageData walk1Image(SAMPLE_CHAR_WALK1_12x16, 12, 16);
-    PaletteImageData walk2Image(SAMPLE_CHAR_WALK2_12x16, 12, 16);
-    
-    RetroAnimation::AnimationFrame walkFrames[] = {
-        {&standImage, 500, 0, 0},  // 立ち：500ms
-        {&walk1Image, 300, 0, 0},  // 歩き1：300ms
-        {&standImage, 200, 0, 0},  // 立ち：200ms
-        {&walk2Image, 300, 0, 0}   // 歩き2：300ms
-    };
-    
-    RetroAnimation walkAnimation(walkFrames, 4, true);
-    PaletteImageRenderer renderer(display, 76, 284);
-    
-    walkAnimation.start();
-    
-    for (int i = 0; i < 200; i++) {  // 20秒間のアニメーション
-        renderer.clearCanvas(0x0400);  // ダークグリーン背景
-        
-        if (walkAnimation.update()) {
-            ESP_LOGI(TAG, "Animation frame changed");
-        }
-        
-        const PaletteImageData* currentFrame = walkAnimation.getCurrentFrame();
-        if (currentFrame) {
-            int offsetX, offsetY;
-            walkAnimation.getCurrentOffset(offsetX, offsetY);
-            renderer.drawToCanvas(*currentFrame, 32 + offsetX, 134 + offsetY, true);
-        }
-        
-        renderer.pushCanvasToDisplayOpaque(0, 0);
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-    }
-    
-    ESP_LOGI(TAG, "Character walk animation complete");
-}
-
-void RetroGameExample::paletteEffectExample(LGFX_ST7789P3_76x284* display) {
-    ESP_LOGI(TAG, "=== Palette Effect Example ===");
-    
-    PaletteImageData faceImage(SAMPLE_FACE_16x16, 16, 16);
-    PaletteImageRenderer renderer(display, 76, 284);
-    
-    for (int frame = 0; frame < 120; frame++) {
-        renderer.clearCanvas(0x0000);
-        
-        // パレット色相を動的に変更
-        RetroColorPalette dynamicPalette;
-        for (int i = 1; i < 16; i++) {
-            uint16_t hue = (frame * 3 + i * 24) % 360;
-            dynamicPalette.setColor(i, RetroColorPalette::hsvToRgb565(hue, 80, 90));
-        }
-        
-        // パレットを変更
-        PaletteImageData coloredFace = faceImage;
-        coloredFace.setPalette(dynamicPalette);
-        
-        renderer.drawToCanvas(coloredFace, 30, 134, true);
-        renderer.pushCanvasToDisplayOpaque(0, 0);
-        
-        vTaskDelay(100 / portTICK_PERIOD_MS);
-    }
-    
-    ESP_LOGI(TAG, "Palette effect complete");
-}
\ No newline at end of file
@@ -13,8 +13,14 @@
 #pragma once
 
 #include <M5Unified.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "LGFX_ST7789P3_76x284.hpp"
 
+struct RetroCollisionMask;  // RetroCollisionMask.hpp
+class RetroHotAssetCache;   // RetroHotAssetCache.hpp
+
 /**
  * 16色レトロパレット定義
  * インデックス0は透明色として予約
@@ -23,11 +29,27 @@ struct RetroColorPalette {
     static constexpr uint8_t TRANSPARENT_INDEX = 0;  // 透明色インデックス
     static constexpr uint8_t MAX_COLORS = 16;        // パレット色数
     
+    /**
+     * バイト→2ピクセル変換テーブル
+     * パックされた1バイト（2ピクセル）から直接RGB565を引く
+     */
+    struct PixelPairLut {
+        uint32_t pairs[256];        // 下位16bit: 偶数ピクセル, 上位16bit: 奇数ピクセル（バイトスワップ済み）
+        uint8_t opaqueMask[256];    // bit0: 偶数ピクセル不透明, bit1: 奇数ピクセル不透明
+    };
+    
     uint16_t colors[MAX_COLORS];  // RGB565形式のカラーパレット
     
     // デフォルトコンストラクタ（レトロゲーム風16色パレット）
     RetroColorPalette();
     
+    // コピー（変換テーブルは共有せず、必要時に再構築）
+    RetroColorPalette(const RetroColorPalette& other);
+    RetroColorPalette& operator=(const RetroColorPalette& other);
+    
+    // デストラクタ
+    ~RetroColorPalette();
+    
     /**
      * クラシックレトロゲーム風カラーパレット初期化
      * ファミコン風の色合いを再現
@@ -53,6 +75,27 @@ struct RetroColorPalette {
      */
     void setColor(uint8_t index, uint16_t color);
     
+    /**
+     * バイト→2ピクセル変換テーブルを取得
+     * パレット変更後の初回呼び出し時のみ再構築する
+     * @return 変換テーブル（確保失敗時はnullptr）
+     */
+    const PixelPairLut* getPairLut() const;
+    
+    /**
+     * 変換テーブルを無効化
+     * colors[]を直接書き換えた場合に呼び出す
+     */
+    void invalidateLut();
+    
+    /**
+     * RGB565色に最も近いパレットインデックスを検索
+     * 完全一致を優先し、無ければRGB距離で最も近い色を返す
+     * @param color RGB565色
+     * @return パレットインデックス（0-15）
+     */
+    uint8_t findClosestIndex(uint16_t color) const;
+    
     /**
      * RGB888からRGB565への変換ヘルパー
      * @param r 赤成分（0-255）
@@ -70,6 +113,10 @@ struct RetroColorPalette {
      * @return RGB565色
      */
     static uint16_t hsvToRgb565(uint16_t h, uint8_t s, uint8_t v);
+
+private:
+    mutable PixelPairLut* lut;    // 変換テーブル（遅延確保）
+    mutable bool lutDirty;        // 再構築が必要か
 };
 
 /**
@@ -81,6 +128,7 @@ struct PaletteImageData {
     RetroColorPalette palette;     // カラーパレット
     int width, height;             // 画像サイズ
     size_t dataSize;               // データサイズ（バイト）
+    const RetroCollisionMask* collisionMask;  // 当たり判定マスク（nullptr=未設定）
     
     /**
      * コンストラクタ
@@ -128,11 +176,189 @@ struct PaletteImageData {
     void setPalette(const RetroColorPalette& newPalette);
 };
 
+/**
+ * ランレングス圧縮パレット画像データ構造体
+ * image_to_palette.py --rle で生成
+ *
+ * 行ごとに独立したトークン列で、rowOffsetsから任意の行へ直接移動できる
+ * - 繰り返しラン: 1LLLLLLL（長さ-1）+ 2ピクセル分の模様1バイト
+ *   ランのi番目のピクセルはiが偶数なら下位4bit、奇数なら上位4bit（単色は0x11倍）
+ * - リテラル: 0LLLLLLL（長さ-1）+ 1バイト2ピクセルのデータ（偶数ピクセルが下位4bit）
+ * トークンが行をまたぐことはない
+ */
+struct PaletteRleImageData {
+    static constexpr uint8_t RUN_FLAG = 0x80;      // 繰り返しランのフラグ
+    static constexpr int MAX_TOKEN_PIXELS = 128;   // 1トークンの最大ピクセル数
+
+    const uint8_t* data;           // 圧縮データ配列（コンスト）
+    const uint16_t* rowOffsets;    // 各行の先頭オフセット（height+1要素、末尾は全体サイズ）
+    RetroColorPalette palette;     // カラーパレット
+    int width, height;             // 画像サイズ
+    size_t dataSize;               // 圧縮データサイズ（バイト）
+
+    /**
+     * コンストラクタ
+     * @param rleData 圧縮データ配列のポインタ
+     * @param offsets 行オフセット配列のポインタ（height+1要素）
+     * @param w 画像幅
+     * @param h 画像高さ
+     * @param customPalette カスタムパレット（nullptr = デフォルト）
+     */
+    PaletteRleImageData(const uint8_t* rleData, const uint16_t* offsets, int w, int h,
+                        const RetroColorPalette* customPalette = nullptr);
+
+    /**
+     * 指定座標のパレットインデックスを取得
+     * 行頭からトークンを辿るため、1ピクセルずつの読み出しには向かない
+     * @param x X座標
+     * @param y Y座標
+     * @return パレットインデックス（0-15）
+     */
+    uint8_t getPixelIndex(int x, int y) const;
+
+    /**
+     * 指定座標のRGB565色を取得
+     * @param x X座標
+     * @param y Y座標
+     * @return RGB565色
+     */
+    uint16_t getPixelColor(int x, int y) const;
+
+    /**
+     * 透明ピクセルかどうかチェック
+     * @param x X座標
+     * @param y Y座標
+     * @return true=透明, false=不透明
+     */
+    bool isTransparent(int x, int y) const;
+
+    /**
+     * メモリ使用量を計算（行オフセット含む）
+     * @return 使用メモリ量（バイト）
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * パレットを変更
+     * @param newPalette 新しいパレット
+     */
+    void setPalette(const RetroColorPalette& newPalette);
+};
+
+/**
+ * 1bitモノクロ画像データ構造体
+ * image_to_c_header.py（append/display_images.h）の形式をそのまま扱う
+ *
+ * 1バイト8ピクセル、MSBが左端のピクセル、各行はバイト単位に切り上げ（(width+7)/8バイト）
+ * ビット0/1それぞれの色を2色パレットとして持つ
+ */
+struct MonoImageData {
+    const uint8_t* data;           // ビットマップ配列（コンスト）
+    uint16_t colors[2];            // ビット0/1の色（RGB565）
+    int width, height;             // 画像サイズ
+    int rowBytes;                  // 1行のバイト数
+    size_t dataSize;               // データサイズ（バイト）
+
+    /**
+     * コンストラクタ
+     * デフォルトは image_to_c_header.py の出力（1=黒、0=白）に合わせる
+     * @param bitmap ビットマップ配列のポインタ
+     * @param w 画像幅
+     * @param h 画像高さ
+     * @param color1 ビット1の色（RGB565）
+     * @param color0 ビット0の色（RGB565）
+     */
+    MonoImageData(const uint8_t* bitmap, int w, int h, uint16_t color1 = 0x0000, uint16_t color0 = 0xFFFF);
+
+    /**
+     * 指定座標のビットを取得
+     * @param x X座標
+     * @param y Y座標
+     * @return 0または1（範囲外は0）
+     */
+    uint8_t getPixelBit(int x, int y) const;
+
+    /**
+     * 指定座標のRGB565色を取得
+     * @param x X座標
+     * @param y Y座標
+     * @return RGB565色
+     */
+    uint16_t getPixelColor(int x, int y) const;
+
+    /**
+     * メモリ使用量を計算
+     * @return 使用メモリ量（バイト）
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * 2色パレットを変更
+     * @param color1 ビット1の色（RGB565）
+     * @param color0 ビット0の色（RGB565）
+     */
+    void setColors(uint16_t color1, uint16_t color0);
+};
+
 /**
  * パレット画像描画クラス
  * M5Canvas経由での高速描画を提供
  */
 class PaletteImageRenderer {
+public:
+    static constexpr int MAX_DIRTY_RECTS = 16;  // 保持するダーティ矩形の最大数
+    
+    // 変換描画フラグ（drawToCanvasTransformed）
+    static constexpr uint8_t BLIT_NONE = 0;       // 変換なし
+    static constexpr uint8_t BLIT_FLIP_H = 1;     // 左右反転
+    static constexpr uint8_t BLIT_FLIP_V = 2;     // 上下反転
+    static constexpr uint8_t BLIT_ROTATE_90 = 4;  // 時計回りに90度回転（反転の後に適用）
+    static constexpr uint8_t BLIT_ROTATE_180 = BLIT_FLIP_H | BLIT_FLIP_V;                  // 180度回転
+    static constexpr uint8_t BLIT_ROTATE_270 = BLIT_FLIP_H | BLIT_FLIP_V | BLIT_ROTATE_90; // 270度回転
+    
+    /**
+     * ダーティ矩形（キャンバス座標）
+     */
+    struct DirtyRect {
+        int x, y;                     // 左上座標
+        int w, h;                     // サイズ
+    };
+    
+    // プロファイラの計測ステージ
+    static constexpr int STAGE_CLEAR = 0;       // クリア・塗りつぶし
+    static constexpr int STAGE_BLIT = 1;        // 画像のデコード・描画
+    static constexpr int STAGE_PUSH = 2;        // ディスプレイへの転送
+    static constexpr int PROFILE_STAGES = 3;    // ステージ数
+    static constexpr int PROFILE_WINDOW = 100;  // 統計に使う直近フレーム数
+    
+    /**
+     * 時間統計（マイクロ秒、直近PROFILE_WINDOWフレーム）
+     */
+    struct TimingStats {
+        uint32_t minUs;               // 最小
+        uint32_t avgUs;               // 平均
+        uint32_t p99Us;               // 99パーセンタイル
+        uint32_t lastUs;              // 直近フレーム
+    };
+    
+    /**
+     * 描画統計
+     * プッシュ1回（pushCanvasToDisplay系・pushDirtyRegions・swapBuffers）を1フレームとして集計
+     */
+    struct RenderStats {
+        TimingStats stage[PROFILE_STAGES];  // ステージ別の時間
+        TimingStats render;                 // 3ステージの合計
+        TimingStats interval;               // 前フレームのプッシュからの経過時間
+        uint32_t samples;                   // 統計に含まれるフレーム数
+        uint32_t frames;                    // 累計フレーム数
+        uint32_t lastPixels;                // 直近フレームでキャンバスに書いたピクセル数
+        uint32_t lastSpiBytes;              // 直近フレームでSPI送信したバイト数
+        uint64_t totalPixels;               // 累計ピクセル数
+        uint64_t totalSpiBytes;             // 累計SPI送信バイト数
+        uint32_t assetHits;                 // 高速アセットキャッシュから読んだ回数（未設定時0）
+        uint32_t assetMisses;               // フラッシュ上の画像データを直接読んだ回数（未設定時0）
+    };
+    
 private:
     LGFX_ST7789P3_76x284* display;    // ディスプレイインスタンス
     M5Canvas* canvas;                 // 描画用キャンバス
@@ -141,6 +367,222 @@ private:
     uint16_t* lineBuffer;             // ライン描画用バッファ
     size_t bufferSize;                // バッファサイズ
     
+    uint16_t* scaleXMap;              // スケール描画用のソースX座標テーブル
+    uint8_t* scaleRowIndex;           // スケール済み1行分のパレットインデックス
+    size_t scaleBufferSize;           // スケール描画用バッファの幅
+    
+    RetroColorPalette canvasPalette;  // 4bitキャンバスのパレット
+    RetroHotAssetCache* assetCache;   // 高速アセットキャッシュ（nullptr=未使用）
+    
+    DirtyRect dirtyRects[MAX_DIRTY_RECTS];  // 前回プッシュ以降の変更領域
+    int dirtyCount;                         // ダーティ矩形数
+    
+    // ダブルバッファ（非同期プッシュ）
+    M5Canvas* frontCanvas;                  // 転送中のキャンバス
+    M5Canvas* secondaryCanvas;              // ダブルバッファ用に確保したキャンバス
+    TaskHandle_t pushTask;                  // 転送タスク
+    SemaphoreHandle_t pushDone;             // 転送完了フェンス
+    volatile bool pushTaskStop;             // 転送タスク停止要求
+    int pushX, pushY;                       // 転送先座標
+    
+    // プロファイラ
+    static constexpr int PROFILE_SERIES = PROFILE_STAGES + 2;  // ステージ＋合計＋フレーム間隔
+    struct ProfileState {
+        bool enabled = true;                    // 計測有効フラグ
+        int depth = 0;                          // 計測区間の入れ子（外側だけ計上）
+        uint32_t stageUs[PROFILE_STAGES] = {};  // 現フレームのステージ別累積時間
+        uint32_t pixels = 0;                    // 現フレームの書き込みピクセル数
+        uint32_t* samples = nullptr;            // 系列×PROFILE_WINDOWのリングバッファ（遅延確保）
+        int head = 0;                           // 次の書き込み位置
+        int count = 0;                          // 有効サンプル数
+        int64_t lastFrameEnd = 0;               // 前フレームのプッシュ完了時刻
+        uint32_t frames = 0;                    // 累計フレーム数
+        uint32_t lastPixels = 0;                // 直近フレームのピクセル数
+        uint32_t lastSpiBytes = 0;              // 直近フレームのSPI送信バイト数
+        uint64_t totalPixels = 0;               // 累計ピクセル数
+        uint64_t totalSpiBytes = 0;             // 累計SPI送信バイト数
+        uint32_t logInterval = 0;               // ログ出力間隔（フレーム数、0=無効）
+    };
+    ProfileState profile;
+    
+    /**
+     * ステージの計測区間（スコープを抜けた時点で加算）
+     */
+    struct ProfileScope {
+        PaletteImageRenderer* owner;
+        int stage;
+        int64_t start;
+        bool active;
+        ProfileScope(PaletteImageRenderer* renderer, int profileStage);
+        ~ProfileScope();
+    };
+    
+    /**
+     * 現フレームの書き込みピクセル数に加算
+     * @param width 幅
+     * @param height 高さ
+     */
+    void addProfilePixels(int width, int height);
+    
+    /**
+     * フレームを締めて統計に追加
+     * @param spiBytes このフレームで送信したバイト数
+     */
+    void endProfileFrame(size_t spiBytes);
+
+    /**
+     * 画像矩形をキャンバス範囲でクリップ
+     * @param imgWidth 画像幅
+     * @param imgHeight 画像高さ
+     * @param offsetX 描画開始X座標
+     * @param offsetY 描画開始Y座標
+     * @param srcX クリップ後の画像側開始X（出力）
+     * @param srcY クリップ後の画像側開始Y（出力）
+     * @param width クリップ後の幅（出力）
+     * @param height クリップ後の高さ（出力）
+     * @return 描画範囲が残る場合true
+     */
+    bool clipToCanvas(int imgWidth, int imgHeight, int offsetX, int offsetY,
+                      int& srcX, int& srcY, int& width, int& height) const;
+
+    /**
+     * 画像の部分領域を画像範囲とキャンバス範囲でクリップ
+     * @param img パレット画像データ
+     * @param regionX 領域の画像側X座標
+     * @param regionY 領域の画像側Y座標
+     * @param regionWidth 領域の幅
+     * @param regionHeight 領域の高さ
+     * @param offsetX 領域左上の描画先X座標
+     * @param offsetY 領域左上の描画先Y座標
+     * @param srcX クリップ後の画像側開始X（出力）
+     * @param srcY クリップ後の画像側開始Y（出力）
+     * @param dstX クリップ後の描画先X（出力）
+     * @param dstY クリップ後の描画先Y（出力）
+     * @param width クリップ後の幅（出力）
+     * @param height クリップ後の高さ（出力）
+     * @return 描画範囲が残る場合true
+     */
+    bool clipRegionToCanvas(const PaletteImageData& img, int regionX, int regionY,
+                            int regionWidth, int regionHeight, int offsetX, int offsetY,
+                            int& srcX, int& srcY, int& dstX, int& dstY,
+                            int& width, int& height) const;
+
+    /**
+     * 16bitキャンバスのバッファを取得（直接書き込み用）
+     * バッファはST7789のバス順（バイトスワップ済みRGB565）
+     * @return バッファのポインタ（16bit以外のキャンバスはnullptr）
+     */
+    uint16_t* getCanvasBuffer16() const;
+
+    /**
+     * 4bitパレットキャンバスのバッファを取得（直接書き込み用）
+     * 1バイト2ピクセル、偶数ピクセルが上位4bit（LovyanGFXの配置）
+     * @return バッファのポインタ（4bitパレット以外のキャンバスはnullptr）
+     */
+    uint8_t* getCanvasBuffer4() const;
+
+    /**
+     * 4bitキャンバスへインデックスをそのままコピー
+     * @param img パレット画像データ
+     * @param data 画像データ（キャッシュ読み替え済み）
+     * @param regionX 領域の画像側X座標
+     * @param regionY 領域の画像側Y座標
+     * @param regionWidth 領域の幅
+     * @param regionHeight 領域の高さ
+     * @param offsetX 描画開始X座標
+     * @param offsetY 描画開始Y座標
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawToIndexedCanvas(const PaletteImageData& img, const uint8_t* data, int regionX, int regionY,
+                             int regionWidth, int regionHeight,
+                             int offsetX, int offsetY, bool useTransparency);
+
+    /**
+     * 画像の部分領域を不透明で描画（変換テーブルで32bit単位展開）
+     * @param img パレット画像データ
+     * @param data 画像データ（キャッシュ読み替え済み）
+     * @param regionX 領域の画像側X座標
+     * @param regionY 領域の画像側Y座標
+     * @param regionWidth 領域の幅
+     * @param regionHeight 領域の高さ
+     * @param offsetX 描画開始X座標
+     * @param offsetY 描画開始Y座標
+     */
+    void drawRegionOpaque(const PaletteImageData& img, const uint8_t* data, int regionX, int regionY,
+                          int regionWidth, int regionHeight, int offsetX, int offsetY);
+
+    /**
+     * 読み替え済みの画像データで部分領域を描画（drawRegionToCanvas の本体）
+     * @param img パレット画像データ
+     * @param data 画像データ（キャッシュ読み替え済み）
+     * @param regionX 領域の画像側X座標
+     * @param regionY 領域の画像側Y座標
+     * @param regionWidth 領域の幅
+     * @param regionHeight 領域の高さ
+     * @param offsetX 描画開始X座標
+     * @param offsetY 描画開始Y座標
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawRegionWithData(const PaletteImageData& img, const uint8_t* data, int regionX, int regionY,
+                            int regionWidth, int regionHeight, int offsetX, int offsetY, bool useTransparency);
+
+    /**
+     * 描画に使う画像データを取得（高速アセットキャッシュがあれば内部RAMのコピーに読み替え）
+     * 1回の描画呼び出しにつき1回だけ呼ぶ（ヒット・ミスの計数のため）
+     * @param img パレット画像データ
+     * @return 画像データ
+     */
+    const uint8_t* resolveImageData(const PaletteImageData& img);
+
+    // 特殊化した行ループの種類
+    static constexpr uint8_t BLIT_MODE_NORMAL = 0;   // 等倍
+    static constexpr uint8_t BLIT_MODE_FLIP_X = 1;   // 等倍・左右反転
+    static constexpr uint8_t BLIT_MODE_SCALE2 = 2;   // 整数倍拡大（2〜4倍は BLIT_MODE_SCALE2 + 倍率 - 2）
+    static constexpr uint8_t BLIT_MODE_COUNT = 5;
+    static constexpr int BLIT_MAX_INT_SCALE = 4;     // 特殊化する最大の整数倍率
+
+    /**
+     * 透明色・左右反転・整数倍率・出力深度ごとにコンパイル時特殊化した行ループで描画
+     * 該当する特殊化が無い（Kconfigで外した）場合やLGFX経由の描画は何もせずfalseを返す
+     * @param img パレット画像データ
+     * @param data 画像データ（キャッシュ読み替え済み）
+     * @param srcPixel 出力先頭行の先頭ピクセルのソース位置（クリップ済み）
+     * @param srcRowStep ソース行の増分（上下反転時は負）
+     * @param dstX 描画開始X座標（クリップ済み）
+     * @param dstY 描画開始Y座標（クリップ済み）
+     * @param width 描画幅
+     * @param height 描画高さ
+     * @param mode 行ループの種類（BLIT_MODE_*）
+     * @param phaseX 拡大時の先頭ピクセルの拡大内の位置
+     * @param phaseY 拡大時の先頭行の拡大内の位置
+     * @param useTransparency 透明色を使用するか
+     * @return 描画した場合true
+     */
+    bool blitSpecialized(const PaletteImageData& img, const uint8_t* data, int srcPixel, int srcRowStep,
+                         int dstX, int dstY, int width, int height,
+                         uint8_t mode, int phaseX, int phaseY, bool useTransparency);
+
+    /**
+     * スケール描画用バッファを確保
+     * @param maxWidth 最大描画幅
+     * @return 確保できた場合true
+     */
+    bool initScaleBuffer(int maxWidth);
+
+    /**
+     * 転送タスク本体
+     * @param arg レンダラーインスタンス
+     */
+    static void pushTaskEntry(void* arg);
+
+    /**
+     * キャンバスを表示用にDMA転送（転送完了まで待つ）
+     * @param target 転送するキャンバス
+     * @param x ディスプレイ上のX座標
+     * @param y ディスプレイ上のY座標
+     */
+    void pushCanvasDMA(M5Canvas* target, int x, int y);
+
 public:
     /**
      * コンストラクタ（外部キャンバス使用）
@@ -157,6 +599,18 @@ public:
      */
     PaletteImageRenderer(LGFX_ST7789P3_76x284* gfx, int canvasWidth, int canvasHeight);
     
+    /**
+     * コンストラクタ（4bitパレットキャンバス作成）
+     * キャンバスはパレットインデックスのまま保持し、RGB565への展開はプッシュ時に行う
+     * メモリ使用量は16bitキャンバスの1/4
+     * @param gfx ディスプレイインスタンス
+     * @param canvasWidth キャンバス幅
+     * @param canvasHeight キャンバス高さ
+     * @param palette キャンバスのパレット
+     */
+    PaletteImageRenderer(LGFX_ST7789P3_76x284* gfx, int canvasWidth, int canvasHeight,
+                         const RetroColorPalette& palette);
+    
     /**
      * デストラクタ
      */
@@ -170,6 +624,8 @@ public:
     
     /**
      * パレット画像をキャンバスに描画（透明色対応）
+     * 1行を1バイト2ピクセルで展開し、不透明ピクセルのランのみ書き込む
+     * 4bitキャンバスでは画像のパレットは使わずインデックスをそのままコピーする
      * @param img パレット画像データ
      * @param offsetX 描画開始X座標
      * @param offsetY 描画開始Y座標
@@ -179,14 +635,70 @@ public:
     
     /**
      * パレット画像をキャンバスに高速描画（不透明）
+     * 変換テーブルで1バイトを32bit（2ピクセル）単位で書き込む
      * @param img パレット画像データ
      * @param offsetX 描画開始X座標
      * @param offsetY 描画開始Y座標
      */
     void drawToCanvasOpaque(const PaletteImageData& img, int offsetX = 0, int offsetY = 0);
-    
+
+    /**
+     * パレット画像の部分領域をキャンバスに描画
+     * スプライトシートやタイルセットから1枚分を切り出す用途
+     * @param img パレット画像データ
+     * @param regionX 領域の画像側X座標
+     * @param regionY 領域の画像側Y座標
+     * @param regionWidth 領域の幅
+     * @param regionHeight 領域の高さ
+     * @param offsetX 領域左上の描画先X座標
+     * @param offsetY 領域左上の描画先Y座標
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawRegionToCanvas(const PaletteImageData& img, int regionX, int regionY,
+                            int regionWidth, int regionHeight,
+                            int offsetX, int offsetY, bool useTransparency = true);
+
+    /**
+     * パレット画像を反転・回転してキャンバスに描画
+     * 出力行ごとにソースの開始ピクセルと進み幅（左右反転は-1、回転は±画像幅）を求め、
+     * 座標変換なしで1行ずつデコードする
+     * 上下反転のみの場合は通常の行コピーを逆順に行う
+     * @param img パレット画像データ
+     * @param offsetX 変換後の画像左上の描画先X座標
+     * @param offsetY 変換後の画像左上の描画先Y座標
+     * @param transform 変換フラグ（BLIT_FLIP_H | BLIT_FLIP_V | BLIT_ROTATE_90）
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawToCanvasTransformed(const PaletteImageData& img, int offsetX, int offsetY,
+                                 uint8_t transform, bool useTransparency = true);
+
+    /**
+     * 圧縮パレット画像をキャンバスに描画
+     * 繰り返しランは塗りつぶしとして、リテラルはスパン展開として処理し、
+     * 透明ランはピクセル単位の判定なしでスキップする
+     * @param img 圧縮パレット画像データ
+     * @param offsetX 描画開始X座標
+     * @param offsetY 描画開始Y座標
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawToCanvas(const PaletteRleImageData& img, int offsetX = 0, int offsetY = 0, bool useTransparency = true);
+
+    /**
+     * 1bitモノクロ画像をキャンバスに描画
+     * 1バイト8ピクセルを4ピクセル単位の変換テーブルで一度に展開する
+     * 4bitキャンバスでは2色をキャンバスパレットの最も近いインデックスに置き換える
+     * @param img モノクロ画像データ
+     * @param offsetX 描画開始X座標
+     * @param offsetY 描画開始Y座標
+     * @param useTransparency true=ビット0を透明として扱う（全ビット0のバイトは丸ごとスキップ）
+     */
+    void drawToCanvas(const MonoImageData& img, int offsetX = 0, int offsetY = 0, bool useTransparency = true);
+
     /**
      * パレット画像をキャンバスに描画（スケーリング対応）
+     * ソースX座標は16.16固定小数点で行ごとに1回だけテーブル化し、
+     * 同じソース行に対応する出力行はデコード結果を使い回す
+     * 2倍・0.5倍は専用カーネルで処理する
      * @param img パレット画像データ
      * @param offsetX 描画開始X座標
      * @param offsetY 描画開始Y座標
@@ -199,9 +711,10 @@ public:
     
     /**
      * キャンバスをディスプレイにプッシュ（透明色対応）
+     * 4bitキャンバスはここでパレットからRGB565へ展開される
      * @param x ディスプレイ上のX座標
      * @param y ディスプレイ上のY座標
-     * @param transparentColor 透明色（RGB565）
+     * @param transparentColor 透明色（RGB565、4bitキャンバスでは最も近いパレット色）
      */
     void pushCanvasToDisplay(int x = 0, int y = 0, uint16_t transparentColor = 0x0000);
     
@@ -212,12 +725,187 @@ public:
      */
     void pushCanvasToDisplayOpaque(int x = 0, int y = 0);
     
+    /**
+     * 変更のあった領域だけをディスプレイにプッシュ（不透明）
+     * プッシュ後にダーティ矩形はクリアされる
+     * @param x キャンバス左上のディスプレイ上X座標
+     * @param y キャンバス左上のディスプレイ上Y座標
+     * @return 送信したピクセルデータのバイト数
+     */
+    size_t pushDirtyRegions(int x = 0, int y = 0);
+    
+    /**
+     * 領域を変更済みとして登録
+     * getCanvas()経由で直接描画した場合に呼び出す
+     * 重なる・接する矩形は結合する
+     * @param x 左上X座標
+     * @param y 左上Y座標
+     * @param w 幅
+     * @param h 高さ
+     */
+    void markDirty(int x, int y, int w, int h);
+    
+    /**
+     * キャンバス全体を変更済みとして登録
+     */
+    void markAllDirty();
+    
+    /**
+     * ダーティ矩形をすべて破棄
+     */
+    void clearDirty();
+    
+    /**
+     * ダーティ矩形数を取得
+     * @return 矩形数
+     */
+    int getDirtyRectCount() const;
+    
+    /**
+     * ダーティ矩形配列を取得
+     * @return 矩形配列（要素数はgetDirtyRectCount()）
+     */
+    const DirtyRect* getDirtyRects() const;
+    
+    /**
+     * キャンバスの矩形を塗りつぶし（ダーティ登録付き）
+     * スプライトの移動前の位置を消す用途
+     * @param x 左上X座標
+     * @param y 左上Y座標
+     * @param w 幅
+     * @param h 高さ
+     * @param color 塗りつぶし色（4bitキャンバスでは最も近いパレット色）
+     */
+    void fillCanvasRect(int x, int y, int w, int h, uint16_t color);
+    
+    /**
+     * ダブルバッファモードを開始
+     * 同じ形式のキャンバスをもう1枚確保し、指定コアの転送タスクが
+     * 表側をDMAで送る間にアプリ側は裏側（getCanvas()）へ次フレームを描画できる
+     * 16bitキャンバスでは2枚分のメモリが必要なため4bitキャンバス推奨
+     * 有効中はディスプレイへ直接描画しないこと
+     * @param coreId 転送タスクを固定するコア
+     * @return 開始できた場合true
+     */
+    bool enableDoubleBuffer(int coreId = 1);
+    
+    /**
+     * ダブルバッファモードを終了
+     * 転送完了を待ち、描画中だった裏側の内容を元のキャンバスに引き継ぐ
+     */
+    void disableDoubleBuffer();
+    
+    /**
+     * ダブルバッファモード中かどうか
+     * @return true=有効
+     */
+    bool isDoubleBuffered() const;
+    
+    /**
+     * 裏側と表側を入れ替えて転送を開始
+     * 前フレームの転送完了を待ってから入れ替えるので、戻った時点で
+     * getCanvas()は次フレーム用の裏側を指す（内容は2フレーム前）
+     * 無効時はpushCanvasToDisplayOpaque()と同じ
+     * @param x ディスプレイ上のX座標
+     * @param y ディスプレイ上のY座標
+     */
+    void swapBuffers(int x = 0, int y = 0);
+    
+    /**
+     * 転送中のフレームが完了するまで待つ（フェンス）
+     */
+    void waitForPushComplete();
+    
+    /**
+     * キャンバスの向きを保ったままディスプレイの回転角度を切り替え（setRotationFast()）
+     * 幅・高さが変わらない回転（0↔2・1↔3）だけ受け付け、キャンバスは描き直さない
+     * ダブルバッファ中は表示中のフレームをすぐ転送し直し、
+     * それ以外はキャンバス全体をダーティ登録するので次のpushDirtyRegions()で全体が送られる
+     * @param rotation 回転角度
+     * @return 切り替えた場合true（幅・高さが入れ替わる回転はfalse、キャンバスを作り直すこと）
+     */
+    bool rotateDisplay(int rotation);
+    
     /**
      * キャンバスをクリア
+     * 4bitキャンバスでは最も近いパレット色で塗りつぶす
      * @param color クリア色
      */
     void clearCanvas(uint16_t color = 0x0000);
     
+    /**
+     * キャンバスをパレットインデックスでクリア
+     * @param index パレットインデックス（4bitキャンバス以外はパレット色で塗りつぶし）
+     */
+    void clearCanvasIndex(uint8_t index);
+    
+    /**
+     * 4bitキャンバスのパレットを変更
+     * 再描画不要で次回プッシュ時から反映される
+     * @param palette 新しいパレット
+     */
+    void setCanvasPalette(const RetroColorPalette& palette);
+    
+    /**
+     * 4bitキャンバスのパレットを取得
+     * @return キャンバスのパレット
+     */
+    const RetroColorPalette& getCanvasPalette() const;
+    
+    /**
+     * 4bitパレットキャンバスかどうか
+     * @return true=4bitパレット, false=それ以外
+     */
+    bool isIndexedCanvas() const;
+    
+    /**
+     * 高速アセットキャッシュを設定
+     * 以降のパレット画像の描画は、キャッシュ済みのデータを内部RAMのコピーから読む
+     * @param cache キャッシュ（nullptr=使用しない）
+     */
+    void setAssetCache(RetroHotAssetCache* cache);
+    
+    /**
+     * 高速アセットキャッシュを取得
+     * @return キャッシュ（未設定時nullptr）
+     */
+    RetroHotAssetCache* getAssetCache() const;
+    
+    /**
+     * 描画統計を取得
+     * @return 直近PROFILE_WINDOWフレームの統計
+     */
+    RenderStats getStats() const;
+    
+    /**
+     * 描画統計をリセット
+     */
+    void resetStats();
+    
+    /**
+     * 計測の有効/無効を切り替え（デフォルト有効）
+     * 無効にするとサンプル用バッファも解放する
+     * @param enable true=有効
+     */
+    void setProfilingEnabled(bool enable);
+    
+    /**
+     * 計測が有効かどうか
+     * @return true=有効
+     */
+    bool isProfilingEnabled() const;
+    
+    /**
+     * 統計を定期的にログ出力
+     * @param frames 出力間隔（フレーム数、0=出力しない）
+     */
+    void setStatsLogInterval(uint32_t frames);
+    
+    /**
+     * 現在の統計を1行でログ出力
+     */
+    void logStats() const;
+    
     /**
      * キャンバスの取得
      * @return キャンバスのポインタ
@@ -269,6 +957,20 @@ public:
      */
     bool update();
     
+    /**
+     * 指定時刻でアニメーション更新
+     * 切り替え時刻は予定時刻から積み上げる（呼び出しが遅れても周期がずれない）
+     * @param timeMs 現在時刻（ミリ秒）
+     * @return フレームが変更された場合true
+     */
+    bool update(uint32_t timeMs);
+    
+    /**
+     * 次にフレームが切り替わる時刻を取得
+     * @return 切り替え時刻（ミリ秒、esp_timer基準）
+     */
+    uint32_t getNextFrameTime() const;
+    
     /**
      * 現在のフレーム画像を取得
      * @return 現在のフレーム画像（nullptr=終了）
@@ -282,6 +984,32 @@ public:
      */
     void getCurrentOffset(int& offsetX, int& offsetY);
     
+    /**
+     * 現在のフレームの当たり判定マスクを取得
+     * フレーム画像に設定されたマスク（PaletteImageData::collisionMask）を返す
+     * @return マスク（nullptr=終了・未設定）
+     */
+    const RetroCollisionMask* getCurrentMask() const;
+    
+    /**
+     * フレーム数を取得
+     * @return フレーム数
+     */
+    int getFrameCount() const;
+    
+    /**
+     * 現在のフレーム番号を取得（停止中も保持している番号を返す）
+     * @return フレーム番号（非ループ再生の終了後はフレーム数）
+     */
+    int getCurrentFrameIndex() const;
+    
+    /**
+     * 指定フレームの画像を取得（先読み用）
+     * @param index フレーム番号
+     * @return フレーム画像（範囲外はnullptr）
+     */
+    const PaletteImageData* getFrameImage(int index) const;
+    
     /**
      * アニメーション開始
      */
@@ -346,33 +1074,3 @@ extern const uint8_t SAMPLE_CHAR_WALK1_12x16[];
  * RPG風キャラクター
  */
 extern const uint8_t SAMPLE_CHAR_WALK2_12x16[];
-
-/**
- * 基本的な使用方法のサンプルクラス
- */
-class RetroGameExample {
-public:
-    /**
-     * 基本描画のサンプル
-     * @param display ディスプレイインスタンス
-     */
-    static void basicUsageExample(LGFX_ST7789P3_76x284* display);
-    
-    /**
-     * アニメーションのサンプル
-     * @param display ディスプレイインスタンス
-     */
-    static void animationExample(LGFX_ST7789P3_76x284* display);
-    
-    /**
-     * キャラクター歩行アニメーションのサンプル
-     * @param display ディスプレイインスタンス
-     */
-    static void characterWalkExample(LGFX_ST7789P3_76x284* display);
-    
-    /**
-     * パレット変更エフェクトのサンプル
-     * @param display ディスプレイインスタンス
-     */
-    static void paletteEffectExample(LGFX_ST7789P3_76x284* display);
-};
\ No newline at end of file
@@ -0,0 +1,144 @@
+/*
+ * RetroHotAssetCache.cpp
+ * 内部RAMの高速アセットキャッシュ実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroHotAssetCache.hpp"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+
+// ログタグ定義
+static const char *TAG = "RetroHotAsset";
+
+RetroHotAssetCache::RetroHotAssetCache(size_t capacityBytes)
+    : arena(nullptr), capacity(0), used(0), entryCount(0), useCounter(0), hitCount(0), missCount(0) {
+    // フラッシュキャッシュを経由しないよう内部RAMに確保する
+    if (capacityBytes > 0) {
+        arena = (uint8_t*)heap_caps_malloc(capacityBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (arena) {
+        capacity = capacityBytes;
+        ESP_LOGI(TAG, "RetroHotAssetCache created: %zu bytes", capacity);
+    } else {
+        ESP_LOGE(TAG, "Failed to allocate asset cache (%zu bytes)", capacityBytes);
+    }
+}
+
+RetroHotAssetCache::~RetroHotAssetCache() {
+    heap_caps_free(arena);
+}
+
+int RetroHotAssetCache::find(const uint8_t* source) const {
+    for (int i = 0; i < entryCount; i++) {
+        if (entries[i].source == source) return i;
+    }
+    return -1;
+}
+
+void RetroHotAssetCache::removeEntry(int index) {
+    const Entry removed = entries[index];
+    const size_t tail = (arena + used) - (removed.copy + removed.size);
+    memmove(removed.copy, removed.copy + removed.size, tail);
+    used -= removed.size;
+
+    for (int i = index; i < entryCount - 1; i++) {
+        entries[i] = entries[i + 1];
+        entries[i].copy -= removed.size;
+    }
+    entryCount--;
+}
+
+bool RetroHotAssetCache::prefetch(const PaletteImageData& img) {
+    if (!img.data || img.dataSize == 0) return false;
+
+    // RAM上のデータはキャッシュミスしないのでコピーしない
+    if (!esp_ptr_in_drom(img.data)) return true;
+
+    const int existing = find(img.data);
+    if (existing >= 0) {
+        entries[existing].lastUse = ++useCounter;
+        return true;
+    }
+    if (img.dataSize > capacity) {
+        ESP_LOGE(TAG, "Asset too large to cache: %zu bytes (capacity %zu)", img.dataSize, capacity);
+        return false;
+    }
+
+    // 空きが足りなければ最も長く参照されていないものから追い出す
+    while (entryCount > 0 && (entryCount >= MAX_ENTRIES || used + img.dataSize > capacity)) {
+        int oldest = 0;
+        for (int i = 1; i < entryCount; i++) {
+            if (entries[i].lastUse < entries[oldest].lastUse) oldest = i;
+        }
+        removeEntry(oldest);
+    }
+
+    Entry& entry = entries[entryCount++];
+    entry.source = img.data;
+    entry.copy = arena + used;
+    entry.size = img.dataSize;
+    entry.lastUse = ++useCounter;
+    memcpy(entry.copy, img.data, img.dataSize);
+    used += img.dataSize;
+    return true;
+}
+
+int RetroHotAssetCache::prefetch(const RetroAnimation& anim) {
+    int cached = 0;
+    for (int i = 0; i < anim.getFrameCount(); i++) {
+        const PaletteImageData* image = anim.getFrameImage(i);
+        if (image && prefetch(*image)) cached++;
+    }
+    ESP_LOGI(TAG, "Prefetched %d/%d animation frames (%zu/%zu bytes used)",
+             cached, anim.getFrameCount(), used, capacity);
+    return cached;
+}
+
+const uint8_t* RetroHotAssetCache::lookup(const uint8_t* source) {
+    const int index = find(source);
+    if (index >= 0) {
+        entries[index].lastUse = ++useCounter;
+        hitCount++;
+        return entries[index].copy;
+    }
+    if (source && esp_ptr_in_drom(source)) {
+        missCount++;
+    }
+    return source;
+}
+
+bool RetroHotAssetCache::contains(const uint8_t* source) const {
+    return find(source) >= 0;
+}
+
+void RetroHotAssetCache::clear() {
+    entryCount = 0;
+    used = 0;
+}
+
+uint32_t RetroHotAssetCache::getHitCount() const {
+    return hitCount;
+}
+
+uint32_t RetroHotAssetCache::getMissCount() const {
+    return missCount;
+}
+
+uint32_t RetroHotAssetCache::getHitRate() const {
+    const uint32_t total = hitCount + missCount;
+    return total ? (uint32_t)((uint64_t)hitCount * 100 / total) : 0;
+}
+
+void RetroHotAssetCache::resetStats() {
+    hitCount = missCount = 0;
+}
+
+size_t RetroHotAssetCache::getUsedBytes() const {
+    return used;
+}
+
+size_t RetroHotAssetCache::getCapacity() const {
+    return capacity;
+}
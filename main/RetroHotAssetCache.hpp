@@ -0,0 +1,145 @@
+/*
+ * RetroHotAssetCache.hpp
+ * 内部RAMの高速アセットキャッシュ for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - フラッシュ上の画像データ（const配列）を内部RAMへコピーしておき、描画時に読み替える
+ * - SPI DMA転送中などにフラッシュキャッシュミスでラスタライズが止まるのを防ぐ
+ * - アニメーションのフレームをまとめて先読みできる
+ * - 容量を超える場合は最も長く参照されていないものから追い出す（LRU）
+ * - 参照のヒット数・ミス数を数え、描画統計（PaletteImageRenderer::getStats）に載せる
+ *
+ * 先読み・追い出しでコピーの位置が変わるため、prefetch は描画の合間（描画タスク）で行うこと
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * 高速アセットキャッシュ
+ * PaletteImageRenderer::setAssetCache() で設定したレンダラーが描画時に参照する
+ */
+class RetroHotAssetCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 8 * 1024;  // 内部RAMの確保量（デフォルト）
+    static constexpr int MAX_ENTRIES = 16;                // キャッシュできる画像数
+
+private:
+    /**
+     * キャッシュ項目（アリーナ内の並び順で保持）
+     */
+    struct Entry {
+        const uint8_t* source;         // 元データ（フラッシュ上）
+        uint8_t* copy;                 // 内部RAM上のコピー
+        size_t size;                   // バイト数
+        uint32_t lastUse;              // 最後に参照した時の通し番号（LRU用）
+    };
+
+    uint8_t* arena;                    // コピー置き場（内部RAM）
+    size_t capacity;                   // アリーナのバイト数
+    size_t used;                       // 使用中のバイト数
+    Entry entries[MAX_ENTRIES];        // キャッシュ項目
+    int entryCount;                    // 項目数
+    uint32_t useCounter;               // 参照の通し番号
+    uint32_t hitCount;                 // 描画時にキャッシュから読んだ回数
+    uint32_t missCount;                // 描画時にフラッシュから読んだ回数
+
+    /**
+     * 元データの項目を検索
+     * @param source 元データ
+     * @return 項目番号（無ければ-1）
+     */
+    int find(const uint8_t* source) const;
+
+    /**
+     * 項目を削除し、後ろのコピーを詰める
+     * @param index 項目番号
+     */
+    void removeEntry(int index);
+
+public:
+    /**
+     * コンストラクタ
+     * @param capacityBytes 内部RAMに確保するバイト数
+     */
+    explicit RetroHotAssetCache(size_t capacityBytes = DEFAULT_CAPACITY);
+
+    /**
+     * デストラクタ
+     */
+    ~RetroHotAssetCache();
+
+    // バッファを所有するためコピー禁止
+    RetroHotAssetCache(const RetroHotAssetCache&) = delete;
+    RetroHotAssetCache& operator=(const RetroHotAssetCache&) = delete;
+
+    /**
+     * 画像データを内部RAMへ先読み
+     * 元データが既にRAM上にある場合はコピーせずtrueを返す
+     * @param img パレット画像データ
+     * @return キャッシュ済み（またはコピー不要）ならtrue
+     */
+    bool prefetch(const PaletteImageData& img);
+
+    /**
+     * アニメーションの全フレームを先読み
+     * @param anim アニメーション
+     * @return キャッシュ済みのフレーム数
+     */
+    int prefetch(const RetroAnimation& anim);
+
+    /**
+     * 描画に使うデータを取得（ヒット・ミスを数える）
+     * @param source 元データ
+     * @return キャッシュ済みなら内部RAMのコピー、それ以外は元データ
+     */
+    const uint8_t* lookup(const uint8_t* source);
+
+    /**
+     * 元データがキャッシュ済みか
+     * @param source 元データ
+     * @return true=キャッシュ済み
+     */
+    bool contains(const uint8_t* source) const;
+
+    /**
+     * キャッシュを空にする（統計は残す）
+     */
+    void clear();
+
+    /**
+     * ヒット数を取得
+     * @return フラッシュ上のデータの参照のうちキャッシュから読んだ回数
+     */
+    uint32_t getHitCount() const;
+
+    /**
+     * ミス数を取得
+     * @return フラッシュ上のデータの参照のうちフラッシュから読んだ回数
+     */
+    uint32_t getMissCount() const;
+
+    /**
+     * ヒット率を取得
+     * @return ヒット率（パーセント、参照が無ければ0）
+     */
+    uint32_t getHitRate() const;
+
+    /**
+     * ヒット数・ミス数をリセット
+     */
+    void resetStats();
+
+    /**
+     * 使用中のバイト数を取得
+     * @return バイト数
+     */
+    size_t getUsedBytes() const;
+
+    /**
+     * 確保したバイト数を取得
+     * @return バイト数（確保失敗時0）
+     */
+    size_t getCapacity() const;
+};
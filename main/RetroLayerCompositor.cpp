@@ -0,0 +1,346 @@
+/*
+ * RetroLayerCompositor.cpp
+ * 多重スクロール背景のレイヤー合成実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroLayerCompositor.hpp"
+#include "RetroHotAssetCache.hpp"
+#include "RetroRenderPool.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// ログタグ定義
+static const char *TAG = "RetroLayer";
+
+/**
+ * スクロール率を16.16固定小数点に変換
+ * @param rate スクロール率
+ * @return 固定小数点値
+ */
+static inline int32_t toFixedRate(float rate) {
+    return (int32_t)(rate * 65536.0f);
+}
+
+RetroLayerCompositor::RetroLayerCompositor(PaletteImageRenderer* target)
+    : renderer(target), layerCount(0), spriteCount(0), droppedCount(0), cameraX(0), cameraY(0),
+      background(0x0000), writtenPixels(0), skippedPixels(0), composeUs(0), paletteWarned(false) {
+}
+
+int RetroLayerCompositor::allocLayer() {
+    if (layerCount >= MAX_LAYERS) {
+        ESP_LOGE(TAG, "Layer limit reached (%d layers)", MAX_LAYERS);
+        return -1;
+    }
+
+    Layer& layer = layers[layerCount];
+    layer = {};
+    layer.visible = true;
+    return layerCount++;
+}
+
+int RetroLayerCompositor::addImageLayer(const PaletteImageData* img, float rateX, float rateY,
+                                        int offsetX, int offsetY, bool repeatX, bool useTransparency) {
+    if (!img) return -1;
+    const int index = allocLayer();
+    if (index < 0) return -1;
+
+    Layer& layer = layers[index];
+    layer.image = img;
+    layer.rateX = toFixedRate(rateX);
+    layer.rateY = toFixedRate(rateY);
+    layer.offsetX = offsetX;
+    layer.offsetY = offsetY;
+    layer.repeatX = repeatX;
+    layer.transparent = useTransparency;
+    setCamera(cameraX, cameraY);
+    return index;
+}
+
+int RetroLayerCompositor::addSpriteLayer(float rateX, float rateY) {
+    const int index = allocLayer();
+    if (index < 0) return -1;
+
+    Layer& layer = layers[index];
+    layer.rateX = toFixedRate(rateX);
+    layer.rateY = toFixedRate(rateY);
+    setCamera(cameraX, cameraY);
+    return index;
+}
+
+void RetroLayerCompositor::setLayerVisible(int layer, bool visible) {
+    if (layer < 0 || layer >= layerCount) return;
+    layers[layer].visible = visible;
+}
+
+void RetroLayerCompositor::setLayerOffset(int layer, int offsetX, int offsetY) {
+    if (layer < 0 || layer >= layerCount) return;
+    layers[layer].offsetX = offsetX;
+    layers[layer].offsetY = offsetY;
+}
+
+void RetroLayerCompositor::setLayerPalette(int layer, const RetroColorPalette* palette) {
+    if (layer < 0 || layer >= layerCount) return;
+    layers[layer].palette = palette;
+}
+
+void RetroLayerCompositor::setCamera(int x, int y) {
+    cameraX = x;
+    cameraY = y;
+    for (int i = 0; i < layerCount; i++) {
+        layers[i].scrollX = (int)(((int64_t)x * layers[i].rateX) >> 16);
+        layers[i].scrollY = (int)(((int64_t)y * layers[i].rateY) >> 16);
+    }
+}
+
+void RetroLayerCompositor::setBackgroundColor(uint16_t color) {
+    background = color;
+}
+
+void RetroLayerCompositor::clearSprites() {
+    spriteCount = 0;
+    droppedCount = 0;
+}
+
+bool RetroLayerCompositor::addSprite(int layer, const PaletteImageData* img, int x, int y,
+                                     bool useTransparency, const RetroColorPalette* palette) {
+    if (layer < 0 || layer >= layerCount || layers[layer].image || !img) return false;
+    if (spriteCount >= MAX_SPRITES) {
+        droppedCount++;
+        return false;
+    }
+
+    Sprite& s = sprites[spriteCount++];
+    s.image = img;
+    s.palette = palette;
+    s.x = (int16_t)x;
+    s.y = (int16_t)y;
+    s.layer = (uint8_t)layer;
+    s.transparent = useTransparency;
+    return true;
+}
+
+void RetroLayerCompositor::compositeSpan(uint16_t* dst, uint32_t* cover, const Source& src,
+                                         int srcPixel, int x, int count) {
+    const uint8_t* data = src.data;
+    const uint32_t* pairs = src.lut->pairs;
+    const int pixelBase = srcPixel - x;  // 画面X座標 + pixelBase = ソースのピクセル番号
+    const int end = x + count;
+
+    while (x < end) {
+        const int word = x >> 5;
+        const int bit = x & 31;
+        const int n = min(32 - bit, end - x);
+        const uint32_t range = (n == 32) ? 0xFFFFFFFFu : (((1u << n) - 1) << bit);
+        uint32_t open = ~cover[word] & range;
+
+        // 手前で埋まった位置は読まない（全て埋まっていれば32ピクセル丸ごと飛ばす）
+        skippedPixels += __builtin_popcount(range & ~open);
+
+        if (open == range && !src.transparent) {
+            for (int sx = x; sx < x + n; sx++) {
+                const int p = sx + pixelBase;
+                const uint8_t b = data[p >> 1];
+                dst[sx] = (uint16_t)pairs[(p & 1) ? (b >> 4) : (b & 0x0F)];
+            }
+            cover[word] |= range;
+            writtenPixels += n;
+        } else {
+            uint32_t drawn = 0;
+            while (open) {
+                const int b = __builtin_ctz(open);
+                open &= open - 1;
+                const int sx = (word << 5) + b;
+                const int p = sx + pixelBase;
+                const uint8_t packed = data[p >> 1];
+                const uint8_t index = (p & 1) ? (packed >> 4) : (packed & 0x0F);
+                if (src.transparent && index == RetroColorPalette::TRANSPARENT_INDEX) continue;
+                dst[sx] = (uint16_t)pairs[index];
+                drawn |= 1u << b;
+            }
+            cover[word] |= drawn;
+            writtenPixels += __builtin_popcount(drawn);
+        }
+        x += n;
+    }
+}
+
+void RetroLayerCompositor::compositeLine(uint16_t* dst, uint32_t* cover, const Source& src, int line, int width) {
+    const PaletteImageData& img = *src.image;
+    const int row = line - src.y;
+    if (row < 0 || row >= img.height) return;
+    const int rowPixel = row * img.width;
+
+    if (!src.repeatX) {
+        const int x0 = max(0, src.x);
+        const int x1 = min(width, src.x + img.width);
+        if (x0 < x1) {
+            compositeSpan(dst, cover, src, rowPixel + (x0 - src.x), x0, x1 - x0);
+        }
+        return;
+    }
+
+    // 画像の右端で折り返し、画面左端から連続する区間ごとに合成
+    int col = (-src.x) % img.width;
+    if (col < 0) col += img.width;
+    for (int x = 0; x < width; ) {
+        const int n = min(width - x, img.width - col);
+        compositeSpan(dst, cover, src, rowPixel + col, x, n);
+        x += n;
+        col = 0;
+    }
+}
+
+void RetroLayerCompositor::composeWithRenderer() {
+    M5Canvas* canvas = renderer->getCanvas();
+    const int width = canvas->width();
+
+    // 奥から順に重ねる（パレットの差し替えは使わず、画像のパレットで描く）
+    bool paletteIgnored = false;
+    renderer->clearCanvas(background);
+    for (int l = 0; l < layerCount; l++) {
+        const Layer& layer = layers[l];
+        if (!layer.visible) continue;
+
+        if (layer.image) {
+            const PaletteImageData& img = *layer.image;
+            paletteIgnored |= layer.palette != nullptr;
+            if (img.width <= 0) continue;
+            const int x = layer.offsetX - layer.scrollX;
+            const int y = layer.offsetY - layer.scrollY;
+            if (!layer.repeatX) {
+                renderer->drawToCanvas(img, x, y, layer.transparent);
+                continue;
+            }
+            int start = x % img.width;
+            if (start > 0) start -= img.width;
+            for (int px = start; px < width; px += img.width) {
+                renderer->drawToCanvas(img, px, y, layer.transparent);
+            }
+        } else {
+            for (int i = 0; i < spriteCount; i++) {
+                const Sprite& s = sprites[i];
+                if (s.layer != l) continue;
+                paletteIgnored |= s.palette != nullptr;
+                renderer->drawToCanvas(*s.image, s.x + layer.offsetX - layer.scrollX,
+                                       s.y + layer.offsetY - layer.scrollY, s.transparent);
+            }
+        }
+    }
+
+    if (paletteIgnored && !paletteWarned) {
+        ESP_LOGW(TAG, "Layer/sprite palettes are ignored on this canvas (%d bpp)", (int)(canvas->getColorDepth() & lgfx::bit_mask));
+        paletteWarned = true;
+    }
+}
+
+void RetroLayerCompositor::compose() {
+    const int64_t start = esp_timer_get_time();
+    writtenPixels = 0;
+    skippedPixels = 0;
+
+    M5Canvas* canvas = renderer ? renderer->getCanvas() : nullptr;
+    if (!canvas) return;
+
+    const int width = canvas->width();
+    const int height = canvas->height();
+    uint16_t* frame = (canvas->getColorDepth() == lgfx::rgb565_2Byte) ? (uint16_t*)canvas->getBuffer() : nullptr;
+    const int words = (width + 31) / 32;
+    uint32_t* cover = frame ? (uint32_t*)RetroRenderPool::acquireBuffer(words * sizeof(uint32_t)) : nullptr;
+    if (!cover) {
+        composeWithRenderer();
+        composeUs = esp_timer_get_time() - start;
+        return;
+    }
+
+    // 手前から順に描画元を並べる（同じレイヤーのスプライトは後から登録した方が手前）
+    Source sources[MAX_LAYERS + MAX_SPRITES];
+    int sourceCount = 0;
+    RetroHotAssetCache* cache = renderer->getAssetCache();
+    for (int l = layerCount - 1; l >= 0; l--) {
+        const Layer& layer = layers[l];
+        if (!layer.visible) continue;
+
+        const int count = layer.image ? 1 : spriteCount;
+        for (int i = count - 1; i >= 0; i--) {
+            const PaletteImageData* img;
+            const RetroColorPalette* palette;
+            int x = layer.offsetX - layer.scrollX;
+            int y = layer.offsetY - layer.scrollY;
+            bool repeatX = false;
+            bool transparent;
+            if (layer.image) {
+                img = layer.image;
+                palette = layer.palette;
+                repeatX = layer.repeatX;
+                transparent = layer.transparent;
+            } else {
+                const Sprite& s = sprites[i];
+                if (s.layer != l) continue;
+                img = s.image;
+                palette = s.palette;
+                x += s.x;
+                y += s.y;
+                transparent = s.transparent;
+            }
+
+            // 画面にかからないものは描画元にしない
+            if (!img->data || img->width <= 0 || y >= height || y + img->height <= 0) continue;
+            if (!repeatX && (x >= width || x + img->width <= 0)) continue;
+            const RetroColorPalette::PixelPairLut* lut = (palette ? palette : &img->palette)->getPairLut();
+            if (!lut) continue;
+
+            Source& src = sources[sourceCount++];
+            src.data = cache ? cache->lookup(img->data) : img->data;
+            src.lut = lut;
+            src.image = img;
+            src.x = x;
+            src.y = y;
+            src.repeatX = repeatX;
+            src.transparent = transparent;
+        }
+    }
+
+    // 右端の余りビットは最初から埋まっている扱いにする
+    const uint32_t tailMask = (width & 31) ? ~((1u << (width & 31)) - 1) : 0;
+    for (int line = 0; line < height; line++) {
+        uint16_t* dst = frame + (size_t)line * width;
+        memset(cover, 0, words * sizeof(uint32_t));
+        cover[words - 1] = tailMask;
+
+        for (int i = 0; i < sourceCount; i++) {
+            compositeLine(dst, cover, sources[i], line, width);
+        }
+
+        // どのレイヤーも描かなかった位置を背景色で塗る
+        const uint16_t fill = (uint16_t)((background >> 8) | (background << 8));
+        for (int w = 0; w < words; w++) {
+            uint32_t open = ~cover[w];
+            while (open) {
+                const int b = __builtin_ctz(open);
+                open &= open - 1;
+                dst[(w << 5) + b] = fill;
+            }
+        }
+    }
+
+    RetroRenderPool::releaseBuffer(cover);
+    renderer->markAllDirty();
+    composeUs = esp_timer_get_time() - start;
+}
+
+uint32_t RetroLayerCompositor::getWrittenPixels() const {
+    return writtenPixels;
+}
+
+uint32_t RetroLayerCompositor::getSkippedPixels() const {
+    return skippedPixels;
+}
+
+int64_t RetroLayerCompositor::getComposeTime() const {
+    return composeUs;
+}
+
+int RetroLayerCompositor::getDroppedCount() const {
+    return droppedCount;
+}
@@ -0,0 +1,231 @@
+/*
+ * RetroLayerCompositor.hpp
+ * 多重スクロール背景のレイヤー合成 for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 背景（パレット画像）・スプライト・HUDのレイヤーを最大4枚重ねて1パスで合成
+ * - レイヤーごとにカメラに対するスクロール率を持ち、遠景ほどゆっくり流れる多重スクロールにできる
+ * - 背景レイヤーは横方向に繰り返し可能（画像幅を周期に折り返す）
+ * - 1行ずつ手前のレイヤーから合成し、既に不透明画素で埋まった位置は奥のレイヤーを読まない
+ *   （埋まった位置を32ピクセル単位のビットマスクで管理し、全て埋まった32ピクセルは丸ごと飛ばす）
+ * - 最後まで何も描かれなかった位置だけを背景色で塗る（キャンバス全体のクリア不要）
+ *
+ * 行単位で直接書き込むのは16bitキャンバスのみ
+ * それ以外のキャンバス（4bitキャンバスなど）では奥のレイヤーから順にレンダラーで描画する
+ * - 手前に隠れた画素も全て描くので、読み飛ばし（getSkippedPixels）は働かない
+ * - レイヤー・スプライトのパレット差し替えは使えず、画像自身のパレットで描く
+ *   （4bitキャンバスはインデックスをそのまま書き、色はキャンバスのパレットで決まるため）
+ *   差し替えが無視された場合は最初の1回だけ警告ログを出す
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * レイヤー合成
+ * addImageLayer()/addSpriteLayer() で奥から順にレイヤーを作り、
+ * 毎フレーム setCamera() → clearSprites() → addSprite() → compose() の順に呼ぶ
+ * 登録した画像・パレットは compose() まで保持しておくこと
+ */
+class RetroLayerCompositor {
+public:
+    static constexpr int MAX_LAYERS = 4;     // レイヤー数の上限
+    static constexpr int MAX_SPRITES = 32;   // 1フレームに登録できるスプライト数
+
+private:
+    /**
+     * レイヤー
+     */
+    struct Layer {
+        const PaletteImageData* image;     // 背景画像（スプライトレイヤーはnullptr）
+        const RetroColorPalette* palette;  // 使用するパレット（nullptr = 画像のパレット）
+        int32_t rateX, rateY;              // カメラに対するスクロール率（16.16固定小数点）
+        int offsetX, offsetY;              // カメラ原点での表示位置（画面座標）
+        int scrollX, scrollY;              // 現在のスクロール量（setCamera() で更新）
+        bool repeatX;                      // 横方向に繰り返すか（背景）
+        bool transparent;                  // 透明色を使用するか
+        bool visible;                      // 表示するか
+    };
+
+    /**
+     * スプライト（座標はレイヤー座標）
+     */
+    struct Sprite {
+        const PaletteImageData* image;     // 画像
+        const RetroColorPalette* palette;  // 使用するパレット（nullptr = 画像のパレット）
+        int16_t x, y;                      // 左上位置
+        uint8_t layer;                     // 所属レイヤー
+        bool transparent;                  // 透明色を使用するか
+    };
+
+    /**
+     * 合成1行分の描画元（compose() の先頭でレイヤー・スプライトから作る）
+     */
+    struct Source {
+        const uint8_t* data;               // 画素データ（キャッシュ済みならそのコピー）
+        const RetroColorPalette::PixelPairLut* lut;  // 変換テーブル
+        const PaletteImageData* image;     // 画像
+        int x, y;                          // 画像左上の画面座標
+        bool repeatX;                      // 横方向に繰り返すか
+        bool transparent;                  // 透明色を使用するか
+    };
+
+    PaletteImageRenderer* renderer;    // 描画先レンダラー
+    Layer layers[MAX_LAYERS];          // レイヤー（奥から順）
+    int layerCount;                    // レイヤー数
+    Sprite sprites[MAX_SPRITES];       // 登録済みスプライト（登録順）
+    int spriteCount;                   // 登録数
+    int droppedCount;                  // 上限超過で登録できなかった数
+    int cameraX, cameraY;              // カメラ位置
+    uint16_t background;               // 背景色（RGB565）
+
+    uint32_t writtenPixels;            // 直近の合成で書き込んだ画素数
+    uint32_t skippedPixels;            // 直近の合成で手前に隠れて読まなかった画素数
+    int64_t composeUs;                 // 直近の合成時間
+    bool paletteWarned;                // パレット差し替えを無視した警告を出したか
+
+    /**
+     * レイヤーを1枚追加（上限チェック込み）
+     * @return 追加したレイヤー番号（上限超過時-1）
+     */
+    int allocLayer();
+
+    /**
+     * 描画元の1行のうち、まだ埋まっていない位置だけを書き込む
+     * @param dst 出力先の行（バイトスワップ済みRGB565）
+     * @param cover 埋まった位置のビットマスク（書いた位置を立てる）
+     * @param src 描画元
+     * @param srcPixel 先頭画素のソースのピクセル番号
+     * @param x 先頭の画面X座標
+     * @param count 画素数
+     */
+    void compositeSpan(uint16_t* dst, uint32_t* cover, const Source& src, int srcPixel, int x, int count);
+
+    /**
+     * 描画元の1行を合成（繰り返しは画像の右端で折り返す）
+     * @param dst 出力先の行
+     * @param cover 埋まった位置のビットマスク
+     * @param src 描画元
+     * @param line 画面Y座標
+     * @param width 画面の幅
+     */
+    void compositeLine(uint16_t* dst, uint32_t* cover, const Source& src, int line, int width);
+
+    /**
+     * 16bit以外のキャンバス向けに、奥のレイヤーから順にレンダラーで描画
+     * パレットの差し替えは使わない（使われていれば1回だけ警告する）
+     */
+    void composeWithRenderer();
+
+public:
+    /**
+     * コンストラクタ
+     * @param target 描画先レンダラー
+     */
+    explicit RetroLayerCompositor(PaletteImageRenderer* target);
+
+    /**
+     * 背景画像レイヤーを追加（後から追加したものほど手前）
+     * @param img パレット画像データ
+     * @param rateX カメラX移動に対するスクロール率（0=固定、1=カメラと同じ速さ）
+     * @param rateY カメラY移動に対するスクロール率
+     * @param offsetX カメラ原点での画像左上の画面X座標
+     * @param offsetY カメラ原点での画像左上の画面Y座標
+     * @param repeatX 横方向に繰り返すか
+     * @param useTransparency 透明色を使用するか（false=不透明、奥を完全に隠す）
+     * @return レイヤー番号（上限超過時-1）
+     */
+    int addImageLayer(const PaletteImageData* img, float rateX, float rateY = 0.0f,
+                      int offsetX = 0, int offsetY = 0, bool repeatX = true, bool useTransparency = true);
+
+    /**
+     * スプライトレイヤーを追加（後から追加したものほど手前）
+     * @param rateX カメラX移動に対するスクロール率（0=画面固定のHUD、1=ワールド座標）
+     * @param rateY カメラY移動に対するスクロール率
+     * @return レイヤー番号（上限超過時-1）
+     */
+    int addSpriteLayer(float rateX = 1.0f, float rateY = 1.0f);
+
+    /**
+     * レイヤーの表示・非表示を設定
+     * @param layer レイヤー番号
+     * @param visible 表示するか
+     */
+    void setLayerVisible(int layer, bool visible);
+
+    /**
+     * レイヤーのカメラ原点での表示位置を設定
+     * @param layer レイヤー番号
+     * @param offsetX 画面X座標
+     * @param offsetY 画面Y座標
+     */
+    void setLayerOffset(int layer, int offsetX, int offsetY);
+
+    /**
+     * レイヤーのパレットを差し替え（夕暮れ版の遠景など、16bitキャンバスのみ有効）
+     * @param layer レイヤー番号
+     * @param palette パレット（nullptr = 画像のパレット）
+     */
+    void setLayerPalette(int layer, const RetroColorPalette* palette);
+
+    /**
+     * カメラ位置を設定（各レイヤーのスクロール量をスクロール率から計算）
+     * @param x カメラX座標
+     * @param y カメラY座標
+     */
+    void setCamera(int x, int y);
+
+    /**
+     * 背景色を設定（どのレイヤーも描かなかった位置の色）
+     * @param color RGB565色
+     */
+    void setBackgroundColor(uint16_t color);
+
+    /**
+     * 登録済みスプライトを全て削除（毎フレームの登録前に呼ぶ）
+     */
+    void clearSprites();
+
+    /**
+     * スプライトを登録（同じレイヤーでは後から登録したものほど手前）
+     * @param layer スプライトレイヤー番号
+     * @param img パレット画像データ
+     * @param x レイヤー座標のX
+     * @param y レイヤー座標のY
+     * @param useTransparency 透明色を使用するか
+     * @param palette 使用するパレット（nullptr = 画像のパレット、16bitキャンバスのみ有効）
+     * @return 登録できた場合true
+     */
+    bool addSprite(int layer, const PaletteImageData* img, int x, int y,
+                   bool useTransparency = true, const RetroColorPalette* palette = nullptr);
+
+    /**
+     * 全レイヤーをキャンバスに合成（キャンバス全体を変更済みとして登録）
+     */
+    void compose();
+
+    /**
+     * 直近の合成でレイヤーから書き込んだ画素数を取得
+     * @return 画素数（背景色で塗った画素は含まない）
+     */
+    uint32_t getWrittenPixels() const;
+
+    /**
+     * 直近の合成で手前のレイヤーに隠れて読まなかった画素数を取得
+     * @return 画素数（16bit以外のキャンバスでは0）
+     */
+    uint32_t getSkippedPixels() const;
+
+    /**
+     * 直近の合成時間を取得
+     * @return 時間（マイクロ秒）
+     */
+    int64_t getComposeTime() const;
+
+    /**
+     * 現在のフレームで上限超過により登録できなかったスプライト数を取得
+     * @return スプライト数
+     */
+    int getDroppedCount() const;
+};
@@ -0,0 +1,243 @@
+/*
+ * RetroPaletteAnimator.cpp
+ * パレットアニメーション実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroPaletteAnimator.hpp"
+#include "RetroRenderPool.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// ログタグ定義
+static const char *TAG = "RetroPaletteAnim";
+
+/**
+ * RGB565同士を整数で線形補間
+ * @param from 開始色
+ * @param to 目標色
+ * @param t 補間係数（0=from, 256=to）
+ * @return 補間した色
+ */
+static inline uint16_t blend565(uint16_t from, uint16_t to, int t) {
+    int r0 = from >> 11, g0 = (from >> 5) & 0x3F, b0 = from & 0x1F;
+    int r1 = to >> 11, g1 = (to >> 5) & 0x3F, b1 = to & 0x1F;
+    int r = r0 + (((r1 - r0) * t) >> 8);
+    int g = g0 + (((g1 - g0) * t) >> 8);
+    int b = b0 + (((b1 - b0) * t) >> 8);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+RetroPaletteAnimator::RetroPaletteAnimator(const RetroColorPalette& base)
+    : basePalette(base), output(base), outputValid(false) {
+    for (int i = 0; i < MAX_EFFECTS; i++) {
+        effects[i].type = EFFECT_NONE;
+        effects[i].hueTable = nullptr;
+    }
+}
+
+RetroPaletteAnimator::~RetroPaletteAnimator() {
+    clear();
+}
+
+void RetroPaletteAnimator::setBasePalette(const RetroColorPalette& base) {
+    basePalette = base;
+    outputValid = false;
+}
+
+int RetroPaletteAnimator::allocEffect(uint8_t type, uint8_t first, uint8_t last, uint32_t durationMs) {
+    if (first > last || last >= RetroColorPalette::MAX_COLORS) {
+        ESP_LOGE(TAG, "Invalid palette range: %d-%d", first, last);
+        return -1;
+    }
+
+    for (int i = 0; i < MAX_EFFECTS; i++) {
+        Effect& e = effects[i];
+        if (e.type != EFFECT_NONE) continue;
+
+        e.type = type;
+        e.first = first;
+        e.last = last;
+        e.started = false;
+        e.reverse = false;
+        e.startMs = 0;
+        e.durationMs = durationMs ? durationMs : 1;
+        e.color = 0;
+        e.count = 0;
+        e.spread = 0;
+        e.hueTable = nullptr;
+        return i;
+    }
+
+    ESP_LOGE(TAG, "No free effect slot (max %d)", MAX_EFFECTS);
+    return -1;
+}
+
+int RetroPaletteAnimator::addCycle(uint8_t first, uint8_t last, uint32_t stepMs, bool reverse) {
+    int id = allocEffect(EFFECT_CYCLE, first, last, stepMs);
+    if (id >= 0) {
+        effects[id].reverse = reverse;
+    }
+    return id;
+}
+
+int RetroPaletteAnimator::addHueCycle(uint8_t first, uint8_t last, uint32_t periodMs, uint8_t saturation,
+                                      uint8_t value, uint16_t hueSpread) {
+    int id = allocEffect(EFFECT_HUE_CYCLE, first, last, periodMs);
+    if (id < 0) return -1;
+
+    Effect& e = effects[id];
+    e.hueTable = (uint16_t*)RetroRenderPool::acquireBuffer(HUE_STEPS * sizeof(uint16_t));
+    if (!e.hueTable) {
+        ESP_LOGE(TAG, "Failed to allocate hue table");
+        e.type = EFFECT_NONE;
+        return -1;
+    }
+
+    // 彩度・明度は固定なので、色相ごとのRGB565を登録時に全部計算しておく
+    for (int i = 0; i < HUE_STEPS; i++) {
+        e.hueTable[i] = RetroColorPalette::hsvToRgb565((uint16_t)(i * 360 / HUE_STEPS), saturation, value);
+    }
+    e.spread = (uint16_t)((hueSpread % 360) * HUE_STEPS / 360);
+    return id;
+}
+
+int RetroPaletteAnimator::addFade(uint8_t first, uint8_t last, uint16_t targetColor, uint32_t durationMs, bool pingPong) {
+    int id = allocEffect(EFFECT_FADE, first, last, durationMs);
+    if (id >= 0) {
+        effects[id].color = targetColor;
+        effects[id].reverse = pingPong;
+    }
+    return id;
+}
+
+int RetroPaletteAnimator::addFlash(uint8_t first, uint8_t last, uint16_t flashColor, uint32_t durationMs, uint16_t count) {
+    int id = allocEffect(EFFECT_FLASH, first, last, durationMs);
+    if (id >= 0) {
+        effects[id].color = flashColor;
+        effects[id].count = count;
+    }
+    return id;
+}
+
+void RetroPaletteAnimator::remove(int id) {
+    if (id < 0 || id >= MAX_EFFECTS) return;
+
+    Effect& e = effects[id];
+    RetroRenderPool::releaseBuffer(e.hueTable);
+    e.hueTable = nullptr;
+    e.type = EFFECT_NONE;
+}
+
+void RetroPaletteAnimator::clear() {
+    for (int i = 0; i < MAX_EFFECTS; i++) {
+        remove(i);
+    }
+}
+
+bool RetroPaletteAnimator::isActive(int id) const {
+    return id >= 0 && id < MAX_EFFECTS && effects[id].type != EFFECT_NONE;
+}
+
+bool RetroPaletteAnimator::applyEffect(Effect& e, uint16_t* colors, uint32_t timeMs) {
+    const uint32_t elapsed = timeMs - e.startMs;
+    const int n = e.last - e.first + 1;
+    uint16_t* range = colors + e.first;
+
+    switch (e.type) {
+    case EFFECT_CYCLE: {
+        int shift = (int)((elapsed / e.durationMs) % n);
+        if (shift == 0) break;
+        if (e.reverse) shift = n - shift;
+        // 正方向は色が高いインデックス側へ移動する
+        uint16_t src[RetroColorPalette::MAX_COLORS];
+        memcpy(src, range, n * sizeof(uint16_t));
+        for (int i = 0; i < n; i++) {
+            range[(i + shift) % n] = src[i];
+        }
+        break;
+    }
+
+    case EFFECT_HUE_CYCLE: {
+        int phase = (int)((uint64_t)(elapsed % e.durationMs) * HUE_STEPS / e.durationMs);
+        for (int i = 0; i < n; i++) {
+            range[i] = e.hueTable[(phase + i * e.spread) & (HUE_STEPS - 1)];
+        }
+        break;
+    }
+
+    case EFFECT_FADE: {
+        int t;
+        if (e.reverse) {
+            // 往復: 0→256→0 の三角波
+            uint32_t cycle = elapsed % (2 * e.durationMs);
+            uint32_t pos = (cycle < e.durationMs) ? cycle : 2 * e.durationMs - cycle;
+            t = (int)((uint64_t)pos * 256 / e.durationMs);
+        } else {
+            t = (elapsed >= e.durationMs) ? 256 : (int)((uint64_t)elapsed * 256 / e.durationMs);
+        }
+        for (int i = 0; i < n; i++) {
+            range[i] = blend565(range[i], e.color, t);
+        }
+        break;
+    }
+
+    case EFFECT_FLASH: {
+        uint32_t phase = elapsed / e.durationMs;
+        if (e.count && phase >= 2u * e.count) return true;
+        if ((phase & 1) == 0) {
+            for (int i = 0; i < n; i++) {
+                range[i] = e.color;
+            }
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+    return false;
+}
+
+bool RetroPaletteAnimator::update(uint32_t timeMs) {
+    uint16_t colors[RetroColorPalette::MAX_COLORS];
+    memcpy(colors, basePalette.colors, sizeof(colors));
+
+    // 登録順に重ねる（色循環の後にフェードを登録すれば循環中の色がフェードする）
+    for (int i = 0; i < MAX_EFFECTS; i++) {
+        Effect& e = effects[i];
+        if (e.type == EFFECT_NONE) continue;
+
+        if (!e.started) {
+            e.started = true;
+            e.startMs = timeMs;
+        }
+        if (applyEffect(e, colors, timeMs)) {
+            remove(i);
+        }
+    }
+
+    if (outputValid && memcmp(colors, output.colors, sizeof(colors)) == 0) {
+        return false;
+    }
+
+    memcpy(output.colors, colors, sizeof(colors));
+    output.invalidateLut();
+    outputValid = true;
+    return true;
+}
+
+bool RetroPaletteAnimator::update() {
+    return update((uint32_t)(esp_timer_get_time() / 1000));
+}
+
+const RetroColorPalette& RetroPaletteAnimator::getPalette() const {
+    return output;
+}
+
+bool RetroPaletteAnimator::apply(PaletteImageRenderer& renderer) {
+    if (!update()) return false;
+
+    renderer.setCanvasPalette(output);
+    return true;
+}
@@ -0,0 +1,182 @@
+/*
+ * RetroPaletteAnimator.hpp
+ * パレットアニメーション for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - インデックス範囲ごとの色循環・色相循環・フェード・フラッシュ
+ * - 時刻（ミリ秒）から各フレームのパレットを計算（フレームレートに依存しない）
+ * - 色相循環のHSV→RGB565は整数テーブルで事前計算（浮動小数点演算なし）
+ * - 画像データには一切触れず、パレットだけを差し替える
+ *   4bitキャンバスならプッシュ時に展開、RetroSpriteBatchならラスタライズ時に参照される
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * パレットアニメーター
+ * ベースパレットに登録順にエフェクトを重ねて出力パレットを作る
+ */
+class RetroPaletteAnimator {
+public:
+    static constexpr int MAX_EFFECTS = 8;     // 同時に登録できるエフェクト数
+    static constexpr int HUE_STEPS = 256;     // 色相テーブルの分割数
+
+private:
+    // エフェクトの種類
+    static constexpr uint8_t EFFECT_NONE = 0;
+    static constexpr uint8_t EFFECT_CYCLE = 1;      // 範囲内の色を回転
+    static constexpr uint8_t EFFECT_HUE_CYCLE = 2;  // 範囲内の色相を変化
+    static constexpr uint8_t EFFECT_FADE = 3;       // 指定色へのフェード
+    static constexpr uint8_t EFFECT_FLASH = 4;      // 指定色での点滅
+
+    /**
+     * エフェクト設定
+     */
+    struct Effect {
+        uint8_t type;                 // エフェクトの種類
+        uint8_t first, last;          // 対象インデックス範囲 [first, last]
+        bool started;                 // 開始時刻を記録済みか
+        bool reverse;                 // 逆方向（色循環）/ 往復（フェード）
+        uint32_t startMs;             // 開始時刻
+        uint32_t durationMs;          // 1ステップ・1周期・フェード時間・点灯時間
+        uint16_t color;               // 目標色（フェード・フラッシュ）
+        uint16_t count;               // 点滅回数（0=無限）
+        uint16_t spread;              // 隣接インデックス間の色相差（HUE_STEPS単位）
+        uint16_t* hueTable;           // 色相→RGB565テーブル（HUE_STEPS要素）
+    };
+
+    RetroColorPalette basePalette;    // 元のパレット
+    RetroColorPalette output;         // エフェクト適用後のパレット
+    Effect effects[MAX_EFFECTS];      // エフェクト一覧
+    bool outputValid;                 // 出力パレットを一度でも計算したか
+
+    /**
+     * 空きスロットにエフェクトを登録
+     * @return 登録したスロット番号（空きが無い場合-1）
+     */
+    int allocEffect(uint8_t type, uint8_t first, uint8_t last, uint32_t durationMs);
+
+    /**
+     * 1つのエフェクトを出力色に適用
+     * @param e エフェクト
+     * @param colors 出力色（書き換えられる）
+     * @param timeMs 現在時刻
+     * @return エフェクトが終了した場合true
+     */
+    bool applyEffect(Effect& e, uint16_t* colors, uint32_t timeMs);
+
+public:
+    /**
+     * コンストラクタ
+     * @param base ベースパレット
+     */
+    RetroPaletteAnimator(const RetroColorPalette& base);
+
+    /**
+     * デストラクタ
+     */
+    ~RetroPaletteAnimator();
+
+    // 色相テーブル（プールのバッファ）を所有するためコピー禁止
+    RetroPaletteAnimator(const RetroPaletteAnimator&) = delete;
+    RetroPaletteAnimator& operator=(const RetroPaletteAnimator&) = delete;
+
+    /**
+     * ベースパレットを変更
+     * @param base 新しいベースパレット
+     */
+    void setBasePalette(const RetroColorPalette& base);
+
+    /**
+     * 色循環を登録（範囲内の色を一定間隔で1つずつずらす）
+     * @param first 先頭インデックス
+     * @param last 末尾インデックス
+     * @param stepMs 1つずらす間隔（ミリ秒）
+     * @param reverse true=逆方向
+     * @return エフェクトID（登録できない場合-1）
+     */
+    int addCycle(uint8_t first, uint8_t last, uint32_t stepMs, bool reverse = false);
+
+    /**
+     * 色相循環を登録（範囲内の色を虹色に変化させる）
+     * @param first 先頭インデックス
+     * @param last 末尾インデックス
+     * @param periodMs 色相が1周する時間（ミリ秒）
+     * @param saturation 彩度（0-100）
+     * @param value 明度（0-100）
+     * @param hueSpread 隣接インデックス間の色相差（度）
+     * @return エフェクトID（登録できない場合-1）
+     */
+    int addHueCycle(uint8_t first, uint8_t last, uint32_t periodMs, uint8_t saturation, uint8_t value,
+                    uint16_t hueSpread = 0);
+
+    /**
+     * フェードを登録（範囲内の色を指定色へ近づける、完了後は指定色を保持）
+     * @param first 先頭インデックス
+     * @param last 末尾インデックス
+     * @param targetColor 目標色（RGB565）
+     * @param durationMs フェード時間（ミリ秒）
+     * @param pingPong true=目標色と元の色を往復し続ける
+     * @return エフェクトID（登録できない場合-1）
+     */
+    int addFade(uint8_t first, uint8_t last, uint16_t targetColor, uint32_t durationMs, bool pingPong = false);
+
+    /**
+     * フラッシュを登録（範囲内の色を指定色で点滅、回数分で自動終了）
+     * @param first 先頭インデックス
+     * @param last 末尾インデックス
+     * @param flashColor 点灯時の色（RGB565）
+     * @param durationMs 点灯・消灯それぞれの時間（ミリ秒）
+     * @param count 点滅回数（0=無限）
+     * @return エフェクトID（登録できない場合-1）
+     */
+    int addFlash(uint8_t first, uint8_t last, uint16_t flashColor, uint32_t durationMs, uint16_t count = 1);
+
+    /**
+     * エフェクトを削除
+     * @param id エフェクトID
+     */
+    void remove(int id);
+
+    /**
+     * 全エフェクトを削除
+     */
+    void clear();
+
+    /**
+     * エフェクトが動作中かどうか
+     * @param id エフェクトID
+     * @return true=動作中
+     */
+    bool isActive(int id) const;
+
+    /**
+     * 指定時刻の出力パレットを計算
+     * @param timeMs 時刻（ミリ秒）
+     * @return 出力パレットが変化した場合true
+     */
+    bool update(uint32_t timeMs);
+
+    /**
+     * 現在時刻（esp_timer）で出力パレットを計算
+     * @return 出力パレットが変化した場合true
+     */
+    bool update();
+
+    /**
+     * 出力パレットを取得
+     * RetroSpriteBatch::add() のパレットに渡せば描画時に反映される
+     * @return 出力パレット
+     */
+    const RetroColorPalette& getPalette() const;
+
+    /**
+     * 現在時刻で更新し、変化していればレンダラーのキャンバスパレットに反映
+     * 4bitキャンバスでは画像を描き直さず、次のプッシュで新しい色になる
+     * @param renderer 反映先のレンダラー
+     * @return パレットを反映した場合true
+     */
+    bool apply(PaletteImageRenderer& renderer);
+};
@@ -0,0 +1,322 @@
+/*
+ * RetroParallelRasterizer.cpp
+ * 2コア並列ラスタライズ実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroParallelRasterizer.hpp"
+#include "RetroRenderPool.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+// ログタグ定義
+static const char *TAG = "RetroParallel";
+
+RetroParallelRasterizer::RetroParallelRasterizer(PaletteImageRenderer* renderer, LGFX_ST7789P3_76x284* gfx,
+                                                 int maxCommandCount)
+    : target(renderer), display(gfx), commands(nullptr), maxCommands(0), commandCount(0), droppedCount(0),
+      boundBuffer(nullptr), boundWidth(0), boundHeight(0), worker(nullptr), workerDone(nullptr),
+      busLock(nullptr), workerStop(false), pushEachBand(false), pushX(0), pushY(0), inFrame(false) {
+    if (maxCommandCount > 0) {
+        commands = (DrawCommand*)RetroRenderPool::acquireBuffer(maxCommandCount * sizeof(DrawCommand));
+    }
+    if (commands) {
+        maxCommands = maxCommandCount;
+    } else {
+        ESP_LOGE(TAG, "Failed to allocate command list (%d commands)", maxCommandCount);
+    }
+
+    // バンドのビューは描画先キャンバスの行を指すだけなので画素バッファは持たない
+    for (int i = 0; i < BAND_COUNT; i++) {
+        bands[i].view = new M5Canvas(gfx);
+        bands[i].renderer = new PaletteImageRenderer(gfx, bands[i].view);
+        bands[i].renderer->setProfilingEnabled(false);
+        bands[i].top = bands[i].lines = 0;
+        bands[i].renderUs = 0;
+    }
+
+    workerDone = xSemaphoreCreateBinary();
+    busLock = xSemaphoreCreateMutex();
+    const BaseType_t core = xPortGetCoreID() ^ 1;
+    if (!workerDone || !busLock ||
+        xTaskCreatePinnedToCore(workerEntry, "raster_band", 4096, this, uxTaskPriorityGet(nullptr),
+                                &worker, core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create raster worker, drawing on the calling core only");
+        worker = nullptr;
+        return;
+    }
+    ESP_LOGI(TAG, "RetroParallelRasterizer created: %d commands max, worker on core %d", maxCommands, (int)core);
+}
+
+RetroParallelRasterizer::~RetroParallelRasterizer() {
+    if (worker) {
+        workerStop = true;
+        xTaskNotifyGive(worker);
+        xSemaphoreTake(workerDone, portMAX_DELAY);
+        worker = nullptr;
+    }
+    if (workerDone) vSemaphoreDelete(workerDone);
+    if (busLock) vSemaphoreDelete(busLock);
+
+    for (int i = 0; i < BAND_COUNT; i++) {
+        delete bands[i].renderer;
+        delete bands[i].view;
+    }
+    RetroRenderPool::releaseBuffer(commands);
+}
+
+void RetroParallelRasterizer::workerEntry(void* arg) {
+    RetroParallelRasterizer* self = (RetroParallelRasterizer*)arg;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (self->workerStop) break;
+
+        self->renderBand(self->bands[1]);
+        xSemaphoreGive(self->workerDone);
+    }
+
+    // 停止完了を通知
+    xSemaphoreGive(self->workerDone);
+    vTaskDelete(nullptr);
+}
+
+bool RetroParallelRasterizer::bindBands() {
+    M5Canvas* canvas = target ? target->getCanvas() : nullptr;
+    if (!worker || !canvas || (canvas->getColorDepth() & lgfx::bit_mask) != 16) return false;
+
+    // ダブルバッファでは描画先が毎フレーム入れ替わるので、変わった時だけ張り直す
+    uint8_t* buffer = (uint8_t*)canvas->getBuffer();
+    const int width = canvas->width();
+    const int height = canvas->height();
+    if (buffer == boundBuffer && width == boundWidth && height == boundHeight) return true;
+    if (!buffer || height < BAND_COUNT) return false;
+
+    const int split = height / 2;
+    bands[0].top = 0;
+    bands[0].lines = split;
+    bands[1].top = split;
+    bands[1].lines = height - split;
+    for (int i = 0; i < BAND_COUNT; i++) {
+        bands[i].view->setBuffer(buffer + (size_t)bands[i].top * width * sizeof(uint16_t),
+                                 width, bands[i].lines, lgfx::rgb565_2Byte);
+    }
+
+    boundBuffer = buffer;
+    boundWidth = width;
+    boundHeight = height;
+    return true;
+}
+
+RetroParallelRasterizer::DrawCommand* RetroParallelRasterizer::allocCommand(uint8_t kind, int top, int height) {
+    if (!inFrame) return nullptr;
+    if (commandCount >= maxCommands) {
+        droppedCount++;
+        return nullptr;
+    }
+
+    DrawCommand* c = &commands[commandCount++];
+    *c = {};
+    c->kind = kind;
+    c->top = (int16_t)max(-32768, min(32767, top));
+    c->bottom = (int16_t)max(-32768, min(32767, top + height));
+    return c;
+}
+
+void RetroParallelRasterizer::prepareImage(const PaletteImageData& img) {
+    // 変換テーブルは初回参照時に作られるため、ここで作っておく
+    img.palette.getPairLut();
+}
+
+void RetroParallelRasterizer::begin() {
+    commandCount = 0;
+    droppedCount = 0;
+    inFrame = commands != nullptr;
+}
+
+void RetroParallelRasterizer::clear(uint16_t color) {
+    DrawCommand* c = allocCommand(CMD_CLEAR, -32768, 65535);
+    if (!c) return;
+    c->color = color;
+}
+
+void RetroParallelRasterizer::fillRect(int x, int y, int w, int h, uint16_t color) {
+    DrawCommand* c = allocCommand(CMD_FILL_RECT, y, h);
+    if (!c) return;
+    c->x = (int16_t)x;
+    c->y = (int16_t)y;
+    c->regionWidth = (int16_t)w;
+    c->regionHeight = (int16_t)h;
+    c->color = color;
+}
+
+void RetroParallelRasterizer::draw(const PaletteImageData& img, int x, int y, bool useTransparency) {
+    DrawCommand* c = allocCommand(CMD_IMAGE, y, img.height);
+    if (!c) return;
+    prepareImage(img);
+    c->image = &img;
+    c->x = (int16_t)x;
+    c->y = (int16_t)y;
+    c->transparent = useTransparency;
+}
+
+void RetroParallelRasterizer::drawRegion(const PaletteImageData& img, int regionX, int regionY,
+                                         int regionWidth, int regionHeight, int x, int y, bool useTransparency) {
+    DrawCommand* c = allocCommand(CMD_REGION, y, regionHeight);
+    if (!c) return;
+    prepareImage(img);
+    c->image = &img;
+    c->x = (int16_t)x;
+    c->y = (int16_t)y;
+    c->regionX = (int16_t)regionX;
+    c->regionY = (int16_t)regionY;
+    c->regionWidth = (int16_t)regionWidth;
+    c->regionHeight = (int16_t)regionHeight;
+    c->transparent = useTransparency;
+}
+
+void RetroParallelRasterizer::drawScaled(const PaletteImageData& img, int x, int y, float scaleX, float scaleY,
+                                         bool useTransparency) {
+    // 拡大後の高さは丸め方に依存するので1行余分に見積もる
+    DrawCommand* c = allocCommand(CMD_SCALED, y, (int)(img.height * scaleY) + 1);
+    if (!c) return;
+    prepareImage(img);
+    c->image = &img;
+    c->x = (int16_t)x;
+    c->y = (int16_t)y;
+    c->scaleX = scaleX;
+    c->scaleY = scaleY;
+    c->transparent = useTransparency;
+}
+
+void RetroParallelRasterizer::drawTransformed(const PaletteImageData& img, int x, int y, uint8_t transform,
+                                              bool useTransparency) {
+    const bool rotate = (transform & PaletteImageRenderer::BLIT_ROTATE_90) != 0;
+    DrawCommand* c = allocCommand(CMD_TRANSFORMED, y, rotate ? img.width : img.height);
+    if (!c) return;
+    prepareImage(img);
+    c->image = &img;
+    c->x = (int16_t)x;
+    c->y = (int16_t)y;
+    c->transform = transform;
+    c->transparent = useTransparency;
+}
+
+void RetroParallelRasterizer::execute(PaletteImageRenderer& r, const DrawCommand& c, int offsetY) {
+    const int y = c.y - offsetY;
+    switch (c.kind) {
+    case CMD_CLEAR:
+        r.clearCanvas(c.color);
+        break;
+    case CMD_FILL_RECT:
+        r.getCanvas()->fillRect(c.x, y, c.regionWidth, c.regionHeight, c.color);
+        break;
+    case CMD_IMAGE:
+        r.drawToCanvas(*c.image, c.x, y, c.transparent);
+        break;
+    case CMD_REGION:
+        r.drawRegionToCanvas(*c.image, c.regionX, c.regionY, c.regionWidth, c.regionHeight, c.x, y, c.transparent);
+        break;
+    case CMD_SCALED:
+        r.drawToCanvasScaled(*c.image, c.x, y, c.scaleX, c.scaleY, c.transparent);
+        break;
+    case CMD_TRANSFORMED:
+        r.drawToCanvasTransformed(*c.image, c.x, y, c.transform, c.transparent);
+        break;
+    }
+}
+
+void RetroParallelRasterizer::renderBand(Band& band) {
+    const int64_t start = esp_timer_get_time();
+    const int bottom = band.top + band.lines;
+
+    // 記録順に実行（このバンドにかからない命令は飛ばす）
+    for (int i = 0; i < commandCount; i++) {
+        const DrawCommand& c = commands[i];
+        if (c.bottom <= band.top || c.top >= bottom) continue;
+        execute(*band.renderer, c, band.top);
+    }
+    band.renderer->clearDirty();
+    band.renderUs = esp_timer_get_time() - start;
+
+    if (pushEachBand) {
+        // 反対側のバンドの転送と重ならないようにバスを排他する
+        xSemaphoreTake(busLock, portMAX_DELAY);
+        display->startWrite();
+        display->pushImageDMA(pushX, pushY + band.top, boundWidth, band.lines,
+                              (const lgfx::swap565_t*)band.view->getBuffer());
+        display->waitDMA();
+        display->endWrite();
+        xSemaphoreGive(busLock);
+    }
+}
+
+void RetroParallelRasterizer::run(bool push, int x, int y) {
+    inFrame = false;
+
+    if (!bindBands()) {
+        // 並列描画できない場合は呼び出し元で順に描画
+        for (int i = 0; i < commandCount; i++) {
+            execute(*target, commands[i], 0);
+        }
+        if (push) {
+            target->pushCanvasToDisplayOpaque(x, y);
+        }
+    } else {
+        pushEachBand = push && display;
+        pushX = x;
+        pushY = y;
+
+        // バンドのレンダラーも描画先と同じアセットキャッシュから読む
+        // （先読みは描画の合間に行うので、描画中は項目の位置が変わらない。ヒット数は両コアから数えるため概数）
+        for (int i = 0; i < BAND_COUNT; i++) {
+            bands[i].renderer->setAssetCache(target->getAssetCache());
+        }
+
+        // バンドごとの転送は両コアから行うので、転送フックはこのタスクでまとめて呼ぶ
+        if (pushEachBand) {
+            display->notifyTransferBegin();
+        }
+
+        // 下半分をワーカーに渡し、上半分はこのタスクで描く
+        xTaskNotifyGive(worker);
+        renderBand(bands[0]);
+        xSemaphoreTake(workerDone, portMAX_DELAY);
+
+        if (pushEachBand) {
+            target->clearDirty();
+            display->notifyFrameSent((size_t)(bands[0].lines + bands[1].lines) * boundWidth * sizeof(uint16_t));
+        } else {
+            target->markAllDirty();
+        }
+    }
+
+    if (droppedCount > 0) {
+        ESP_LOGE(TAG, "Command list full: %d commands dropped", droppedCount);
+    }
+}
+
+void RetroParallelRasterizer::finish() {
+    run(false, 0, 0);
+}
+
+size_t RetroParallelRasterizer::finishAndPush(int x, int y) {
+    M5Canvas* canvas = target ? target->getCanvas() : nullptr;
+    if (!canvas) return 0;
+
+    run(true, x, y);
+    return (size_t)canvas->width() * canvas->height() * sizeof(uint16_t);
+}
+
+bool RetroParallelRasterizer::isParallel() const {
+    const M5Canvas* canvas = target ? target->getCanvas() : nullptr;
+    return worker && canvas && (canvas->getColorDepth() & lgfx::bit_mask) == 16;
+}
+
+int64_t RetroParallelRasterizer::getBandTime(int band) const {
+    return (band >= 0 && band < BAND_COUNT) ? bands[band].renderUs : 0;
+}
+
+int RetroParallelRasterizer::getDroppedCount() const {
+    return droppedCount;
+}
@@ -0,0 +1,251 @@
+/*
+ * RetroParallelRasterizer.hpp
+ * 2コア並列ラスタライズ for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 1フレーム分の描画命令（クリア・画像・部分領域・拡大縮小・反転回転・矩形塗り）を記録
+ * - キャンバスを上下2つのバンドに分け、呼び出し元タスクが上半分、
+ *   もう一方のコアに固定したワーカータスクが下半分を同じ命令列でラスタライズ
+ * - 各バンドはキャンバスの該当行を直接指すビュー（行が連続する16bitキャンバスのみ対応）
+ * - 両方の完了を待ってから転送する方式と、バンドごとに描き終わり次第転送する方式を選べる
+ *
+ * ダブルバッファ使用時は、描画先（裏キャンバス）が入れ替わるたびにビューを張り直す
+ * 16bit以外のキャンバスでは呼び出し元タスクだけで順に描画する
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * 2コア並列ラスタライザ
+ * begin() → clear()/draw*()/fillRect() を繰り返す → finish() または finishAndPush()
+ * 登録した画像は finish() まで保持しておくこと
+ */
+class RetroParallelRasterizer {
+public:
+    static constexpr int BAND_COUNT = 2;              // バンド数（コア数）
+    static constexpr int DEFAULT_MAX_COMMANDS = 32;   // 1フレームの描画命令数（デフォルト）
+
+private:
+    // 描画命令の種類
+    static constexpr uint8_t CMD_CLEAR = 0;        // キャンバス全体を塗りつぶし
+    static constexpr uint8_t CMD_FILL_RECT = 1;    // 矩形塗りつぶし
+    static constexpr uint8_t CMD_IMAGE = 2;        // drawToCanvas
+    static constexpr uint8_t CMD_REGION = 3;       // drawRegionToCanvas
+    static constexpr uint8_t CMD_SCALED = 4;       // drawToCanvasScaled
+    static constexpr uint8_t CMD_TRANSFORMED = 5;  // drawToCanvasTransformed
+
+    /**
+     * 描画命令（座標はキャンバス座標）
+     */
+    struct DrawCommand {
+        const PaletteImageData* image;     // 画像
+        float scaleX, scaleY;              // 倍率（拡大縮小）
+        int16_t x, y;                      // 描画位置
+        int16_t regionX, regionY;          // 部分領域の画像側座標・矩形のサイズ（矩形塗り）
+        int16_t regionWidth, regionHeight; // 部分領域のサイズ
+        int16_t top, bottom;               // 命令がかかる行範囲 [top, bottom)
+        uint16_t color;                    // 塗りつぶし色
+        uint8_t kind;                      // 命令の種類
+        uint8_t transform;                 // 反転・回転フラグ
+        bool transparent;                  // 透明色を使用するか
+    };
+
+    /**
+     * バンド（キャンバスの連続した行範囲）
+     */
+    struct Band {
+        M5Canvas* view;                    // キャンバスの該当行を指すビュー
+        PaletteImageRenderer* renderer;    // ビューに描くレンダラー
+        int top, lines;                    // 行範囲
+        int64_t renderUs;                  // 直近のラスタライズ時間
+    };
+
+    PaletteImageRenderer* target;      // 描画先レンダラー
+    LGFX_ST7789P3_76x284* display;     // ディスプレイ（バンドごとの転送用）
+    DrawCommand* commands;             // 描画命令リスト
+    int maxCommands;                   // 登録できる最大数
+    int commandCount;                  // 登録数
+    int droppedCount;                  // 上限超過で登録できなかった数
+    Band bands[BAND_COUNT];            // バンド
+    uint8_t* boundBuffer;              // ビューを設定した時のキャンバスバッファ
+    int boundWidth, boundHeight;       // ビューを設定した時のキャンバスサイズ
+
+    TaskHandle_t worker;               // 下半分を描くワーカータスク
+    SemaphoreHandle_t workerDone;      // ワーカーの完了通知
+    SemaphoreHandle_t busLock;         // バンドごとの転送でのSPIバス排他
+    volatile bool workerStop;          // ワーカー停止要求
+    volatile bool pushEachBand;        // 描き終わったバンドをすぐ転送するか
+    int pushX, pushY;                  // バンドごとの転送先（キャンバス左上）
+    bool inFrame;                      // begin()済みか
+
+    /**
+     * ワーカータスク本体
+     * @param arg ラスタライザ
+     */
+    static void workerEntry(void* arg);
+
+    /**
+     * キャンバスの行範囲を指すビューを設定（キャンバスが変わった時だけ）
+     * @return 並列描画できる場合true
+     */
+    bool bindBands();
+
+    /**
+     * 描画命令リストに1項目追加（上限チェック込み）
+     * @param kind 命令の種類
+     * @param top 命令がかかる先頭行
+     * @param height 命令がかかる行数
+     * @return 追加した項目（上限超過時nullptr）
+     */
+    DrawCommand* allocCommand(uint8_t kind, int top, int height);
+
+    /**
+     * 画像のパレット変換テーブルを事前に作る（両コアからは読むだけにする）
+     * @param img パレット画像データ
+     */
+    static void prepareImage(const PaletteImageData& img);
+
+    /**
+     * 1バンド分をラスタライズ（し、必要なら転送）
+     * @param band バンド
+     */
+    void renderBand(Band& band);
+
+    /**
+     * 描画命令を1つ実行
+     * @param r 描画先レンダラー
+     * @param c 描画命令
+     * @param offsetY 描画先の先頭行（キャンバス座標）
+     */
+    static void execute(PaletteImageRenderer& r, const DrawCommand& c, int offsetY);
+
+    /**
+     * 記録した命令列を描画（finish系の共通処理）
+     * @param push バンドごとに転送するか
+     * @param x 転送先X座標
+     * @param y 転送先Y座標
+     */
+    void run(bool push, int x, int y);
+
+public:
+    /**
+     * コンストラクタ
+     * ワーカータスクは呼び出し元と反対のコアに固定して作成する
+     * @param renderer 描画先レンダラー（16bitキャンバス）
+     * @param gfx ディスプレイインスタンス（finishAndPush() 用）
+     * @param maxCommandCount 1フレームに登録できる最大命令数
+     */
+    RetroParallelRasterizer(PaletteImageRenderer* renderer, LGFX_ST7789P3_76x284* gfx,
+                            int maxCommandCount = DEFAULT_MAX_COMMANDS);
+
+    /**
+     * デストラクタ（ワーカータスクを停止）
+     */
+    ~RetroParallelRasterizer();
+
+    // タスクとバッファを所有するためコピー禁止
+    RetroParallelRasterizer(const RetroParallelRasterizer&) = delete;
+    RetroParallelRasterizer& operator=(const RetroParallelRasterizer&) = delete;
+
+    /**
+     * フレームの記録を開始
+     */
+    void begin();
+
+    /**
+     * キャンバス全体を塗りつぶす
+     * @param color RGB565色
+     */
+    void clear(uint16_t color);
+
+    /**
+     * 矩形を塗りつぶす
+     * @param x 左上X座標
+     * @param y 左上Y座標
+     * @param w 幅
+     * @param h 高さ
+     * @param color RGB565色
+     */
+    void fillRect(int x, int y, int w, int h, uint16_t color);
+
+    /**
+     * PaletteImageRenderer::drawToCanvas を記録
+     * @param img パレット画像データ
+     * @param x 描画先X座標
+     * @param y 描画先Y座標
+     * @param useTransparency 透明色を使用するか
+     */
+    void draw(const PaletteImageData& img, int x, int y, bool useTransparency = true);
+
+    /**
+     * PaletteImageRenderer::drawRegionToCanvas を記録
+     * @param img パレット画像データ
+     * @param regionX 領域の画像側X座標
+     * @param regionY 領域の画像側Y座標
+     * @param regionWidth 領域の幅
+     * @param regionHeight 領域の高さ
+     * @param x 領域左上の描画先X座標
+     * @param y 領域左上の描画先Y座標
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawRegion(const PaletteImageData& img, int regionX, int regionY, int regionWidth, int regionHeight,
+                    int x, int y, bool useTransparency = true);
+
+    /**
+     * PaletteImageRenderer::drawToCanvasScaled を記録
+     * @param img パレット画像データ
+     * @param x 描画先X座標
+     * @param y 描画先Y座標
+     * @param scaleX X方向倍率
+     * @param scaleY Y方向倍率
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawScaled(const PaletteImageData& img, int x, int y, float scaleX, float scaleY,
+                    bool useTransparency = true);
+
+    /**
+     * PaletteImageRenderer::drawToCanvasTransformed を記録
+     * @param img パレット画像データ
+     * @param x 変換後の画像左上の描画先X座標
+     * @param y 変換後の画像左上の描画先Y座標
+     * @param transform 変換フラグ（BLIT_FLIP_H | BLIT_FLIP_V | BLIT_ROTATE_90）
+     * @param useTransparency 透明色を使用するか
+     */
+    void drawTransformed(const PaletteImageData& img, int x, int y, uint8_t transform,
+                         bool useTransparency = true);
+
+    /**
+     * 記録した命令を2コアで描画し、両方の完了を待つ（転送は呼び出し側で行う）
+     * 描画先レンダラーのキャンバス全体を変更済みとして登録する
+     */
+    void finish();
+
+    /**
+     * 記録した命令を2コアで描画し、描き終わったバンドから順にディスプレイへ転送
+     * @param x キャンバス左上のディスプレイ上X座標
+     * @param y キャンバス左上のディスプレイ上Y座標
+     * @return 送信したバイト数
+     */
+    size_t finishAndPush(int x = 0, int y = 0);
+
+    /**
+     * 並列描画できる状態か（ワーカー作成済み・16bitキャンバス）
+     * @return true=並列描画
+     */
+    bool isParallel() const;
+
+    /**
+     * 直近のフレームのバンドごとのラスタライズ時間を取得
+     * @param band バンド番号（0=上半分、1=下半分）
+     * @return 時間（マイクロ秒）
+     */
+    int64_t getBandTime(int band) const;
+
+    /**
+     * 現在のフレームで上限超過により登録できなかった数を取得
+     * @return 命令数
+     */
+    int getDroppedCount() const;
+};
@@ -0,0 +1,273 @@
+/*
+ * RetroPowerManager.cpp
+ * 省電力アイドルモード実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroPowerManager.hpp"
+#include "esp_log.h"
+#if CONFIG_CSBOARD_POWER_SAVE
+#include "esp_pm.h"
+#endif
+
+// ログタグ定義
+static const char *TAG = "RetroPower";
+
+// アイドル中に一定FPS・vsync風モードのスケジューラを起こす間隔
+#ifdef CONFIG_CSBOARD_POWER_IDLE_FPS
+static constexpr uint32_t IDLE_FRAME_INTERVAL_MS = 1000 / CONFIG_CSBOARD_POWER_IDLE_FPS;
+#else
+static constexpr uint32_t IDLE_FRAME_INTERVAL_MS = 500;
+#endif
+
+#if CONFIG_CSBOARD_POWER_SAVE
+static esp_pm_lock_handle_t cpuLock = nullptr;  // 最大クロック要求（アクティブ中だけ保持）
+#endif
+
+// ===== 静的メンバ =====
+LGFX_ST7789P3_76x284* RetroPowerManager::panel = nullptr;
+bool RetroPowerManager::initialized = false;
+bool RetroPowerManager::enabled = false;
+volatile bool RetroPowerManager::idle = false;
+SemaphoreHandle_t RetroPowerManager::mutex = nullptr;
+esp_timer_handle_t RetroPowerManager::idleTimer = nullptr;
+uint32_t RetroPowerManager::idleAfterUs = 0;
+int64_t RetroPowerManager::lastChangeUs = 0;
+int64_t RetroPowerManager::stateSinceUs = 0;
+uint32_t RetroPowerManager::activeMw = RetroPowerManager::DEFAULT_ACTIVE_MW;
+#if CONFIG_CSBOARD_POWER_LIGHT_SLEEP
+uint32_t RetroPowerManager::idleMw = RetroPowerManager::DEFAULT_SLEEP_MW;
+#else
+uint32_t RetroPowerManager::idleMw = RetroPowerManager::DEFAULT_DFS_MW;
+#endif
+RetroPowerManager::PowerStats RetroPowerManager::stats = {};
+
+bool RetroPowerManager::init(LGFX_ST7789P3_76x284* display, uint32_t idleAfterMs) {
+    if (initialized) {
+        ESP_LOGE(TAG, "Power manager already initialized");
+        return enabled;
+    }
+
+    panel = display;
+    idleAfterUs = idleAfterMs * 1000;
+    mutex = xSemaphoreCreateMutex();
+    if (!mutex) {
+        ESP_LOGE(TAG, "Failed to create power manager mutex");
+        return false;
+    }
+    stats = {};
+    stateSinceUs = lastChangeUs = esp_timer_get_time();
+    initialized = true;
+
+    // 転送のたびにディスプレイから呼ばれる（レンダラー・スプライトバッチ・スクロール等の全経路）
+    if (panel) {
+        LGFX_ST7789P3_76x284::TransferHooks hooks = {};
+        hooks.beforeTransfer = wake;
+        hooks.afterFrame = notifyFrame;
+        panel->setTransferHooks(hooks);
+    }
+
+#if CONFIG_CSBOARD_POWER_SAVE
+    // 最大クロック要求を保持している間は常に最大クロック、解除するとDFS・ライトスリープに任せる
+    esp_pm_config_t config = {};
+    config.max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    config.min_freq_mhz = CONFIG_CSBOARD_POWER_MIN_CPU_MHZ;
+#if CONFIG_CSBOARD_POWER_LIGHT_SLEEP
+    config.light_sleep_enable = true;
+#endif
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_OK) {
+        err = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "retro_render", &cpuLock);
+    }
+    if (err == ESP_OK) {
+        err = esp_pm_lock_acquire(cpuLock);
+    }
+    if (err == ESP_OK) {
+        esp_timer_create_args_t args = {};
+        args.callback = idleTimerCallback;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "power_idle";
+        err = esp_timer_create(&args, &idleTimer);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set up power management (%s), staying at full clock", esp_err_to_name(err));
+        if (cpuLock) {
+            esp_pm_lock_delete(cpuLock);
+            cpuLock = nullptr;
+        }
+        return false;
+    }
+
+    enabled = true;
+    restartIdleTimer();
+    ESP_LOGI(TAG, "Power save enabled: idle after %lu ms static, CPU %d-%d MHz, light sleep %s, idle frame %lu ms",
+             (unsigned long)idleAfterMs, config.min_freq_mhz, config.max_freq_mhz,
+             config.light_sleep_enable ? "on" : "off", (unsigned long)IDLE_FRAME_INTERVAL_MS);
+    return true;
+#else
+    ESP_LOGI(TAG, "Power save disabled, collecting frame energy stats only");
+    return false;
+#endif
+}
+
+void RetroPowerManager::idleTimerCallback(void*) {
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    // タイマーを掛けた後に画面が変わっていればその時点から数え直す
+    const int64_t now = esp_timer_get_time();
+    if (!idle && now - lastChangeUs >= (int64_t)idleAfterUs) {
+        enterIdleLocked(now);
+    }
+    xSemaphoreGive(mutex);
+}
+
+void RetroPowerManager::accumulateLocked(int64_t now) {
+    const uint64_t elapsed = (uint64_t)(now - stateSinceUs);
+    if (idle) {
+        stats.idleUs += elapsed;
+    } else {
+        stats.activeUs += elapsed;
+    }
+    stateSinceUs = now;
+}
+
+void RetroPowerManager::enterIdleLocked(int64_t now) {
+    accumulateLocked(now);
+    idle = true;
+    stats.idleEntries++;
+#if CONFIG_CSBOARD_POWER_SAVE
+    esp_pm_lock_release(cpuLock);
+#endif
+}
+
+void RetroPowerManager::leaveIdleLocked(int64_t now) {
+    accumulateLocked(now);
+#if CONFIG_CSBOARD_POWER_SAVE
+    esp_pm_lock_acquire(cpuLock);
+#endif
+    idle = false;
+}
+
+void RetroPowerManager::restartIdleTimer() {
+    esp_timer_stop(idleTimer);  // 停止中の場合のエラーは無視
+    esp_timer_start_once(idleTimer, idleAfterUs);
+}
+
+bool RetroPowerManager::isIdle() {
+    return idle;
+}
+
+void RetroPowerManager::wake() {
+    if (!enabled) return;
+    if (!idle && !(panel && panel->isPanelIdleMode())) return;  // 最大クロックで動作中
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    const int64_t now = esp_timer_get_time();
+    if (idle) {
+        leaveIdleLocked(now);
+    }
+    if (panel && panel->isPanelIdleMode()) {
+        panel->setPanelIdleMode(false);
+    }
+
+    // 起きた後に何も転送しなければ、またアイドルに戻る
+    lastChangeUs = now;
+    restartIdleTimer();
+    xSemaphoreGive(mutex);
+}
+
+void RetroPowerManager::notifyFrame(size_t spiBytes) {
+    if (!initialized) return;
+
+    if (spiBytes == 0) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        stats.staticFrames++;
+        xSemaphoreGive(mutex);
+        return;
+    }
+
+    wake();
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    stats.displayedFrames++;
+    lastChangeUs = esp_timer_get_time();
+    xSemaphoreGive(mutex);
+    if (enabled) {
+        restartIdleTimer();
+    }
+}
+
+void RetroPowerManager::hold(uint32_t ms) {
+    if (enabled) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        esp_timer_stop(idleTimer);
+        if (!idle) {
+            enterIdleLocked(esp_timer_get_time());
+        }
+#if CONFIG_CSBOARD_POWER_PANEL_IDLE
+        if (panel) {
+            panel->setPanelIdleMode(true);
+        }
+#endif
+        xSemaphoreGive(mutex);
+    }
+    vTaskDelay(pdMS_TO_TICKS(ms));
+
+    if (enabled) {
+        // 次のフレームの描画は最大クロックで行う（パネルは次の転送まで静止画のアイドル表示のまま）
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        const int64_t now = esp_timer_get_time();
+        if (idle) {
+            leaveIdleLocked(now);
+        }
+        lastChangeUs = now;
+        restartIdleTimer();
+        xSemaphoreGive(mutex);
+    }
+}
+
+uint32_t RetroPowerManager::getIdleFrameIntervalMs() {
+    return IDLE_FRAME_INTERVAL_MS;
+}
+
+void RetroPowerManager::setPowerModel(uint32_t activeMilliwatts, uint32_t idleMilliwatts) {
+    activeMw = activeMilliwatts;
+    idleMw = idleMilliwatts;
+}
+
+RetroPowerManager::PowerStats RetroPowerManager::getStats() {
+    PowerStats result = {};
+    if (!initialized) return result;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    result = stats;
+    const uint64_t elapsed = (uint64_t)(esp_timer_get_time() - stateSinceUs);
+    if (idle) {
+        result.idleUs += elapsed;
+    } else {
+        result.activeUs += elapsed;
+    }
+    xSemaphoreGive(mutex);
+
+    // mW × µs = nJ
+    result.energyUj = (result.activeUs * activeMw + result.idleUs * idleMw) / 1000;
+    result.energyPerFrameUj = result.displayedFrames ? (uint32_t)(result.energyUj / result.displayedFrames) : 0;
+    return result;
+}
+
+void RetroPowerManager::resetStats() {
+    if (!initialized) return;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    stats = {};
+    stateSinceUs = esp_timer_get_time();
+    xSemaphoreGive(mutex);
+}
+
+void RetroPowerManager::logStats() {
+    const PowerStats s = getStats();
+    const uint64_t totalUs = s.activeUs + s.idleUs;
+    ESP_LOGI(TAG, "Power: %lu frames shown, %lu static, idle %lu%% of %.1f s (%lu entries), "
+             "est. %lu uJ/frame (%.1f mJ total)",
+             (unsigned long)s.displayedFrames, (unsigned long)s.staticFrames,
+             (unsigned long)(totalUs ? s.idleUs * 100 / totalUs : 0), totalUs / 1000000.0f,
+             (unsigned long)s.idleEntries, (unsigned long)s.energyPerFrameUj, s.energyUj / 1000.0f);
+}
@@ -0,0 +1,167 @@
+/*
+ * RetroPowerManager.hpp
+ * 省電力アイドルモード for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 画面が変わらない（転送するものが無い）状態が一定時間続いたら、CPUの最大クロック要求を解除して
+ *   動的周波数制御（DFS）・自動ライトスリープに任せる
+ * - アイドル中は RetroFrameScheduler の一定FPS・vsync風モードを低いフレームレートに落とす
+ * - 次に画面が変わったら（転送の直前・アニメーションのフレームが変わった時点で）すぐ最大クロックに戻す
+ * - 静止画を表示し続ける hold() ではすぐにアイドルへ入り、設定によりパネルもアイドルモード（8色）にする
+ * - 状態ごとの時間と代表的な消費電力から、表示した1フレームあたりの推定消費エネルギーを出す
+ *
+ * ディスプレイの転送フック（全ての転送経路から呼ばれる）とフレームスケジューラから自動で呼ばれるので、
+ * アプリは起動時の init() と、静止画を見せる間の hold() だけ使えばよい
+ * CONFIG_CSBOARD_POWER_SAVE 無効時は常に最大クロックのまま、統計だけを取る
+ */
+
+#pragma once
+
+#include <M5Unified.h>
+#include "LGFX_ST7789P3_76x284.hpp"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+// 画面が変わらなくなってからアイドルに入るまでの時間（menuconfig「csboard-pico Display」で変更可能）
+#ifdef CONFIG_CSBOARD_POWER_IDLE_AFTER_MS
+constexpr uint32_t POWER_IDLE_AFTER_MS_DEFAULT = CONFIG_CSBOARD_POWER_IDLE_AFTER_MS;
+#else
+constexpr uint32_t POWER_IDLE_AFTER_MS_DEFAULT = 250;
+#endif
+
+/**
+ * 省電力アイドルモード（プロセス全体で1つ、静的メンバのみ）
+ */
+class RetroPowerManager {
+public:
+    // 消費電力の推定に使う代表値（mW、3.3V、ESP32データシートの目安。パネル・バックライトは含まない）
+    static constexpr uint32_t DEFAULT_ACTIVE_MW = 165;   // 240MHz動作（約50mA）
+    static constexpr uint32_t DEFAULT_DFS_MW = 66;       // 80MHzまで下げた待機（約20mA）
+    static constexpr uint32_t DEFAULT_SLEEP_MW = 3;      // 自動ライトスリープ（約0.8mA）
+
+    /**
+     * 統計（resetStats() から）
+     */
+    struct PowerStats {
+        uint64_t activeUs;             // 最大クロックだった時間
+        uint64_t idleUs;               // アイドルだった時間
+        uint32_t displayedFrames;      // 転送したフレーム数
+        uint32_t staticFrames;         // 変化が無く転送しなかったフレーム数
+        uint32_t idleEntries;          // アイドルに入った回数
+        uint64_t energyUj;             // 推定消費エネルギーの合計（µJ）
+        uint32_t energyPerFrameUj;     // 転送した1フレームあたりの推定消費エネルギー（µJ）
+    };
+
+private:
+    static LGFX_ST7789P3_76x284* panel;  // パネルアイドルモードを切り替えるディスプレイ
+    static bool initialized;           // init() 済み（統計を取る）
+    static bool enabled;               // 省電力が有効（DFS・ライトスリープを設定済み）
+    static volatile bool idle;         // アイドル中
+    static SemaphoreHandle_t mutex;    // 状態の排他制御（描画タスクとタイマータスク）
+    static esp_timer_handle_t idleTimer;  // 最後に画面が変わってからアイドルに入るまでのタイマー
+    static uint32_t idleAfterUs;       // アイドルに入るまでの静止時間
+    static int64_t lastChangeUs;       // 最後に画面が変わった時刻
+    static int64_t stateSinceUs;       // 現在の状態に入った時刻（統計用）
+    static uint32_t activeMw;          // 推定用の消費電力（最大クロック）
+    static uint32_t idleMw;            // 推定用の消費電力（アイドル）
+    static PowerStats stats;           // 統計（時間・エネルギーは getStats() で計算）
+
+    /**
+     * アイドル判定タイマーのコールバック（esp_timerタスクから呼ばれる）
+     * @param arg 未使用
+     */
+    static void idleTimerCallback(void* arg);
+
+    /**
+     * 現在の状態の経過時間を統計に加え、状態の開始時刻を更新（mutex取得中に呼ぶ）
+     * @param now 現在時刻
+     */
+    static void accumulateLocked(int64_t now);
+
+    /**
+     * アイドルに入る（mutex取得中に呼ぶ）
+     * @param now 現在時刻
+     */
+    static void enterIdleLocked(int64_t now);
+
+    /**
+     * アイドルから最大クロックに戻る（mutex取得中、アイドル中に呼ぶ）
+     * @param now 現在時刻
+     */
+    static void leaveIdleLocked(int64_t now);
+
+    /**
+     * アイドル判定タイマーを掛け直す（今から idleAfterUs 後に判定）
+     */
+    static void restartIdleTimer();
+
+public:
+    /**
+     * 初期化（起動時に1回だけ呼ぶ）
+     * CONFIG_CSBOARD_POWER_SAVE 有効時はDFS・ライトスリープを設定し、最大クロックで開始する
+     * ディスプレイに転送フックを登録する（登録済みのフックは置き換える）
+     * @param display 転送を監視し、パネルアイドルモードを切り替えるディスプレイ
+     * @param idleAfterMs 画面が変わらなくなってからアイドルに入るまでの時間（ミリ秒）
+     * @return 省電力が有効になった場合true（無効時・設定失敗時は統計のみ）
+     */
+    static bool init(LGFX_ST7789P3_76x284* display, uint32_t idleAfterMs = POWER_IDLE_AFTER_MS_DEFAULT);
+
+    /**
+     * アイドル中かどうか
+     * @return true=アイドル（省電力無効時は常にfalse）
+     */
+    static bool isIdle();
+
+    /**
+     * 最大クロックに戻す（パネルのアイドルモードも解除）
+     * ディスプレイの転送前とフレームスケジューラのフレーム変化時に呼ばれる
+     * 描画タスクから呼ぶこと
+     */
+    static void wake();
+
+    /**
+     * 1フレーム分の転送を記録（ディスプレイの転送フックから呼ばれる）
+     * @param spiBytes 転送したバイト数（0=画面に変化なし）
+     */
+    static void notifyFrame(size_t spiBytes);
+
+    /**
+     * 静止画を表示したまま待つ（すぐにアイドルへ入る）
+     * CONFIG_CSBOARD_POWER_PANEL_IDLE 有効時はパネルもアイドルモード（8色表示）にする
+     * 戻る時に最大クロックへ戻す（次のフレームの描画を最低クロックで行わないように）
+     * パネルは次の転送まで静止画のアイドルモードのまま、転送で通常表示へ戻る
+     * ダブルバッファの転送タスクが転送中なら、パネルの切り替えはその転送の完了を待ってから行う
+     * @param ms 待つ時間（ミリ秒）
+     */
+    static void hold(uint32_t ms);
+
+    /**
+     * アイドル中に一定FPS・vsync風モードのスケジューラを起こす間隔を取得
+     * @return 間隔（ミリ秒）
+     */
+    static uint32_t getIdleFrameIntervalMs();
+
+    /**
+     * 推定に使う消費電力を設定（実測値がある場合）
+     * @param activeMilliwatts 最大クロック時（mW）
+     * @param idleMilliwatts アイドル時（mW）
+     */
+    static void setPowerModel(uint32_t activeMilliwatts, uint32_t idleMilliwatts);
+
+    /**
+     * 統計を取得
+     * @return 統計（現在の状態の経過時間を含む）
+     */
+    static PowerStats getStats();
+
+    /**
+     * 統計をリセット
+     */
+    static void resetStats();
+
+    /**
+     * 統計をログ出力
+     */
+    static void logStats();
+};
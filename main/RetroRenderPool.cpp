@@ -0,0 +1,252 @@
+/*
+ * RetroRenderPool.cpp
+ * 描画バッファプール実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroRenderPool.hpp"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <assert.h>
+
+// ログタグ定義
+static const char *TAG = "RetroRenderPool";
+
+RetroRenderPool::CanvasSlot RetroRenderPool::canvasSlots[MAX_CANVASES];
+int RetroRenderPool::canvasSlotCount = 0;
+RetroRenderPool::BlockSlot RetroRenderPool::blockSlots[MAX_BLOCKS];
+int RetroRenderPool::blockSlotCount = 0;
+volatile uint32_t RetroRenderPool::heapAllocCount = 0;
+
+// 枠の貸し借りの排他（変換テーブルは任意のタスクから、並列ラスタライズでは両コアから借りる）
+static portMUX_TYPE poolLock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * キャンバスの画素バッファのバイト数
+ * @param width 幅
+ * @param height 高さ
+ * @param colorDepth 色深度（16 or 4）
+ * @return バイト数
+ */
+static inline size_t canvasBytes(int width, int height, int colorDepth) {
+    return (size_t)((width * colorDepth + 7) / 8) * height;
+}
+
+bool RetroRenderPool::init(LGFX_ST7789P3_76x284* display, int canvasCount, int canvasWidth, int canvasHeight,
+                           int blockCount, size_t blockSize) {
+    if (canvasSlotCount || blockSlotCount) {
+        ESP_LOGE(TAG, "Render pool already initialized");
+        return false;
+    }
+
+    // DMA転送するので内部RAMに確保する
+    const size_t arenaBytes = canvasBytes(canvasWidth, canvasHeight, 16);
+    for (int i = 0; i < min(canvasCount, MAX_CANVASES); i++) {
+        uint8_t* arena = (uint8_t*)heap_caps_malloc(arenaBytes, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+        if (!arena) {
+            ESP_LOGE(TAG, "Failed to allocate pooled canvas %d (%zu bytes)", i, arenaBytes);
+            break;
+        }
+        CanvasSlot& slot = canvasSlots[canvasSlotCount++];
+        slot.canvas = new M5Canvas(display);
+        slot.arena = arena;
+        slot.arenaBytes = arenaBytes;
+        slot.width = slot.height = 0;
+        slot.colorDepth = 0;
+        slot.inUse = false;
+    }
+
+    const bool blocksOk = addBlockClass(blockCount, blockSize);
+
+    ESP_LOGI(TAG, "Render pool initialized: %d canvases x %zu bytes", canvasSlotCount, arenaBytes);
+    return canvasSlotCount == canvasCount && blocksOk;
+}
+
+bool RetroRenderPool::addBlockClass(int blockCount, size_t blockSize) {
+    const size_t bytes = (blockSize + 3) & ~(size_t)3;
+    int added = 0;
+    while (added < blockCount && blockSlotCount < MAX_BLOCKS) {
+        uint8_t* memory = (uint8_t*)malloc(bytes);
+        if (!memory) {
+            ESP_LOGE(TAG, "Failed to allocate pooled block %d (%zu bytes)", added, bytes);
+            break;
+        }
+
+        // 小さい順に並べておき、先頭から探した最初の空きを最適な枠にする
+        taskENTER_CRITICAL(&poolLock);
+        int pos = blockSlotCount++;
+        while (pos > 0 && blockSlots[pos - 1].bytes > bytes) {
+            blockSlots[pos] = blockSlots[pos - 1];
+            pos--;
+        }
+        blockSlots[pos].memory = memory;
+        blockSlots[pos].bytes = bytes;
+        blockSlots[pos].inUse = false;
+        taskEXIT_CRITICAL(&poolLock);
+        added++;
+    }
+
+    ESP_LOGI(TAG, "Render pool block class: %d blocks x %zu bytes", added, bytes);
+    return added == blockCount;
+}
+
+bool RetroRenderPool::isInitialized() {
+    return canvasSlotCount > 0 || blockSlotCount > 0;
+}
+
+M5Canvas* RetroRenderPool::acquireCanvas(LGFX_ST7789P3_76x284* display, int width, int height, int colorDepth) {
+    if (width <= 0 || height <= 0) return nullptr;
+    const size_t bytes = canvasBytes(width, height, colorDepth);
+
+    // 収まる空き枠のうち、同じ設定のものを優先（設定し直しとパレット再作成を避ける）
+    // 枠を確保するところだけ排他し、設定し直しとクリアは借りた側で行う
+    CanvasSlot* found = nullptr;
+    taskENTER_CRITICAL(&poolLock);
+    for (int i = 0; i < canvasSlotCount && (colorDepth == 16 || colorDepth == 4); i++) {
+        CanvasSlot& slot = canvasSlots[i];
+        if (slot.inUse || slot.arenaBytes < bytes) continue;
+        if (slot.width == width && slot.height == height && slot.colorDepth == colorDepth) {
+            found = &slot;
+            break;
+        }
+        if (!found) found = &slot;
+    }
+    if (found) {
+        found->inUse = true;
+    } else {
+        heapAllocCount++;
+    }
+    taskEXIT_CRITICAL(&poolLock);
+
+    if (found) {
+        if (found->width != width || found->height != height || found->colorDepth != colorDepth) {
+            found->canvas->setBuffer(found->arena, width, height,
+                                     colorDepth == 4 ? lgfx::palette_4bit : lgfx::rgb565_2Byte);
+            if (colorDepth == 4) {
+                found->canvas->createPalette();
+            }
+            found->width = width;
+            found->height = height;
+            found->colorDepth = colorDepth;
+        }
+        // createSprite() 直後と同じ状態で渡す（前の利用者の描画設定を持ち越さない）
+        memset(found->arena, 0, bytes);
+        found->canvas->clearClipRect();
+        found->canvas->setCursor(0, 0);
+        found->canvas->setTextSize(1);
+        return found->canvas;
+    }
+
+    // 空きが無い場合はヒープから生成
+    if (canvasSlotCount) {
+        ESP_LOGW(TAG, "No pooled canvas for %dx%d/%dbpp, allocating from heap", width, height, colorDepth);
+    }
+    M5Canvas* canvas = new M5Canvas(display);
+    canvas->setColorDepth(colorDepth);
+    canvas->setPsram(false);  // DMA転送するので内部RAMに置く
+    if (!canvas->createSprite(width, height)) {
+        ESP_LOGE(TAG, "Failed to allocate canvas: %dx%d", width, height);
+        delete canvas;
+        return nullptr;
+    }
+    if (colorDepth <= 8) {
+        canvas->createPalette();
+    }
+    return canvas;
+}
+
+void RetroRenderPool::releaseCanvas(M5Canvas* canvas) {
+    if (!canvas) return;
+
+    taskENTER_CRITICAL(&poolLock);
+    for (int i = 0; i < canvasSlotCount; i++) {
+        if (canvasSlots[i].canvas == canvas) {
+            canvasSlots[i].inUse = false;
+            taskEXIT_CRITICAL(&poolLock);
+            return;
+        }
+    }
+    taskEXIT_CRITICAL(&poolLock);
+    canvas->deleteSprite();
+    delete canvas;
+}
+
+void* RetroRenderPool::acquireBuffer(size_t bytes) {
+    taskENTER_CRITICAL(&poolLock);
+    for (int i = 0; i < blockSlotCount; i++) {
+        if (!blockSlots[i].inUse && blockSlots[i].bytes >= bytes) {
+            blockSlots[i].inUse = true;
+            taskEXIT_CRITICAL(&poolLock);
+            return blockSlots[i].memory;
+        }
+    }
+    heapAllocCount++;
+    taskEXIT_CRITICAL(&poolLock);
+
+    if (blockSlotCount) {
+        ESP_LOGW(TAG, "No pooled block for %zu bytes, allocating from heap", bytes);
+    }
+    return malloc(bytes);
+}
+
+void RetroRenderPool::releaseBuffer(void* buffer) {
+    if (!buffer) return;
+
+    taskENTER_CRITICAL(&poolLock);
+    for (int i = 0; i < blockSlotCount; i++) {
+        if (blockSlots[i].memory == buffer) {
+            blockSlots[i].inUse = false;
+            taskEXIT_CRITICAL(&poolLock);
+            return;
+        }
+    }
+    taskEXIT_CRITICAL(&poolLock);
+    free(buffer);
+}
+
+uint32_t RetroRenderPool::getHeapAllocCount() {
+    return heapAllocCount;
+}
+
+void RetroRenderPool::logStats() {
+    int canvasesInUse = 0;
+    for (int i = 0; i < canvasSlotCount; i++) {
+        canvasesInUse += canvasSlots[i].inUse;
+    }
+    ESP_LOGI(TAG, "Render pool: canvases %d/%d in use, %lu heap allocations",
+             canvasesInUse, canvasSlotCount, (unsigned long)heapAllocCount);
+
+    // サイズクラスごとの貸出数
+    for (int i = 0; i < blockSlotCount;) {
+        const size_t bytes = blockSlots[i].bytes;
+        int total = 0, inUse = 0;
+        for (; i < blockSlotCount && blockSlots[i].bytes == bytes; i++) {
+            total++;
+            inUse += blockSlots[i].inUse;
+        }
+        ESP_LOGI(TAG, "  blocks %zu bytes: %d/%d in use", bytes, inUse, total);
+    }
+}
+
+// ===== RetroNoAllocScope 実装 =====
+
+RetroNoAllocScope::RetroNoAllocScope(const char* scopeLabel)
+    : label(scopeLabel), startCount(RetroRenderPool::getHeapAllocCount()) {
+}
+
+RetroNoAllocScope::~RetroNoAllocScope() {
+    const uint32_t count = getAllocCount();
+    if (count) {
+        ESP_LOGE(TAG, "%s: %lu heap allocation(s) in no-alloc scope", label, (unsigned long)count);
+    }
+#if CONFIG_CSBOARD_RENDER_POOL_ASSERT
+    assert(count == 0);
+#endif
+}
+
+uint32_t RetroNoAllocScope::getAllocCount() const {
+    return RetroRenderPool::getHeapAllocCount() - startCount;
+}
@@ -0,0 +1,156 @@
+/*
+ * RetroRenderPool.hpp
+ * 描画バッファプール for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - キャンバスと小さな作業バッファ（ラインバッファ・変換テーブル等）を起動時に一度だけ確保
+ * - 作業バッファは大きさの違う複数のサイズクラスで持ち、収まる中で最も小さい空きから貸す
+ * - レンダラーやスプライトバッチは生成時に借り、破棄時に返す（シーンごとのmalloc/freeをなくす）
+ * - プール未初期化・空き不足の場合はヒープから確保し、その回数を数える
+ * - RetroNoAllocScope で「この区間ではヒープ確保が起きない」ことを検査できる
+ *
+ * 貸し借りは排他制御するので、どのタスクからでも行える
+ * （パレットの変換テーブルは任意のタスクで確保・解放され、並列ラスタライズでは両コアから借りる）
+ */
+
+#pragma once
+
+#include <M5Unified.h>
+#include "LGFX_ST7789P3_76x284.hpp"
+
+/**
+ * 描画バッファプール（プロセス全体で1つ、静的メンバのみ）
+ */
+class RetroRenderPool {
+public:
+    static constexpr int MAX_CANVASES = 4;   // プールできるキャンバス数
+    static constexpr int MAX_BLOCKS = 64;    // プールできる作業バッファ数（全サイズクラスの合計）
+
+private:
+    /**
+     * キャンバス枠
+     * 前回と同じサイズ・色深度で借りる場合は設定し直さない
+     */
+    struct CanvasSlot {
+        M5Canvas* canvas;              // キャンバス（外部バッファモード）
+        uint8_t* arena;                // 画素バッファ
+        size_t arenaBytes;             // 画素バッファのバイト数
+        int width, height;             // 現在の設定
+        int colorDepth;                // 現在の色深度（0=未設定）
+        bool inUse;                    // 貸出中
+    };
+
+    /**
+     * 作業バッファ枠
+     */
+    struct BlockSlot {
+        uint8_t* memory;               // バッファ
+        size_t bytes;                  // バッファのバイト数（サイズクラス）
+        bool inUse;                    // 貸出中
+    };
+
+    static CanvasSlot canvasSlots[MAX_CANVASES];
+    static int canvasSlotCount;
+    static BlockSlot blockSlots[MAX_BLOCKS];
+    static int blockSlotCount;         // 作業バッファ数（小さいサイズクラスから順に並ぶ）
+    static volatile uint32_t heapAllocCount;  // プール外で行ったヒープ確保の回数
+
+public:
+    /**
+     * プールを確保（起動時に1回だけ呼ぶ）
+     * @param display ディスプレイ（キャンバスの転送先）
+     * @param canvasCount キャンバス数
+     * @param canvasWidth キャンバスの最大幅
+     * @param canvasHeight キャンバスの最大高さ（RGB565で確保）
+     * @param blockCount 作業バッファ数（最大のサイズクラス）
+     * @param blockSize 作業バッファ1つのバイト数
+     * @return 全て確保できた場合true
+     */
+    static bool init(LGFX_ST7789P3_76x284* display, int canvasCount, int canvasWidth, int canvasHeight,
+                     int blockCount, size_t blockSize);
+
+    /**
+     * 作業バッファのサイズクラスを追加（init() の後、起動時に呼ぶ）
+     * 変換テーブルや数十バイトのマスクが大きな作業バッファを1つずつ占有しないようにする
+     * @param blockCount 作業バッファ数
+     * @param blockSize 作業バッファ1つのバイト数
+     * @return 全て確保できた場合true
+     */
+    static bool addBlockClass(int blockCount, size_t blockSize);
+
+    /**
+     * プールを確保済みかどうか
+     * @return true=確保済み
+     */
+    static bool isInitialized();
+
+    /**
+     * キャンバスを借りる（空きが無ければヒープから生成）
+     * 中身はゼロクリア済み、4bitキャンバスはパレット作成済み
+     * @param display ディスプレイ
+     * @param width 幅
+     * @param height 高さ
+     * @param colorDepth 色深度（プールするのは16と4のみ、それ以外はヒープから生成）
+     * @return キャンバス（確保失敗時はnullptr）
+     */
+    static M5Canvas* acquireCanvas(LGFX_ST7789P3_76x284* display, int width, int height, int colorDepth);
+
+    /**
+     * キャンバスを返す（プール外のものは解放）
+     * @param canvas acquireCanvas() で借りたキャンバス
+     */
+    static void releaseCanvas(M5Canvas* canvas);
+
+    /**
+     * 作業バッファを借りる（収まる中で最も小さいサイズクラスの空き、無ければヒープから確保）
+     * @param bytes 必要なバイト数
+     * @return バッファ（確保失敗時はnullptr）
+     */
+    static void* acquireBuffer(size_t bytes);
+
+    /**
+     * 作業バッファを返す（プール外のものは解放）
+     * @param buffer acquireBuffer() で借りたバッファ（nullptr可）
+     */
+    static void releaseBuffer(void* buffer);
+
+    /**
+     * プール外で行ったヒープ確保の回数を取得
+     * @return 回数（起動時から累計）
+     */
+    static uint32_t getHeapAllocCount();
+
+    /**
+     * 貸出状況をログ出力
+     */
+    static void logStats();
+};
+
+/**
+ * ヒープ確保なし区間の検査
+ * 生存中にプール外のヒープ確保が起きた場合、破棄時にエラーログを出す
+ * （CONFIG_CSBOARD_RENDER_POOL_ASSERT 有効時はassertで停止）
+ */
+class RetroNoAllocScope {
+private:
+    const char* label;                 // ログに出す区間名
+    uint32_t startCount;               // 開始時の確保回数
+
+public:
+    /**
+     * コンストラクタ
+     * @param scopeLabel 区間名
+     */
+    explicit RetroNoAllocScope(const char* scopeLabel);
+
+    /**
+     * デストラクタ（確保回数を検査）
+     */
+    ~RetroNoAllocScope();
+
+    /**
+     * 区間内で行われたヒープ確保の回数を取得
+     * @return 回数
+     */
+    uint32_t getAllocCount() const;
+};
@@ -0,0 +1,321 @@
+/*
+ * RetroSpriteBatch.cpp
+ * スプライトバッチ（ディスプレイリスト）描画実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroSpriteBatch.hpp"
+#include "RetroRenderPool.hpp"
+#include "esp_log.h"
+#include <algorithm>
+
+// ログタグ定義
+static const char *TAG = "RetroSpriteBatch";
+
+/**
+ * RGB565をパネル転送用にバイトスワップ
+ * @param color RGB565色
+ * @return バイトスワップ済みの色
+ */
+static inline uint16_t swap565(uint16_t color) {
+    return (uint16_t)((color >> 8) | (color << 8));
+}
+
+RetroSpriteBatch::RetroSpriteBatch(LGFX_ST7789P3_76x284* gfx, int maxEntryCount, int bandLineCount)
+    : display(gfx), entries(nullptr), maxEntries(0), entryCount(0), droppedCount(0),
+      bandLines(max(1, bandLineCount)), bandCanvas{nullptr, nullptr}, bandRenderer{nullptr, nullptr},
+      bandWidth(0), regionX(0), regionY(0), regionWidth(0), regionHeight(0), background(0), inFrame(false) {
+    if (maxEntryCount > 0) {
+        entries = (DrawEntry*)RetroRenderPool::acquireBuffer(maxEntryCount * sizeof(DrawEntry));
+    }
+    if (entries) {
+        maxEntries = maxEntryCount;
+        ESP_LOGI(TAG, "RetroSpriteBatch created: %d entries max, %d-line bands", maxEntries, bandLines);
+    } else {
+        ESP_LOGE(TAG, "Failed to allocate draw list (%d entries)", maxEntryCount);
+    }
+}
+
+RetroSpriteBatch::~RetroSpriteBatch() {
+    for (int i = 0; i < 2; i++) {
+        delete bandRenderer[i];
+        RetroRenderPool::releaseCanvas(bandCanvas[i]);
+    }
+    RetroRenderPool::releaseBuffer(entries);
+}
+
+bool RetroSpriteBatch::initBandBuffers(int width) {
+    if (width == bandWidth && bandCanvas[0] && bandCanvas[1]) return true;
+
+    for (int i = 0; i < 2; i++) {
+        // DMA転送はバッファ先頭から連続で読むので、幅はぴったり描画領域に合わせる
+        // （幅が変わった時だけプールから借り直す）
+        delete bandRenderer[i];
+        bandRenderer[i] = nullptr;
+        RetroRenderPool::releaseCanvas(bandCanvas[i]);
+        bandCanvas[i] = RetroRenderPool::acquireCanvas(display, width, bandLines, 16);
+        if (!bandCanvas[i]) {
+            ESP_LOGE(TAG, "Failed to allocate band buffer: %dx%d", width, bandLines);
+            bandWidth = 0;
+            return false;
+        }
+        bandRenderer[i] = new PaletteImageRenderer(display, bandCanvas[i]);
+        bandRenderer[i]->setProfilingEnabled(false);
+    }
+
+    bandWidth = width;
+    ESP_LOGI(TAG, "Band buffers initialized: 2 x %dx%d (%zu bytes)",
+             width, bandLines, 2 * (size_t)width * bandLines * sizeof(uint16_t));
+    return true;
+}
+
+bool RetroSpriteBatch::begin(uint16_t backgroundColor, int x, int y, int width, int height) {
+    entryCount = 0;
+    droppedCount = 0;
+    inFrame = false;
+    if (!display || !entries) return false;
+
+    if (width <= 0) width = display->width();
+    if (height <= 0) height = display->height();
+    if (width <= 0 || height <= 0) return false;
+
+    if (!initBandBuffers(width)) return false;
+
+    regionX = x;
+    regionY = y;
+    regionWidth = width;
+    regionHeight = height;
+    background = swap565(backgroundColor);
+    inFrame = true;
+    return true;
+}
+
+RetroSpriteBatch::DrawEntry* RetroSpriteBatch::allocEntry() {
+    if (entryCount >= maxEntries) {
+        droppedCount++;
+        return nullptr;
+    }
+
+    DrawEntry* e = &entries[entryCount];
+    *e = {};
+    e->order = (uint16_t)entryCount;
+    entryCount++;
+    return e;
+}
+
+bool RetroSpriteBatch::add(const PaletteImageData& img, int x, int y, int priority, uint8_t flip,
+                           const RetroColorPalette* palette, bool useTransparency) {
+    if (!inFrame || !img.data) return false;
+
+    // 描画領域でクリップ（見えないスプライトはリストに入れない）
+    const bool rotate = (flip & ROTATE_90) != 0;
+    int x0 = max(0, x);
+    int y0 = max(0, y);
+    int x1 = min(regionWidth, x + (rotate ? img.height : img.width));
+    int y1 = min(regionHeight, y + (rotate ? img.width : img.height));
+    if (x0 >= x1 || y0 >= y1) return true;
+
+    DrawEntry* s = allocEntry();
+    if (!s) return false;
+
+    s->kind = ENTRY_SPRITE;
+    s->image = &img;
+    s->palette = palette ? palette : &img.palette;
+    s->x = (int16_t)x;
+    s->y = (int16_t)y;
+    s->clipX0 = (int16_t)x0;
+    s->clipX1 = (int16_t)x1;
+    s->clipY0 = (int16_t)y0;
+    s->clipY1 = (int16_t)y1;
+    s->priority = (int16_t)priority;
+    s->flip = flip;
+    s->transparent = useTransparency;
+    return true;
+}
+
+bool RetroSpriteBatch::addTilemap(RetroTilemap& tilemap, int priority, bool useTransparency,
+                                  int viewX, int viewY, int viewWidth, int viewHeight) {
+    if (!inFrame) return false;
+
+    if (viewWidth <= 0) viewWidth = regionWidth - viewX;
+    if (viewHeight <= 0) viewHeight = regionHeight - viewY;
+    int x0 = max(0, viewX);
+    int y0 = max(0, viewY);
+    int x1 = min(regionWidth, viewX + viewWidth);
+    int y1 = min(regionHeight, viewY + viewHeight);
+    if (x0 >= x1 || y0 >= y1) return true;
+
+    DrawEntry* t = allocEntry();
+    if (!t) return false;
+
+    t->kind = ENTRY_TILEMAP;
+    t->tilemap = &tilemap;
+    t->x = (int16_t)viewX;
+    t->y = (int16_t)viewY;
+    t->clipX0 = (int16_t)x0;
+    t->clipX1 = (int16_t)x1;
+    t->clipY0 = (int16_t)y0;
+    t->clipY1 = (int16_t)y1;
+    t->priority = (int16_t)priority;
+    t->transparent = useTransparency;
+    return true;
+}
+
+bool RetroSpriteBatch::addText(const char* text, int x, int y, uint16_t color, int priority, int textSize) {
+    if (!inFrame || !text) return false;
+
+    DrawEntry* t = allocEntry();
+    if (!t) return false;
+
+    // 文字の高さはフォント依存なので、縦方向の判定は描画時にバンド単位で行う
+    t->kind = ENTRY_TEXT;
+    t->text = text;
+    t->x = (int16_t)x;
+    t->y = (int16_t)y;
+    t->priority = (int16_t)priority;
+    t->color = color;
+    t->textSize = (uint8_t)max(1, textSize);
+    return true;
+}
+
+void RetroSpriteBatch::rasterizeSpriteLine(const DrawEntry& s, int line, uint16_t* dst) {
+    const PaletteImageData& img = *s.image;
+    const uint8_t* data = img.data;
+    const uint16_t* colors = s.palette->colors;
+
+    const int row = line - s.y;
+    const int col = s.clipX0 - s.x;
+
+    // 行頭のソース座標（反転を先に、回転を後に適用）
+    const bool rotate = (s.flip & ROTATE_90) != 0;
+    int srcX = rotate ? row : col;
+    int srcY = rotate ? img.height - 1 - col : row;
+    if (s.flip & FLIP_H) srcX = img.width - 1 - srcX;
+    if (s.flip & FLIP_V) srcY = img.height - 1 - srcY;
+
+    // ソースのピクセル番号を進める（左右反転時は逆方向、回転時はソースの列をたどる）
+    int p = srcY * img.width + srcX;
+    int step;
+    if (rotate) {
+        step = (s.flip & FLIP_V) ? img.width : -img.width;
+    } else {
+        step = (s.flip & FLIP_H) ? -1 : 1;
+    }
+
+    uint16_t* out = dst + s.clipX0;
+    const int count = s.clipX1 - s.clipX0;
+    if (s.transparent) {
+        for (int i = 0; i < count; i++, p += step) {
+            uint8_t b = data[p >> 1];
+            uint8_t index = (p & 1) ? (b >> 4) : (b & 0x0F);
+            if (index != RetroColorPalette::TRANSPARENT_INDEX) {
+                out[i] = swap565(colors[index]);
+            }
+        }
+    } else {
+        for (int i = 0; i < count; i++, p += step) {
+            uint8_t b = data[p >> 1];
+            out[i] = swap565(colors[(p & 1) ? (b >> 4) : (b & 0x0F)]);
+        }
+    }
+}
+
+void RetroSpriteBatch::renderBand(int index, int top, int lines) {
+    M5Canvas* band = bandCanvas[index];
+    uint16_t* buffer = (uint16_t*)band->getBuffer();
+    const int bottom = top + lines;
+
+    const int pixels = regionWidth * lines;
+    for (int i = 0; i < pixels; i++) {
+        buffer[i] = background;
+    }
+
+    // 優先度の低い順に上書きしていく
+    for (int n = 0; n < entryCount; n++) {
+        const DrawEntry& e = entries[n];
+
+        if (e.kind == ENTRY_TEXT) {
+            band->setTextSize(e.textSize);
+            if (e.y >= bottom || e.y + band->fontHeight() <= top) continue;
+            band->setTextColor(e.color);
+            band->drawString(e.text, e.x, e.y - top);
+            continue;
+        }
+
+        const int y0 = max((int)e.clipY0, top);
+        const int y1 = min((int)e.clipY1, bottom);
+        if (y0 >= y1) continue;
+
+        if (e.kind == ENTRY_SPRITE) {
+            for (int line = y0; line < y1; line++) {
+                rasterizeSpriteLine(e, line, buffer + (line - top) * regionWidth);
+            }
+        } else {
+            // ビューポートのうちこのバンドに入る部分だけを、スクロール位置をずらして描画
+            int scrollX, scrollY;
+            e.tilemap->getScroll(scrollX, scrollY);
+            e.tilemap->setScroll(scrollX + (e.clipX0 - e.x), scrollY + (y0 - e.y));
+            e.tilemap->render(*bandRenderer[index], e.clipX0, y0 - top,
+                              e.clipX1 - e.clipX0, y1 - y0, e.transparent);
+            e.tilemap->setScroll(scrollX, scrollY);
+        }
+    }
+}
+
+size_t RetroSpriteBatch::end() {
+    if (!inFrame) return 0;
+    inFrame = false;
+
+    // 優先度順、同じ優先度は登録順
+    std::sort(entries, entries + entryCount, [](const DrawEntry& a, const DrawEntry& b) {
+        return (a.priority != b.priority) ? a.priority < b.priority : a.order < b.order;
+    });
+
+    // バンドkの描画中にバンドk-1をDMA転送する
+    // バンドkのバッファを前回使ったバンドk-2の転送は、バンドk-1の転送開始前に完了している
+    display->notifyTransferBegin();
+    display->startWrite();
+    int index = 0;
+    for (int top = 0; top < regionHeight; top += bandLines) {
+        const int lines = min(bandLines, regionHeight - top);
+        renderBand(index, top, lines);
+
+        display->waitDMA();
+        display->pushImageDMA(regionX, regionY + top, regionWidth, lines,
+                              (const lgfx::swap565_t*)bandCanvas[index]->getBuffer());
+        index ^= 1;
+    }
+    display->waitDMA();
+    display->endWrite();
+
+    for (int i = 0; i < 2; i++) {
+        bandRenderer[i]->clearDirty();
+    }
+
+    if (droppedCount > 0) {
+        ESP_LOGE(TAG, "Draw list full: %d entries dropped", droppedCount);
+    }
+    const size_t bytesSent = (size_t)regionWidth * regionHeight * sizeof(uint16_t);
+    display->notifyFrameSent(bytesSent);
+    return bytesSent;
+}
+
+int RetroSpriteBatch::getSpriteCount() const {
+    return entryCount;
+}
+
+int RetroSpriteBatch::getDroppedCount() const {
+    return droppedCount;
+}
+
+int RetroSpriteBatch::getMaxSprites() const {
+    return maxEntries;
+}
+
+int RetroSpriteBatch::getBandLines() const {
+    return bandLines;
+}
+
+size_t RetroSpriteBatch::getMemoryUsage() const {
+    return maxEntries * sizeof(DrawEntry) + 2 * (size_t)bandWidth * bandLines * sizeof(uint16_t);
+}
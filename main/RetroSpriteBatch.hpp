@@ -0,0 +1,206 @@
+/*
+ * RetroSpriteBatch.hpp
+ * スプライトバッチ（ディスプレイリスト）描画 for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 1フレーム分のスプライト・タイルマップ背景・テキストを登録してまとめて描画
+ * - 画面領域とのクリップは登録時に1回だけ行う
+ * - 優先度順（同じ優先度は登録順）に重ね、N行ずつのバンドにラスタライズ
+ * - バンドは内部DMA対応RAMの2枚のバッファを交互に使い、
+ *   1枚をDMA転送している間にもう1枚を描画する（全画面キャンバス不要）
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+#include "RetroTilemap.hpp"
+
+/**
+ * スプライトバッチ
+ * begin() → add()/addTilemap()/addText() を繰り返す → end() で1フレームを描画する
+ * 登録した画像・パレット・タイルマップ・文字列は end() まで保持しておくこと
+ */
+class RetroSpriteBatch {
+public:
+    // 反転・回転フラグ（PaletteImageRenderer::drawToCanvasTransformed と同じ値）
+    static constexpr uint8_t FLIP_NONE = PaletteImageRenderer::BLIT_NONE;       // 反転なし
+    static constexpr uint8_t FLIP_H = PaletteImageRenderer::BLIT_FLIP_H;        // 左右反転
+    static constexpr uint8_t FLIP_V = PaletteImageRenderer::BLIT_FLIP_V;        // 上下反転
+    static constexpr uint8_t ROTATE_90 = PaletteImageRenderer::BLIT_ROTATE_90;  // 時計回りに90度回転（反転の後に適用）
+
+    static constexpr int DEFAULT_BAND_LINES = 8;  // バンドの行数（デフォルト）
+
+private:
+    // 登録項目の種類
+    static constexpr uint8_t ENTRY_SPRITE = 0;   // パレット画像
+    static constexpr uint8_t ENTRY_TILEMAP = 1;  // タイルマップ背景
+    static constexpr uint8_t ENTRY_TEXT = 2;     // テキスト
+
+    /**
+     * 登録済み項目（座標は描画領域内、クリップ済み）
+     */
+    struct DrawEntry {
+        const PaletteImageData* image;     // 画像（スプライト）
+        const RetroColorPalette* palette;  // 使用するパレット（スプライト）
+        RetroTilemap* tilemap;             // タイルマップ（タイルマップ背景）
+        const char* text;                  // 文字列（テキスト）
+        int16_t x, y;                      // 描画位置・ビューポート位置（描画領域内）
+        int16_t clipX0, clipX1;            // 描画するX範囲 [clipX0, clipX1)
+        int16_t clipY0, clipY1;            // 描画するY範囲 [clipY0, clipY1)
+        int16_t priority;                  // 優先度（大きいほど手前）
+        uint16_t order;                    // 登録順（同じ優先度の並び順）
+        uint16_t color;                    // 文字色（テキスト）
+        uint8_t kind;                      // 項目の種類
+        uint8_t flip;                      // 反転・回転フラグ（スプライト）
+        uint8_t textSize;                  // 文字サイズ（テキスト）
+        bool transparent;                  // 透明色を使用するか
+    };
+
+    LGFX_ST7789P3_76x284* display;    // ディスプレイインスタンス
+    DrawEntry* entries;               // 登録リスト
+    int maxEntries;                   // 登録できる最大数
+    int entryCount;                   // 登録数
+    int droppedCount;                 // 上限超過で登録できなかった数
+
+    int bandLines;                    // バンドの行数
+    M5Canvas* bandCanvas[2];          // バンドバッファ（交互に描画・転送）
+    PaletteImageRenderer* bandRenderer[2];  // タイルマップ描画用（バンドバッファに描く）
+    int bandWidth;                    // バンドバッファの幅
+
+    int regionX, regionY;             // 描画領域のディスプレイ上の位置
+    int regionWidth, regionHeight;    // 描画領域のサイズ
+    uint16_t background;              // 背景色（バイトスワップ済み）
+    bool inFrame;                     // begin()済みか
+
+    /**
+     * 登録リストに1項目追加（上限チェック込み）
+     * @return 追加した項目（上限超過時nullptr）
+     */
+    DrawEntry* allocEntry();
+
+    /**
+     * バンドバッファを描画領域の幅で確保
+     * @param width 描画領域の幅
+     * @return 確保できた場合true
+     */
+    bool initBandBuffers(int width);
+
+    /**
+     * スプライトの1行分をラスタライズ
+     * @param s スプライト
+     * @param line 描画領域内のY座標
+     * @param dst 出力先の行（描画領域の左端）
+     */
+    void rasterizeSpriteLine(const DrawEntry& s, int line, uint16_t* dst);
+
+    /**
+     * 1バンド分を描画
+     * @param index バンドバッファ番号
+     * @param top バンド先頭の描画領域内Y座標
+     * @param lines バンドの行数
+     */
+    void renderBand(int index, int top, int lines);
+
+public:
+    /**
+     * コンストラクタ
+     * @param gfx ディスプレイインスタンス
+     * @param maxEntryCount 1フレームに登録できる最大項目数
+     * @param bandLineCount バンドの行数（バッファ2枚×幅×行数×2バイトを使用）
+     */
+    RetroSpriteBatch(LGFX_ST7789P3_76x284* gfx, int maxEntryCount = 64, int bandLineCount = DEFAULT_BAND_LINES);
+
+    /**
+     * デストラクタ
+     */
+    ~RetroSpriteBatch();
+
+    /**
+     * フレームの登録を開始
+     * @param backgroundColor 背景色（RGB565）
+     * @param x 描画領域のディスプレイ上X座標
+     * @param y 描画領域のディスプレイ上Y座標
+     * @param width 描画領域の幅（0以下=ディスプレイ幅）
+     * @param height 描画領域の高さ（0以下=ディスプレイ高さ）
+     * @return 開始できた場合true
+     */
+    bool begin(uint16_t backgroundColor = 0x0000, int x = 0, int y = 0, int width = 0, int height = 0);
+
+    /**
+     * スプライトを登録
+     * 描画領域に全くかからないスプライトは登録せずにtrueを返す
+     * @param img パレット画像データ
+     * @param x 描画領域内のX座標
+     * @param y 描画領域内のY座標
+     * @param priority 優先度（大きいほど手前、同じなら後から登録した方が手前）
+     * @param flip 反転・回転フラグ（FLIP_H | FLIP_V | ROTATE_90、回転時は幅と高さが入れ替わる）
+     * @param palette 使用するパレット（nullptr = 画像のパレット）
+     * @param useTransparency 透明色を使用するか
+     * @return 登録できた場合true（上限超過時false）
+     */
+    bool add(const PaletteImageData& img, int x, int y, int priority = 0, uint8_t flip = FLIP_NONE,
+             const RetroColorPalette* palette = nullptr, bool useTransparency = true);
+
+    /**
+     * タイルマップ背景を登録
+     * 描画時点のスクロール位置で、ビューポートに見えるタイルを描画する
+     * @param tilemap タイルマップ
+     * @param priority 優先度
+     * @param useTransparency 透明色を使用するか（前景レイヤー用）
+     * @param viewX ビューポートの描画領域内X座標
+     * @param viewY ビューポートの描画領域内Y座標
+     * @param viewWidth ビューポート幅（0以下=描画領域幅）
+     * @param viewHeight ビューポート高さ（0以下=描画領域高さ）
+     * @return 登録できた場合true（上限超過時false）
+     */
+    bool addTilemap(RetroTilemap& tilemap, int priority = 0, bool useTransparency = false,
+                    int viewX = 0, int viewY = 0, int viewWidth = 0, int viewHeight = 0);
+
+    /**
+     * テキストを登録（背景は透過）
+     * @param text 文字列
+     * @param x 描画領域内のX座標
+     * @param y 描画領域内のY座標（文字の上端）
+     * @param color 文字色（RGB565）
+     * @param priority 優先度
+     * @param textSize 文字サイズ倍率
+     * @return 登録できた場合true（上限超過時false）
+     */
+    bool addText(const char* text, int x, int y, uint16_t color, int priority = 0, int textSize = 1);
+
+    /**
+     * 登録した項目をバンドごとに描画してディスプレイにDMA転送
+     * @return 送信したバイト数
+     */
+    size_t end();
+
+    /**
+     * 現在のフレームに登録されている項目数を取得
+     * @return 項目数
+     */
+    int getSpriteCount() const;
+
+    /**
+     * 現在のフレームで上限超過により登録できなかった数を取得
+     * @return 項目数
+     */
+    int getDroppedCount() const;
+
+    /**
+     * 登録できる最大項目数を取得
+     * @return 最大数
+     */
+    int getMaxSprites() const;
+
+    /**
+     * バンドの行数を取得
+     * @return 行数
+     */
+    int getBandLines() const;
+
+    /**
+     * メモリ使用量を計算（登録リスト＋バンドバッファ2枚）
+     * @return 使用メモリ量（バイト）
+     */
+    size_t getMemoryUsage() const;
+};
@@ -0,0 +1,156 @@
+/*
+ * RetroTilemap.cpp
+ * レトロゲーム風タイルマップシステム実装
+ * csboard-picoプロジェクト対応
+ */
+
+#include "RetroTilemap.hpp"
+#include "esp_log.h"
+
+// ログタグ定義
+static const char *TAG = "RetroTilemap";
+
+/**
+ * 負の値にも対応した剰余（結果は常に0以上）
+ * @param value 値
+ * @param divisor 除数（正）
+ * @return 剰余
+ */
+static inline int floorMod(int value, int divisor) {
+    int r = value % divisor;
+    return (r < 0) ? r + divisor : r;
+}
+
+/**
+ * 負の値にも対応した切り捨て除算
+ * @param value 値
+ * @param divisor 除数（正）
+ * @return 商
+ */
+static inline int floorDiv(int value, int divisor) {
+    return (value - floorMod(value, divisor)) / divisor;
+}
+
+// ===== RetroTileset 実装 =====
+
+RetroTileset::RetroTileset(const uint8_t* tileData, int size, int count, const RetroColorPalette* customPalette)
+    : sheet(tileData, size, size * count, customPalette), tileSize(size), tileCount(count) {
+    if (size != 8 && size != 16) {
+        ESP_LOGE(TAG, "Unsupported tile size: %d (use 8 or 16)", size);
+    }
+    ESP_LOGI(TAG, "RetroTileset created: %d tiles of %dx%d, %zu bytes", tileCount, tileSize, tileSize, sheet.dataSize);
+}
+
+size_t RetroTileset::getMemoryUsage() const {
+    return sheet.getMemoryUsage();
+}
+
+void RetroTileset::setPalette(const RetroColorPalette& newPalette) {
+    sheet.setPalette(newPalette);
+}
+
+// ===== RetroTilemap 実装 =====
+
+RetroTilemap::RetroTilemap(const RetroTileset* tiles, const uint16_t* tileMap, int width, int height)
+    : tileset(tiles), map(tileMap), mapWidth(width), mapHeight(height),
+      scrollX(0), scrollY(0), wrap(false), lastDrawnTiles(0) {
+    ESP_LOGI(TAG, "RetroTilemap created: %dx%d tiles (%dx%d pixels)",
+             mapWidth, mapHeight, getPixelWidth(), getPixelHeight());
+}
+
+void RetroTilemap::setScroll(int x, int y) {
+    scrollX = x;
+    scrollY = y;
+}
+
+void RetroTilemap::scrollBy(int dx, int dy) {
+    scrollX += dx;
+    scrollY += dy;
+}
+
+void RetroTilemap::getScroll(int& x, int& y) const {
+    x = scrollX;
+    y = scrollY;
+}
+
+void RetroTilemap::setWrap(bool enable) {
+    wrap = enable;
+}
+
+uint16_t RetroTilemap::getTile(int tileX, int tileY) const {
+    if (!map || tileX < 0 || tileX >= mapWidth || tileY < 0 || tileY >= mapHeight) {
+        return EMPTY_TILE;
+    }
+    return map[tileY * mapWidth + tileX];
+}
+
+int RetroTilemap::getPixelWidth() const {
+    return tileset ? mapWidth * tileset->tileSize : 0;
+}
+
+int RetroTilemap::getPixelHeight() const {
+    return tileset ? mapHeight * tileset->tileSize : 0;
+}
+
+void RetroTilemap::render(PaletteImageRenderer& renderer, int viewX, int viewY,
+                          int viewWidth, int viewHeight, bool useTransparency) {
+    lastDrawnTiles = 0;
+    M5Canvas* canvas = renderer.getCanvas();
+    if (!tileset || !map || !canvas || mapWidth <= 0 || mapHeight <= 0) return;
+
+    if (viewWidth <= 0) viewWidth = canvas->width() - viewX;
+    if (viewHeight <= 0) viewHeight = canvas->height() - viewY;
+    if (viewWidth <= 0 || viewHeight <= 0) return;
+
+    const int ts = tileset->tileSize;
+    const int viewRight = viewX + viewWidth;
+    const int viewBottom = viewY + viewHeight;
+
+    // ビューポート左上にかかるタイルと、その描画位置
+    const int firstTileX = floorDiv(scrollX, ts);
+    const int firstTileY = floorDiv(scrollY, ts);
+    const int startX = viewX - floorMod(scrollX, ts);
+    const int startY = viewY - floorMod(scrollY, ts);
+
+    for (int tileY = firstTileY, y = startY; y < viewBottom; tileY++, y += ts) {
+        int mapY = tileY;
+        if (wrap) {
+            mapY = floorMod(tileY, mapHeight);
+        } else if (mapY < 0 || mapY >= mapHeight) {
+            continue;
+        }
+
+        // ビューポートにかかる行範囲（タイル内座標）
+        const int top = max(y, viewY);
+        const int bottom = min(y + ts, viewBottom);
+        const uint16_t* mapRow = map + mapY * mapWidth;
+
+        for (int tileX = firstTileX, x = startX; x < viewRight; tileX++, x += ts) {
+            int mapX = tileX;
+            if (wrap) {
+                mapX = floorMod(tileX, mapWidth);
+            } else if (mapX < 0 || mapX >= mapWidth) {
+                continue;
+            }
+
+            const uint16_t tile = mapRow[mapX];
+            if (tile == EMPTY_TILE || tile >= tileset->tileCount) continue;
+
+            // 端のタイルはビューポート内の部分だけ切り出す
+            const int left = max(x, viewX);
+            const int right = min(x + ts, viewRight);
+            renderer.drawRegionToCanvas(tileset->sheet, left - x, tile * ts + (top - y),
+                                        right - left, bottom - top, left, top, useTransparency);
+            lastDrawnTiles++;
+        }
+    }
+}
+
+int RetroTilemap::getLastDrawnTileCount() const {
+    return lastDrawnTiles;
+}
+
+size_t RetroTilemap::getMemoryUsage() const {
+    size_t mapBytes = (size_t)mapWidth * mapHeight * sizeof(uint16_t);
+    return mapBytes + (tileset ? tileset->getMemoryUsage() : 0);
+}
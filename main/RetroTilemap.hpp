@@ -0,0 +1,147 @@
+/*
+ * RetroTilemap.hpp
+ * レトロゲーム風タイルマップシステム for M5StampPico + ST7789P3
+ *
+ * 特徴:
+ * - 8x8 / 16x16 の4bitタイル（重複除去済みタイルセット）
+ * - タイルインデックスマップで画面より大きな背景を表現
+ * - スクロール位置から見えるタイルだけをキャンバスに描画
+ * - メモリ使用量はマップ面積ではなくユニークタイル数に比例
+ * - append/tile_slicer.py で画像からタイルセットとマップを生成
+ */
+
+#pragma once
+
+#include "RetroGamePaletteImage.hpp"
+
+/**
+ * タイルセット
+ * タイルを縦に並べた1枚のパレット画像（幅tileSize、高さtileSize*tileCount）として保持
+ * タイルiのデータは data + i * tileSize * tileSize / 2 から連続して格納される
+ */
+struct RetroTileset {
+    PaletteImageData sheet;        // タイルを縦に並べた画像
+    int tileSize;                  // タイルの一辺（8または16）
+    int tileCount;                 // タイル数
+
+    /**
+     * コンストラクタ
+     * @param tileData タイルデータ配列のポインタ
+     * @param size タイルの一辺（8または16）
+     * @param count タイル数
+     * @param customPalette カスタムパレット（nullptr = デフォルト）
+     */
+    RetroTileset(const uint8_t* tileData, int size, int count, const RetroColorPalette* customPalette = nullptr);
+
+    /**
+     * メモリ使用量を計算
+     * @return 使用メモリ量（バイト）
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * パレットを変更
+     * @param newPalette 新しいパレット
+     */
+    void setPalette(const RetroColorPalette& newPalette);
+};
+
+/**
+ * タイルマップ
+ * スクロール位置（マップ上のピクセル座標）を保持し、ビューポートに見える範囲だけ描画する
+ */
+class RetroTilemap {
+public:
+    static constexpr uint16_t EMPTY_TILE = 0xFFFF;  // 何も描画しないタイル
+
+private:
+    const RetroTileset* tileset;      // タイルセット
+    const uint16_t* map;              // タイルインデックスマップ（mapWidth*mapHeight要素）
+    int mapWidth, mapHeight;          // マップサイズ（タイル単位）
+    int scrollX, scrollY;             // ビューポート左上のマップ上ピクセル座標
+    bool wrap;                        // マップ端でループするか
+    int lastDrawnTiles;               // 前回描画したタイル数
+
+public:
+    /**
+     * コンストラクタ
+     * @param tiles タイルセット
+     * @param tileMap タイルインデックスマップ
+     * @param width マップ幅（タイル単位）
+     * @param height マップ高さ（タイル単位）
+     */
+    RetroTilemap(const RetroTileset* tiles, const uint16_t* tileMap, int width, int height);
+
+    /**
+     * スクロール位置を設定
+     * @param x ビューポート左上のマップ上X座標
+     * @param y ビューポート左上のマップ上Y座標
+     */
+    void setScroll(int x, int y);
+
+    /**
+     * スクロール位置を相対移動
+     * @param dx X方向移動量
+     * @param dy Y方向移動量
+     */
+    void scrollBy(int dx, int dy);
+
+    /**
+     * スクロール位置を取得
+     * @param x X座標の格納先
+     * @param y Y座標の格納先
+     */
+    void getScroll(int& x, int& y) const;
+
+    /**
+     * マップ端でのループ設定
+     * 無効時はマップ外の領域には何も描画しない
+     * @param enable true=ループする
+     */
+    void setWrap(bool enable);
+
+    /**
+     * 指定タイル座標のタイルインデックスを取得
+     * @param tileX タイルX座標
+     * @param tileY タイルY座標
+     * @return タイルインデックス（範囲外はEMPTY_TILE）
+     */
+    uint16_t getTile(int tileX, int tileY) const;
+
+    /**
+     * マップのピクセル幅を取得
+     * @return ピクセル幅
+     */
+    int getPixelWidth() const;
+
+    /**
+     * マップのピクセル高さを取得
+     * @return ピクセル高さ
+     */
+    int getPixelHeight() const;
+
+    /**
+     * 見えているタイルをキャンバスに描画
+     * ビューポートにかかるタイルだけを部分描画で切り出す
+     * @param renderer 描画先レンダラー
+     * @param viewX ビューポートのキャンバス上X座標
+     * @param viewY ビューポートのキャンバス上Y座標
+     * @param viewWidth ビューポート幅（0以下=キャンバス幅）
+     * @param viewHeight ビューポート高さ（0以下=キャンバス高さ）
+     * @param useTransparency 透明色を使用するか（前景レイヤー用）
+     */
+    void render(PaletteImageRenderer& renderer, int viewX = 0, int viewY = 0,
+                int viewWidth = 0, int viewHeight = 0, bool useTransparency = false);
+
+    /**
+     * 前回の描画で処理したタイル数を取得
+     * @return タイル数
+     */
+    int getLastDrawnTileCount() const;
+
+    /**
+     * メモリ使用量を計算（タイルセット＋マップ）
+     * @return 使用メモリ量（バイト）
+     */
+    size_t getMemoryUsage() const;
+};
@@ -12,10 +12,25 @@
 // ST7789P3ディスプレイとレトロゲームシステム
 #include "LGFX_ST7789P3_76x284.hpp"
 #include "RetroGamePaletteImage.hpp"
+#include "RetroSpriteBatch.hpp"
+#include "RetroPaletteAnimator.hpp"
+#include "RetroAssetPack.hpp"
+#include "RetroFrameScheduler.hpp"
+#include "RetroRenderPool.hpp"
+#include "RetroBitmapFont.hpp"
+#include "RetroCollisionMask.hpp"
+#include "RetroParallelRasterizer.hpp"
+#include "RetroHotAssetCache.hpp"
+#include "RetroLayerCompositor.hpp"
+#include "RetroDeltaAnimation.hpp"
+#include "RetroPowerManager.hpp"
 
 // 【重要】パレット変換ツールで生成されたヘッダーをインクルード
 #include "dot_landscape.h"
 
+// image_to_c_header.py で生成した1bitモノクロ画像（append/display_images.h）
+#include "display_images.h"
+
 static const char *TAG = "PaletteImageExample";
 
 // ディスプレイインスタンス
@@ -95,8 +110,6 @@ void drawMultipleImages() {
     PaletteImageData img(dot_landscape_data, dot_landscape_width, dot_landscape_height);
     PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
     
-    renderer.clearCanvas(0x8410);  // グレー背景
-    
     // 小さなサイズで複数配置
     float scale = 0.5f;
     int scaledW = (int)(dot_landscape_width * scale);
@@ -105,20 +118,37 @@ void drawMultipleImages() {
     // 横向きレイアウトで配置（横に多く、縦に少なく）
     int screenW = tft.width();   // 284
     int screenH = tft.height();  // 76
-    
-    // 左右に配置
-    renderer.drawToCanvasScaled(img, 5, 5, scale, scale, true);                           // 左上
-    renderer.drawToCanvasScaled(img, screenW - scaledW - 5, 5, scale, scale, true);      // 右上
-    renderer.drawToCanvasScaled(img, 5, screenH - scaledH - 5, scale, scale, true);      // 左下
-    renderer.drawToCanvasScaled(img, screenW - scaledW - 5, screenH - scaledH - 5, scale, scale, true); // 右下
-    
-    // 中央にも配置
-    int centerX = (screenW - scaledW) / 2;
-    int centerY = (screenH - scaledH) / 2;
-    renderer.drawToCanvasScaled(img, centerX, centerY, scale, scale, true);              // 中央
+    const int positions[5][2] = {
+        {5, 5},                                         // 左上
+        {screenW - scaledW - 5, 5},                     // 右上
+        {5, screenH - scaledH - 5},                     // 左下
+        {screenW - scaledW - 5, screenH - scaledH - 5}, // 右下
+        {(screenW - scaledW) / 2, (screenH - scaledH) / 2},  // 中央
+    };
+    
+    // 1コアで描画
+    int64_t start = esp_timer_get_time();
+    renderer.clearCanvas(0x8410);  // グレー背景
+    for (int i = 0; i < 5; i++) {
+        renderer.drawToCanvasScaled(img, positions[i][0], positions[i][1], scale, scale, true);
+    }
+    const int64_t singleUs = esp_timer_get_time() - start;
+    
+    // 同じ命令列を上下のバンドに分けて2コアで描画
+    RetroParallelRasterizer raster(&renderer, &tft);
+    start = esp_timer_get_time();
+    raster.begin();
+    raster.clear(0x8410);
+    for (int i = 0; i < 5; i++) {
+        raster.drawScaled(img, positions[i][0], positions[i][1], scale, scale, true);
+    }
+    raster.finish();
+    const int64_t parallelUs = esp_timer_get_time() - start;
     
     renderer.pushCanvasToDisplayOpaque(0, 0);
     
+    ESP_LOGI(TAG, "Raster time: %lld us on one core, %lld us on two cores (bands %lld / %lld us)",
+             singleUs, parallelUs, raster.getBandTime(0), raster.getBandTime(1));
     ESP_LOGI(TAG, "Five scaled images drawn in landscape layout");
 }
 
@@ -129,9 +159,29 @@ void animateImage() {
     PaletteImageData img(dot_landscape_data, dot_landscape_width, dot_landscape_height);
     PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
     
+    // 毎フレーム描く一枚絵は内部RAMへ先読みし、転送中のフラッシュキャッシュミスを避ける
+    RetroHotAssetCache hotAssets(img.dataSize);
+    hotAssets.prefetch(img);
+    renderer.setAssetCache(&hotAssets);
+    
+    // 初回のみ全面を送る
+    renderer.clearCanvas(0x0000);  // 黒背景
+    renderer.pushCanvasToDisplayOpaque(0, 0);
+    
+    // 初回の全面プッシュは統計から除き、20フレームごとにステージ別時間をログ出力
+    renderer.resetStats();
+    renderer.setStatsLogInterval(20);
+    
+    int prevX = -1, prevY = 0;
+    size_t totalBytes = 0;
+    
+    // 10fps固定（vTaskDelayのティック丸めと描画時間の分だけ遅れていくのを防ぐ）
+    RetroFrameScheduler scheduler;
+    scheduler.setFixedFps(10);
+    
     // 60フレームのアニメーション
     for (int frame = 0; frame < 60; frame++) {
-        renderer.clearCanvas(0x0000);  // 黒背景
+        RetroNoAllocScope noAlloc("animateImage frame");  // 定常状態ではヒープ確保しない
         
         // 正弦波で左右に動かす（横向きなので左右移動の方が効果的）
         int x = (tft.width() / 2) + (int)(50.0f * sin(frame * 0.2f));  // 中央±50ピクセル
@@ -140,13 +190,23 @@ void animateImage() {
         // 画面外にはみ出さないように制限
         x = max(0, min(x, tft.width() - dot_landscape_width));
         
-        renderer.drawToCanvas(img, x, y, true);
-        renderer.pushCanvasToDisplayOpaque(0, 0);
+        // 位置が変わった時だけ前回位置を消して描き直す
+        if (x != prevX || y != prevY) {
+            if (prevX >= 0) {
+                renderer.fillCanvasRect(prevX, prevY, dot_landscape_width, dot_landscape_height, 0x0000);
+            }
+            renderer.drawToCanvas(img, x, y, true);
+            prevX = x;
+            prevY = y;
+        }
         
-        vTaskDelay(100 / portTICK_PERIOD_MS);  // 100ms待機
+        // 変更領域だけ送信
+        totalBytes += renderer.pushDirtyRegions(0, 0);
+        
+        scheduler.wait();  // 次の100ms格子まで待機
     }
     
-    ESP_LOGI(TAG, "Animation complete");
+    ESP_LOGI(TAG, "Animation complete (%zu bytes pushed)", totalBytes);
 }
 
 // カスタムパレット使用例（横向き対応）
@@ -177,26 +237,30 @@ void colorCycleEffect() {
     ESP_LOGI(TAG, "=== Color Cycle Effect ===");
     
     PaletteImageData img(dot_landscape_data, dot_landscape_width, dot_landscape_height);
-    PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
+    
+    // 4bitパレットキャンバス：パレット変更はプッシュ時に反映されるので再描画不要
+    PaletteImageRenderer renderer(&tft, tft.width(), tft.height(), img.palette);
     
     int centerX = (tft.width() - dot_landscape_width) / 2;
     int centerY = (tft.height() - dot_landscape_height) / 2;
     
-    // 120フレームで色相を変化
+    // 画像は一度だけ描画
+    renderer.clearCanvasIndex(RetroColorPalette::TRANSPARENT_INDEX);
+    renderer.drawToCanvas(img, centerX, centerY, true);
+    
+    // 色相を6秒で1周（隣の色とは24度ずらす）、途中で白フラッシュ
+    RetroPaletteAnimator animator(img.palette);
+    animator.addHueCycle(1, 15, 6000, 80, 90, 24);  // 透明色(0)は変更しない
+    
     for (int frame = 0; frame < 120; frame++) {
-        renderer.clearCanvas(0x0000);
-        
-        // 動的パレットを作成
-        RetroColorPalette dynamicPalette;
-        for (int i = 1; i < 16; i++) {  // 透明色(0)は変更しない
-            uint16_t hue = (frame * 3 + i * 24) % 360;  // 色相を時間とともに変化
-            dynamicPalette.setColor(i, RetroColorPalette::hsvToRgb565(hue, 80, 90));
+        if (frame == 60) {
+            animator.addFlash(1, 15, 0xFFFF, 100, 2);
         }
         
-        // パレットを変更して描画
-        img.setPalette(dynamicPalette);
-        renderer.drawToCanvas(img, centerX, centerY, true);
-        renderer.pushCanvasToDisplayOpaque(0, 0);
+        // パレットが変わった時だけキャンバスのパレットを差し替えてプッシュ
+        if (animator.apply(renderer)) {
+            renderer.pushCanvasToDisplayOpaque(0, 0);
+        }
         
         vTaskDelay(50 / portTICK_PERIOD_MS);
     }
@@ -213,22 +277,30 @@ void drawLandscapeDemo() {
     
     renderer.clearCanvas(0x0010);  // ダークブルー背景
     
+    // HUD文字列（ビットマップフォントのキャッシュ付きテキスト）
+    RetroBitmapFont& font = RetroBitmapFont::getDefault();
+    RetroTextRun title(&font, 28);
+    RetroTextRun status[3] = {{&font, 3}, {&font, 3}, {&font, 3}};
+    RetroTextRun counter(&font, 3);
+    title.setColors(0xFFFF, 0x4208);
+    title.setText("M5StampPico - Landscape Mode");
+    const char* statusLabels[3] = {"STA", "TUS", "OK!"};
+    const int statusY[3] = {25, 35, 55};
+    for (int i = 0; i < 3; i++) {
+        status[i].setColors(0xFFFF, 0x0400);
+        status[i].setText(statusLabels[i]);
+    }
+    counter.setColors(0xFFE0, 0x0400);  // 黄色
+    
     // ヘッダーバー（上部）
     renderer.getCanvas()->fillRect(0, 0, tft.width(), 15, 0x4208);  // グレー
-    renderer.getCanvas()->setTextColor(0xFFFF, 0x4208);
-    renderer.getCanvas()->setTextSize(1);
-    renderer.getCanvas()->setCursor(5, 4);
-    renderer.getCanvas()->println("M5StampPico - Landscape Mode");
+    title.draw(renderer, 5, 4);
     
     // サイドバー（右端）
     renderer.getCanvas()->fillRect(tft.width()-40, 15, 40, tft.height()-15, 0x0400);  // ダークグリーン
-    renderer.getCanvas()->setTextColor(0xFFFF, 0x0400);
-    renderer.getCanvas()->setCursor(tft.width()-35, 25);
-    renderer.getCanvas()->println("STA");
-    renderer.getCanvas()->setCursor(tft.width()-35, 35);
-    renderer.getCanvas()->println("TUS");
-    renderer.getCanvas()->setCursor(tft.width()-35, 55);
-    renderer.getCanvas()->println("OK!");
+    for (int i = 0; i < 3; i++) {
+        status[i].draw(renderer, tft.width()-35, statusY[i]);
+    }
     
     // メイン画像（左側）
     int imgX = 10;
@@ -237,9 +309,345 @@ void drawLandscapeDemo() {
     
     renderer.pushCanvasToDisplayOpaque(0, 0);
     
+    // カウンターだけ更新（文字列が変わった時だけラスタライズ・転送）
+    size_t bytesPushed = 0;
+    for (int frame = 0; frame < 50; frame++) {
+        RetroNoAllocScope noAlloc("landscape HUD frame");
+        counter.setTextf("%03d", frame / 5);
+        if (counter.isChanged()) {
+            counter.draw(renderer, tft.width()-35, 45);
+            bytesPushed += renderer.pushDirtyRegions(0, 0);
+        }
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+    }
+    ESP_LOGI(TAG, "HUD: %lu rasterizations, %zu bytes pushed",
+             (unsigned long)counter.getRasterizeCount(), bytesPushed);
+    
     ESP_LOGI(TAG, "Landscape layout demo complete");
 }
 
+// 回転切り替えデモ（再初期化・再描画なしで横向きの上下を反転）
+void rotationFlipDemo() {
+    ESP_LOGI(TAG, "=== Rotation Flip ===");
+    
+    PaletteImageData img(dot_landscape_data, dot_landscape_width, dot_landscape_height);
+    PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
+    
+    renderer.clearCanvas(0x0010);
+    renderer.drawToCanvas(img, (tft.width() - dot_landscape_width) / 2, (tft.height() - dot_landscape_height) / 2, true);
+    renderer.pushCanvasToDisplayOpaque(0, 0);
+    RetroPowerManager::hold(1000);
+    
+    // 1（横右）→3（横左）→1 と切り替え、同じキャンバスを転送し直すだけ
+    const int rotations[2] = {3, 1};
+    for (int i = 0; i < 2; i++) {
+        if (!renderer.rotateDisplay(rotations[i])) break;
+        renderer.pushDirtyRegions(0, 0);
+        RetroPowerManager::hold(1000);
+    }
+    
+    ESP_LOGI(TAG, "Rotation flip complete: %s", tft.getCurrentRotationName());
+}
+
+// ハードウェアスクロールデモ（新しく見える帯だけ転送）
+void hardwareScrollDemo() {
+    ESP_LOGI(TAG, "=== Hardware Scroll Demo ===");
+    
+    // 通常パレットとセピアパレットの画像を並べた横長のワールド
+    RetroColorPalette sepia;
+    sepia.initSepiaPalette();
+    PaletteImageData day(dot_landscape_data, dot_landscape_width, dot_landscape_height);
+    PaletteImageData dusk(dot_landscape_data, dot_landscape_width, dot_landscape_height, &sepia);
+    const int worldWidth = dot_landscape_width * 2;
+    const int step = 4;  // 1フレームのスクロール量（画像幅を割り切れる値）
+    
+    // 最初の1画面は全体を転送
+    PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
+    renderer.clearCanvas(0x0000);
+    renderer.drawToCanvas(day, 0, 0, false);
+    renderer.pushCanvasToDisplayOpaque(0, 0);
+    
+    // 右端に現れる帯用のキャンバス（プールから借りる）
+    M5Canvas* strip = RetroRenderPool::acquireCanvas(&tft, step, tft.height(), 16);
+    if (!strip) return;
+    PaletteImageRenderer stripRenderer(&tft, strip);
+    
+    tft.enableHardwareScroll();
+    
+    size_t bytesPushed = 0;
+    for (int scroll = step; scroll <= worldWidth; scroll += step) {
+        RetroNoAllocScope noAlloc("hardwareScroll frame");
+        
+        // 画面右端に新しく見える列（ワールド座標）
+        int worldX = (scroll + tft.width() - step) % worldWidth;
+        const PaletteImageData& src = (worldX < dot_landscape_width) ? day : dusk;
+        stripRenderer.drawRegionToCanvas(src, worldX % dot_landscape_width, 0, step, dot_landscape_height, 0, 0, false);
+        
+        tft.setHardwareScroll(scroll);
+        tft.pushScrollStrip(strip, tft.width() - step);
+        bytesPushed += step * tft.height() * 2;
+        
+        vTaskDelay(16 / portTICK_PERIOD_MS);
+    }
+    
+    tft.disableHardwareScroll();
+    RetroRenderPool::releaseCanvas(strip);
+    ESP_LOGI(TAG, "Hardware scroll complete: %zu bytes pushed (full redraw: %d bytes)",
+             bytesPushed, (worldWidth / step) * (int)(tft.width() * tft.height() * 2));
+}
+
+// スプライトバッチ（全画面キャンバスなし、8行バンドをDMA転送）
+void spriteBatchDemo() {
+    ESP_LOGI(TAG, "=== Sprite Batch ===");
+    
+    PaletteImageData coin(SAMPLE_COIN_8x8, 8, 8);
+    PaletteImageData heart(SAMPLE_HEART_8x8, 8, 8);
+    PaletteImageData walk1(SAMPLE_CHAR_WALK1_12x16, 12, 16);
+    PaletteImageData walk2(SAMPLE_CHAR_WALK2_12x16, 12, 16);
+    
+    // 当たり判定マスク（左右反転で描くフレームは反転済みマスクを使う）
+    RetroCollisionMask coinMask(coin);
+    RetroCollisionMask walkMasks[2][2] = {{RetroCollisionMask(walk1), RetroCollisionMask(walk1, true)},
+                                           {RetroCollisionMask(walk2), RetroCollisionMask(walk2, true)}};
+    coin.collisionMask = &coinMask;
+    
+    RetroSpriteBatch batch(&tft, 48);
+    size_t totalBytes = 0;
+    int hits = 0;
+    int64_t collisionUs = 0;
+    
+    for (int frame = 0; frame < 120; frame++) {
+        RetroNoAllocScope noAlloc("spriteBatch frame");
+        batch.begin(0x0010);  // 紺色背景
+        
+        // 奥: 流れるコイン列
+        for (int i = 0; i < 36; i++) {
+            int x = (i * 8 - frame) % (tft.width() + 8);
+            if (x < -8) x += tft.width() + 8;
+            batch.add(coin, x, 8 + (i % 3) * 24, 0);
+        }
+        
+        // 中: 往復するキャラクター（向きに合わせて左右反転）
+        int span = tft.width() - 12;
+        int pos = frame * 3 % (span * 2);
+        bool backward = pos >= span;
+        int charX = backward ? span * 2 - pos : pos;
+        const int walkFrame = (frame / 4) % 2;
+        const PaletteImageData& walk = walkFrame ? walk2 : walk1;
+        const int charY = (tft.height() - 16) / 2;
+        batch.add(walk, charX, charY, 1,
+                  backward ? RetroSpriteBatch::FLIP_H : RetroSpriteBatch::FLIP_NONE);
+        
+        // キャラクターとコイン列の当たり判定
+        int64_t start = esp_timer_get_time();
+        const RetroCollisionMask& walkMask = walkMasks[walkFrame][backward];
+        for (int i = 0; i < 36; i++) {
+            int x = (i * 8 - frame) % (tft.width() + 8);
+            if (x < -8) x += tft.width() + 8;
+            hits += RetroCollisionMask::overlap(walkMask, charX, charY, *coin.collisionMask, x, 8 + (i % 3) * 24);
+        }
+        collisionUs += esp_timer_get_time() - start;
+        
+        // 手前: キャラクターの頭上のハート
+        batch.add(heart, charX + 2, (tft.height() - 16) / 2 - 10, 2);
+        
+        // 最前面: フレーム番号
+        char label[16];
+        snprintf(label, sizeof(label), "FRAME %03d", frame);
+        batch.addText(label, 2, tft.height() - 10, 0xFFFF, 3);
+        
+        totalBytes += batch.end();
+        vTaskDelay(16 / portTICK_PERIOD_MS);
+    }
+    
+    ESP_LOGI(TAG, "Sprite batch complete: %zu bytes pushed, %zu bytes used (canvas: %d bytes)",
+             totalBytes, batch.getMemoryUsage(), (int)(tft.width() * tft.height() * 2));
+    ESP_LOGI(TAG, "Collision: %d hits, %.1f us per frame for 36 sprites", hits, collisionUs / 120.0f);
+}
+
+// 多重スクロール（遠景・近景・スプライト・HUDを1パスで合成）
+void parallaxDemo() {
+    ESP_LOGI(TAG, "=== Parallax Layers ===");
+    
+    RetroColorPalette sepia;
+    sepia.initSepiaPalette();
+    PaletteImageData scenery(dot_landscape_data, dot_landscape_width, dot_landscape_height);
+    PaletteImageData coin(SAMPLE_COIN_8x8, 8, 8);
+    PaletteImageData walk1(SAMPLE_CHAR_WALK1_12x16, 12, 16);
+    PaletteImageData walk2(SAMPLE_CHAR_WALK2_12x16, 12, 16);
+    PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
+    
+    RetroTextRun distance(&RetroBitmapFont::getDefault(), 10);
+    distance.setColors(0xFFFF);
+    
+    // 奥から: セピアの遠景（不透明、1/4の速さ）→ 近景（透明色付き、等速）→ スプライト → HUD（画面固定）
+    RetroLayerCompositor layers(&renderer);
+    const int farLayer = layers.addImageLayer(&scenery, 0.25f, 0.0f, 0, 0, true, false);
+    layers.setLayerPalette(farLayer, &sepia);
+    layers.addImageLayer(&scenery, 1.0f, 0.0f, 0, tft.height() / 2, true, true);
+    const int spriteLayer = layers.addSpriteLayer(1.0f, 0.0f);
+    const int hudLayer = layers.addSpriteLayer(0.0f, 0.0f);
+    
+    // 1フレーム分のカメラ位置とスプライトを設定
+    auto buildFrame = [&](int frame) {
+        const int cameraX = frame * 2;
+        layers.setCamera(cameraX, 0);
+        layers.clearSprites();
+        
+        // コイン列（ワールド座標、画面にかかるものだけ登録）
+        for (int x = cameraX - cameraX % 24; x < cameraX + tft.width(); x += 24) {
+            layers.addSprite(spriteLayer, &coin, x, 12 + (x / 24 % 3) * 12);
+        }
+        
+        // キャラクターはカメラに合わせて画面の1/3の位置を歩く
+        layers.addSprite(spriteLayer, (frame / 4) % 2 ? &walk2 : &walk1,
+                         cameraX + tft.width() / 3, tft.height() - 24);
+        
+        distance.setTextf("DIST %04d", cameraX);
+        layers.addSprite(hudLayer, &distance.getImage(), 2, 2);
+    };
+    
+    // 変換テーブルは初回の合成で作られるため、計測ループの前に1回合成しておく
+    buildFrame(0);
+    layers.compose();
+    
+    const int frames = 180;
+    int64_t composeUs = 0;
+    uint64_t written = 0, skipped = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        RetroNoAllocScope noAlloc("parallax frame");
+        buildFrame(frame);
+        layers.compose();
+        composeUs += layers.getComposeTime();
+        written += layers.getWrittenPixels();
+        skipped += layers.getSkippedPixels();
+        
+        renderer.pushCanvasToDisplayOpaque(0, 0);
+        vTaskDelay(16 / portTICK_PERIOD_MS);
+    }
+    
+    ESP_LOGI(TAG, "Parallax complete: %.1f us per frame, %llu pixels written, %llu hidden pixels skipped",
+             composeUs / (float)frames, (unsigned long long)written, (unsigned long long)skipped);
+}
+
+// 差分圧縮の歩行アニメーション（変わった部分だけ描き直して転送）
+void deltaAnimationDemo() {
+    ESP_LOGI(TAG, "=== Delta Animation ===");
+    
+    PaletteDeltaAnimationData walkData(SAMPLE_CHAR_STAND_12x16, SAMPLE_CHAR_WALK_DELTA_DATA,
+                                       SAMPLE_CHAR_WALK_DELTA_OFFSETS, SAMPLE_CHAR_WALK_DELTA_DURATIONS, 12, 16, 4);
+    RetroDeltaAnimation walk(walkData);
+    PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
+    
+    // 背景は最初に一度だけ全面送信
+    const uint16_t background = 0x0400;  // ダークグリーン
+    renderer.clearCanvas(background);
+    renderer.pushCanvasToDisplayOpaque(0, 0);
+    
+    RetroFrameScheduler scheduler;
+    scheduler.add(&walk.getAnimation());
+    walk.getAnimation().start();
+    
+    const int charX = (tft.width() - walkData.width) / 2;
+    const int charY = (tft.height() - walkData.height) / 2;
+    size_t bytesPushed = 0;
+    int redraws = 0;
+    for (int wake = 0; wake < 24; wake++) {
+        // 変わった矩形の背景を塗り直してから、その部分だけ描く
+        int x, y, w, h;
+        if (walk.getChangedRect(x, y, w, h)) {
+            renderer.fillCanvasRect(charX + x, charY + y, w, h, background);
+            walk.drawChanged(renderer, charX, charY, true);
+            bytesPushed += renderer.pushDirtyRegions(0, 0);
+            redraws++;
+        }
+        scheduler.wait(1000);
+    }
+    
+    ESP_LOGI(TAG, "Delta animation complete: %d redraws, %zu bytes pushed, %lu delta bytes applied",
+             redraws, bytesPushed, (unsigned long)walk.getAppliedBytes());
+}
+
+// アセットパーティションの画像・フレーム列を再生（画素データはフラッシュから直接読む）
+void assetPackDemo() {
+    ESP_LOGI(TAG, "=== Asset Pack ===");
+    
+    RetroAssetPack pack;
+    if (!pack.open("assets")) {
+        ESP_LOGI(TAG, "No asset pack flashed, skipping (see append/asset_packer.py)");
+        return;
+    }
+    
+    PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
+    PaletteImageData img(nullptr, 0, 0);
+    
+    for (int i = 0; i < pack.getEntryCount(); i++) {
+        const RetroAssetPack::Entry* e = pack.getEntry(i);
+        if (e->type != RetroAssetPack::TYPE_IMAGE && e->type != RetroAssetPack::TYPE_SEQUENCE) continue;
+        
+        ESP_LOGI(TAG, "Asset %s: %dx%d, %d frame(s)", e->name, e->width, e->height, e->frameCount);
+        
+        // 1枚絵は2秒、フレーム列は2周
+        const int loops = (e->type == RetroAssetPack::TYPE_SEQUENCE) ? e->frameCount * 2 : 1;
+        const int frameMs = (e->type == RetroAssetPack::TYPE_SEQUENCE) ? max(16, (int)e->frameMs) : 2000;
+        for (int n = 0; n < loops; n++) {
+            if (!pack.getImage(i, img, n % e->frameCount)) break;
+            
+            renderer.clearCanvas(0x0000);
+            renderer.drawToCanvas(img, (tft.width() - img.width) / 2, (tft.height() - img.height) / 2, true);
+            renderer.pushDirtyRegions(0, 0);
+            vTaskDelay(frameMs / portTICK_PERIOD_MS);
+        }
+    }
+    
+    ESP_LOGI(TAG, "Asset pack complete: %zu bytes in flash", pack.getSize());
+}
+
+// 1bitモノクロ画像の縦スクロール（display_images.h の3枚を縦に繋げて表示）
+void monoImageDemo() {
+    ESP_LOGI(TAG, "=== Mono Image Scroll ===");
+    
+    // 黒インクを紺色に置き換え、ビット0（白）は透明として背景色を見せる
+    const uint16_t ink = 0x0010;
+    const uint16_t paper = 0xFFDE;
+    MonoImageData cuts[] = {
+        MonoImageData(nekonoba2025_cut_0_0_560, NEKONOBA2025_CUT_0_0_560_WIDTH, NEKONOBA2025_CUT_0_0_560_HEIGHT, ink),
+        MonoImageData(nekonoba2025_cut_1_560_730, NEKONOBA2025_CUT_1_560_730_WIDTH, NEKONOBA2025_CUT_1_560_730_HEIGHT, ink),
+        MonoImageData(nekonoba2025_cut_2_730_1180, NEKONOBA2025_CUT_2_730_1180_WIDTH, NEKONOBA2025_CUT_2_730_1180_HEIGHT, ink),
+    };
+    const int cutCount = sizeof(cuts) / sizeof(cuts[0]);
+    int totalHeight = 0;
+    size_t totalBytes = 0;
+    for (int i = 0; i < cutCount; i++) {
+        totalHeight += cuts[i].height;
+        totalBytes += cuts[i].getMemoryUsage();
+    }
+    
+    PaletteImageRenderer renderer(&tft, tft.width(), tft.height());
+    const int x = (tft.width() - cuts[0].width) / 2;
+    
+    for (int scroll = 0; scroll + tft.height() <= totalHeight; scroll += 4) {
+        RetroNoAllocScope noAlloc("monoImage frame");
+        renderer.clearCanvas(paper);
+        
+        // 画面にかかるカットだけ描画（はみ出した部分はクリップされる）
+        int top = 0;
+        for (int i = 0; i < cutCount; i++) {
+            const int y = top - scroll;
+            if (y < tft.height() && y + cuts[i].height > 0) {
+                renderer.drawToCanvas(cuts[i], x, y, true);
+            }
+            top += cuts[i].height;
+        }
+        
+        renderer.pushCanvasToDisplayOpaque(0, 0);
+        vTaskDelay(16 / portTICK_PERIOD_MS);
+    }
+    
+    ESP_LOGI(TAG, "Mono image scroll complete: %zu bytes (4bit: %d bytes)",
+             totalBytes, (cuts[0].width * totalHeight + 1) / 2);
+}
+
 // メイン関数（横向き対応版）
 extern "C" void app_main(void) {
     ESP_LOGI(TAG, "=== Palette Image System Demo (Landscape) ===");
@@ -251,42 +659,91 @@ extern "C" void app_main(void) {
     // 【重要】ディスプレイ初期化（横向き）
     tft.initWithRotation(1);  // 横向き（284×76）
     
+#if CONFIG_CSBOARD_LCD_SPI_PROBE
+    // より速いSPIクロックを探す（menuconfigで有効化、MISOが無ければ安定性は確認しない）
+    tft.probeWriteFrequency(CONFIG_CSBOARD_LCD_SPI_PROBE_MAX_HZ);
+#endif
+    
     ESP_LOGI(TAG, "Display initialized: %ldx%ld (landscape)", tft.width(), tft.height());
     ESP_LOGI(TAG, "Image size: %dx%d", dot_landscape_width, dot_landscape_height);
     
+    // 描画バッファを起動時に一度だけ確保（全画面キャンバス2枚＋作業バッファ）
+    // 作業バッファはサイズクラス別に持つ
+    // - 2KB: ラインバッファ・拡大用テーブル・描画リスト・キーフレーム
+    // - 変換テーブル: パレット（画像ごとのコピー）1つに1枚
+    // - 512B: 色相テーブル・短い文字列の画素
+    // - 128B: 合成の被覆マスク・差分アニメーションのフレーム表
+    RetroRenderPool::init(&tft, 2, tft.width(), tft.height(), 10, 2048);
+    RetroRenderPool::addBlockClass(12, sizeof(RetroColorPalette::PixelPairLut));
+    RetroRenderPool::addBlockClass(8, 512);
+    RetroRenderPool::addBlockClass(16, 128);
+    
+    // 静止画の表示中はCPUクロックを下げる（menuconfigで有効化、無効時は推定消費エネルギーの記録のみ）
+    RetroPowerManager::init(&tft);
+    
     while (true) {
         // 基本描画
         drawImageBasic();
-        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(3000);
         
         // 中央描画
         drawImageCentered();
-        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(3000);
         
         // スケール描画
         drawImageScaled();
-        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(3000);
         
         // 複数配置（横向きレイアウト）
         drawMultipleImages();
-        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(3000);
         
         // アニメーション（左右移動）
         animateImage();
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(1000);
         
         // カスタムパレット
         drawWithCustomPalette();
-        vTaskDelay(3000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(3000);
         
         // カラーサイクルエフェクト
         colorCycleEffect();
-        vTaskDelay(1000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(1000);
         
         // 横向けレイアウトデモ
         drawLandscapeDemo();
-        vTaskDelay(5000 / portTICK_PERIOD_MS);
+        RetroPowerManager::hold(5000);
+        
+        // 回転切り替え
+        rotationFlipDemo();
+        
+        // ハードウェアスクロール
+        hardwareScrollDemo();
+        RetroPowerManager::hold(1000);
+        
+        // スプライトバッチ
+        spriteBatchDemo();
+        RetroPowerManager::hold(1000);
+        
+        // 多重スクロール
+        parallaxDemo();
+        RetroPowerManager::hold(1000);
+        
+        // 差分圧縮アニメーション
+        deltaAnimationDemo();
+        RetroPowerManager::hold(1000);
+        
+        // アセットパック
+        assetPackDemo();
+        RetroPowerManager::hold(1000);
+        
+        // 1bitモノクロ画像
+        monoImageDemo();
+        RetroPowerManager::hold(1000);
         
+        RetroRenderPool::logStats();
+        RetroPowerManager::logStats();
+        RetroPowerManager::resetStats();
         ESP_LOGI(TAG, "=== Demo cycle complete ===");
     }
 }